@@ -24,4 +24,6 @@
 #include "Sources/Containers/DataArrayHistogram.h"
 #include "Sources/Containers/DataArrayHistogram2D.h"
 
+#include "Sources/Containers/DataArrayStatistics.h"
+
 #endif // Containers_h__
@@ -72,9 +72,14 @@ class GenericAlgebraElement : public FieldElement<XRAD__template_1_args>
 		template<XRAD__template_2>
 		child_type	&operator /= (const GenericAlgebraElement<XRAD__template_2_args> &original){return algorithms_type::AA_Op_Assign(child_ref(), original, Functors::divide_assign());}
 		template<XRAD__template_2>
-		child_type	operator * (const GenericAlgebraElement<XRAD__template_2_args> &original) const {return algorithms_type::AA_Op_New(child_ref(), original, Functors::assign_multiply());}
+		child_type	operator * (const GenericAlgebraElement<XRAD__template_2_args> &original) const & {return algorithms_type::AA_Op_New(child_ref(), original, Functors::assign_multiply());}
 		template<XRAD__template_2>
-		child_type	operator / (const GenericAlgebraElement<XRAD__template_2_args> &original) const {return algorithms_type::AA_Op_New(child_ref(), original, Functors::assign_divide());}
+		child_type	operator / (const GenericAlgebraElement<XRAD__template_2_args> &original) const & {return algorithms_type::AA_Op_New(child_ref(), original, Functors::assign_divide());}
+		// для временного объекта результат записывается в него же (см. GenericFieldElement::temporary_AA_Op)
+		template<XRAD__template_2>
+		child_type	operator * (const GenericAlgebraElement<XRAD__template_2_args> &original) && {return this->temporary_AA_Op(original, Functors::multiply_assign(), Functors::assign_multiply());}
+		template<XRAD__template_2>
+		child_type	operator / (const GenericAlgebraElement<XRAD__template_2_args> &original) && {return this->temporary_AA_Op(original, Functors::divide_assign(), Functors::assign_divide());}
 
 
 		// тернарные действия: все массивы заранее имеют одинаковый размер,
@@ -21,6 +21,7 @@
 //--------------------------------------------------------------
 
 #include <XRADBasic/Sources/Containers/BasicArrayInteractions2D.h>
+#include "FieldExpression.h"
 
 XRAD_BEGIN
 
@@ -107,6 +108,52 @@ class AlgebraicAlgorithmsDataArray2D
 			Apply_AAS_2D_F3(array_0, array_1, x, ternary_action);
 			return array_0;
 		}
+
+		//! \name Ленивые выражения (FieldExpression.h), см. AlgebraicAlgorithmsDataArray
+		//! @{
+		static constexpr bool lazy_expressions = true;
+
+		template <class AT>
+		class row_cursor
+		{
+			public:
+				explicit row_cursor(const AT &array): m_array(array) {}
+				void start_row(size_t row_no) { m_it = m_array.row(row_no).begin(); }
+				const typename AT::value_type &next() { return *m_it++; }
+			private:
+				const AT &m_array;
+				typename AT::const_row_iterator m_it;
+		};
+
+		template <class AT, class E, class OP>
+		static AT &Expr_Op_Assign(AT& array, const E &expression, const OP &binary_action)
+		{
+			if(!array.hsize())
+				return array;
+			ParallelApply::ProcessParts<OP>(array.vsize(), array.vsize()*array.hsize(), [&](size_t i)
+				{
+					auto	cursor = expression.make_cursor();
+					cursor.start_row(i);
+					auto	&row = array.row(i);
+					for(auto it = row.begin(), ie = row.end(); it != ie; ++it)
+						binary_action(*it, cursor.next());
+				},
+				"Expr_Op_Assign");
+			return array;
+		}
+
+		template <class AT1, class AT2>
+		static void A_ReallocLike(AT1& result, const AT2& original)
+		{
+			result.realloc(original.vsize(), original.hsize());
+		}
+
+		template <class AT>
+		static FieldExpressionAuxiliaries::memory_layout A_MemoryLayout(const AT& array)
+		{
+			return ParallelApply::MemoryLayout_2D(array);
+		}
+		//! @}
 };
 
 //--------------------------------------------------------------
@@ -19,6 +19,7 @@
 //--------------------------------------------------------------
 
 #include <XRADBasic/Sources/Containers/BasicArrayInteractions1D.h>
+#include "FieldExpression.h"
 
 XRAD_BEGIN
 
@@ -192,6 +193,70 @@ class AlgebraicAlgorithmsDataArray
 		{
 			return Apply_Any_AA_1D_RF2(array_1, array_2, binary_test);
 		}
+
+		/*!
+			\name Ленивые выражения
+			\brief Поддержка выражений FieldExpression (см. FieldExpression.h)
+
+			Выражение вычисляется по строкам: row_cursor последовательно читает элементы строки операнда,
+			Expr_Op_Assign перебирает строки приемника в том же порядке.
+			Одномерный массив делится на строки по expression_row_size элементов, чтобы строки
+			можно было вычислять в разных потоках (как в Apply_*, см. ParallelApply.h).
+			@{
+		*/
+		static constexpr bool lazy_expressions = true;
+		static constexpr size_t expression_row_size = 4096;
+
+		template <class AT>
+		class row_cursor
+		{
+			public:
+				explicit row_cursor(const AT &array): m_array(array), m_it(array.begin()) {}
+				void start_row(size_t row_no) { m_it = m_array.begin() + ptrdiff_t(row_no*expression_row_size); }
+				const typename AT::value_type &next() { return *m_it++; }
+			private:
+				const AT &m_array;
+				typename AT::const_iterator m_it;
+		};
+
+		/*!
+			\brief Применяет функтор f(x, y) к элементам array и значениям выражения expression,
+			возвращает ссылку на array
+
+			Размеры должны быть проверены, перекрытие операндов с array должно быть исключено
+			(см. FieldExpressionAuxiliaries::AssignExpression).
+		*/
+		template <class AT, class E, class OP>
+		static AT &Expr_Op_Assign(AT& array, const E &expression, const OP &binary_action)
+		{
+			const size_t	n = array.size();
+			const size_t	n_rows = (n + expression_row_size - 1)/expression_row_size;
+			ParallelApply::ProcessParts<OP>(n_rows, n, [&](size_t i)
+				{
+					auto	cursor = expression.make_cursor();
+					cursor.start_row(i);
+					auto	it = array.begin() + ptrdiff_t(i*expression_row_size);
+					auto	ie = i + 1 < n_rows ? it + ptrdiff_t(expression_row_size) : array.end();
+					for(; it != ie; ++it)
+						binary_action(*it, cursor.next());
+				},
+				"Expr_Op_Assign");
+			return array;
+		}
+
+		//! \brief Выделяет в result память под массив размера original
+		template <class AT1, class AT2>
+		static void A_ReallocLike(AT1& result, const AT2& original)
+		{
+			result.realloc(original.size());
+		}
+
+		template <class AT>
+		static FieldExpressionAuxiliaries::memory_layout A_MemoryLayout(const AT& array)
+		{
+			return ParallelApply::MemoryLayout_1D(array);
+		}
+		//! @}
 };
 
 //--------------------------------------------------------------
@@ -21,6 +21,7 @@
 //--------------------------------------------------------------
 
 #include <XRADBasic/Sources/Containers/BasicArrayInteractionsMD.h>
+#include "FieldExpression.h"
 
 XRAD_BEGIN
 
@@ -107,6 +108,76 @@ class	AlgebraicAlgorithmsDataArrayMD
 			Apply_AAS_MD_F3(array_0, array_1, x, ternary_action);
 			return array_0;
 		}
+
+		//! \name Ленивые выражения (FieldExpression.h), см. AlgebraicAlgorithmsDataArray
+		//! Строки идут вдоль последнего измерения, в порядке возрастания остальных индексов.
+		//! @{
+		static constexpr bool lazy_expressions = true;
+
+		template <class AT>
+		class row_cursor
+		{
+			public:
+				explicit row_cursor(const AT &array): m_array(array) {}
+				void start_row(size_t row_no)
+				{
+					m_array.GetRow(m_row, row_index(m_array, row_no));
+					m_it = m_row.cbegin();
+				}
+				const typename AT::value_type &next() { return *m_it++; }
+			private:
+				const AT &m_array;
+				typename MDAT_aux::constness_types<const AT>::row_type m_row;
+				typename AT::const_row_iterator m_it;
+		};
+
+		template <class AT, class E, class OP>
+		static AT &Expr_Op_Assign(AT& array, const E &expression, const OP &binary_action)
+		{
+			if(array.empty())
+				return array;
+			const size_t	n_rows = array.element_count()/array.sizes(array.n_dimensions() - 1);
+			ParallelApply::ProcessParts<OP>(n_rows, array.element_count(), [&](size_t i)
+				{
+					auto	cursor = expression.make_cursor();
+					cursor.start_row(i);
+					typename MDAT_aux::constness_types<AT>::row_type	row;
+					array.GetRow(row, row_index(array, i));
+					for(auto it = row.begin(), ie = row.end(); it != ie; ++it)
+						binary_action(*it, cursor.next());
+				},
+				"Expr_Op_Assign");
+			return array;
+		}
+
+		template <class AT1, class AT2>
+		static void A_ReallocLike(AT1& result, const AT2& original)
+		{
+			result.realloc(original.sizes());
+		}
+
+		template <class AT>
+		static FieldExpressionAuxiliaries::memory_layout A_MemoryLayout(const AT& array)
+		{
+			return ParallelApply::MemoryLayout_MD(array);
+		}
+		//! @}
+
+	private:
+		//! \brief Спецификация строки номер row_no (для GetRow)
+		template <class AT>
+		static index_vector row_index(const AT &array, size_t row_no)
+		{
+			const size_t	n = array.n_dimensions();
+			index_vector	iv(n);
+			iv[n - 1] = slice_mask(0);
+			for(size_t d = n - 1; d-- > 0;)
+			{
+				iv[d] = row_no%array.sizes(d);
+				row_no /= array.sizes(d);
+			}
+			return iv;
+		}
 };
 
 //--------------------------------------------------------------
@@ -21,6 +21,7 @@
 
 #include <type_traits>
 #include "FieldTraits.h"
+#include "FieldExpression.h"
 #include <XRADBasic/Sources/Core/Functors.h>
 
 XRAD_BEGIN
@@ -42,6 +43,20 @@ XRAD_BEGIN
 namespace	AlgebraicStructures
 {
 
+//--------------------------------------------------------------
+
+namespace FieldElementAuxiliaries
+{
+
+//! \brief true, если массив владеет своими данными. Для контейнеров без uses_external_data() -- false
+template<class T>
+auto	owns_data(const T &x, int) -> decltype(!x.uses_external_data()) { return !x.uses_external_data(); }
+
+template<class T>
+bool	owns_data(const T &, long) { return false; }
+
+} // namespace FieldElementAuxiliaries
+
 //--------------------------------------------------------------
 /*!
 	\brief Элемент поля, универсальная часть
@@ -103,6 +118,60 @@ class GenericFieldElement : public CONTAINER_T
 		GenericFieldElement(parent &&p): parent(std::move(p)) {}
 		using parent::operator=;
 
+		//! \brief Создание массива из ленивого выражения (FieldExpression.h)
+		template<class E, std::enable_if_t<is_field_expression<E>::value, int> = 0>
+		GenericFieldElement(const E &expression)
+		{
+			expression.realloc_like(*this);
+			FieldExpressionAuxiliaries::AssignExpression<algorithms_type>(*this, expression, Functors::assign());
+		}
+
+		/*!
+			\brief Присваивание ленивого выражения (FieldExpression.h): все операции выполняются за один проход
+
+			Как и при присваивании массивов, пустой массив получает размер выражения,
+			непустой должен иметь тот же размер.
+		*/
+		template<class E, std::enable_if_t<is_field_expression<E>::value, int> = 0>
+		child_type	&operator = (const E &expression)
+		{
+			if(child_ref().empty())
+				expression.realloc_like(child_ref());
+			return FieldExpressionAuxiliaries::AssignExpression<algorithms_type>(child_ref(), expression, Functors::assign());
+		}
+
+		template<class E, std::enable_if_t<is_field_expression<E>::value, int> = 0>
+		child_type	&operator += (const E &expression) { return FieldExpressionAuxiliaries::AssignExpression<algorithms_type>(child_ref(), expression, Functors::plus_assign()); }
+
+		template<class E, std::enable_if_t<is_field_expression<E>::value, int> = 0>
+		child_type	&operator -= (const E &expression) { return FieldExpressionAuxiliaries::AssignExpression<algorithms_type>(child_ref(), expression, Functors::minus_assign()); }
+
+	protected:
+		/*!
+			\brief Бинарная операция над временным объектом (операторы с квалификатором &&)
+
+			Если временный объект владеет своими данными, результат записывается в него,
+			и выражения вида a*x + b - c не выделяют память на каждую операцию.
+			Временный объект, ссылающийся на чужие данные (например, фрагмент другого массива), не изменяется.
+		*/
+		template<class T2, class OP_ASSIGN, class OP_NEW>
+		child_type	temporary_AA_Op(const T2 &f2, const OP_ASSIGN &op_assign, const OP_NEW &op_new)
+		{
+			if(!FieldElementAuxiliaries::owns_data(child_ref(), 0))
+				return algorithms_type::AA_Op_New(child_ref(), f2, op_new);
+			algorithms_type::AA_Op_Assign(child_ref(), f2, op_assign);
+			return std::move(child_ref());
+		}
+
+		template<class T2, class OP_ASSIGN, class OP_NEW>
+		child_type	temporary_AS_Op(const T2 &x, const OP_ASSIGN &op_assign, const OP_NEW &op_new)
+		{
+			if(!FieldElementAuxiliaries::owns_data(child_ref(), 0))
+				return algorithms_type::AS_Op_New(child_ref(), x, op_new);
+			algorithms_type::AS_Op_Assign(child_ref(), x, op_assign);
+			return std::move(child_ref());
+		}
+
 	public:
 		// сложение с другим FieldElement
 		template<XRAD__template_2>
@@ -112,10 +181,14 @@ class GenericFieldElement : public CONTAINER_T
 		child_type	&operator -= (const GenericFieldElement<XRAD__template_2_args> &f2) { return algorithms_type::AA_Op_Assign(child_ref(), f2, Functors::minus_assign()); }
 
 		template<XRAD__template_2>
-		child_type	operator + (const GenericFieldElement<XRAD__template_2_args> &f2) const { return algorithms_type::AA_Op_New(child_ref(), f2, Functors::assign_plus()); }
+		child_type	operator + (const GenericFieldElement<XRAD__template_2_args> &f2) const & { return algorithms_type::AA_Op_New(child_ref(), f2, Functors::assign_plus()); }
+		template<XRAD__template_2>
+		child_type	operator + (const GenericFieldElement<XRAD__template_2_args> &f2) && { return temporary_AA_Op(f2, Functors::plus_assign(), Functors::assign_plus()); }
 
 		template<XRAD__template_2>
-		child_type	operator - (const GenericFieldElement<XRAD__template_2_args> &f2) const { return algorithms_type::AA_Op_New(child_ref(), f2, Functors::assign_minus()); }
+		child_type	operator - (const GenericFieldElement<XRAD__template_2_args> &f2) const & { return algorithms_type::AA_Op_New(child_ref(), f2, Functors::assign_minus()); }
+		template<XRAD__template_2>
+		child_type	operator - (const GenericFieldElement<XRAD__template_2_args> &f2) && { return temporary_AA_Op(f2, Functors::minus_assign(), Functors::assign_minus()); }
 
 		// Маскирование. Поэлементно умножает или делит контейнер на другой, равный ему по размерам. Сходно по наполнению с AlgebraElement::operator*
 		template<class MASK_T>
@@ -134,15 +207,19 @@ class GenericFieldElement : public CONTAINER_T
 		child_type	&operator *= (const scalar_type &x) { return algorithms_type::AS_Op_Assign(child_ref(), x, Functors::multiply_assign()); }
 		child_type	&operator /= (const scalar_type &x) { return algorithms_type::AS_Op_Assign(child_ref(), x, Functors::divide_assign()); }
 
-		child_type	operator * (const scalar_type &x) const { return algorithms_type::AS_Op_New(child_ref(), x, Functors::assign_multiply()); }
-		child_type	operator / (const scalar_type &x) const { return algorithms_type::AS_Op_New(child_ref(), x, Functors::assign_divide()); }
+		child_type	operator * (const scalar_type &x) const & { return algorithms_type::AS_Op_New(child_ref(), x, Functors::assign_multiply()); }
+		child_type	operator / (const scalar_type &x) const & { return algorithms_type::AS_Op_New(child_ref(), x, Functors::assign_divide()); }
+		child_type	operator * (const scalar_type &x) && { return temporary_AS_Op(x, Functors::multiply_assign(), Functors::assign_multiply()); }
+		child_type	operator / (const scalar_type &x) && { return temporary_AS_Op(x, Functors::divide_assign(), Functors::assign_divide()); }
 
 		// следующие действия (сложение с числом типа "компонент вектора") строго в алгебре не заданы.
 		// речь идет о действии с вектором, все компоненты которого равны x (иначе -- с константной функцией)
 		child_type	&operator += (const value_type &x) { return algorithms_type::AS_Op_Assign(child_ref(), x, Functors::plus_assign()); }
 		child_type	&operator -= (const value_type &x) { return algorithms_type::AS_Op_Assign(child_ref(), x, Functors::minus_assign()); }
-		child_type	operator + (const value_type &x) const { return algorithms_type::AS_Op_New(child_ref(), x, Functors::assign_plus()); }
-		child_type	operator - (const value_type &x) const { return algorithms_type::AS_Op_New(child_ref(), x, Functors::assign_minus()); }
+		child_type	operator + (const value_type &x) const & { return algorithms_type::AS_Op_New(child_ref(), x, Functors::assign_plus()); }
+		child_type	operator - (const value_type &x) const & { return algorithms_type::AS_Op_New(child_ref(), x, Functors::assign_minus()); }
+		child_type	operator + (const value_type &x) && { return temporary_AS_Op(x, Functors::plus_assign(), Functors::assign_plus()); }
+		child_type	operator - (const value_type &x) && { return temporary_AS_Op(x, Functors::minus_assign(), Functors::assign_minus()); }
 		// инкремент префиксный, поэлементное сложение или вычитание с единицей
 		child_type	&operator ++ () { return algorithms_type::A_Op_Assign(child_ref(), Functors::increment()); }
 		child_type	&operator -- () { return algorithms_type::A_Op_Assign(child_ref(), Functors::decrement()); }
@@ -215,7 +292,14 @@ class GenericFieldElement : public CONTAINER_T
 		}
 
 		// инверсия знака
-		child_type	operator - () const { return algorithms_type::A_Op_New(child_ref(), Functors::assign_unary_minus()); }
+		child_type	operator - () const & { return algorithms_type::A_Op_New(child_ref(), Functors::assign_unary_minus()); }
+		child_type	operator - () &&
+		{
+			if(!FieldElementAuxiliaries::owns_data(child_ref(), 0))
+				return algorithms_type::A_Op_New(child_ref(), Functors::assign_unary_minus());
+			algorithms_type::A_Op_Assign(child_ref(), Functors::unary_minus_inplace());
+			return std::move(child_ref());
+		}
 
 		// скалярное произведение, результат пишется в первый аргумент, тип результата задается извне
 		template<class RT, XRAD__template_2>
@@ -284,12 +368,31 @@ auto	operator * (const ST &x, const GenericFieldElement<XRAD__template_1_args> &
 	return y.child_ref() * x;
 }
 
+// те же операторы для временного y: результат записывается в y, если он владеет своими данными
+template<XRAD__template_1>
+auto operator + (const VT &x, GenericFieldElement<XRAD__template_1_args> &&y)
+{
+	return std::move(y.child_ref()) + x;
+}
+
+template<XRAD__template_1>
+auto	operator - (const VT &x, GenericFieldElement<XRAD__template_1_args> &&y)
+{
+	return -std::move(y.child_ref()) + x;
+}
+
+template<XRAD__template_1>
+auto	operator * (const ST &x, GenericFieldElement<XRAD__template_1_args> &&y)
+{
+	return std::move(y.child_ref()) * x;
+}
+
 template<XRAD__template_1>
 auto	operator / (const ST &x, const GenericFieldElement<XRAD__template_1_args> &y)
 {
 	auto	result = y.child_ref();
 	ApplyFunction(result, [](VT &x){return x = 1./x;});
-	return result * x;
+	return std::move(result) * x;
 }
 
 
@@ -0,0 +1,407 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_FieldExpression_h
+#define XRAD__File_FieldExpression_h
+/*!
+	\addtogroup gr_Algebra
+	@{
+
+	\file
+	\brief Ленивые выражения над элементами полей (FieldElement)
+
+	Обычные операторы FieldElement (a*b + c*d - e) создают новый массив на каждую операцию.
+	Выражение, начинающееся с lazy(), не вычисляется до присваивания: операторы строят дерево
+	выражения, а при присваивании (или создании массива из выражения) все операции выполняются
+	за один проход без промежуточных массивов:
+
+	~~~~
+	RealFunction2D_F32	result = lazy(a)*b + lazy(c)*d - e;
+	result += lazy(a)*0.5 - b;
+	~~~~
+
+	Тип промежуточного результата каждой операции тот же, что и у обычных операторов
+	(тип элемента первого операнда), поэтому округление совпадает с вычислением через временные массивы.
+
+	Если какой-либо операнд частично перекрывается в памяти с массивом-приемником (например,
+	сдвинутый фрагмент того же массива), выражение вычисляется во временный массив,
+	как и при обычных операторах. Совпадение операнда с приемником (a = lazy(a)*b + c) безопасно
+	и временного массива не требует.
+
+	Выражения поддерживаются для алгоритмов, в которых объявлено lazy_expressions = true
+	(DataArray, DataArray2D, DataArrayMD). Для остальных типов lazy() возвращает сам массив,
+	и выражение вычисляется обычными операторами.
+
+	Объект выражения хранит ссылки на массивы-операнды, поэтому сохранять его (auto e = lazy(a) + b;)
+	можно только пока существуют операнды.
+
+	@}
+*/
+//--------------------------------------------------------------
+
+#include <XRADBasic/Sources/Core/Functors.h>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+XRAD_BEGIN
+
+namespace AlgebraicStructures
+{
+
+namespace FieldExpressionAuxiliaries
+{
+
+//--------------------------------------------------------------
+
+//! \brief Расположение массива в памяти, используется для обнаружения перекрытия операндов с приемником
+struct memory_layout
+{
+	const char	*first = nullptr;
+	const char	*min_address = nullptr;
+	const char	*max_address = nullptr;
+	size_t	element_size = 0;
+	std::vector<ptrdiff_t>	byte_steps;
+
+	memory_layout(){}
+
+	//! \brief first -- адрес первого элемента, sizes и byte_steps -- размеры и шаги (в байтах) по каждому измерению
+	template<class T>
+	memory_layout(const T *in_first, const std::vector<size_t> &sizes, const std::vector<ptrdiff_t> &in_byte_steps):
+		first(reinterpret_cast<const char*>(in_first)),
+		element_size(sizeof(T)),
+		byte_steps(in_byte_steps)
+	{
+		ptrdiff_t	low = 0, high = 0;
+		for(size_t i = 0; i < sizes.size(); ++i)
+		{
+			ptrdiff_t	extent = ptrdiff_t(sizes[i] - 1)*byte_steps[i];
+			(extent < 0 ? low : high) += extent;
+		}
+		min_address = first + low;
+		max_address = first + high + element_size - 1;
+	}
+
+	bool	empty() const { return !first; }
+
+	bool	overlaps(const memory_layout &other) const
+	{
+		return !empty() && !other.empty() && min_address <= other.max_address && other.min_address <= max_address;
+	}
+
+	//! \brief Элементы с одинаковыми индексами находятся по одним и тем же адресам
+	bool	same(const memory_layout &other) const
+	{
+		return first == other.first && element_size == other.element_size && byte_steps == other.byte_steps;
+	}
+};
+
+//! \brief Разность адресов двух элементов в байтах
+template<class T>
+ptrdiff_t	byte_distance(const T &x1, const T &x2)
+{
+	return reinterpret_cast<const char*>(&x2) - reinterpret_cast<const char*>(&x1);
+}
+
+//--------------------------------------------------------------
+
+template<class ALG, class = void>
+struct supports_lazy_expressions : std::false_type {};
+
+template<class ALG>
+struct supports_lazy_expressions<ALG, std::enable_if_t<ALG::lazy_expressions>> : std::true_type {};
+
+//--------------------------------------------------------------
+
+} // namespace FieldExpressionAuxiliaries
+
+//--------------------------------------------------------------
+
+//! \brief Общий предок всех выражений, служит для их распознавания в шаблонах
+class FieldExpressionBase {};
+
+template<class T>
+using is_field_expression = std::is_base_of<FieldExpressionBase, std::decay_t<T>>;
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Операнд выражения -- массив
+
+	Чтение идет построчно: строки задаются алгоритмами массива (ALG::row_cursor),
+	разбиение на строки одинаково для всех массивов одного вида (одномерных, двумерных, многомерных).
+*/
+template<class AT>
+class FieldExpressionArray : public FieldExpressionBase
+{
+	public:
+		typedef std::remove_cv_t<typename AT::value_type> value_type;
+		typedef typename AT::algorithms_type algorithms_type;
+		static constexpr bool is_scalar = false;
+
+		explicit FieldExpressionArray(const AT &array): m_array(array){}
+
+		class cursor
+		{
+			public:
+				explicit cursor(const AT &array): m_row(array){}
+				void	start_row(size_t row_no){ m_row.start_row(row_no); }
+				decltype(auto)	next(){ return m_row.next(); }
+			private:
+				typename algorithms_type::template row_cursor<AT>	m_row;
+		};
+
+		cursor	make_cursor() const { return cursor(m_array); }
+
+		template<class DEST>
+		void	check_sizes(const DEST &destination) const
+		{
+			if(!algorithms_type::AA_EqSize(destination, m_array))
+				throw invalid_argument("FieldExpression: array sizes do not match");
+		}
+
+		template<class DEST>
+		bool	realloc_like(DEST &destination) const
+		{
+			algorithms_type::A_ReallocLike(destination, m_array);
+			return true;
+		}
+
+		bool	aliased(const FieldExpressionAuxiliaries::memory_layout &destination) const
+		{
+			FieldExpressionAuxiliaries::memory_layout	layout = algorithms_type::A_MemoryLayout(m_array);
+			return layout.overlaps(destination) && !layout.same(destination);
+		}
+
+	private:
+		const AT	&m_array;
+};
+
+//! \brief Операнд выражения -- число (одинаковое для всех элементов)
+template<class T>
+class FieldExpressionScalar : public FieldExpressionBase
+{
+	public:
+		typedef T value_type;
+		static constexpr bool is_scalar = true;
+
+		explicit FieldExpressionScalar(const T &value): m_value(value){}
+
+		class cursor
+		{
+			public:
+				explicit cursor(const T &value): m_value(value){}
+				void	start_row(size_t){}
+				const T	&next() const { return m_value; }
+			private:
+				T	m_value;
+		};
+
+		cursor	make_cursor() const { return cursor(m_value); }
+
+		template<class DEST>
+		void	check_sizes(const DEST &) const {}
+		template<class DEST>
+		bool	realloc_like(DEST &) const { return false; }
+		bool	aliased(const FieldExpressionAuxiliaries::memory_layout &) const { return false; }
+
+	private:
+		T	m_value;
+};
+
+/*!
+	\brief Двуместная операция. Функтор вызывается как op(result, x, y)
+
+	Тип результата -- тип элемента первого операнда-массива (как у обычных операторов FieldElement).
+*/
+template<class E1, class E2, class OP>
+class FieldExpressionBinary : public FieldExpressionBase
+{
+	public:
+		typedef std::conditional_t<E1::is_scalar, typename E2::value_type, typename E1::value_type> value_type;
+		static constexpr bool is_scalar = false;
+
+		FieldExpressionBinary(const E1 &e1, const E2 &e2, const OP &op): m_e1(e1), m_e2(e2), m_op(op){}
+
+		class cursor
+		{
+			public:
+				cursor(const FieldExpressionBinary &e): m_c1(e.m_e1.make_cursor()), m_c2(e.m_e2.make_cursor()), m_op(e.m_op){}
+				void	start_row(size_t row_no){ m_c1.start_row(row_no); m_c2.start_row(row_no); }
+				value_type	next()
+				{
+					value_type	result;
+					auto	&&x1 = m_c1.next();
+					auto	&&x2 = m_c2.next();
+					m_op(result, x1, x2);
+					return result;
+				}
+			private:
+				typename E1::cursor	m_c1;
+				typename E2::cursor	m_c2;
+				OP	m_op;
+		};
+
+		cursor	make_cursor() const { return cursor(*this); }
+
+		template<class DEST>
+		void	check_sizes(const DEST &destination) const { m_e1.check_sizes(destination); m_e2.check_sizes(destination); }
+		template<class DEST>
+		bool	realloc_like(DEST &destination) const { return m_e1.realloc_like(destination) || m_e2.realloc_like(destination); }
+		bool	aliased(const FieldExpressionAuxiliaries::memory_layout &destination) const { return m_e1.aliased(destination) || m_e2.aliased(destination); }
+
+	private:
+		E1	m_e1;
+		E2	m_e2;
+		OP	m_op;
+};
+
+//! \brief Одноместная операция. Функтор вызывается как op(result, x)
+template<class E, class OP>
+class FieldExpressionUnary : public FieldExpressionBase
+{
+	public:
+		typedef typename E::value_type value_type;
+		static constexpr bool is_scalar = false;
+
+		FieldExpressionUnary(const E &e, const OP &op): m_e(e), m_op(op){}
+
+		class cursor
+		{
+			public:
+				cursor(const FieldExpressionUnary &e): m_c(e.m_e.make_cursor()), m_op(e.m_op){}
+				void	start_row(size_t row_no){ m_c.start_row(row_no); }
+				value_type	next()
+				{
+					value_type	result;
+					m_op(result, m_c.next());
+					return result;
+				}
+			private:
+				typename E::cursor	m_c;
+				OP	m_op;
+		};
+
+		cursor	make_cursor() const { return cursor(*this); }
+
+		template<class DEST>
+		void	check_sizes(const DEST &destination) const { m_e.check_sizes(destination); }
+		template<class DEST>
+		bool	realloc_like(DEST &destination) const { return m_e.realloc_like(destination); }
+		bool	aliased(const FieldExpressionAuxiliaries::memory_layout &destination) const { return m_e.aliased(destination); }
+
+	private:
+		E	m_e;
+		OP	m_op;
+};
+
+//--------------------------------------------------------------
+
+namespace FieldExpressionAuxiliaries
+{
+
+/*!
+	\brief Вычисление выражения с функтором action(result_element, value), используется FieldElement
+
+	Если операнд частично перекрывается с result, выражение сначала вычисляется во временный массив.
+*/
+template<class ALG, class AT, class E, class OP>
+AT	&AssignExpression(AT &result, const E &expression, const OP &action)
+{
+	expression.check_sizes(result);
+	if(expression.aliased(ALG::A_MemoryLayout(result)))
+	{
+		AT	buffer;
+		ALG::A_ReallocLike(buffer, result);
+		ALG::Expr_Op_Assign(buffer, expression, Functors::assign());
+		return ALG::AA_Op_Assign(result, buffer, action);
+	}
+	return ALG::Expr_Op_Assign(result, expression, action);
+}
+
+template<class T, class = void>
+struct has_algorithms : std::false_type {};
+
+template<class T>
+struct has_algorithms<T, std::void_t<typename T::algorithms_type>> : std::true_type {};
+
+template<class T>
+auto	as_expression(const T &x)
+{
+	if constexpr(is_field_expression<T>::value)
+	{
+		return x;
+	}
+	else if constexpr(has_algorithms<T>::value)
+	{
+		static_assert(supports_lazy_expressions<typename T::algorithms_type>::value,
+				"FieldExpression: lazy expressions are not supported for this container type.");
+		return FieldExpressionArray<T>(x);
+	}
+	else
+	{
+		return FieldExpressionScalar<T>(x);
+	}
+}
+
+template<class X, class Y, class OP>
+auto	make_binary(const X &x, const Y &y, const OP &op)
+{
+	auto	e1 = as_expression(x);
+	auto	e2 = as_expression(y);
+	return FieldExpressionBinary<decltype(e1), decltype(e2), OP>(e1, e2, op);
+}
+
+template<class X, class Y>
+using enable_if_expression_operands = std::enable_if_t<is_field_expression<X>::value || is_field_expression<Y>::value, int>;
+
+} // namespace FieldExpressionAuxiliaries
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Начало ленивого выражения: lazy(a)*b + c
+
+	Для контейнеров, алгоритмы которых не поддерживают выражения, возвращает ссылку на сам массив,
+	и дальнейшие операции выполняются обычными операторами.
+*/
+template<class AT>
+decltype(auto)	lazy(const AT &array)
+{
+	if constexpr(FieldExpressionAuxiliaries::supports_lazy_expressions<typename AT::algorithms_type>::value)
+		return FieldExpressionArray<AT>(array);
+	else
+		return (array);
+}
+
+//--------------------------------------------------------------
+//
+//	Операторы. Хотя бы один из операндов должен быть выражением,
+//	второй может быть выражением, массивом (FieldElement) или числом.
+//
+
+template<class X, class Y, FieldExpressionAuxiliaries::enable_if_expression_operands<X, Y> = 0>
+auto	operator + (const X &x, const Y &y) { return FieldExpressionAuxiliaries::make_binary(x, y, Functors::assign_plus()); }
+
+template<class X, class Y, FieldExpressionAuxiliaries::enable_if_expression_operands<X, Y> = 0>
+auto	operator - (const X &x, const Y &y) { return FieldExpressionAuxiliaries::make_binary(x, y, Functors::assign_minus()); }
+
+//! \brief Умножение на число или поэлементное умножение (как AlgebraElement::operator*)
+template<class X, class Y, FieldExpressionAuxiliaries::enable_if_expression_operands<X, Y> = 0>
+auto	operator * (const X &x, const Y &y) { return FieldExpressionAuxiliaries::make_binary(x, y, Functors::assign_multiply()); }
+
+template<class X, class Y, FieldExpressionAuxiliaries::enable_if_expression_operands<X, Y> = 0>
+auto	operator / (const X &x, const Y &y) { return FieldExpressionAuxiliaries::make_binary(x, y, Functors::assign_divide()); }
+
+template<class E, std::enable_if_t<is_field_expression<E>::value, int> = 0>
+auto	operator - (const E &e) { return FieldExpressionUnary<E, Functors::assign_unary_minus>(e, Functors::assign_unary_minus()); }
+
+//--------------------------------------------------------------
+
+} // namespace AlgebraicStructures
+
+XRAD_END
+
+#endif // XRAD__File_FieldExpression_h
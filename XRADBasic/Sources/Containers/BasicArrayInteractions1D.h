@@ -37,6 +37,7 @@
 
 #include <XRADBasic/Core.h>
 #include "ContainersBasic.h"
+#include "ParallelApply.h"
 
 XRAD_BEGIN
 
@@ -144,16 +145,26 @@ void ECheckSizes_AA_1D(const Array1 &array_1, const Array2 &array_2)
 
 //--------------------------------------------------------------
 
+/*!
+	\details
+	Функции Apply_A_1D_F1, Apply_A_1D_RF1, Apply_AS_1D_F2, Apply_AA_1D_F2, Apply_AAA_1D_F3, Apply_AAS_1D_F3
+	для больших массивов и поэлементных функторов выполняются в несколько потоков,
+	массив делится на непрерывные отрезки. См. ParallelApply.h.
+*/
 template <class Array, class Functor>
 void Apply_A_1D_F1(Array &&array, Functor functor)
 {
-	auto it = array.begin();
-	auto ie = array.end();
+	ParallelApply::ProcessRanges<Functor>(ParallelApply::RangeSize(array.begin(), array.end()), [&](size_t first, size_t last)
+		{
+			auto it = std::next(array.begin(), first);
+			auto ie = std::next(array.begin(), last);
 
-	for(; it != ie; ++it)
-	{
-		functor(*it);
-	}
+			for(; it != ie; ++it)
+			{
+				functor(*it);
+			}
+		},
+		"Apply_A_1D_F1");
 }
 
 //--------------------------------------------------------------
@@ -161,13 +172,17 @@ void Apply_A_1D_F1(Array &&array, Functor functor)
 template <class Array, class Functor>
 void Apply_A_1D_RF1(Array &&array, Functor functor)
 {
-	auto it = array.begin();
-	auto ie = array.end();
+	ParallelApply::ProcessRanges<Functor>(ParallelApply::RangeSize(array.begin(), array.end()), [&](size_t first, size_t last)
+		{
+			auto it = std::next(array.begin(), first);
+			auto ie = std::next(array.begin(), last);
 
-	for(; it != ie; ++it)
-	{
-		*it = functor(*it);
-	}
+			for(; it != ie; ++it)
+			{
+				*it = functor(*it);
+			}
+		},
+		"Apply_A_1D_RF1");
 }
 
 //--------------------------------------------------------------
@@ -198,13 +213,17 @@ void Apply_IA_1D_F2(Array &&array, Functor functor)
 template <class Array, class Scalar, class Functor>
 void Apply_AS_1D_F2(Array &&array, Scalar &&scalar, Functor functor)
 {
-	auto it = array.begin();
-	auto ie = array.end();
+	ParallelApply::ProcessRanges<Functor>(ParallelApply::RangeSize(array.begin(), array.end()), [&](size_t first, size_t last)
+		{
+			auto it = std::next(array.begin(), first);
+			auto ie = std::next(array.begin(), last);
 
-	for(; it != ie; ++it)
-	{
-		functor(*it, scalar);
-	}
+			for(; it != ie; ++it)
+			{
+				functor(*it, scalar);
+			}
+		},
+		"Apply_AS_1D_F2");
 }
 
 //--------------------------------------------------------------
@@ -216,14 +235,19 @@ void Apply_AA_1D_F2(Array1 &&array_1, Array2 &&array_2, Functor functor)
 {
 	ECheckSizes_AA_1D<Apply_AA_1D_F2_name>(array_1, array_2);
 
-	auto it1 = array_1.begin();
-	auto ie1 = array_1.end();
-	auto it2 = array_2.begin();
+	ParallelApply::ProcessRanges<Functor>(ParallelApply::RangeSize(array_1.begin(), array_1.end()), [&](size_t first, size_t last)
+		{
+			auto it1 = std::next(array_1.begin(), first);
+			auto ie1 = std::next(array_1.begin(), last);
+			auto it2 = std::next(array_2.begin(), first);
 
-	for(; it1 != ie1; ++it1, ++it2)
-	{
-		functor(*it1, *it2);
-	}
+			for(; it1 != ie1; ++it1, ++it2)
+			{
+				functor(*it1, *it2);
+			}
+		},
+		Apply_AA_1D_F2_name::name(),
+		[&] { return ParallelApply::IndependentOperands(ParallelApply::MemoryLayout_1D(array_1), ParallelApply::MemoryLayout_1D(array_2)); });
 }
 
 //--------------------------------------------------------------
@@ -326,15 +350,25 @@ void Apply_AAA_1D_F3(Array1 &&array_1, Array2 &&array_2, Array3 &&array_3, Funct
 	ECheckSizes_AA_1D<Apply_AAA_1D_F3_name>(array_1, array_2);
 	ECheckSizes_AA_1D<Apply_AAA_1D_F3_name>(array_2, array_3);
 
-	auto it1 = array_1.begin();
-	auto ie1 = array_1.end();
-	auto it2 = array_2.begin();
-	auto it3 = array_3.begin();
+	ParallelApply::ProcessRanges<Functor>(ParallelApply::RangeSize(array_1.begin(), array_1.end()), [&](size_t first, size_t last)
+		{
+			auto it1 = std::next(array_1.begin(), first);
+			auto ie1 = std::next(array_1.begin(), last);
+			auto it2 = std::next(array_2.begin(), first);
+			auto it3 = std::next(array_3.begin(), first);
 
-	for(; it1 != ie1; ++it1, ++it2, ++it3)
-	{
-		functor(*it1, *it2, *it3);
-	}
+			for(; it1 != ie1; ++it1, ++it2, ++it3)
+			{
+				functor(*it1, *it2, *it3);
+			}
+		},
+		Apply_AAA_1D_F3_name::name(),
+		[&]
+		{
+			auto	layout_1 = ParallelApply::MemoryLayout_1D(array_1);
+			return ParallelApply::IndependentOperands(layout_1, ParallelApply::MemoryLayout_1D(array_2)) &&
+					ParallelApply::IndependentOperands(layout_1, ParallelApply::MemoryLayout_1D(array_3));
+		});
 }
 
 //--------------------------------------------------------------
@@ -346,14 +380,19 @@ void Apply_AAS_1D_F3(Array1 &&array_1, Array2 &&array_2, Scalar &&scalar, Functo
 {
 	ECheckSizes_AA_1D<Apply_AAS_1D_F3_name>(array_1, array_2);
 
-	auto it1 = array_1.begin();
-	auto ie1 = array_1.end();
-	auto it2 = array_2.begin();
+	ParallelApply::ProcessRanges<Functor>(ParallelApply::RangeSize(array_1.begin(), array_1.end()), [&](size_t first, size_t last)
+		{
+			auto it1 = std::next(array_1.begin(), first);
+			auto ie1 = std::next(array_1.begin(), last);
+			auto it2 = std::next(array_2.begin(), first);
 
-	for(; it1 != ie1; ++it1, ++it2)
-	{
-		functor(*it1, *it2, scalar);
-	}
+			for(; it1 != ie1; ++it1, ++it2)
+			{
+				functor(*it1, *it2, scalar);
+			}
+		},
+		Apply_AAS_1D_F3_name::name(),
+		[&] { return ParallelApply::IndependentOperands(ParallelApply::MemoryLayout_1D(array_1), ParallelApply::MemoryLayout_1D(array_2)); });
 }
 
 //--------------------------------------------------------------
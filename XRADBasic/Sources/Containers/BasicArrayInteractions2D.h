@@ -85,17 +85,19 @@ void Apply_A_2D_F1(Array &&array, Functor functor)
 {
 	if(array.steps(1) < array.steps(0))
 	{
-		for (size_t i = 0; i < array.sizes(0); ++i)
-		{
-			Apply_A_1D_F1(array.row(i), functor);
-		}
+		ParallelApply::ProcessParts<Functor>(array.sizes(0), array.sizes(0)*array.sizes(1), [&](size_t i)
+			{
+				Apply_A_1D_F1(array.row(i), functor);
+			},
+			"Apply_A_2D_F1");
 	}
 	else
 	{
-		for (size_t i = 0; i < array.sizes(1); ++i)
-		{
-			Apply_A_1D_F1(array.col(i), functor);
-		}
+		ParallelApply::ProcessParts<Functor>(array.sizes(1), array.sizes(0)*array.sizes(1), [&](size_t i)
+			{
+				Apply_A_1D_F1(array.col(i), functor);
+			},
+			"Apply_A_2D_F1");
 	}
 }
 
@@ -166,17 +168,19 @@ void Apply_A_2D_RF1(Array &&array, Functor functor)
 {
 	if(array.steps(1) < array.steps(0))
 	{
-		for (size_t i = 0; i < array.sizes(0); ++i)
-		{
-			Apply_A_1D_RF1(array.row(i), functor);
-		}
+		ParallelApply::ProcessParts<Functor>(array.sizes(0), array.sizes(0)*array.sizes(1), [&](size_t i)
+			{
+				Apply_A_1D_RF1(array.row(i), functor);
+			},
+			"Apply_A_2D_RF1");
 	}
 	else
 	{
-		for (size_t i = 0; i < array.sizes(1); ++i)
-		{
-			Apply_A_1D_RF1(array.col(i), functor);
-		}
+		ParallelApply::ProcessParts<Functor>(array.sizes(1), array.sizes(0)*array.sizes(1), [&](size_t i)
+			{
+				Apply_A_1D_RF1(array.col(i), functor);
+			},
+			"Apply_A_2D_RF1");
 	}
 }
 
@@ -187,17 +191,19 @@ void Apply_AS_2D_F2(Array &&array, Scalar &&scalar, Functor functor)
 {
 	if(array.steps(1) < array.steps(0))
 	{
-		for (size_t i = 0; i < array.sizes(0); ++i)
-		{
-			Apply_AS_1D_F2(array.row(i), scalar, functor);
-		}
+		ParallelApply::ProcessParts<Functor>(array.sizes(0), array.sizes(0)*array.sizes(1), [&](size_t i)
+			{
+				Apply_AS_1D_F2(array.row(i), scalar, functor);
+			},
+			"Apply_AS_2D_F2");
 	}
 	else
 	{
-		for (size_t i = 0; i < array.sizes(1); ++i)
-		{
-			Apply_AS_1D_F2(array.col(i), scalar, functor);
-		}
+		ParallelApply::ProcessParts<Functor>(array.sizes(1), array.sizes(0)*array.sizes(1), [&](size_t i)
+			{
+				Apply_AS_1D_F2(array.col(i), scalar, functor);
+			},
+			"Apply_AS_2D_F2");
 	}
 }
 
@@ -212,17 +218,21 @@ void Apply_AA_2D_F2(Array1 &&array_1, Array2 &&array_2, Functor functor)
 
 	if(array_1.steps(1) < array_1.steps(0))
 	{
-		for (size_t i = 0; i < array_1.sizes(0); ++i)
-		{
-			Apply_AA_1D_F2(array_1.row(i), array_2.row(i), functor);
-		}
+		ParallelApply::ProcessParts<Functor>(array_1.sizes(0), array_1.sizes(0)*array_1.sizes(1), [&](size_t i)
+			{
+				Apply_AA_1D_F2(array_1.row(i), array_2.row(i), functor);
+			},
+			Apply_AA_2D_F2_name::name(),
+			[&] { return ParallelApply::IndependentOperands(ParallelApply::MemoryLayout_2D(array_1), ParallelApply::MemoryLayout_2D(array_2)); });
 	}
 	else
 	{
-		for (size_t i = 0; i < array_1.sizes(1); ++i)
-		{
-			Apply_AA_1D_F2(array_1.col(i), array_2.col(i), functor);
-		}
+		ParallelApply::ProcessParts<Functor>(array_1.sizes(1), array_1.sizes(0)*array_1.sizes(1), [&](size_t i)
+			{
+				Apply_AA_1D_F2(array_1.col(i), array_2.col(i), functor);
+			},
+			Apply_AA_2D_F2_name::name(),
+			[&] { return ParallelApply::IndependentOperands(ParallelApply::MemoryLayout_2D(array_1), ParallelApply::MemoryLayout_2D(array_2)); });
 	}
 }
 
@@ -339,20 +349,30 @@ void Apply_AAA_2D_F3(Array1 &&array_1, Array2 &&array_2, Array3 &&array_3, Funct
 {
 	ECheckSizes_AA_2D<Apply_AAA_2D_F3_name>(array_1, array_2);
 	ECheckSizes_AA_2D<Apply_AAA_2D_F3_name>(array_2, array_3);
+	auto	independent_operands = [&]
+	{
+		auto	layout_1 = ParallelApply::MemoryLayout_2D(array_1);
+		return ParallelApply::IndependentOperands(layout_1, ParallelApply::MemoryLayout_2D(array_2)) &&
+				ParallelApply::IndependentOperands(layout_1, ParallelApply::MemoryLayout_2D(array_3));
+	};
 
 	if(array_1.steps(1) < array_1.steps(0))
 	{
-		for (size_t i = 0; i < array_1.sizes(0); ++i)
-		{
-			Apply_AAA_1D_F3(array_1.row(i), array_2.row(i), array_3.row(i), functor);
-		}
+		ParallelApply::ProcessParts<Functor>(array_1.sizes(0), array_1.sizes(0)*array_1.sizes(1), [&](size_t i)
+			{
+				Apply_AAA_1D_F3(array_1.row(i), array_2.row(i), array_3.row(i), functor);
+			},
+			Apply_AAA_2D_F3_name::name(),
+			independent_operands);
 	}
 	else
 	{
-		for (size_t i = 0; i < array_1.sizes(1); ++i)
-		{
-			Apply_AAA_1D_F3(array_1.col(i), array_2.col(i), array_3.col(i), functor);
-		}
+		ParallelApply::ProcessParts<Functor>(array_1.sizes(1), array_1.sizes(0)*array_1.sizes(1), [&](size_t i)
+			{
+				Apply_AAA_1D_F3(array_1.col(i), array_2.col(i), array_3.col(i), functor);
+			},
+			Apply_AAA_2D_F3_name::name(),
+			independent_operands);
 	}
 }
 
@@ -367,17 +387,21 @@ void Apply_AAS_2D_F3(Array1 &&array_1, Array2 &&array_2, Scalar &&scalar, Functo
 
 	if(array_1.steps(1) < array_1.steps(0))
 	{
-		for (size_t i = 0; i < array_1.sizes(0); ++i)
-		{
-			Apply_AAS_1D_F3(array_1.row(i), array_2.row(i), scalar, functor);
-		}
+		ParallelApply::ProcessParts<Functor>(array_1.sizes(0), array_1.sizes(0)*array_1.sizes(1), [&](size_t i)
+			{
+				Apply_AAS_1D_F3(array_1.row(i), array_2.row(i), scalar, functor);
+			},
+			Apply_AAS_2D_F3_name::name(),
+			[&] { return ParallelApply::IndependentOperands(ParallelApply::MemoryLayout_2D(array_1), ParallelApply::MemoryLayout_2D(array_2)); });
 	}
 	else
 	{
-		for (size_t i = 0; i < array_1.sizes(1); ++i)
-		{
-			Apply_AAS_1D_F3(array_1.col(i), array_2.col(i), scalar, functor);
-		}
+		ParallelApply::ProcessParts<Functor>(array_1.sizes(1), array_1.sizes(0)*array_1.sizes(1), [&](size_t i)
+			{
+				Apply_AAS_1D_F3(array_1.col(i), array_2.col(i), scalar, functor);
+			},
+			Apply_AAS_2D_F3_name::name(),
+			[&] { return ParallelApply::IndependentOperands(ParallelApply::MemoryLayout_2D(array_1), ParallelApply::MemoryLayout_2D(array_2)); });
 	}
 }
 
@@ -159,24 +159,25 @@ void Apply_A_MD_F1(Array &array, Functor functor)
 	MaxValue(array.steps(), &scan_dimension);
 	const size_t	scan_size = array.sizes(scan_dimension);
 	size_t	n_dimensions = array.n_dimensions();
-	for(size_t i = 0; i < scan_size; ++i)
-	{
-		index_vector	subset_mask = MDAT_aux::GetSubsetMask(array, scan_dimension, i);
-		if(n_dimensions > 3)
-		{
-			typename MDAT_aux::constness_types<Array>::array_type subset;
-			array.GetSubset(subset, subset_mask);
-			// рекурсия
-			Apply_A_MD_F1(subset, functor);
-		}
-		else
+	ParallelApply::ProcessParts<Functor>(scan_size, array.element_count(), [&](size_t i)
 		{
-			typename MDAT_aux::constness_types<Array>::slice_type slice;
-			array.GetSlice(slice, subset_mask);
-			// конец рекурсии, обработка двумерного среза
-			Apply_A_2D_F1(slice, functor);
-		}
-	}
+			index_vector	subset_mask = MDAT_aux::GetSubsetMask(array, scan_dimension, i);
+			if(n_dimensions > 3)
+			{
+				typename MDAT_aux::constness_types<Array>::array_type subset;
+				array.GetSubset(subset, subset_mask);
+				// рекурсия
+				Apply_A_MD_F1(subset, functor);
+			}
+			else
+			{
+				typename MDAT_aux::constness_types<Array>::slice_type slice;
+				array.GetSlice(slice, subset_mask);
+				// конец рекурсии, обработка двумерного среза
+				Apply_A_2D_F1(slice, functor);
+			}
+		},
+		Apply_A_MD_F1_name::name());
 }
 
 //--------------------------------------------------------------
@@ -274,24 +275,25 @@ void Apply_A_MD_RF1(Array &array, Functor functor)
 	MaxValue(array.steps(), &scan_dimension);
 	const size_t	scan_size = array.sizes(scan_dimension);
 	size_t	n_dimensions = array.n_dimensions();
-	for(size_t i = 0; i < scan_size; ++i)
-	{
-		index_vector	subset_mask = MDAT_aux::GetSubsetMask(array, scan_dimension, i);
-		if(n_dimensions > 3)
-		{
-			typename MDAT_aux::constness_types<Array>::array_type subset;
-			array.GetSubset(subset, subset_mask);
-			// рекурсия
-			Apply_A_MD_RF1(subset, functor);
-		}
-		else
+	ParallelApply::ProcessParts<Functor>(scan_size, array.element_count(), [&](size_t i)
 		{
-			typename MDAT_aux::constness_types<Array>::slice_type slice;
-			array.GetSlice(slice, subset_mask);
-			// конец рекурсии, обработка двумерного среза
-			Apply_A_2D_RF1(slice, functor);
-		}
-	}
+			index_vector	subset_mask = MDAT_aux::GetSubsetMask(array, scan_dimension, i);
+			if(n_dimensions > 3)
+			{
+				typename MDAT_aux::constness_types<Array>::array_type subset;
+				array.GetSubset(subset, subset_mask);
+				// рекурсия
+				Apply_A_MD_RF1(subset, functor);
+			}
+			else
+			{
+				typename MDAT_aux::constness_types<Array>::slice_type slice;
+				array.GetSlice(slice, subset_mask);
+				// конец рекурсии, обработка двумерного среза
+				Apply_A_2D_RF1(slice, functor);
+			}
+		},
+		Apply_A_MD_RF1_name::name());
 }
 
 //--------------------------------------------------------------
@@ -314,24 +316,25 @@ void Apply_AS_MD_F2(Array &array, Scalar &scalar, Functor functor)
 	MaxValue(array.steps(), &scan_dimension);
 	const size_t	scan_size = array.sizes(scan_dimension);
 	size_t	n_dimensions = array.n_dimensions();
-	for(size_t i = 0; i < scan_size; ++i)
-	{
-		index_vector	subset_mask = MDAT_aux::GetSubsetMask(array, scan_dimension, i);
-		if(n_dimensions > 3)
-		{
-			typename MDAT_aux::constness_types<Array>::array_type subset;
-			array.GetSubset(subset, subset_mask);
-			// рекурсия
-			Apply_AS_MD_F2(subset, scalar, functor);
-		}
-		else
+	ParallelApply::ProcessParts<Functor>(scan_size, array.element_count(), [&](size_t i)
 		{
-			typename MDAT_aux::constness_types<Array>::slice_type slice;
-			array.GetSlice(slice, subset_mask);
-			// конец рекурсии, обработка двумерного среза
-			Apply_AS_2D_F2(slice, scalar, functor);
-		}
-	}
+			index_vector	subset_mask = MDAT_aux::GetSubsetMask(array, scan_dimension, i);
+			if(n_dimensions > 3)
+			{
+				typename MDAT_aux::constness_types<Array>::array_type subset;
+				array.GetSubset(subset, subset_mask);
+				// рекурсия
+				Apply_AS_MD_F2(subset, scalar, functor);
+			}
+			else
+			{
+				typename MDAT_aux::constness_types<Array>::slice_type slice;
+				array.GetSlice(slice, subset_mask);
+				// конец рекурсии, обработка двумерного среза
+				Apply_AS_2D_F2(slice, scalar, functor);
+			}
+		},
+		Apply_AS_MD_F2_name::name());
 }
 
 //--------------------------------------------------------------
@@ -356,33 +359,35 @@ void Apply_AA_MD_F2(Array1 &array_1, Array2 &array_2, Functor functor)
 
 	size_t	n_dimensions = array_1.n_dimensions();
 
-	for(size_t i = 0; i < scan_size; ++i)
-	{
-		index_vector	subset_mask = MDAT_aux::GetSubsetMask(array_1, scan_dimension, i);
-
-		if(n_dimensions>3)
+	ParallelApply::ProcessParts<Functor>(scan_size, array_1.element_count(), [&](size_t i)
 		{
-			typename MDAT_aux::constness_types<Array1>::array_type	subset_1;
-			typename MDAT_aux::constness_types<Array2>::array_type	subset_2;
+			index_vector	subset_mask = MDAT_aux::GetSubsetMask(array_1, scan_dimension, i);
 
-			array_1.GetSubset(subset_1, subset_mask);
-			array_2.GetSubset(subset_2, subset_mask);
+			if(n_dimensions>3)
+			{
+				typename MDAT_aux::constness_types<Array1>::array_type	subset_1;
+				typename MDAT_aux::constness_types<Array2>::array_type	subset_2;
 
-			// рекурсия
-			Apply_AA_MD_F2(subset_1, subset_2, functor);
-		}
-		else
-		{
-			typename MDAT_aux::constness_types<Array1>::slice_type	slice_1;
-			typename MDAT_aux::constness_types<Array2>::slice_type	slice_2;
+				array_1.GetSubset(subset_1, subset_mask);
+				array_2.GetSubset(subset_2, subset_mask);
 
-			array_1.GetSlice(slice_1, subset_mask);
-			array_2.GetSlice(slice_2, subset_mask);
+				// рекурсия
+				Apply_AA_MD_F2(subset_1, subset_2, functor);
+			}
+			else
+			{
+				typename MDAT_aux::constness_types<Array1>::slice_type	slice_1;
+				typename MDAT_aux::constness_types<Array2>::slice_type	slice_2;
 
-			// конец рекурсии, обработка двумерного среза
-			Apply_AA_2D_F2(slice_1, slice_2, functor);
-		}
-	}
+				array_1.GetSlice(slice_1, subset_mask);
+				array_2.GetSlice(slice_2, subset_mask);
+
+				// конец рекурсии, обработка двумерного среза
+				Apply_AA_2D_F2(slice_1, slice_2, functor);
+			}
+		},
+		Apply_AA_MD_F2_name::name(),
+		[&] { return ParallelApply::IndependentOperands(ParallelApply::MemoryLayout_MD(array_1), ParallelApply::MemoryLayout_MD(array_2)); });
 }
 
 //--------------------------------------------------------------
@@ -559,6 +564,12 @@ void Apply_AAA_MD_F3(Array1 &array_1, Array2 &array_2, Array3 &array_3, Functor
 	}
 	ECheckSizes_AA_MD<Apply_AAA_MD_F3_name>(array_1, array_2);
 	ECheckSizes_AA_MD<Apply_AAA_MD_F3_name>(array_2, array_3);
+	auto	independent_operands = [&]
+	{
+		auto	layout_1 = ParallelApply::MemoryLayout_MD(array_1);
+		return ParallelApply::IndependentOperands(layout_1, ParallelApply::MemoryLayout_MD(array_2)) &&
+				ParallelApply::IndependentOperands(layout_1, ParallelApply::MemoryLayout_MD(array_3));
+	};
 
 	// находим размерность с максимальным шагом, и ее исключаем в первую очередь. тогда есть надежда,
 	// что окончательная обработка двумерных срезов будет хорошо оптимизирована
@@ -568,37 +579,39 @@ void Apply_AAA_MD_F3(Array1 &array_1, Array2 &array_2, Array3 &array_3, Functor
 
 	size_t	n_dimensions = array_1.n_dimensions();
 
-	for(size_t i = 0; i < scan_size; ++i)
-	{
-		index_vector	subset_mask = MDAT_aux::GetSubsetMask(array_1, scan_dimension, i);
-
-		if(n_dimensions>3)
+	ParallelApply::ProcessParts<Functor>(scan_size, array_1.element_count(), [&](size_t i)
 		{
-			typename MDAT_aux::constness_types<Array1>::array_type subset_1;
-			typename MDAT_aux::constness_types<Array2>::array_type subset_2;
-			typename MDAT_aux::constness_types<Array3>::array_type subset_3;
+			index_vector	subset_mask = MDAT_aux::GetSubsetMask(array_1, scan_dimension, i);
 
-			array_1.GetSubset(subset_1, subset_mask);
-			array_2.GetSubset(subset_2, subset_mask);
-			array_3.GetSubset(subset_3, subset_mask);
+			if(n_dimensions>3)
+			{
+				typename MDAT_aux::constness_types<Array1>::array_type subset_1;
+				typename MDAT_aux::constness_types<Array2>::array_type subset_2;
+				typename MDAT_aux::constness_types<Array3>::array_type subset_3;
 
-			// рекурсия
-			Apply_AAA_MD_F3(subset_1, subset_2, subset_3, functor);
-		}
-		else
-		{
-			typename MDAT_aux::constness_types<Array1>::slice_type	slice_1;
-			typename MDAT_aux::constness_types<Array2>::slice_type	slice_2;
-			typename MDAT_aux::constness_types<Array3>::slice_type	slice_3;
+				array_1.GetSubset(subset_1, subset_mask);
+				array_2.GetSubset(subset_2, subset_mask);
+				array_3.GetSubset(subset_3, subset_mask);
 
-			array_1.GetSlice(slice_1, subset_mask);
-			array_2.GetSlice(slice_2, subset_mask);
-			array_3.GetSlice(slice_3, subset_mask);
+				// рекурсия
+				Apply_AAA_MD_F3(subset_1, subset_2, subset_3, functor);
+			}
+			else
+			{
+				typename MDAT_aux::constness_types<Array1>::slice_type	slice_1;
+				typename MDAT_aux::constness_types<Array2>::slice_type	slice_2;
+				typename MDAT_aux::constness_types<Array3>::slice_type	slice_3;
 
-			// конец рекурсии, обработка двумерного среза
-			Apply_AAA_2D_F3(slice_1, slice_2, slice_3, functor);
-		}
-	}
+				array_1.GetSlice(slice_1, subset_mask);
+				array_2.GetSlice(slice_2, subset_mask);
+				array_3.GetSlice(slice_3, subset_mask);
+
+				// конец рекурсии, обработка двумерного среза
+				Apply_AAA_2D_F3(slice_1, slice_2, slice_3, functor);
+			}
+		},
+		Apply_AAA_MD_F3_name::name(),
+		independent_operands);
 }
 
 //--------------------------------------------------------------
@@ -623,33 +636,35 @@ void Apply_AAS_MD_F3(Array1 &array_1, Array2 &array_2, Scalar &scalar, Functor f
 
 	size_t	n_dimensions = array_1.n_dimensions();
 
-	for(size_t i = 0; i < scan_size; ++i)
-	{
-		index_vector	subset_mask = MDAT_aux::GetSubsetMask(array_1, scan_dimension, i);
-
-		if(n_dimensions>3)
+	ParallelApply::ProcessParts<Functor>(scan_size, array_1.element_count(), [&](size_t i)
 		{
-			typename MDAT_aux::constness_types<Array1>::array_type subset_1;
-			typename MDAT_aux::constness_types<Array2>::array_type subset_2;
+			index_vector	subset_mask = MDAT_aux::GetSubsetMask(array_1, scan_dimension, i);
 
-			array_1.GetSubset(subset_1, subset_mask);
-			array_2.GetSubset(subset_2, subset_mask);
+			if(n_dimensions>3)
+			{
+				typename MDAT_aux::constness_types<Array1>::array_type subset_1;
+				typename MDAT_aux::constness_types<Array2>::array_type subset_2;
 
-			// рекурсия
-			Apply_AAS_MD_F3(subset_1, subset_2, scalar, functor);
-		}
-		else
-		{
-			typename MDAT_aux::constness_types<Array1>::slice_type	slice_1;
-			typename MDAT_aux::constness_types<Array2>::slice_type	slice_2;
+				array_1.GetSubset(subset_1, subset_mask);
+				array_2.GetSubset(subset_2, subset_mask);
 
-			array_1.GetSlice(slice_1, subset_mask);
-			array_2.GetSlice(slice_2, subset_mask);
+				// рекурсия
+				Apply_AAS_MD_F3(subset_1, subset_2, scalar, functor);
+			}
+			else
+			{
+				typename MDAT_aux::constness_types<Array1>::slice_type	slice_1;
+				typename MDAT_aux::constness_types<Array2>::slice_type	slice_2;
 
-			// конец рекурсии, обработка двумерного среза
-			Apply_AAS_2D_F3(slice_1, slice_2, scalar, functor);
-		}
-	}
+				array_1.GetSlice(slice_1, subset_mask);
+				array_2.GetSlice(slice_2, subset_mask);
+
+				// конец рекурсии, обработка двумерного среза
+				Apply_AAS_2D_F3(slice_1, slice_2, scalar, functor);
+			}
+		},
+		Apply_AAS_MD_F3_name::name(),
+		[&] { return ParallelApply::IndependentOperands(ParallelApply::MemoryLayout_MD(array_1), ParallelApply::MemoryLayout_MD(array_2)); });
 }
 
 //--------------------------------------------------------------
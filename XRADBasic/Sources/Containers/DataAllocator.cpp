@@ -0,0 +1,300 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#include "pre.h"
+#include "DataAllocator.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#if defined(XRAD_COMPILER_GNUC) && defined(__linux__)
+	#include <sys/mman.h>
+#endif
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+namespace
+{
+
+/*!
+	\brief Заголовок блока, располагается непосредственно перед данными
+
+	Размер заголовка равен data_alignment, поэтому данные сохраняют выравнивание блока.
+*/
+struct data_header
+{
+	DataAllocator	*allocator;
+	size_t	block_bytes;
+	size_t	data_bytes;
+};
+
+static_assert(sizeof(data_header) <= data_alignment, "DataAllocator: data header is too large.");
+
+//! \brief Блоки от 2 МБ выравниваются на границу большой страницы
+constexpr size_t	huge_page_size = size_t(2) << 20;
+
+//! \brief Максимальное количество блоков в пуле
+constexpr size_t	data_pool_max_blocks = 256;
+
+atomic<size_t>	allocations_count(0);
+atomic<size_t>	deallocations_count(0);
+atomic<size_t>	bytes_in_use(0);
+atomic<size_t>	peak_bytes_in_use(0);
+
+atomic<size_t>	pool_hits_count(0);
+atomic<size_t>	system_allocations_count(0);
+atomic<size_t>	huge_page_allocations_count(0);
+
+atomic<size_t>	huge_pages_threshold(default_huge_pages_threshold);
+
+void	update_peak(size_t in_use)
+{
+	size_t	peak = peak_bytes_in_use.load(memory_order_relaxed);
+	while(in_use > peak && !peak_bytes_in_use.compare_exchange_weak(peak, in_use, memory_order_relaxed))
+	{
+	}
+}
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Распределитель по умолчанию: выровненные блоки от системы и пул блоков для повторного использования
+
+	Блок из пула выдается только для запроса точно того же размера: временные массивы
+	в циклах обработки, как правило, имеют одинаковые размеры.
+*/
+class DefaultDataAllocator : public DataAllocator
+{
+	public:
+		void	*Allocate(size_t bytes) override
+		{
+			if(bytes >= data_pool_min_bytes)
+			{
+				lock_guard<mutex>	lock(m_mutex);
+				for(size_t i = m_pool.size(); i--;)
+				{
+					if(m_pool[i].bytes == bytes)
+					{
+						void	*block = m_pool[i].block;
+						m_pool.erase(m_pool.begin() + i);
+						m_pooled_bytes -= bytes;
+						++pool_hits_count;
+						return block;
+					}
+				}
+			}
+			return SystemAllocate(bytes);
+		}
+
+		void	Free(void *block, size_t bytes) override
+		{
+			if(bytes >= data_pool_min_bytes)
+			{
+				vector<pool_entry>	evicted;
+				{
+					lock_guard<mutex>	lock(m_mutex);
+					if(bytes <= m_pool_limit)
+					{
+						m_pool.push_back({block, bytes});
+						m_pooled_bytes += bytes;
+						block = nullptr;
+						// вытесняем самые старые блоки
+						size_t	n_evicted = 0;
+						for(size_t pooled = m_pooled_bytes;
+								pooled > m_pool_limit || m_pool.size() - n_evicted > data_pool_max_blocks;
+								++n_evicted)
+						{
+							pooled -= m_pool[n_evicted].bytes;
+						}
+						if(n_evicted)
+						{
+							evicted.assign(m_pool.begin(), m_pool.begin() + n_evicted);
+							m_pool.erase(m_pool.begin(), m_pool.begin() + n_evicted);
+							for(auto &entry: evicted)
+								m_pooled_bytes -= entry.bytes;
+						}
+					}
+				}
+				// системные вызовы -- вне блокировки
+				for(auto &entry: evicted)
+					SystemFree(entry.block, entry.bytes);
+				if(!block)
+					return;
+			}
+			SystemFree(block, bytes);
+		}
+
+		void	SetLimit(size_t bytes)
+		{
+			{
+				lock_guard<mutex>	lock(m_mutex);
+				m_pool_limit = bytes;
+			}
+			// содержимое пула могло превысить новый предел
+			Release();
+		}
+
+		size_t	Limit()
+		{
+			lock_guard<mutex>	lock(m_mutex);
+			return m_pool_limit;
+		}
+
+		void	Release()
+		{
+			vector<pool_entry>	released;
+			{
+				lock_guard<mutex>	lock(m_mutex);
+				released.swap(m_pool);
+				m_pooled_bytes = 0;
+			}
+			for(auto &entry: released)
+				SystemFree(entry.block, entry.bytes);
+		}
+
+		size_t	PooledBytes()
+		{
+			lock_guard<mutex>	lock(m_mutex);
+			return m_pooled_bytes;
+		}
+
+	private:
+		static size_t	SystemAlignment(size_t bytes)
+		{
+			return bytes >= huge_page_size ? huge_page_size : data_alignment;
+		}
+
+		static void	*SystemAllocate(size_t bytes)
+		{
+			void	*block = ::operator new(bytes, align_val_t(SystemAlignment(bytes)));
+			++system_allocations_count;
+			if(bytes >= huge_pages_threshold.load(memory_order_relaxed))
+			{
+#if defined(XRAD_COMPILER_GNUC) && defined(__linux__) && defined(MADV_HUGEPAGE)
+				// подсказка ядру; ошибка (например, THP отключены) не мешает работе
+				if(!madvise(block, bytes & ~(huge_page_size - 1), MADV_HUGEPAGE))
+					++huge_page_allocations_count;
+#endif
+			}
+			return block;
+		}
+
+		static void	SystemFree(void *block, size_t bytes)
+		{
+			::operator delete(block, align_val_t(SystemAlignment(bytes)));
+		}
+
+	private:
+		struct pool_entry
+		{
+			void	*block;
+			size_t	bytes;
+		};
+
+		mutex	m_mutex;
+		//! \brief Блоки в порядке освобождения, от старых к новым
+		vector<pool_entry>	m_pool;
+		size_t	m_pooled_bytes = 0;
+		size_t	m_pool_limit = default_data_pool_limit;
+};
+
+//! \brief Объект никогда не удаляется: данные статических контейнеров могут освобождаться
+//! после завершения main()
+DefaultDataAllocator	&default_allocator()
+{
+	static DefaultDataAllocator	*allocator = new DefaultDataAllocator;
+	return *allocator;
+}
+
+atomic<DataAllocator*>	current_allocator(nullptr);
+
+} // namespace
+
+//--------------------------------------------------------------
+
+DataAllocator	*GetDataAllocator()
+{
+	DataAllocator	*allocator = current_allocator.load();
+	return allocator ? allocator : &default_allocator();
+}
+
+void	SetDataAllocator(DataAllocator *allocator)
+{
+	current_allocator = allocator;
+}
+
+void	*AllocateDataMemory(size_t bytes)
+{
+	if(bytes > numeric_limits<size_t>::max() - data_alignment)
+		throw bad_alloc();
+	// размер блока кратен data_alignment: так пул чаще находит подходящие блоки
+	size_t	block_bytes = data_alignment + (bytes + data_alignment - 1)/data_alignment*data_alignment;
+	DataAllocator	*allocator = GetDataAllocator();
+	char	*block = static_cast<char*>(allocator->Allocate(block_bytes));
+	new(block) data_header{allocator, block_bytes, bytes};
+
+	++allocations_count;
+	update_peak(bytes_in_use += bytes);
+	return block + data_alignment;
+}
+
+void	FreeDataMemory(void *data)
+{
+	if(!data)
+		return;
+	char	*block = static_cast<char*>(data) - data_alignment;
+	data_header	header = *reinterpret_cast<data_header*>(block);
+
+	++deallocations_count;
+	bytes_in_use -= header.data_bytes;
+	header.allocator->Free(block, header.block_bytes);
+}
+
+//--------------------------------------------------------------
+
+void	SetDataPoolLimit(size_t bytes)
+{
+	default_allocator().SetLimit(bytes);
+}
+
+size_t	DataPoolLimit()
+{
+	return default_allocator().Limit();
+}
+
+void	ReleaseDataPool()
+{
+	default_allocator().Release();
+}
+
+void	SetHugePagesThreshold(size_t bytes)
+{
+	huge_pages_threshold = bytes;
+}
+
+size_t	HugePagesThreshold()
+{
+	return huge_pages_threshold;
+}
+
+DataAllocatorStatistics	GetDataAllocatorStatistics()
+{
+	DataAllocatorStatistics	result;
+	result.allocations = allocations_count;
+	result.deallocations = deallocations_count;
+	result.bytes_in_use = bytes_in_use;
+	result.peak_bytes_in_use = peak_bytes_in_use;
+	result.pool_hits = pool_hits_count;
+	result.system_allocations = system_allocations_count;
+	result.huge_page_allocations = huge_page_allocations_count;
+	result.pooled_bytes = default_allocator().PooledBytes();
+	return result;
+}
+
+//--------------------------------------------------------------
+
+XRAD_END
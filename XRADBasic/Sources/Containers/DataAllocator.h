@@ -0,0 +1,177 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_DataAllocator_h
+#define XRAD__File_DataAllocator_h
+/*!
+	\file
+	\brief Выделение памяти под данные контейнеров (DataOwner и наследники)
+
+	Память под данные DataOwner (DataArray, DataArray2D, DataArrayMD и т.п.) выделяется
+	функцией AllocateDataMemory() и всегда выровнена на data_alignment байт.
+	Собственно выделение выполняет объект DataAllocator, который можно заменить (SetDataAllocator()).
+
+	Распределитель по умолчанию:
+	- блоки размером от data_pool_min_bytes после освобождения помещаются в пул и используются
+		повторно для запросов того же размера (временные массивы фильтров, FFT и т.п.).
+		Общий объем пула ограничен (SetDataPoolLimit()), при переполнении освобождаются
+		самые старые блоки;
+	- блоки размером от HugePagesThreshold() (по умолчанию 64 МБ) помечаются как подходящие
+		для прозрачных больших страниц (Linux, madvise(MADV_HUGEPAGE)). На других платформах
+		этот параметр ни на что не влияет.
+*/
+//--------------------------------------------------------------
+
+#include <XRADBasic/Core.h>
+#include <new>
+#include <type_traits>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+//! \brief Выравнивание данных контейнеров, в байтах
+constexpr size_t data_alignment = 64;
+
+//! \brief Блоки меньшего размера в пул не помещаются (для них системный распределитель и так быстр)
+constexpr size_t data_pool_min_bytes = size_t(64) << 10;
+
+//! \brief Максимальный объем пула по умолчанию
+constexpr size_t default_data_pool_limit = size_t(256) << 20;
+
+//! \brief Порог использования больших страниц по умолчанию
+constexpr size_t default_huge_pages_threshold = size_t(64) << 20;
+
+/*!
+	\brief Интерфейс распределителя памяти для данных контейнеров
+
+	Allocate() возвращает блок не менее bytes байт, выровненный на data_alignment байт,
+	при нехватке памяти генерирует bad_alloc.
+	Free() получает блок, выделенный Allocate() этого же объекта, и его размер.
+	Методы могут вызываться одновременно из разных потоков.
+
+	Объект распределителя должен существовать, пока не освобождены все выделенные им блоки
+	(на практике -- до конца работы программы).
+*/
+class DataAllocator
+{
+	public:
+		virtual ~DataAllocator() = default;
+
+		virtual void	*Allocate(size_t bytes) = 0;
+		virtual void	Free(void *block, size_t bytes) = 0;
+};
+
+//! \brief Распределитель, используемый для новых блоков. Не бывает nullptr
+DataAllocator	*GetDataAllocator();
+
+//! \brief Замена распределителя для новых блоков. nullptr -- распределитель по умолчанию.
+//! Ранее выделенные блоки освобождаются тем распределителем, который их выделил
+void	SetDataAllocator(DataAllocator *allocator);
+
+//! \brief Выделение памяти под bytes байт данных, выравнивание data_alignment
+void	*AllocateDataMemory(size_t bytes);
+
+//! \brief Освобождение памяти, выделенной AllocateDataMemory(). nullptr допускается
+void	FreeDataMemory(void *data);
+
+//--------------------------------------------------------------
+
+//! \brief Установка максимального объема пула распределителя по умолчанию, пул при этом очищается.
+//! 0 отключает пул
+void	SetDataPoolLimit(size_t bytes);
+size_t	DataPoolLimit();
+
+//! \brief Освобождение всех блоков, находящихся в пуле распределителя по умолчанию
+void	ReleaseDataPool();
+
+//! \brief Установка порога использования больших страниц. size_t(-1) отключает их
+void	SetHugePagesThreshold(size_t bytes);
+size_t	HugePagesThreshold();
+
+//! \brief Статистика выделения памяти под данные контейнеров
+struct DataAllocatorStatistics
+{
+	//! \brief Количество вызовов AllocateDataMemory() и FreeDataMemory()
+	size_t	allocations = 0;
+	size_t	deallocations = 0;
+	//! \brief Объем выделенных и еще не освобожденных данных
+	size_t	bytes_in_use = 0;
+	//! \brief Максимальное значение bytes_in_use
+	size_t	peak_bytes_in_use = 0;
+
+	//! \name Распределитель по умолчанию
+	//! @{
+	//! \brief Запросы, удовлетворенные блоками из пула
+	size_t	pool_hits = 0;
+	//! \brief Блоки, полученные от системы
+	size_t	system_allocations = 0;
+	//! \brief Блоки, для которых запрошены большие страницы
+	size_t	huge_page_allocations = 0;
+	//! \brief Объем блоков, находящихся в пуле
+	size_t	pooled_bytes = 0;
+	//! @}
+};
+
+DataAllocatorStatistics	GetDataAllocatorStatistics();
+
+//--------------------------------------------------------------
+
+namespace DataAllocatorAuxiliaries
+{
+
+/*!
+	\brief Создание массива из n элементов в памяти AllocateDataMemory()
+
+	Элементы инициализируются так же, как в new T[n]: для типов без конструктора
+	значения остаются неопределенными.
+*/
+template <class T>
+T	*CreateArray(size_t n)
+{
+	static_assert(alignof(T) <= data_alignment, "DataAllocator: alignment of the type is too large.");
+	if(n > (numeric_limits<size_t>::max() - data_alignment)/sizeof(T))
+		throw bad_alloc();
+	T	*data = static_cast<T*>(AllocateDataMemory(n*sizeof(T)));
+	if constexpr(!is_trivially_default_constructible<T>::value)
+	{
+		size_t	i = 0;
+		try
+		{
+			for(; i < n; ++i)
+				new(data + i) T;
+		}
+		catch(...)
+		{
+			while(i)
+				data[--i].~T();
+			FreeDataMemory(data);
+			throw;
+		}
+	}
+	return data;
+}
+
+//! \brief Удаление массива, созданного CreateArray()
+template <class T>
+void	DestroyArray(T *data, size_t n)
+{
+	if(!data)
+		return;
+	if constexpr(!is_trivially_destructible<T>::value)
+	{
+		for(size_t i = n; i--;)
+			data[i].~T();
+	}
+	FreeDataMemory(data);
+}
+
+} // namespace DataAllocatorAuxiliaries
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_DataAllocator_h
@@ -261,6 +261,8 @@ class DataArray2D : private DataOwner<typename RT::value_type>
 		//! \brief Количество элементов в массиве
 		inline size_t element_count() const { return m_sizes[0]*m_sizes[1]; }
 		using parent::element_size;
+		//! \brief true, если массив ссылается на чужие данные, а не владеет ими
+		using parent::uses_external_data;
 
 		inline size_t vsize() const { return m_sizes[0]; }
 		inline size_t hsize() const { return m_sizes[1]; }
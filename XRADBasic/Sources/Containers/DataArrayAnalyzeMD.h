@@ -262,38 +262,23 @@ floating64_type<typename A2T::value_type>	AverageSquare(const DataArrayMD<A2T> &
 template <class A2T, class T>
 void	ComputeHistogram(const DataArrayMD<A2T> &array, DataArray<T> &histogram, const range1_F64 &values_range)
 {
-	size_t histogram_size = histogram.size();
-	if(!histogram_size) return;
+	if(!histogram.size() || array.empty()) return;
 
-
-
-	if(array.n_dimensions() > 2)
+	if(values_range.x1() == values_range.x2())
 	{
 		histogram.fill(0);
-		DataArray<T> histogram_increment(histogram_size);
-		typename DataArrayMD<A2T>::invariable	subset;
-		index_vector	iv(array.n_dimensions());
-
-		for(size_t j = 0; j < array.n_dimensions()-1; ++j)
-		{
-			iv[j+1] = slice_mask(j);
-		}
-		iv[0] = 0;
-		for(size_t i = 0; i < array.sizes(0); ++iv[0], ++i)
-		{
-			array.GetSubset(subset, iv);
-			ComputeHistogram(subset, histogram_increment, values_range);
-			Apply_AA_1D_F2(histogram, histogram_increment, Functors::plus_assign());
-		}
-		size_t div = array.sizes(0);
-		Apply_A_1D_F1(histogram, [div](T &v) { v /= div; });
+		histogram[histogram.size()/2] = 1;
+		return;
 	}
-	else if(array.n_dimensions() == 2)
+	if(!is_number(values_range.x1()) || !is_number(values_range.x2()))
 	{
-		typename DataArrayMD<A2T>::slice_type::invariable	slice;
-		array.GetSlice(slice, {slice_mask(0), slice_mask(1)});
-		ComputeHistogram(slice, histogram, values_range);
+		throw invalid_argument(ssprintf("ComputeHistogram(const DataArrayMD<A2T> &array, DataArray<T> &histogram, const range1_F64 &values_range)\n"
+				"Invalid values range (%g, %g)", values_range.p1(), values_range.p2()));
 	}
+
+	using namespace HistogramAuxiliaries;
+	StoreHistogram(histogram, CountHistogram(array, histogram_binning::intervals(values_range, histogram.size()), to_double()),
+			1./array.element_count());
 }
 
 /*!
@@ -312,6 +297,9 @@ void	ComputeHistogram(const DataArrayMD<A2T> &array, DataArray<T> &histogram, co
 	Можно сделать учет количества элементов вне диапазона в отдельных переменных,
 	а не прибавлять их к первому и последнему элементам гистограммы.
 
+	Вычисляется параллельно. Значения, не являющиеся числами, не учитываются.
+	Для 8- и 16-битных целых данных интервал определяется по таблице значений, см. HistogramAuxiliaries.
+
 	\todo Сделать вариант Transformed.
 
 	\todo Можно сделать также функцию ComputeHistogramNormalized, которая будет
@@ -322,13 +310,9 @@ void	ComputeHistogram(const DataArrayMD<A2T> &array, DataArray<T> &histogram, co
 template <class Histogram = DataArray<size_t>, class A2T = void /* dummy default: always deduced */>
 Histogram ComputeHistogramRaw(const DataArrayMD<A2T> &array, const range1_F64 &values_range, size_t histogram_size)
 {
+	using namespace HistogramAuxiliaries;
 	Histogram histogram(histogram_size, 0);
-	size_t less_counter(0), greater_counter(0);
-	Functors::acquire_histogram_functor<Histogram> hf(&histogram, &less_counter, &greater_counter,
-			values_range.p1(), values_range.p2());
-	Apply_A_MD_F1(array, hf);
-	histogram[0] += (typename Histogram::value_type)less_counter;
-	histogram[histogram.size() - 1] += (typename Histogram::value_type)greater_counter;
+	StoreHistogram(histogram, CountHistogram(array, histogram_binning::intervals(values_range, histogram_size), to_double()), 1);
 	return histogram;
 }
 
@@ -336,36 +320,34 @@ Histogram ComputeHistogramRaw(const DataArrayMD<A2T> &array, const range1_F64 &v
 template <class A2T, class T, class F>
 void	ComputeHistogramTransformed(const DataArrayMD<A2T> &array, DataArray<T> &histogram, const range1_F64 &values_range, const F& function)
 {
-	size_t histogram_size = histogram.size();
-	if(!histogram_size) return;
-
-	if(array.n_dimensions() > 2)
-	{
-		histogram.fill(0);
-		DataArray<T> histogram_increment(histogram_size);
-		typename DataArrayMD<A2T>::invariable	subset;
-		index_vector	iv(array.n_dimensions());
+	if(!histogram.size() || array.empty()) return;
 
-		for(size_t j = 0; j < array.n_dimensions()-1; ++j)
-		{
-			iv[j+1] = slice_mask(j);
-		}
-		iv[0] = 0;
-		for(size_t i = 0; i < array.sizes(0); ++iv[0], ++i)
-		{
-			array.GetSubset(subset, iv);
-			ComputeHistogramTransformed(subset, histogram_increment, values_range, function);
-			Apply_AA_1D_F2(histogram, histogram_increment, Functors::plus_assign());
-		}
-		size_t div = array.sizes(0);
-		Apply_A_1D_F1(histogram, [div](T &v) { v /= div; });
-	}
-	else if(array.n_dimensions() == 2)
+	if(!is_number(values_range.x1()) || !is_number(values_range.x2()) || values_range.x1() == values_range.x2())
 	{
-		typename DataArrayMD<A2T>::slice_type::invariable	slice;
-		array.GetSlice(slice, {slice_mask(0), slice_mask(1)});
-		ComputeHistogramTransformed(slice, histogram, values_range, function);
+		throw invalid_argument(ssprintf("ComputeHistogramTransformed(const DataArrayMD<A2T> &array, DataArray<T> &histogram, const range1_F64 &values_range)\n"
+				"Invalid values range (%g, %g)", values_range.p1(), values_range.p2()));
 	}
+
+	using namespace HistogramAuxiliaries;
+	StoreHistogram(histogram, CountHistogram(array, histogram_binning::nodes(values_range, histogram.size()), function),
+			1./array.element_count());
+}
+
+//! \brief Точное распределение значений 8- или 16-битного целочисленного массива. См. одномерную функцию
+template <class A2T>
+HistogramDistribution	ComputeIntegerValuesDistribution(const DataArrayMD<A2T> &array)
+{
+	return HistogramAuxiliaries::IntegerValuesDistribution(array);
+}
+
+//! \brief Совместная гистограмма двух массивов одинакового размера. См. двумерную функцию
+template <class A2T1, class A2T2, class ROW_T>
+void	ComputeJointHistogram(const DataArrayMD<A2T1> &array1, const DataArrayMD<A2T2> &array2, DataArray2D<ROW_T> &histogram,
+		const range1_F64 &values_range1, const range1_F64 &values_range2)
+{
+	if(array1.sizes() != array2.sizes())
+		throw invalid_argument("ComputeJointHistogram(const DataArrayMD<A2T1> &, const DataArrayMD<A2T2> &, ...), array sizes mismatch");
+	HistogramAuxiliaries::ComputeJointHistogram(array1, array2, histogram, values_range1, values_range2, array1.element_count());
 }
 
 /*!
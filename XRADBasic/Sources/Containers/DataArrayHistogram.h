@@ -15,6 +15,8 @@
 //--------------------------------------------------------------
 
 #include "DataArrayAnalyze.h"
+#include "HistogramAuxiliaries.h"
+#include "HistogramDistribution.h"
 
 XRAD_BEGIN
 
@@ -28,6 +30,8 @@ XRAD_BEGIN
 	Если они у́же, чем диапазон значений изображения, лишние значения плюсуются на краях диапазона.
 
 	Диапазон values_range делится на histogram.size() интервалов.
+
+	Вычисляется параллельно. Значения, не являющиеся числами, не учитываются.
 */
 template <class T, class T2>
 void	ComputeHistogram(const DataArray<T> &row, DataArray<T2> &histogram, const range1_F64 &values_range)
@@ -55,17 +59,9 @@ void	ComputeHistogram(const DataArray<T> &row, DataArray<T2> &histogram, const r
 							"Invalid values range (%g, %g)", values_range.p1(), values_range.p2()));
 	}
 
-	histogram.fill(0);
-
-	double	index_factor = double(histogram.size())/values_range.delta();
-	double	increment = 1./(row.size());
-
-	typename DataArray<T>::const_iterator it = row.begin(), ie = row.end();
-	for(; it < ie; ++it)
-	{
-		size_t	index = range(ptrdiff_t(index_factor*(*it-values_range.p1())), 0, ptrdiff_t(histogram.size())-1);
-		histogram[index] += increment;
-	}
+	using namespace HistogramAuxiliaries;
+	StoreHistogram(histogram, CountHistogram(row, histogram_binning::intervals(values_range, histogram.size()), to_double()),
+			1./row.size());
 }
 
 /*!
@@ -84,6 +80,9 @@ void	ComputeHistogram(const DataArray<T> &row, DataArray<T2> &histogram, const r
 	Можно сделать учет количества элементов вне диапазона в отдельных переменных,
 	а не прибавлять их к первому и последнему элементам гистограммы.
 
+	Вычисляется параллельно. Значения, не являющиеся числами, не учитываются.
+	Для 8- и 16-битных целых данных интервал определяется по таблице значений, см. HistogramAuxiliaries.
+
 	\todo Сделать вариант Transformed.
 
 	\todo Можно сделать также функцию ComputeHistogramNormalized, которая будет
@@ -94,13 +93,9 @@ void	ComputeHistogram(const DataArray<T> &row, DataArray<T2> &histogram, const r
 template <class Histogram = DataArray<size_t>, class T = void /* dummy default: always deduced */>
 Histogram ComputeHistogramRaw(const DataArray<T> &array, const range1_F64 &values_range, size_t histogram_size)
 {
+	using namespace HistogramAuxiliaries;
 	Histogram histogram(histogram_size, 0);
-	size_t less_counter(0), greater_counter(0);
-	Functors::acquire_histogram_functor<Histogram> hf(&histogram, &less_counter, &greater_counter,
-			values_range.p1(), values_range.p2());
-	Apply_A_1D_F1(array, hf);
-	histogram[0] += (typename Histogram::value_type)less_counter;
-	histogram[histogram.size() - 1] += (typename Histogram::value_type)greater_counter;
+	StoreHistogram(histogram, CountHistogram(array, histogram_binning::intervals(values_range, histogram_size), to_double()), 1);
 	return histogram;
 }
 
@@ -116,6 +111,8 @@ Histogram ComputeHistogramRaw(const DataArray<T> &array, const range1_F64 &value
 	Функтор должен быть монотонной функцией на интервале (in_minval, in_maxval),
 	иначе результат непредсказуем. [Кажется, это требование лишнее. / @АБЕ]
 
+	Вычисляется параллельно, функтор должен быть потокобезопасным и зависеть только от аргумента.
+
 	\todo Сейчас function -- двухаргументный функтор (f(&result, value)). Аналогичная двумерная функция
 	расчета гистограммы принимает функтор, возвращающий значение (result_type f(value)).
 	Сделать здесь, как в двумерной функции.
@@ -138,22 +135,28 @@ void	ComputeHistogramTransformed(const DataArray<T> &row, DataArray<T2> &histogr
 		throw invalid_argument("ComputeHistogramTransformed(const DataArray<T> &row, DataArray<T2> &histogram, const range1_F64 &values_range), invalid values range");
 	}
 
-	histogram.fill(0);
-
-	double	index_factor = double(histogram.size() - 1)/values_range.delta();
-	double	increment = 1./row.size();
-	double	transformed;
-	typename DataArray<T>::const_iterator it = row.begin(), ie = row.end();
-	for(; it < ie; ++it)
+	using namespace HistogramAuxiliaries;
+	auto	transform = [&function](const T &x)
 	{
-		function(transformed, *it);
-		if(is_number(transformed))
-		{
-			transformed = range(transformed, values_range.x1(), values_range.x2());
-			size_t	index = range(ptrdiff_t(index_factor*(transformed-values_range.x1())), 0, ptrdiff_t(histogram.size())-1);
-			histogram[index] += increment;
-		}
-	}
+		double	transformed;
+		function(transformed, x);
+		return transformed;
+	};
+	StoreHistogram(histogram, CountHistogram(row, histogram_binning::nodes(values_range, histogram.size()), transform),
+			1./row.size());
+}
+
+/*!
+	\brief Точное распределение значений 8- или 16-битного целочисленного массива
+
+	Позволяет находить точные квантили (HistogramDistribution::quantile) без сортировки данных.
+	Для данных других типов следует строить HistogramDistribution по гистограмме (ComputeHistogramRaw),
+	квантили при этом приближенные.
+*/
+template <class T>
+HistogramDistribution	ComputeIntegerValuesDistribution(const DataArray<T> &array)
+{
+	return HistogramAuxiliaries::IntegerValuesDistribution(array);
 }
 
 //--------------------------------------------------------------
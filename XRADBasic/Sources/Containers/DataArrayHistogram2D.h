@@ -15,6 +15,7 @@
 //--------------------------------------------------------------
 
 #include "DataArrayAnalyze2D.h"
+#include "HistogramAuxiliaries.h"
 
 XRAD_BEGIN
 
@@ -28,6 +29,8 @@ XRAD_BEGIN
 	Если они у́же, чем диапазон значений изображения, лишние значения плюсуются на краях диапазона.
 
 	Диапазон values_range делится на histogram.size() интервалов.
+
+	Вычисляется параллельно. Значения, не являющиеся числами, не учитываются.
 */
 template <class ROW_T, class T>
 void	ComputeHistogram(const DataArray2D<ROW_T> &img, DataArray<T> &histogram, const range1_F64 &values_range)
@@ -50,21 +53,9 @@ void	ComputeHistogram(const DataArray2D<ROW_T> &img, DataArray<T> &histogram, co
 				"Invalid values range (%g, %g)", values_range.p1(), values_range.p2()));
 	}
 
-	histogram.fill(0);
-
-// 	double	index_factor = double(histogram.size() - 1)/values_range.delta();
-	double	index_factor = double(histogram.size())/values_range.delta();
-	double	increment = 1./(img.vsize()*img.hsize());
-
-	for(size_t i = 0; i < img.vsize(); ++i)
-	{
-		typename ROW_T::const_iterator it = img.row(i).begin(), ie = img.row(i).end();
-		for(; it < ie; ++it)
-		{
-			size_t	index = range(ptrdiff_t(index_factor*(*it-values_range.p1())), 0, ptrdiff_t(histogram.size())-1);
-			histogram[index] += increment;
-		}
-	}
+	using namespace HistogramAuxiliaries;
+	StoreHistogram(histogram, CountHistogram(img, histogram_binning::intervals(values_range, histogram.size()), to_double()),
+			1./(img.vsize()*img.hsize()));
 }
 
 /*!
@@ -83,6 +74,9 @@ void	ComputeHistogram(const DataArray2D<ROW_T> &img, DataArray<T> &histogram, co
 	Можно сделать учет количества элементов вне диапазона в отдельных переменных,
 	а не прибавлять их к первому и последнему элементам гистограммы.
 
+	Вычисляется параллельно. Значения, не являющиеся числами, не учитываются.
+	Для 8- и 16-битных целых данных интервал определяется по таблице значений, см. HistogramAuxiliaries.
+
 	\todo Сделать вариант Transformed.
 
 	\todo Можно сделать также функцию ComputeHistogramNormalized, которая будет
@@ -93,13 +87,9 @@ void	ComputeHistogram(const DataArray2D<ROW_T> &img, DataArray<T> &histogram, co
 template <class Histogram = DataArray<size_t>, class ROW_T = void /* dummy default: always deduced */>
 Histogram ComputeHistogramRaw(const DataArray2D<ROW_T> &array, const range1_F64 &values_range, size_t histogram_size)
 {
+	using namespace HistogramAuxiliaries;
 	Histogram histogram(histogram_size, 0);
-	size_t less_counter(0), greater_counter(0);
-	Functors::acquire_histogram_functor<Histogram> hf(&histogram, &less_counter, &greater_counter,
-			values_range.p1(), values_range.p2());
-	Apply_A_2D_F1(array, hf);
-	histogram[0] += (typename Histogram::value_type)less_counter;
-	histogram[histogram.size() - 1] += (typename Histogram::value_type)greater_counter;
+	StoreHistogram(histogram, CountHistogram(array, histogram_binning::intervals(values_range, histogram_size), to_double()), 1);
 	return histogram;
 }
 
@@ -114,6 +104,8 @@ Histogram ComputeHistogramRaw(const DataArray2D<ROW_T> &array, const range1_F64
 
 	Функтор должен быть монотонной функцией на интервале (in_minval, in_maxval),
 	иначе результат непредсказуем. [Кажется, это требование лишнее. / @АБЕ]
+
+	Вычисляется параллельно, функтор должен быть потокобезопасным и зависеть только от аргумента.
 */
 template <class ROW_T, class T, class F>
 void	ComputeHistogramTransformed(const DataArray2D<ROW_T> &img, DataArray<T> &histogram, const range1_F64 &values_range, const F& function)
@@ -128,32 +120,59 @@ void	ComputeHistogramTransformed(const DataArray2D<ROW_T> &img, DataArray<T> &hi
 				"Invalid values range (%g, %g)", values_range.p1(), values_range.p2()));
 	}
 
-	histogram.fill(0);
-
-	double	index_factor = double(histogram.size() - 1)/values_range.delta();
-	double	increment = 1./(img.vsize()*img.hsize());
-// 	double	transformed;
-	for(size_t i = 0; i < img.vsize(); ++i)
-	{
-		typename ROW_T::const_iterator it = img.row(i).begin(), ie = img.row(i).end();
-		for(; it < ie; ++it)
-		{
-			auto transformed = function(*it);
-			if(is_number(transformed))
-			{
-				transformed = range(transformed, values_range.x1(), values_range.x2());
-				size_t	index = range(ptrdiff_t(index_factor*(transformed-values_range.x1())), ptrdiff_t(0), ptrdiff_t(histogram.size()-1));
-				histogram[index] += increment;
-			}
-		}
-	}
+	using namespace HistogramAuxiliaries;
+	StoreHistogram(histogram, CountHistogram(img, histogram_binning::nodes(values_range, histogram.size()), function),
+			1./(img.vsize()*img.hsize()));
 }
 
 
 
+//! \brief Точное распределение значений 8- или 16-битного целочисленного изображения. См. одномерную функцию
+template <class ROW_T>
+HistogramDistribution	ComputeIntegerValuesDistribution(const DataArray2D<ROW_T> &img)
+{
+	return HistogramAuxiliaries::IntegerValuesDistribution(img);
+}
+
 //--------------------------------------------------------------
 
+/*!
+	\brief Совместная гистограмма двух изображений одинакового размера
+
+	Элемент histogram.at(i, j) -- доля пикселей, у которых значение img1 попадает в i-й интервал
+	диапазона values_range1, а значение img2 -- в j-й интервал диапазона values_range2.
+	Разбиение на интервалы и учет значений вне диапазона такие же, как в ComputeHistogram.
+	Пары, в которых хотя бы одно из значений не является числом, не учитываются.
+
+	Вычисляется параллельно, каждый поток использует собственную гистограмму
+	размером histogram.vsize()*histogram.hsize() элементов size_t.
+*/
+template <class ROW_T1, class ROW_T2, class ROW_T>
+void	ComputeJointHistogram(const DataArray2D<ROW_T1> &img1, const DataArray2D<ROW_T2> &img2, DataArray2D<ROW_T> &histogram,
+		const range1_F64 &values_range1, const range1_F64 &values_range2)
+{
+	if(img1.vsize() != img2.vsize() || img1.hsize() != img2.hsize())
+	{
+		throw invalid_argument(ssprintf("ComputeJointHistogram(const DataArray2D<ROW_T1> &, const DataArray2D<ROW_T2> &, ...)\n"
+				"Image sizes mismatch (%zu x %zu, %zu x %zu)", img1.vsize(), img1.hsize(), img2.vsize(), img2.hsize()));
+	}
+	HistogramAuxiliaries::ComputeJointHistogram(img1, img2, histogram, values_range1, values_range2, img1.vsize()*img1.hsize());
+}
+
+//! \brief Совместная гистограмма двух одномерных массивов одинакового размера. См. двумерную функцию
+template <class T1, class T2, class ROW_T>
+void	ComputeJointHistogram(const DataArray<T1> &row1, const DataArray<T2> &row2, DataArray2D<ROW_T> &histogram,
+		const range1_F64 &values_range1, const range1_F64 &values_range2)
+{
+	if(row1.size() != row2.size())
+	{
+		throw invalid_argument(ssprintf("ComputeJointHistogram(const DataArray<T1> &, const DataArray<T2> &, ...)\n"
+				"Array sizes mismatch (%zu, %zu)", row1.size(), row2.size()));
+	}
+	HistogramAuxiliaries::ComputeJointHistogram(row1, row2, histogram, values_range1, values_range2, row1.size());
+}
 
+//--------------------------------------------------------------
 
 /*!
 	\brief Нахождение гистограммы для изображений с векторным элементом
@@ -203,6 +203,8 @@ class	DataArrayMD : private DataOwner<typename A2DT::value_type>
 		size_t	n_dimensions() const {return m_sizes.size();}
 		size_t	element_count() const { size_t result(1); for(auto sz: sizes()) result*=sz; return result; } // количество элементов в массиве
 		using parent::element_size;
+		//! \brief true, если массив ссылается на чужие данные, а не владеет ими
+		using parent::uses_external_data;
 
 		//! @}
 
@@ -0,0 +1,218 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_DataArrayRows_h
+#define XRAD__File_DataArrayRows_h
+/*!
+	\file
+	\brief Единообразный перебор строк DataArray, DataArray2D, DataArrayMD для параллельной обработки
+
+	Массив любой размерности представляется как набор строк, которые можно обрабатывать независимо:
+	- DataArray делится на отрезки по segment_size_1d элементов;
+	- у DataArray2D строки -- обычные строки;
+	- у DataArrayMD строки идут вдоль последнего измерения.
+
+	Не предназначено для использования в пользовательском коде.
+*/
+//--------------------------------------------------------------
+
+#include "DataArray.h"
+#include "DataArray2D.h"
+#include "DataArrayMD.h"
+#include "IndexVector.h"
+#include "ParallelApply.h"
+#include <XRADBasic/Sources/Core/ThreadSetup.h>
+
+XRAD_BEGIN
+
+namespace DataArrayRows
+{
+
+//--------------------------------------------------------------
+
+//! \brief Одномерный массив делится на отрезки такой длины
+static constexpr size_t	segment_size_1d = 4096;
+
+template<class T>
+size_t	rows_count(const DataArray<T> &array)
+{
+	return (array.size() + segment_size_1d - 1)/segment_size_1d;
+}
+
+template<class ROW_T>
+size_t	rows_count(const DataArray2D<ROW_T> &array)
+{
+	return array.hsize() ? array.vsize() : 0;
+}
+
+template<class A2T>
+size_t	rows_count(const DataArrayMD<A2T> &array)
+{
+	return array.empty() ? 0 : array.element_count()/array.sizes(array.n_dimensions() - 1);
+}
+
+template<class T>
+size_t	elements_count(const DataArray<T> &array){ return array.size(); }
+
+template<class ROW_T>
+size_t	elements_count(const DataArray2D<ROW_T> &array){ return array.vsize()*array.hsize(); }
+
+template<class A2T>
+size_t	elements_count(const DataArrayMD<A2T> &array){ return array.empty() ? 0 : array.element_count(); }
+
+//--------------------------------------------------------------
+
+//! \brief Полный индекс элемента многомерного массива по номеру строки и номеру элемента в строке
+template<class A2T>
+index_vector	element_index(const DataArrayMD<A2T> &array, size_t row_no, size_t col)
+{
+	const size_t	n = array.n_dimensions();
+	index_vector	iv(n, 0);
+	iv[n - 1] = col;
+	for(size_t d = n - 1; d-- > 0;)
+	{
+		iv[d] = row_no%array.sizes(d);
+		row_no /= array.sizes(d);
+	}
+	return iv;
+}
+
+template<class T>
+index_vector	element_index(const DataArray<T> &, size_t row_no, size_t col)
+{
+	return index_vector{row_no*segment_size_1d + col};
+}
+
+template<class ROW_T>
+index_vector	element_index(const DataArray2D<ROW_T> &, size_t row_no, size_t col)
+{
+	return index_vector{row_no, col};
+}
+
+//--------------------------------------------------------------
+
+//! \brief Вызов f(begin, end) для строки row_no
+template<class T, class F>
+void	visit_row(const DataArray<T> &array, size_t row_no, const F &f)
+{
+	const size_t	first = row_no*segment_size_1d;
+	const size_t	last = min(first + segment_size_1d, array.size());
+	f(array.begin() + first, array.begin() + last);
+}
+
+template<class ROW_T, class F>
+void	visit_row(const DataArray2D<ROW_T> &array, size_t row_no, const F &f)
+{
+	auto	&row = array.row(row_no);
+	f(row.begin(), row.end());
+}
+
+template<class A2T>
+void	get_row(typename DataArrayMD<A2T>::row_type::invariable &row, const DataArrayMD<A2T> &array, size_t row_no)
+{
+	index_vector	iv = element_index(array, row_no, 0);
+	iv[array.n_dimensions() - 1] = slice_mask(0);
+	array.GetRow(row, iv);
+}
+
+template<class A2T, class F>
+void	visit_row(const DataArrayMD<A2T> &array, size_t row_no, const F &f)
+{
+	typename DataArrayMD<A2T>::row_type::invariable	row;
+	get_row(row, array, row_no);
+	f(row.begin(), row.end());
+}
+
+//! \brief Вызов f(begin1, end1, begin2) для строк row_no двух массивов одинакового размера
+template<class T1, class T2, class F>
+void	visit_rows_pair(const DataArray<T1> &array1, const DataArray<T2> &array2, size_t row_no, const F &f)
+{
+	const size_t	first = row_no*segment_size_1d;
+	const size_t	last = min(first + segment_size_1d, array1.size());
+	f(array1.begin() + first, array1.begin() + last, array2.begin() + first);
+}
+
+template<class ROW_T1, class ROW_T2, class F>
+void	visit_rows_pair(const DataArray2D<ROW_T1> &array1, const DataArray2D<ROW_T2> &array2, size_t row_no, const F &f)
+{
+	auto	&row1 = array1.row(row_no);
+	f(row1.begin(), row1.end(), array2.row(row_no).begin());
+}
+
+template<class A2T1, class A2T2, class F>
+void	visit_rows_pair(const DataArrayMD<A2T1> &array1, const DataArrayMD<A2T2> &array2, size_t row_no, const F &f)
+{
+	typename DataArrayMD<A2T1>::row_type::invariable	row1;
+	typename DataArrayMD<A2T2>::row_type::invariable	row2;
+	get_row(row1, array1, row_no);
+	get_row(row2, array2, row_no);
+	f(row1.begin(), row1.end(), row2.begin());
+}
+
+//--------------------------------------------------------------
+
+//! \brief Преобразование отсчета в double: функтор значения по умолчанию для статистик и гистограмм
+struct to_double
+{
+	template<class T>
+	double	operator()(const T &x) const { return double(x); }
+};
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Параллельная обработка n_rows строк, содержащих всего n_elements элементов, с накоплением результата
+
+	Каждый поток накапливает результат в собственной копии initial функтором process_row(ACC&, size_t row_no),
+	затем копии объединяются с результатом функтором merge(ACC &result, const ACC &local).
+	Порядок объединения не определен.
+
+	Небольшие массивы (см. ParallelApply::WorkThreadsCount) и вызовы внутри параллельной области
+	обрабатываются в одном потоке, без копий initial (копия накопителя может быть велика, например гистограмма).
+*/
+template<class ACC, class ROW_F, class MERGE_F>
+ACC	reduce_rows(size_t n_rows, size_t n_elements, const ACC &initial, const ROW_F &process_row, const MERGE_F &merge, const char *function_name)
+{
+	ACC	result(initial);
+	const size_t	n_threads = ParallelApply::WorkThreadsCount(n_rows, n_elements);
+	if(n_threads <= 1)
+	{
+		for(size_t r = 0; r < n_rows; ++r)
+			process_row(result, r);
+		return result;
+	}
+	ThreadErrorCollector	ec(function_name);
+	#pragma omp parallel num_threads(int(n_threads))
+	{
+		ACC	local(initial);
+		#pragma omp for schedule (static)
+		for(ptrdiff_t r = 0; r < ptrdiff_t(n_rows); ++r)
+		{
+			if (ec.HasErrors())
+				continue;
+			ThreadSetup ts; (void)ts;
+			try
+			{
+				process_row(local, size_t(r));
+			}
+			catch (...)
+			{
+				ec.CatchException();
+			}
+		}
+		#pragma omp critical
+		merge(result, local);
+	}
+	ec.ThrowIfErrors();
+	return result;
+}
+
+//--------------------------------------------------------------
+
+} // namespace DataArrayRows
+
+XRAD_END
+
+#endif // XRAD__File_DataArrayRows_h
@@ -0,0 +1,378 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_DataArrayStatistics_h
+#define XRAD__File_DataArrayStatistics_h
+/*!
+	\file
+	\brief Вычисление набора статистических характеристик массива за один параллельный проход
+
+	Минимум и максимум (с положениями), сумма, среднее, дисперсия, гистограмма и квантили
+	вычисляются одновременно. Каждый поток накапливает собственные частичные результаты,
+	которые объединяются в конце. Функтор преобразования применяется к каждому элементу один раз.
+*/
+//--------------------------------------------------------------
+
+#include "DataArrayRows.h"
+#include "HistogramDistribution.h"
+#include <limits>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+//! \brief Перечень характеристик, которые нужно вычислить функцией ComputeArrayStatistics
+struct ArrayStatisticsRequest
+{
+	//! \brief Минимальное и максимальное значения
+	bool	extrema = true;
+	//! \brief Положения минимального и максимального значений (первые вхождения)
+	bool	positions = false;
+	//! \brief Сумма, среднее и дисперсия
+	bool	moments = false;
+
+	//! \brief Количество интервалов гистограммы. 0 -- гистограмма не нужна
+	size_t	histogram_size = 0;
+	/*!
+		\brief Диапазон значений гистограммы
+
+		Если диапазон не задан (по умолчанию), используется диапазон значений данных [min, max].
+		В этом случае он становится известен только после просмотра всех данных, и гистограмма
+		строится вторым параллельным проходом. При заданном диапазоне все вычисляется за один проход.
+	*/
+	range1_F64	histogram_range = range1_F64(0, 0);
+
+	//! \brief Вероятности, для которых нужно найти квантили. Квантили находятся по гистограмме
+	//! с интерполяцией внутри интервала (HistogramDistribution::quantile),
+	//! если histogram_size == 0, используется гистограмма из default_quantiles_histogram_size интервалов
+	vector<double>	quantiles;
+
+	static constexpr size_t	default_quantiles_histogram_size = 10000;
+};
+
+//! \brief Результат функции ComputeArrayStatistics. Значения, не являющиеся числами (nan, inf), не учитываются
+struct ArrayStatistics
+{
+	//! \brief Общее количество элементов массива
+	size_t	total_count = 0;
+	//! \brief Количество учтенных элементов (являющихся числами)
+	size_t	count = 0;
+
+	double	min_value = numeric_limits<double>::quiet_NaN();
+	double	max_value = numeric_limits<double>::quiet_NaN();
+	//! \brief Положения экстремумов: {i} для DataArray, {v, h} для DataArray2D, полный индекс для DataArrayMD
+	index_vector	min_position;
+	index_vector	max_position;
+
+	double	sum = 0;
+	double	mean = numeric_limits<double>::quiet_NaN();
+	double	variance = numeric_limits<double>::quiet_NaN();
+
+	/*!
+		\brief Гистограмма, нормированная на total_count
+
+		Разбиение на интервалы такое же, как в ComputeHistogramTransformed: значение x попадает
+		в элемент с номером (x - p1)*(size - 1)/(p2 - p1), значения вне диапазона прибавляются к крайним элементам.
+		Если диапазон гистограммы определить не удалось (нет ни одного числа или все значения равны),
+		гистограмма остается пустой.
+	*/
+	DataArray<double>	histogram;
+	range1_F64	histogram_range;
+
+	//! \brief Квантили в порядке ArrayStatisticsRequest::quantiles
+	vector<double>	quantiles;
+
+	range1_F64	values_range() const { return range1_F64(min_value, max_value); }
+};
+
+//--------------------------------------------------------------
+
+namespace ArrayStatisticsAuxiliaries
+{
+
+//! \brief Частичные результаты одного потока
+struct partial
+{
+	size_t	total_count = 0;
+	size_t	count = 0;
+	double	min_value = numeric_limits<double>::infinity();
+	double	max_value = -numeric_limits<double>::infinity();
+	// положение экстремума: номер строки и номер элемента в строке
+	size_t	min_row = 0, min_col = 0;
+	size_t	max_row = 0, max_col = 0;
+	// суммы отсчитываются от значения shift для уменьшения ошибок округления при вычислении дисперсии
+	double	shifted_sum = 0;
+	double	shifted_sum2 = 0;
+	vector<double>	histogram;
+
+	explicit partial(size_t histogram_size) : histogram(histogram_size, 0){}
+
+	//! \brief Объединение с результатами другого потока. При равных экстремумах выбирается первое вхождение
+	void	merge(const partial &other)
+	{
+		total_count += other.total_count;
+		if(!other.count)
+			return;
+		count += other.count;
+		if(other.min_value < min_value ||
+				(other.min_value == min_value && make_pair(other.min_row, other.min_col) < make_pair(min_row, min_col)))
+		{
+			min_value = other.min_value;
+			min_row = other.min_row;
+			min_col = other.min_col;
+		}
+		if(other.max_value > max_value ||
+				(other.max_value == max_value && make_pair(other.max_row, other.max_col) < make_pair(max_row, max_col)))
+		{
+			max_value = other.max_value;
+			max_row = other.max_row;
+			max_col = other.max_col;
+		}
+		shifted_sum += other.shifted_sum;
+		shifted_sum2 += other.shifted_sum2;
+		for(size_t i = 0; i < histogram.size(); ++i)
+			histogram[i] += other.histogram[i];
+	}
+};
+
+struct accumulator_params
+{
+	bool	extrema = false;
+	bool	moments = false;
+	bool	histogram = false;
+	double	shift = 0;
+	size_t	histogram_size = 0;
+	double	histogram_first = 0;
+	double	histogram_last = 0;
+	double	index_factor = 0;
+};
+
+//! \brief Обработка строки. Параметры шаблона исключают ненужные проверки из внутреннего цикла
+template<bool extrema, bool moments, bool histogram, class IT, class F>
+void	AccumulateRow(partial &p, IT it, IT ie, size_t row_no, const F &function, const accumulator_params &ap)
+{
+	size_t	col = 0;
+	for(; it != ie; ++it, ++col)
+	{
+		double	value = function(*it);
+		if(!is_number(value))
+			continue;
+		++p.count;
+		if(extrema)
+		{
+			if(value < p.min_value)
+			{
+				p.min_value = value;
+				p.min_row = row_no;
+				p.min_col = col;
+			}
+			if(value > p.max_value)
+			{
+				p.max_value = value;
+				p.max_row = row_no;
+				p.max_col = col;
+			}
+		}
+		if(moments)
+		{
+			double	d = value - ap.shift;
+			p.shifted_sum += d;
+			p.shifted_sum2 += d*d;
+		}
+		if(histogram)
+		{
+			value = range(value, ap.histogram_first, ap.histogram_last);
+			size_t	index = range(ptrdiff_t(ap.index_factor*(value - ap.histogram_first)), ptrdiff_t(0), ptrdiff_t(ap.histogram_size - 1));
+			p.histogram[index] += 1;
+		}
+	}
+	p.total_count += col;
+}
+
+template<bool E, bool M, bool H, class ARR, class F>
+partial	Accumulate(const ARR &array, const F &function, const accumulator_params &ap)
+{
+	return DataArrayRows::reduce_rows(DataArrayRows::rows_count(array), DataArrayRows::elements_count(array), partial(ap.histogram_size),
+			[&](partial &p, size_t r)
+			{
+				DataArrayRows::visit_row(array, r, [&](auto it, auto ie)
+					{
+						AccumulateRow<E, M, H>(p, it, ie, r, function, ap);
+					});
+			},
+			[](partial &result, const partial &local){ result.merge(local); },
+			"ComputeArrayStatistics");
+}
+
+template<class ARR, class F>
+partial	Accumulate(const ARR &array, const F &function, const accumulator_params &ap)
+{
+	if(ap.extrema)
+	{
+		if(ap.moments)
+			return ap.histogram ? Accumulate<true, true, true>(array, function, ap) : Accumulate<true, true, false>(array, function, ap);
+		return ap.histogram ? Accumulate<true, false, true>(array, function, ap) : Accumulate<true, false, false>(array, function, ap);
+	}
+	if(ap.moments)
+		return ap.histogram ? Accumulate<false, true, true>(array, function, ap) : Accumulate<false, true, false>(array, function, ap);
+	return ap.histogram ? Accumulate<false, false, true>(array, function, ap) : Accumulate<false, false, false>(array, function, ap);
+}
+
+template<class T>
+auto	FirstElement(const DataArray<T> &array){ return array[0]; }
+
+template<class ROW_T>
+auto	FirstElement(const DataArray2D<ROW_T> &array){ return array.at(0, 0); }
+
+template<class A2T>
+auto	FirstElement(const DataArrayMD<A2T> &array){ return array.at(index_vector(array.n_dimensions(), 0)); }
+
+template<class ARR, class F>
+ArrayStatistics	ComputeArrayStatistics(const ARR &array, const ArrayStatisticsRequest &request, const F &function)
+{
+	ArrayStatistics	result;
+	if(array.empty())
+		return result;
+
+	const bool	need_histogram = request.histogram_size || !request.quantiles.empty();
+	const size_t	histogram_size = request.histogram_size ? request.histogram_size : ArrayStatisticsRequest::default_quantiles_histogram_size;
+	const bool	explicit_range = is_number(request.histogram_range.p1()) && is_number(request.histogram_range.p2()) &&
+			request.histogram_range.p1() < request.histogram_range.p2();
+
+	accumulator_params	ap;
+	ap.extrema = request.extrema || request.positions || (need_histogram && !explicit_range);
+	ap.moments = request.moments;
+	ap.histogram = need_histogram && explicit_range;
+	if(ap.moments)
+	{
+		double	first = function(FirstElement(array));
+		ap.shift = is_number(first) ? first : 0;
+	}
+	range1_F64	histogram_range = request.histogram_range;
+	if(ap.histogram)
+	{
+		ap.histogram_size = histogram_size;
+		ap.histogram_first = histogram_range.p1();
+		ap.histogram_last = histogram_range.p2();
+		ap.index_factor = double(histogram_size - 1)/histogram_range.delta();
+	}
+
+	// основной проход
+	partial	p = Accumulate(array, function, ap);
+
+	result.total_count = p.total_count;
+	result.count = p.count;
+	if(p.count && ap.extrema)
+	{
+		result.min_value = p.min_value;
+		result.max_value = p.max_value;
+		if(request.positions)
+		{
+			result.min_position = DataArrayRows::element_index(array, p.min_row, p.min_col);
+			result.max_position = DataArrayRows::element_index(array, p.max_row, p.max_col);
+		}
+	}
+	if(p.count && ap.moments)
+	{
+		const double	shifted_mean = p.shifted_sum/p.count;
+		result.sum = p.shifted_sum + ap.shift*p.count;
+		result.mean = shifted_mean + ap.shift;
+		result.variance = max(p.shifted_sum2/p.count - square(shifted_mean), 0.);
+	}
+
+	if(!need_histogram)
+		return result;
+
+	if(!ap.histogram)
+	{
+		// диапазон гистограммы стал известен только после основного прохода
+		if(!p.count || p.min_value == p.max_value)
+			return result;
+		histogram_range = range1_F64(p.min_value, p.max_value);
+
+		accumulator_params	hp;
+		hp.histogram = true;
+		hp.histogram_size = histogram_size;
+		hp.histogram_first = histogram_range.p1();
+		hp.histogram_last = histogram_range.p2();
+		hp.index_factor = double(histogram_size - 1)/histogram_range.delta();
+		p = Accumulate(array, function, hp);
+	}
+
+	result.histogram_range = histogram_range;
+	result.histogram.realloc(histogram_size);
+	const double	increment = 1./result.total_count;
+	for(size_t i = 0; i < histogram_size; ++i)
+		result.histogram[i] = p.histogram[i]*increment;
+
+	// квантили -- с интерполяцией внутри интервала, как в HistogramDistribution.
+	// элемент i описывает интервал [p1 + i*step, p1 + (i+1)*step), значение p2 попадает в последний
+	const double	step = histogram_range.delta()/max(histogram_size - 1, size_t(1));
+	HistogramDistribution	distribution(result.histogram,
+			range1_F64(histogram_range.p1(), histogram_range.p1() + histogram_size*step));
+	for(double probability: request.quantiles)
+	{
+		if(!in_range(probability, 0, 1))
+			throw invalid_argument(ssprintf("ComputeArrayStatistics, invalid quantile probability = %g", probability));
+		result.quantiles.push_back(distribution.empty() ? numeric_limits<double>::quiet_NaN() :
+				range(distribution.quantile(probability), histogram_range.p1(), histogram_range.p2()));
+	}
+	return result;
+}
+
+using DataArrayRows::to_double;
+
+} // namespace ArrayStatisticsAuxiliaries
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Вычисление статистических характеристик массива за один параллельный проход
+
+	Функтор function должен возвращать значение, приводимое к double, и быть потокобезопасным.
+	Вызывается ровно один раз для каждого элемента (дважды, если нужна гистограмма с диапазоном,
+	определяемым по данным).
+*/
+template<class T, class F>
+ArrayStatistics	ComputeArrayStatistics(const DataArray<T> &array, const ArrayStatisticsRequest &request, const F &function)
+{
+	return ArrayStatisticsAuxiliaries::ComputeArrayStatistics(array, request, function);
+}
+
+template<class ROW_T, class F>
+ArrayStatistics	ComputeArrayStatistics(const DataArray2D<ROW_T> &array, const ArrayStatisticsRequest &request, const F &function)
+{
+	return ArrayStatisticsAuxiliaries::ComputeArrayStatistics(array, request, function);
+}
+
+template<class A2T, class F>
+ArrayStatistics	ComputeArrayStatistics(const DataArrayMD<A2T> &array, const ArrayStatisticsRequest &request, const F &function)
+{
+	return ArrayStatisticsAuxiliaries::ComputeArrayStatistics(array, request, function);
+}
+
+template<class T>
+ArrayStatistics	ComputeArrayStatistics(const DataArray<T> &array, const ArrayStatisticsRequest &request)
+{
+	return ArrayStatisticsAuxiliaries::ComputeArrayStatistics(array, request, ArrayStatisticsAuxiliaries::to_double());
+}
+
+template<class ROW_T>
+ArrayStatistics	ComputeArrayStatistics(const DataArray2D<ROW_T> &array, const ArrayStatisticsRequest &request)
+{
+	return ArrayStatisticsAuxiliaries::ComputeArrayStatistics(array, request, ArrayStatisticsAuxiliaries::to_double());
+}
+
+template<class A2T>
+ArrayStatistics	ComputeArrayStatistics(const DataArrayMD<A2T> &array, const ArrayStatisticsRequest &request)
+{
+	return ArrayStatisticsAuxiliaries::ComputeArrayStatistics(array, request, ArrayStatisticsAuxiliaries::to_double());
+}
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_DataArrayStatistics_h
@@ -10,6 +10,7 @@
 //--------------------------------------------------------------
 
 #include "Iterators.h"
+#include "DataAllocator.h"
 
 XRAD_BEGIN
 
@@ -40,10 +40,10 @@ void DataOwner<VT>::allocate(size_t s)
 
 	if(s>0)
 	{
-		// аллокируем через new[], память инициализируется только
-		// при наличии конструктора (для простых типов вроде int, double
-		// остается неинициализированной)
-		// удаляем через delete[]
+		// аллокируем через AllocateDataMemory (выравнивание data_alignment, пул блоков),
+		// память инициализируется только при наличии конструктора
+		// (для простых типов вроде int, double остается неинициализированной)
+		// удаляем через DataAllocatorAuxiliaries::DestroyArray
 
 		try
 		{
@@ -53,7 +53,7 @@ void DataOwner<VT>::allocate(size_t s)
 			// TODO: Для const-типов не долюно быть операций allocate вообще.
 			// Контейнеры с такими типами могут использоваться только как ссылки на внешние данные
 			// или быть пустыми.
-			m_data = new std::remove_const_t<VT>[m_size];
+			m_data = DataAllocatorAuxiliaries::CreateArray<std::remove_const_t<VT>>(m_size);
 		}
 		catch(bad_alloc &)
 		{
@@ -75,12 +75,11 @@ void DataOwner<VT>::allocate(size_t s)
 			// проверка других исключений
 			ForceDebugBreak();
 
+			// CreateArray сам освобождает память при исключении в конструкторе элемента,
+			// m_data остается нулевым
 			m_size = 0;
 			m_step = 0;
 			m_ownData = false;
-			// вначале m_data была проинициализирована нулем, так что
-			// удаление ненулевого массива здесь корректно
-			DestroyArray(m_data);
 
 			throw;
 		}
@@ -93,7 +92,9 @@ void DataOwner<VT>::dispose()
 {
 	if(m_ownData)
 	{
-		delete[] (m_step >= 0 || !m_size? m_data: m_data + m_step * ptrdiff_t(m_size - 1));
+		DataAllocatorAuxiliaries::DestroyArray(const_cast<std::remove_const_t<VT>*>(
+				m_step >= 0 || !m_size? m_data: m_data + m_step * ptrdiff_t(m_size - 1)),
+				m_size);
 		m_data = nullptr;
 		m_ownData = false;
 	}
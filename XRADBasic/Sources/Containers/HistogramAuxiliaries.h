@@ -0,0 +1,254 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_HistogramAuxiliaries_h
+#define XRAD__File_HistogramAuxiliaries_h
+/*!
+	\file
+	\brief Параллельный подсчет гистограмм для DataArray, DataArray2D, DataArrayMD
+
+	Каждый поток заполняет собственную гистограмму, гистограммы потоков складываются в конце.
+	Для 8- и 16-битных целых данных сначала подсчитывается количество каждого возможного значения
+	(прямая индексация без арифметики с плавающей точкой), затем эти количества распределяются
+	по интервалам гистограммы.
+
+	Не предназначено для использования в пользовательском коде.
+*/
+//--------------------------------------------------------------
+
+#include "DataArrayRows.h"
+#include "HistogramDistribution.h"
+#include <limits>
+
+XRAD_BEGIN
+
+namespace HistogramAuxiliaries
+{
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Разбиение диапазона значений на интервалы гистограммы
+
+	Номер интервала: index_factor*(x - first), значение предварительно ограничивается диапазоном [first, last],
+	номер -- диапазоном [0, size - 1].
+*/
+struct histogram_binning
+{
+	double	first = 0;
+	double	last = 0;
+	double	index_factor = 0;
+	size_t	size = 0;
+
+	//! \brief Диапазон делится на size равных интервалов (ComputeHistogram, ComputeHistogramRaw)
+	static histogram_binning	intervals(const range1_F64 &values_range, size_t size)
+	{
+		return histogram_binning(values_range, size, double(size)/values_range.delta());
+	}
+
+	//! \brief Концы диапазона соответствуют первому и последнему элементам (ComputeHistogramTransformed)
+	static histogram_binning	nodes(const range1_F64 &values_range, size_t size)
+	{
+		return histogram_binning(values_range, size, double(size - 1)/values_range.delta());
+	}
+
+	size_t	index(double x) const
+	{
+		x = range(x, first, last);
+		return range(ptrdiff_t(index_factor*(x - first)), ptrdiff_t(0), ptrdiff_t(size - 1));
+	}
+
+private:
+	histogram_binning(const range1_F64 &values_range, size_t in_size, double in_index_factor):
+		first(values_range.p1()), last(values_range.p2()), index_factor(in_index_factor), size(in_size){}
+};
+
+typedef vector<size_t> counts_t;
+
+inline void	add_counts(counts_t &result, const counts_t &local)
+{
+	for(size_t i = 0; i < result.size(); ++i)
+		result[i] += local[i];
+}
+
+//--------------------------------------------------------------
+
+//! \brief Типы, для которых количество каждого значения подсчитывается по таблице
+template<class T>
+struct direct_indexing : integral_constant<bool, is_integral<T>::value && !is_same<T, bool>::value && sizeof(T) <= 2> {};
+
+//! \brief Таблица используется, если элементов больше, чем table_size*direct_indexing_min_ratio.
+//! Иначе объединение таблиц потоков обходится дороже, чем подсчет по интервалам
+static constexpr size_t	direct_indexing_min_ratio = 16;
+
+/*!
+	\brief Количество каждого из возможных значений целочисленного массива
+
+	Элемент i таблицы -- количество значений, равных numeric_limits<T>::min() + i.
+*/
+template<class ARR>
+counts_t	CountIntegerValues(const ARR &array)
+{
+	typedef typename ARR::value_type value_type;
+	static_assert(direct_indexing<value_type>::value, "CountIntegerValues: 8- or 16-bit integer type expected.");
+	constexpr size_t	table_size = size_t(1) << (8*sizeof(value_type));
+	constexpr ptrdiff_t	offset = numeric_limits<value_type>::min();
+
+	return DataArrayRows::reduce_rows(DataArrayRows::rows_count(array), DataArrayRows::elements_count(array), counts_t(table_size, 0),
+			[&array](counts_t &table, size_t r)
+			{
+				DataArrayRows::visit_row(array, r, [&table](auto it, auto ie)
+					{
+						for(; it != ie; ++it)
+							++table[size_t(ptrdiff_t(*it) - offset)];
+					});
+			},
+			add_counts, "CountIntegerValues");
+}
+
+/*!
+	\brief Подсчет гистограммы: количества значений function(x), попадающих в каждый интервал
+
+	Значения function(x), не являющиеся числами, не учитываются.
+	Функтор должен возвращать значение, приводимое к double, и зависеть только от аргумента:
+	для целочисленных данных он может вызываться один раз для каждого встречающегося значения,
+	а не для каждого элемента.
+*/
+template<class ARR, class F>
+counts_t	CountHistogram(const ARR &array, const histogram_binning &binning, const F &function)
+{
+	typedef typename ARR::value_type value_type;
+	if constexpr(direct_indexing<value_type>::value)
+	{
+		constexpr size_t	table_size = size_t(1) << (8*sizeof(value_type));
+		constexpr ptrdiff_t	offset = numeric_limits<value_type>::min();
+		if(DataArrayRows::elements_count(array) >= table_size*direct_indexing_min_ratio)
+		{
+			counts_t	table = CountIntegerValues(array);
+			counts_t	counts(binning.size, 0);
+			for(size_t i = 0; i < table_size; ++i)
+			{
+				if(!table[i])
+					continue;
+				double	value = function(value_type(ptrdiff_t(i) + offset));
+				if(is_number(value))
+					counts[binning.index(value)] += table[i];
+			}
+			return counts;
+		}
+	}
+	return DataArrayRows::reduce_rows(DataArrayRows::rows_count(array), DataArrayRows::elements_count(array), counts_t(binning.size, 0),
+			[&](counts_t &counts, size_t r)
+			{
+				DataArrayRows::visit_row(array, r, [&](auto it, auto ie)
+					{
+						for(; it != ie; ++it)
+						{
+							double	value = function(*it);
+							if(is_number(value))
+								++counts[binning.index(value)];
+						}
+					});
+			},
+			add_counts, "CountHistogram");
+}
+
+/*!
+	\brief Подсчет совместной гистограммы двух массивов одинакового размера
+
+	Результат -- матрица binning1.size x binning2.size, записанная по строкам.
+	Пары, в которых хотя бы одно из значений не является числом, не учитываются.
+*/
+template<class ARR1, class ARR2, class F1, class F2>
+counts_t	CountJointHistogram(const ARR1 &array1, const ARR2 &array2,
+		const histogram_binning &binning1, const histogram_binning &binning2,
+		const F1 &function1, const F2 &function2)
+{
+	const size_t	hsize = binning2.size;
+	return DataArrayRows::reduce_rows(DataArrayRows::rows_count(array1), DataArrayRows::elements_count(array1), counts_t(binning1.size*hsize, 0),
+			[&](counts_t &counts, size_t r)
+			{
+				DataArrayRows::visit_rows_pair(array1, array2, r, [&](auto it1, auto ie1, auto it2)
+					{
+						for(; it1 != ie1; ++it1, ++it2)
+						{
+							double	value1 = function1(*it1);
+							double	value2 = function2(*it2);
+							if(is_number(value1) && is_number(value2))
+								++counts[binning1.index(value1)*hsize + binning2.index(value2)];
+						}
+					});
+			},
+			add_counts, "CountJointHistogram");
+}
+
+//! \brief Точное распределение значений 8- или 16-битного целочисленного массива
+template<class ARR>
+HistogramDistribution	IntegerValuesDistribution(const ARR &array)
+{
+	typedef typename ARR::value_type value_type;
+	constexpr ptrdiff_t	offset = numeric_limits<value_type>::min();
+	counts_t	table = CountIntegerValues(array);
+
+	// отбрасываем значения, не встречающиеся в массиве, по краям таблицы
+	auto	first = find_if(table.begin(), table.end(), [](size_t n){ return n != 0; });
+	if(first == table.end())
+		return HistogramDistribution();
+	auto	last = find_if(table.rbegin(), table.rend(), [](size_t n){ return n != 0; }).base();
+	return HistogramDistribution::discrete(counts_t(first, last), double(offset + (first - table.begin())));
+}
+
+//--------------------------------------------------------------
+
+using DataArrayRows::to_double;
+
+//! \brief Запись гистограммы: histogram[i] = counts[i]*factor
+template<class T, class FACTOR>
+void	StoreHistogram(DataArray<T> &histogram, const counts_t &counts, FACTOR factor)
+{
+	for(size_t i = 0; i < histogram.size(); ++i)
+		histogram[i] = T(counts[i]*factor);
+}
+
+template<class ROW_T, class FACTOR>
+void	StoreHistogram(DataArray2D<ROW_T> &histogram, const counts_t &counts, FACTOR factor)
+{
+	typedef typename ROW_T::value_type value_type;
+	for(size_t i = 0; i < histogram.vsize(); ++i)
+	{
+		for(size_t j = 0; j < histogram.hsize(); ++j)
+			histogram.at(i, j) = value_type(counts[i*histogram.hsize() + j]*factor);
+	}
+}
+
+//! \brief Общая часть функций ComputeJointHistogram. Размеры массивов должны быть проверены
+template<class ARR1, class ARR2, class ROW_T>
+void	ComputeJointHistogram(const ARR1 &array1, const ARR2 &array2, DataArray2D<ROW_T> &histogram,
+		const range1_F64 &values_range1, const range1_F64 &values_range2, size_t elements_count)
+{
+	if(!histogram.vsize() || !histogram.hsize())
+		return;
+	if(!elements_count)
+		throw invalid_argument("ComputeJointHistogram, empty arrays");
+	if(!is_number(values_range1.delta()) || !values_range1.delta() || !is_number(values_range2.delta()) || !values_range2.delta())
+	{
+		throw invalid_argument(ssprintf("ComputeJointHistogram, invalid values ranges (%g, %g), (%g, %g)",
+				values_range1.p1(), values_range1.p2(), values_range2.p1(), values_range2.p2()));
+	}
+	StoreHistogram(histogram,
+			CountJointHistogram(array1, array2,
+					histogram_binning::intervals(values_range1, histogram.vsize()),
+					histogram_binning::intervals(values_range2, histogram.hsize()),
+					to_double(), to_double()),
+			1./elements_count);
+}
+
+//--------------------------------------------------------------
+
+} // namespace HistogramAuxiliaries
+
+XRAD_END
+
+#endif // XRAD__File_HistogramAuxiliaries_h
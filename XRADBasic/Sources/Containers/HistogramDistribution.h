@@ -0,0 +1,157 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_HistogramDistribution_h
+#define XRAD__File_HistogramDistribution_h
+/*!
+	\file
+	\brief Функция распределения и квантили по гистограмме
+*/
+//--------------------------------------------------------------
+
+#include "DataArray.h"
+#include <algorithm>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Функция распределения, построенная по гистограмме, и обратная к ней (квантили)
+
+	Создается один раз, после чего запросы cdf() и quantile() выполняются за O(log(size)).
+
+	Непрерывный вариант (конструктор от гистограммы): элемент i гистограммы описывает интервал
+	[first + i*step, first + (i+1)*step), step = values_range.delta()/size (соглашение
+	ComputeHistogram и ComputeHistogramRaw). Внутри интервала значения считаются распределенными
+	равномерно, поэтому квантили приближенные, с точностью до ширины интервала.
+
+	Дискретный вариант (ComputeIntegerValuesDistribution): элемент i -- количество значений,
+	равных first_value + i. Квантили точные: quantile(p) возвращает наименьшее значение v,
+	для которого доля элементов, не больших v, не меньше p.
+*/
+class HistogramDistribution
+{
+public:
+	HistogramDistribution(){}
+
+	//! \brief Непрерывное распределение по гистограмме (количества или плотности, нормировка не важна)
+	template<class T>
+	HistogramDistribution(const DataArray<T> &histogram, const range1_F64 &values_range):
+		m_first(values_range.p1()),
+		m_step(histogram.size() ? values_range.delta()/histogram.size() : 0)
+	{
+		if(!is_number(values_range.p1()) || !is_number(values_range.p2()) || values_range.p1() > values_range.p2())
+			throw invalid_argument(ssprintf("HistogramDistribution, invalid values range (%g, %g)", values_range.p1(), values_range.p2()));
+		init(histogram.begin(), histogram.end());
+	}
+
+	//! \brief Дискретное распределение: counts[i] -- количество значений, равных first_value + i
+	static HistogramDistribution	discrete(const vector<size_t> &counts, double first_value)
+	{
+		HistogramDistribution	result;
+		result.m_discrete = true;
+		result.m_first = first_value;
+		result.m_step = 1;
+		result.init(counts.begin(), counts.end());
+		return result;
+	}
+
+	//! \brief true, если гистограмма пустая или нулевая
+	bool	empty() const { return !m_total; }
+	size_t	size() const { return m_cdf.empty() ? 0 : m_cdf.size() - 1; }
+	//! \brief Сумма элементов исходной гистограммы
+	double	total() const { return m_total; }
+	bool	discrete() const { return m_discrete; }
+
+	/*!
+		\brief Функция распределения: доля значений, меньших x
+
+		Для дискретного распределения -- доля значений, не больших x.
+	*/
+	double	cdf(double x) const
+	{
+		if(empty())
+			return 0;
+		if(m_discrete)
+		{
+			double	position = floor(x - m_first) + 1;
+			return position <= 0 ? 0 : position >= size() ? 1 : m_cdf[size_t(position)];
+		}
+		double	position = (x - m_first)/m_step;
+		if(!(position > 0))
+			return 0;
+		if(position >= size())
+			return 1;
+		size_t	i = size_t(position);
+		return m_cdf[i] + (position - i)*(m_cdf[i + 1] - m_cdf[i]);
+	}
+
+	//! \brief Квантиль: значение x, для которого cdf(x) = probability
+	double	quantile(double probability) const
+	{
+		if(!in_range(probability, 0, 1))
+			throw invalid_argument(ssprintf("HistogramDistribution::quantile, invalid probability = %g", probability));
+		if(empty())
+			throw invalid_argument("HistogramDistribution::quantile, empty distribution");
+
+		// первый интервал, на котором функция распределения достигает probability.
+		// при probability == 0 -- первый непустой интервал
+		auto	it = probability > 0 ?
+				lower_bound(m_cdf.begin() + 1, m_cdf.end(), probability) :
+				upper_bound(m_cdf.begin() + 1, m_cdf.end(), 0.);
+		size_t	bin = min(size_t(it - m_cdf.begin()), size()) - 1;
+		if(m_discrete)
+			return m_first + bin;
+		double	fraction = (probability - m_cdf[bin])/(m_cdf[bin + 1] - m_cdf[bin]);
+		return m_first + m_step*(bin + range(fraction, 0, 1));
+	}
+
+	range1_F64	quantiles_range(const range1_F64 &probabilities) const
+	{
+		return range1_F64(quantile(probabilities.p1()), quantile(probabilities.p2()));
+	}
+
+	vector<double>	quantiles(const vector<double> &probabilities) const
+	{
+		vector<double>	result(probabilities.size());
+		for(size_t i = 0; i < probabilities.size(); ++i)
+			result[i] = quantile(probabilities[i]);
+		return result;
+	}
+
+private:
+	template<class IT>
+	void	init(IT it, IT ie)
+	{
+		m_cdf.assign(1, 0);
+		double	sum = 0;
+		for(; it != ie; ++it)
+		{
+			sum += double(*it);
+			m_cdf.push_back(sum);
+		}
+		m_total = sum;
+		if(m_total)
+		{
+			for(auto &v: m_cdf)
+				v /= m_total;
+			m_cdf.back() = 1;
+		}
+	}
+
+	//! \brief Функция распределения в узлах: m_cdf[i] -- доля значений в интервалах 0..i-1
+	vector<double>	m_cdf;
+	double	m_first = 0;
+	double	m_step = 0;
+	double	m_total = 0;
+	bool	m_discrete = false;
+};
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_HistogramDistribution_h
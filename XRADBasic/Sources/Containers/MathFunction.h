@@ -64,6 +64,10 @@ class	MathFunction : public Algebra1D<MathFunction<XRAD__MathFunction_template_a
 		template<class T2> child_type	&operator = (const DataArray<T2> &original){ parent::operator=(original); return child_ref(); }
 
 		template<class T2> child_type	&operator = (DataArray<T2> &&original){ parent::operator=(std::move(original)); return child_ref(); }
+
+		//! \brief Присваивание ленивого выражения, см. FieldExpression.h
+		template<class E, std::enable_if_t<AlgebraicStructures::is_field_expression<E>::value, int> = 0>
+		child_type	&operator = (const E &expression){ parent::operator=(expression); return child_ref(); }
 		//! @}
 
 		//! \brief Интерполяция
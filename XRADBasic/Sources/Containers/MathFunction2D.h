@@ -15,6 +15,8 @@
 
 XRAD_BEGIN
 
+class	SeparableInterpolator2D;
+
 //--------------------------------------------------------------
 
 /*!
@@ -79,6 +81,10 @@ class	MathFunction2D : public Algebra2D<MathFunction2D<FT>, FT, typename FT::val
 		template<class AT> self	&operator = (const DataArray2D<AT> &original){ parent::operator=(original); return *this; }
 
 		template<class AT> self	&operator = (DataArray2D<AT> &&original){ parent::operator=(std::move(original)); return *this; }
+
+		//! \brief Присваивание ленивого выражения, см. FieldExpression.h
+		template<class E, std::enable_if_t<AlgebraicStructures::is_field_expression<E>::value, int> = 0>
+		self	&operator = (const E &expression){ parent::operator=(expression); return *this; }
 		//! @}
 
 		//! \name Roll functions
@@ -114,6 +120,7 @@ class	MathFunction2D : public Algebra2D<MathFunction2D<FT>, FT, typename FT::val
 
 		template<class INTERPOLATOR_T>
 		floating32_type<value_type>	in(double v, double h, const INTERPOLATOR_T *interpolator) const;
+		floating32_type<value_type>	in(double v, double h, const SeparableInterpolator2D *interpolator) const;
 
 		//! @}
 
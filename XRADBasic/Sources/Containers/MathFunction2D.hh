@@ -195,6 +195,13 @@ floating32_type<typename MathFunction2D<FT>::value_type> MathFunction2D<FT>::in(
 	return filter->Apply((*this), vi, hi);
 }
 
+template<class FT>
+floating32_type<typename MathFunction2D<FT>::value_type> MathFunction2D<FT>::in(double v, double h, const SeparableInterpolator2D *interpolator) const
+{
+	interpolator->ApplyOffsetCorrection(v, h);
+	return interpolator->Apply(*this, v, h);
+}
+
 
 
 template<class FT>
@@ -46,6 +46,10 @@ class	MathFunctionMD : public AlgebraMD<MathFunctionMD<A2DT>, A2DT, typename A2D
 		template<class A2DT2> self	&operator = (const DataArrayMD<A2DT2> &original){ parent::operator=(original); return *this; }
 
 		template<class A2DT2> self	&operator = (DataArrayMD<A2DT2> &&original){ parent::operator=(std::move(original)); return *this; }
+
+		//! \brief Присваивание ленивого выражения, см. FieldExpression.h
+		template<class E, std::enable_if_t<AlgebraicStructures::is_field_expression<E>::value, int> = 0>
+		self	&operator = (const E &expression){ parent::operator=(expression); return *this; }
 		//! @}
 };
 
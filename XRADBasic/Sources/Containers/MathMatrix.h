@@ -8,6 +8,7 @@
 
 #include "DataArray2D.h"
 #include "LinearVector.h"
+#include "MatrixProductBlocked.h"
 #include <XRADBasic/Sources/Algebra/AlgebraicAlgorithms2D.h>
 
 XRAD_BEGIN
@@ -115,17 +115,26 @@ MathMatrix<XRAD__MathMatrix_template_args>	&MathMatrix<XRAD__MathMatrix_template
 		throw invalid_argument(problem_description);
 		}
 
-	for(size_t i=0; i<m1.vsize(); i++)
+	if(MatrixProductBlocked::DataOverlap(*this, m1) || MatrixProductBlocked::DataOverlap(*this, m2))
 		{
-		auto it = row(i).begin();
-		for(size_t j=0; j<m2.hsize(); j++, ++it)
-			{
-			//*it = m1.row(i) | m2.col(j);
-			m1.row(i).scalar_product(*it, m2.col(j));
-			// скалярное умножение строки на столбец
-			}
+		// результат обнуляется и накапливается в *this, поэтому при общих с сомножителем данных
+		// (m.matrix_multiply(m, x)) произведение вычисляется во временной матрице
+		self	product(vsize(), hsize());
+		product.matrix_multiply(m1, m2);
+		this->CopyData(product);
+		return *this;
 		}
 
+	// каждый элемент -- скалярное произведение строки m1 на столбец m2 (для комплексных матриц
+	// с сопряжением, как в scalar_product). вычисляется блоками, см. MatrixProductBlocked.h
+	this->fill(zero_value(value_type()));
+	auto	a = MatrixProductBlocked::MakeMatrixView(m1);
+	auto	b = MatrixProductBlocked::MakeMatrixView(m2);
+	auto	c = MatrixProductBlocked::MakeMatrixView(*this);
+	MatrixProductBlocked::Multiply<value_type>(vsize(), hsize(), m1.hsize(), a, b,
+			MatrixProductBlocked::scalar_product_madd(),
+			[&c](size_t i, size_t j, const value_type &s){ c(i, j) += s; });
+
 	return *this;
 	}
 
@@ -206,12 +215,19 @@ MathMatrix<XRAD__MathMatrix_template_args>	& MathMatrix<XRAD__MathMatrix_templat
 		throw invalid_argument(problem_description);
 		}
 
-	auto it = row(0).begin();
-	for(size_t j=0; j<m2.hsize(); j++, ++it)
+	// скалярные произведения v на столбцы m2 накапливаются по строкам m2,
+	// чтобы не обращаться к столбцам с большим шагом
+	auto	&result_row = row(0);
+	result_row.fill(zero_value(value_type()));
+	auto	v_it = v.begin();
+	for(size_t k=0; k<m2.vsize(); ++k, ++v_it)
 		{
-		//*it = v | m2.col(j);
-		v.scalar_product(*it, m2.col(j));
-		// скалярное умножение строки на столбец
+		auto	it = result_row.begin();
+		auto	m2_it = m2.row(k).begin();
+		for(size_t j=0; j<m2.hsize(); ++j, ++it, ++m2_it)
+			{
+			scalar_product_action(*it, *v_it, *m2_it);
+			}
 		}
 
 	return *this;
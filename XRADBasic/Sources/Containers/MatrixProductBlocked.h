@@ -0,0 +1,264 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_MatrixProductBlocked_h
+#define XRAD__File_MatrixProductBlocked_h
+/*!
+	\file
+	\brief Блочное многопоточное произведение матриц
+
+	Используется в MathMatrix::matrix_multiply и в решении линейных систем (SolveLinearSystem.h).
+	Не предназначено для непосредственного использования в пользовательском коде.
+
+	Результат разбивается на блоки tile_rows x tile_columns, которые вычисляются независимо
+	(при большом объеме вычислений -- в нескольких потоках). Для каждого блока сомножители по частям
+	(по depth_block элементов суммы) копируются в непрерывные буферы, упорядоченные так,
+	как их читает внутренний цикл: полосами по micro_rows строк первого сомножителя и по micro_columns
+	столбцов второго. Внутренний цикл накапливает блок micro_rows x micro_columns результата
+	в локальных переменных, которые компилятор может разместить в регистрах.
+
+	Порядок суммирования отличается от поэлементного скалярного произведения, поэтому результат
+	может отличаться от него в пределах ошибки округления.
+*/
+//--------------------------------------------------------------
+
+#include <XRADBasic/Sources/Core/NumberTraits.h>
+#include <XRADBasic/Sources/Containers/ParallelApply.h>
+#include <type_traits>
+#include <vector>
+
+XRAD_BEGIN
+
+namespace MatrixProductBlocked
+{
+
+//--------------------------------------------------------------
+
+//! \name Размеры блоков
+//! @{
+constexpr size_t micro_rows = 4;
+constexpr size_t micro_columns = 4;
+constexpr size_t tile_rows = 64;
+constexpr size_t tile_columns = 128;
+constexpr size_t depth_block = 256;
+//! @}
+
+//! \brief При меньшем количестве умножений (m*n*k) используется простой цикл без буферов
+constexpr size_t blocked_min_operations = size_t(1) << 15;
+
+//--------------------------------------------------------------
+
+//! \brief Умножение с накоплением, как в скалярном произведении векторов (для комплексных -- с сопряжением второго сомножителя)
+struct	scalar_product_madd
+{
+	template<class R, class A, class B>
+	void	operator()(R &result, const A &a, const B &b) const { scalar_product_action(result, a, b); }
+};
+
+//! \brief Умножение с накоплением без сопряжения
+struct	plain_madd
+{
+	template<class R, class A, class B>
+	void	operator()(R &result, const A &a, const B &b) const { result += a*b; }
+};
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Элемент (i, j) матрицы, заданной указателем на элемент (0, 0) и шагами
+
+	Шаги -- в элементах, как DataArray2D::vstep_raw(), hstep_raw().
+*/
+template<class T>
+struct	matrix_view
+{
+	T	*data;
+	ptrdiff_t	vstep, hstep;
+
+	T	&operator()(size_t i, size_t j) const { return data[ptrdiff_t(i)*vstep + ptrdiff_t(j)*hstep]; }
+};
+
+//! \brief Представление подматрицы m, начинающейся с элемента (v0, h0). Для пустой матрицы data = nullptr
+template<class A2D>
+auto	MakeMatrixView(A2D &m, size_t v0 = 0, size_t h0 = 0)
+{
+	matrix_view<std::remove_reference_t<decltype(m.at(0, 0))>>	result{nullptr, m.vstep_raw(), m.hstep_raw()};
+	if(v0 < m.vsize() && h0 < m.hsize())
+		result.data = &m.at(v0, h0);
+	return result;
+}
+
+/*!
+	\brief Пересекаются ли области памяти, занятые элементами матриц m1 и m2
+
+	Используется, чтобы не записывать результат произведения в данные сомножителя.
+*/
+template<class A2D1, class A2D2>
+bool	DataOverlap(const A2D1 &m1, const A2D2 &m2)
+{
+	if(m1.empty() || m2.empty())
+		return false;
+	// шаги могут быть отрицательными, поэтому границы -- по четырем угловым элементам
+	auto	address_range = [](const auto &m)
+		{
+		const uintptr_t	corners[4] = {
+				reinterpret_cast<uintptr_t>(&m.at(0, 0)),
+				reinterpret_cast<uintptr_t>(&m.at(0, m.hsize() - 1)),
+				reinterpret_cast<uintptr_t>(&m.at(m.vsize() - 1, 0)),
+				reinterpret_cast<uintptr_t>(&m.at(m.vsize() - 1, m.hsize() - 1))};
+		auto	bounds = std::minmax_element(corners, corners + 4);
+		return std::make_pair(*bounds.first, *bounds.second + sizeof(m.at(0, 0)));
+		};
+	auto	r1 = address_range(m1);
+	auto	r2 = address_range(m2);
+	return r1.first < r2.second && r2.first < r1.second;
+}
+
+//--------------------------------------------------------------
+
+namespace Auxiliaries
+{
+
+//! \brief Копирование k элементов строк first..first+n_rows-1 полосами по micro_rows; недостающие строки заполняются нулями
+template<class PACKED, class SOURCE>
+void	PackRows(PACKED *packed, const SOURCE &source, size_t first, size_t n_rows, size_t k0, size_t k)
+{
+	for(size_t r0 = 0; r0 < n_rows; r0 += micro_rows)
+	{
+		for(size_t p = 0; p < k; ++p)
+		{
+			for(size_t r = 0; r < micro_rows; ++r, ++packed)
+			{
+				if(r0 + r < n_rows)
+					*packed = source(first + r0 + r, k0 + p);
+				else
+					make_zero(*packed);
+			}
+		}
+	}
+}
+
+//! \brief Копирование k элементов столбцов first..first+n_columns-1 полосами по micro_columns
+template<class PACKED, class SOURCE>
+void	PackColumns(PACKED *packed, const SOURCE &source, size_t first, size_t n_columns, size_t k0, size_t k)
+{
+	for(size_t c0 = 0; c0 < n_columns; c0 += micro_columns)
+	{
+		for(size_t p = 0; p < k; ++p)
+		{
+			for(size_t c = 0; c < micro_columns; ++c, ++packed)
+			{
+				if(c0 + c < n_columns)
+					*packed = source(k0 + p, first + c0 + c);
+				else
+					make_zero(*packed);
+			}
+		}
+	}
+}
+
+template<class ACC, class PA, class PB, class MADD>
+inline void	MicroKernel(ACC (&acc)[micro_rows][micro_columns], const PA *a, const PB *b, size_t k, const MADD &madd)
+{
+	for(size_t r = 0; r < micro_rows; ++r)
+		for(size_t c = 0; c < micro_columns; ++c)
+			make_zero(acc[r][c]);
+	for(size_t p = 0; p < k; ++p, a += micro_rows, b += micro_columns)
+	{
+		for(size_t r = 0; r < micro_rows; ++r)
+			for(size_t c = 0; c < micro_columns; ++c)
+				madd(acc[r][c], a[r], b[c]);
+	}
+}
+
+} // namespace Auxiliaries
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Произведение матриц m x k и k x n
+
+	Для каждого элемента результата (i, j) вычисляется сумма s (типа ACC) произведений
+	madd(s, a(i, p), b(p, j)) по p и вызывается store(i, j, s). При k > depth_block сумма
+	вычисляется по частям, и store вызывается для одного элемента несколько раз:
+	store должен накапливать результат (например, result(i, j) += s).
+
+	Функторы a, b, store вызываются из нескольких потоков одновременно (для разных элементов).
+	Если lower_triangle == true, элементы выше главной диагонали (j > i) можно не вычислять:
+	пропускаются блоки, целиком лежащие выше нее.
+*/
+template<class ACC, class A, class B, class MADD, class STORE>
+void	Multiply(size_t m, size_t n, size_t k, const A &a, const B &b, const MADD &madd, const STORE &store,
+		bool lower_triangle = false)
+{
+	using	PA = std::remove_cv_t<std::remove_reference_t<decltype(a(0, 0))>>;
+	using	PB = std::remove_cv_t<std::remove_reference_t<decltype(b(0, 0))>>;
+	if(!m || !n || !k)
+		return;
+	const double	n_operations = double(m)*double(n)*double(k);
+
+	if(n_operations < blocked_min_operations)
+	{
+		// для малых матриц копирование в буферы не окупается
+		for(size_t i = 0; i < m; ++i)
+		{
+			for(size_t j = 0; j < (lower_triangle ? min(i + 1, n) : n); ++j)
+			{
+				ACC	s;
+				make_zero(s);
+				for(size_t p = 0; p < k; ++p)
+					madd(s, a(i, p), b(p, j));
+				store(i, j, s);
+			}
+		}
+		return;
+	}
+
+	const size_t	n_tiles_v = (m + tile_rows - 1)/tile_rows;
+	const size_t	n_tiles_h = (n + tile_columns - 1)/tile_columns;
+
+	ParallelApply::ProcessIndependentParts(n_tiles_v*n_tiles_h, size_t(n_operations), [&](size_t tile)
+		{
+			const size_t	i0 = (tile/n_tiles_h)*tile_rows;
+			const size_t	j0 = (tile%n_tiles_h)*tile_columns;
+			const size_t	mi = min(tile_rows, m - i0);
+			const size_t	nj = min(tile_columns, n - j0);
+			if(lower_triangle && j0 > i0 + mi - 1)
+				return;
+
+			// буферы выделяются для каждого блока: их заполнение -- не более 1/tile_columns (1/tile_rows) вычислений блока
+			const size_t	max_depth = min(depth_block, k);
+			std::vector<PA>	packed_a(tile_rows*max_depth);
+			std::vector<PB>	packed_b(tile_columns*max_depth);
+			for(size_t p0 = 0; p0 < k; p0 += depth_block)
+			{
+				const size_t	kp = min(depth_block, k - p0);
+				Auxiliaries::PackRows(packed_a.data(), a, i0, mi, p0, kp);
+				Auxiliaries::PackColumns(packed_b.data(), b, j0, nj, p0, kp);
+
+				for(size_t jr = 0; jr < nj; jr += micro_columns)
+				{
+					const PB	*pb = packed_b.data() + jr*kp;
+					for(size_t ir = 0; ir < mi; ir += micro_rows)
+					{
+						ACC	acc[micro_rows][micro_columns];
+						Auxiliaries::MicroKernel(acc, packed_a.data() + ir*kp, pb, kp, madd);
+						for(size_t r = 0; r < min(micro_rows, mi - ir); ++r)
+							for(size_t c = 0; c < min(micro_columns, nj - jr); ++c)
+								store(i0 + ir + r, j0 + jr + c, acc[r][c]);
+					}
+				}
+			}
+		},
+		"MatrixProductBlocked::Multiply");
+}
+
+//--------------------------------------------------------------
+
+} // namespace MatrixProductBlocked
+
+XRAD_END
+
+#endif // XRAD__File_MatrixProductBlocked_h
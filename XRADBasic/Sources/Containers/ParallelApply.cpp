@@ -0,0 +1,55 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#include "pre.h"
+#include "ParallelApply.h"
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+namespace
+{
+
+atomic<size_t>	global_apply_parallel_threshold(default_apply_parallel_threshold);
+
+thread_local bool	thread_apply_parallel_threshold_set = false;
+thread_local size_t	thread_apply_parallel_threshold = 0;
+
+} // namespace
+
+//--------------------------------------------------------------
+
+size_t	ApplyParallelThreshold()
+{
+	if (thread_apply_parallel_threshold_set)
+		return thread_apply_parallel_threshold;
+	return global_apply_parallel_threshold.load(memory_order_relaxed);
+}
+
+void	SetApplyParallelThreshold(size_t threshold)
+{
+	global_apply_parallel_threshold.store(threshold, memory_order_relaxed);
+}
+
+//--------------------------------------------------------------
+
+ApplyParallelThresholdScope::ApplyParallelThresholdScope(size_t threshold):
+	m_previous_set(thread_apply_parallel_threshold_set),
+	m_previous_threshold(thread_apply_parallel_threshold)
+{
+	thread_apply_parallel_threshold_set = true;
+	thread_apply_parallel_threshold = threshold;
+}
+
+ApplyParallelThresholdScope::~ApplyParallelThresholdScope()
+{
+	thread_apply_parallel_threshold_set = m_previous_set;
+	thread_apply_parallel_threshold = m_previous_threshold;
+}
+
+//--------------------------------------------------------------
+
+XRAD_END
@@ -0,0 +1,386 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_ParallelApply_h
+#define XRAD__File_ParallelApply_h
+/*!
+	\file
+	\brief Многопоточное выполнение поэлементных операций Apply_* (BasicArrayInteractions*.h)
+
+	Поэлементные операции над массивами, содержащими не менее ApplyParallelThreshold() элементов,
+	выполняются в несколько потоков: одномерный массив делится на непрерывные отрезки,
+	двумерный -- на строки (или столбцы), многомерный -- на срезы. Каждый элемент обрабатывается
+	ровно один раз тем же функтором, что и при последовательном выполнении, поэтому результат
+	не зависит от количества потоков.
+
+	Параллельно выполняются только функторы, для которых Functors::is_elementwise<F>::value == true:
+	функторы из Functors.h, не имеющие общего изменяемого состояния (plus_assign, assign_multiply и т.п.).
+	Произвольный функтор (например, лямбда-функция) может иметь побочные эффекты и по умолчанию
+	выполняется последовательно. Чтобы разрешить для него многопоточность, его нужно обернуть
+	в Functors::elementwise(f).
+
+	Внутри параллельной области OpenMP операции всегда выполняются последовательно.
+
+	Операции над несколькими массивами выполняются последовательно также при частичном перекрытии
+	приемника с другим операндом (например, a.GetDataFragment(1, n+1) += a.GetDataFragment(0, n)):
+	результат такого цикла зависит от порядка обхода. Совпадающие операнды (a += a) перекрытием
+	не считаются.
+
+	~~~~
+	SetApplyParallelThreshold(size_t(-1)); // отключить многопоточность Apply_* для всей программы
+	{
+		ApplyParallelThresholdScope	scope(0); // в этом потоке -- многопоточность для массивов любого размера
+			// (начиная с apply_parallel_min_elements)
+		a += b;
+	}
+	~~~~
+*/
+//--------------------------------------------------------------
+
+#include <XRADBasic/Sources/Core/Functors.h>
+#include <XRADBasic/Sources/Core/ThreadSetup.h>
+#include <XRADBasic/Sources/Algebra/FieldExpression.h>
+#include <omp.h>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+//! \brief Порог по умолчанию: массивы с меньшим количеством элементов обрабатываются в одном потоке
+constexpr size_t default_apply_parallel_threshold = size_t(1) << 18;
+
+//! \brief Массивы с меньшим количеством элементов всегда обрабатываются в одном потоке, независимо от порога.
+//! Для них не выполняется даже проверка порога (операции над малыми векторами не замедляются)
+constexpr size_t apply_parallel_min_elements = 4096;
+
+//! \brief Действующий в текущем потоке порог количества элементов для многопоточного выполнения Apply_*
+size_t	ApplyParallelThreshold();
+
+//! \brief Установка порога для всей программы. size_t(-1) отключает многопоточность
+void	SetApplyParallelThreshold(size_t threshold);
+
+//! \brief Замена порога в текущем потоке на время существования объекта
+class ApplyParallelThresholdScope
+{
+	public:
+		explicit ApplyParallelThresholdScope(size_t threshold);
+		~ApplyParallelThresholdScope();
+
+		ApplyParallelThresholdScope(const ApplyParallelThresholdScope &) = delete;
+		ApplyParallelThresholdScope &operator=(const ApplyParallelThresholdScope &) = delete;
+
+	private:
+		bool	m_previous_set;
+		size_t	m_previous_threshold;
+};
+
+//--------------------------------------------------------------
+
+namespace Functors
+{
+
+/*!
+	\brief Признак функтора, который можно применять к разным элементам одновременно из нескольких потоков
+
+	Общий шаблон дает false. Для собственных функторов можно определить специализацию
+	или воспользоваться оберткой elementwise().
+*/
+template <class F>
+struct is_elementwise : std::false_type {};
+
+//! \brief Обертка, разрешающая многопоточное выполнение Apply_* с функтором f
+template <class F>
+class elementwise_functor
+{
+	public:
+		elementwise_functor(const F &f): f(f) {}
+
+		template <class... Args>
+		decltype(auto) operator() (Args&&... args) const
+		{
+			return f(std::forward<Args>(args)...);
+		}
+	private:
+		F f;
+};
+
+template <class F>
+elementwise_functor<F> elementwise(const F &f)
+{
+	return elementwise_functor<F>(f);
+}
+
+template <class F> struct is_elementwise<elementwise_functor<F>> : std::true_type {};
+template <class F> struct is_elementwise<assign_f1_functor<F>> : is_elementwise<F> {};
+template <class TA, class TB> struct is_elementwise<assign_mix<TA, TB>> : std::true_type {};
+
+#define XRAD__elementwise_functor(name) template <> struct is_elementwise<name> : std::true_type {}
+
+XRAD__elementwise_functor(increment);
+XRAD__elementwise_functor(decrement);
+XRAD__elementwise_functor(unary_minus_inplace);
+XRAD__elementwise_functor(bitwise_not_inplace);
+XRAD__elementwise_functor(assign);
+XRAD__elementwise_functor(assign_unary_minus);
+XRAD__elementwise_functor(assign_logical_not);
+XRAD__elementwise_functor(assign_bitwise_not);
+XRAD__elementwise_functor(plus_assign);
+XRAD__elementwise_functor(minus_assign);
+XRAD__elementwise_functor(multiply_assign);
+XRAD__elementwise_functor(divide_assign);
+XRAD__elementwise_functor(percent_assign);
+XRAD__elementwise_functor(bitwise_and_assign);
+XRAD__elementwise_functor(bitwise_or_assign);
+XRAD__elementwise_functor(bitwise_xor_assign);
+XRAD__elementwise_functor(logical_and_assign);
+XRAD__elementwise_functor(logical_or_assign);
+XRAD__elementwise_functor(logical_xor_assign);
+XRAD__elementwise_functor(shl_assign);
+XRAD__elementwise_functor(shr_assign);
+XRAD__elementwise_functor(assign_plus);
+XRAD__elementwise_functor(assign_minus);
+XRAD__elementwise_functor(assign_multiply);
+XRAD__elementwise_functor(assign_divide);
+XRAD__elementwise_functor(assign_percent);
+XRAD__elementwise_functor(assign_logical_and);
+XRAD__elementwise_functor(assign_logical_or);
+XRAD__elementwise_functor(assign_logical_xor);
+XRAD__elementwise_functor(assign_bitwise_and);
+XRAD__elementwise_functor(assign_bitwise_or);
+XRAD__elementwise_functor(assign_bitwise_xor);
+XRAD__elementwise_functor(assign_shl);
+XRAD__elementwise_functor(assign_shr);
+XRAD__elementwise_functor(plus_assign_multiply);
+XRAD__elementwise_functor(plus_assign_divide);
+XRAD__elementwise_functor(minus_assign_multiply);
+XRAD__elementwise_functor(minus_assign_divide);
+
+#undef XRAD__elementwise_functor
+
+} // namespace Functors
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Вспомогательные функции для реализации Apply_* и других многопоточных алгоритмов библиотеки.
+	Не предназначены для использования в пользовательском коде
+*/
+namespace ParallelApply
+{
+
+/*!
+	\brief Количество элементов между итераторами
+
+	У итераторов пустого массива шаг может быть нулевым, и std::distance для них делит на 0.
+*/
+template <class Iterator>
+size_t	RangeSize(const Iterator &first, const Iterator &last)
+{
+	return first == last ? 0 : size_t(std::distance(first, last));
+}
+
+using AlgebraicStructures::FieldExpressionAuxiliaries::memory_layout;
+using AlgebraicStructures::FieldExpressionAuxiliaries::byte_distance;
+
+//! \brief Расположение в памяти одномерного массива (шаг между элементами постоянный)
+template <class Array>
+memory_layout	MemoryLayout_1D(const Array &array)
+{
+	size_t	n = RangeSize(array.begin(), array.end());
+	if (!n)
+		return memory_layout();
+	auto	it = array.begin();
+	const auto	&first = *it;
+	ptrdiff_t	step = n > 1 ? byte_distance(first, *std::next(it)) : 0;
+	return memory_layout(&first, {n}, {step});
+}
+
+//! \brief Расположение в памяти двумерного массива
+template <class Array>
+memory_layout	MemoryLayout_2D(const Array &array)
+{
+	if (!array.vsize() || !array.hsize())
+		return memory_layout();
+	const auto	&first = array.at(0, 0);
+	ptrdiff_t	v_step = array.vsize() > 1 ? byte_distance(first, array.at(1, 0)) : 0;
+	ptrdiff_t	h_step = array.hsize() > 1 ? byte_distance(first, array.at(0, 1)) : 0;
+	return memory_layout(&first, {array.vsize(), array.hsize()}, {v_step, h_step});
+}
+
+//! \brief Расположение в памяти многомерного массива
+template <class Array>
+memory_layout	MemoryLayout_MD(const Array &array)
+{
+	if (array.empty())
+		return memory_layout();
+	const size_t	n = array.n_dimensions();
+	typename Array::index_type	iv(n, 0);
+	const auto	&first = array.at(iv);
+	std::vector<size_t>	sizes(n);
+	std::vector<ptrdiff_t>	byte_steps(n, 0);
+	for (size_t d = 0; d < n; ++d)
+	{
+		sizes[d] = array.sizes(d);
+		if (sizes[d] > 1)
+		{
+			iv[d] = 1;
+			byte_steps[d] = byte_distance(first, array.at(iv));
+			iv[d] = 0;
+		}
+	}
+	return memory_layout(&first, sizes, byte_steps);
+}
+
+/*!
+	\brief Операнды можно обрабатывать по частям в разных потоках: они не перекрываются в памяти
+	или совпадают поэлементно
+
+	При частичном перекрытии элемент, записанный одной частью, может читаться другой,
+	и результат зависел бы от порядка выполнения частей.
+*/
+inline bool	IndependentOperands(const memory_layout &destination, const memory_layout &operand)
+{
+	return destination.same(operand) || !destination.overlaps(operand);
+}
+
+/*!
+	\brief Количество потоков для обработки n_elements элементов, разделенных на n_parts независимых частей
+
+	1 -- выполнять последовательно. Если частей меньше, чем потоков, на этом уровне многопоточность
+	не используется: вложенные вызовы Apply_* для частей могут разделить работу сами.
+*/
+template <class Functor>
+size_t	ThreadsCount(size_t n_parts, size_t n_elements)
+{
+	if (!Functors::is_elementwise<Functor>::value || n_elements < apply_parallel_min_elements ||
+			n_elements < ApplyParallelThreshold() || omp_in_parallel())
+	{
+		return 1;
+	}
+	size_t	n_threads = omp_get_max_threads();
+	return n_parts >= n_threads ? n_threads : 1;
+}
+
+/*!
+	\brief Вызов process_part(i) для i = 0..n_parts-1 в n_threads потоках
+
+	Части распределяются между потоками динамически (schedule guided): трудоемкость частей
+	(строк изображения, блоков и т.п.) может различаться.
+*/
+template <class F>
+void	RunParts(size_t n_parts, size_t n_threads, const F &process_part, const char *function_name)
+{
+	if (n_threads <= 1)
+	{
+		for (size_t i = 0; i < n_parts; ++i)
+			process_part(i);
+		return;
+	}
+	ThreadErrorCollector	ec(function_name);
+	#pragma omp parallel for schedule (guided) num_threads(int(n_threads))
+	for (ptrdiff_t i = 0; i < ptrdiff_t(n_parts); ++i)
+	{
+		if (ec.HasErrors())
+			continue;
+		ThreadSetup ts; (void)ts;
+		try
+		{
+			process_part(size_t(i));
+		}
+		catch (...)
+		{
+			ec.CatchException();
+		}
+	}
+	ec.ThrowIfErrors();
+}
+
+/*!
+	\brief Вызов process_range(first, last) для непрерывных отрезков, покрывающих [0, n_elements)
+
+	При последовательном выполнении -- один вызов process_range(0, n_elements).
+	independent_operands() вызывается, только если выбрано несколько потоков; false -- выполнять
+	последовательно (см. IndependentOperands).
+*/
+template <class Functor, class F, class C>
+void	ProcessRanges(size_t n_elements, const F &process_range, const char *function_name, const C &independent_operands)
+{
+	size_t	n_threads = ThreadsCount<Functor>(n_elements, n_elements);
+	if (n_threads > 1 && !independent_operands())
+		n_threads = 1;
+	if (n_threads <= 1)
+	{
+		process_range(0, n_elements);
+		return;
+	}
+	RunParts(n_threads, n_threads, [&](size_t i)
+		{
+			process_range(n_elements*i/n_threads, n_elements*(i + 1)/n_threads);
+		},
+		function_name);
+}
+
+template <class Functor, class F>
+void	ProcessRanges(size_t n_elements, const F &process_range, const char *function_name)
+{
+	ProcessRanges<Functor>(n_elements, process_range, function_name, [] { return true; });
+}
+
+/*!
+	\brief Вызов process_part(i) для n_parts независимых частей массива из n_elements элементов
+
+	independent_operands -- как в ProcessRanges.
+*/
+template <class Functor, class F, class C>
+void	ProcessParts(size_t n_parts, size_t n_elements, const F &process_part, const char *function_name, const C &independent_operands)
+{
+	size_t	n_threads = ThreadsCount<Functor>(n_parts, n_elements);
+	if (n_threads > 1 && !independent_operands())
+		n_threads = 1;
+	RunParts(n_parts, n_threads, process_part, function_name);
+}
+
+template <class Functor, class F>
+void	ProcessParts(size_t n_parts, size_t n_elements, const F &process_part, const char *function_name)
+{
+	RunParts(n_parts, ThreadsCount<Functor>(n_parts, n_elements), process_part, function_name);
+}
+
+/*!
+	\brief Количество потоков для алгоритма, не использующего Apply_*: work_size единиц работы
+	(обычно обрабатываемых отсчетов), разделенных на n_parts независимых частей
+
+	Порог тот же, что для Apply_* (ApplyParallelThreshold()); внутри параллельной области -- 1.
+*/
+inline size_t	WorkThreadsCount(size_t n_parts, size_t work_size)
+{
+	if (n_parts <= 1 || work_size < apply_parallel_min_elements || work_size < ApplyParallelThreshold() || omp_in_parallel())
+		return 1;
+	return std::min(n_parts, size_t(omp_get_max_threads()));
+}
+
+/*!
+	\brief Вызов process_part(i) для n_parts независимых частей алгоритма, не использующего Apply_*
+
+	Заменяет в алгоритмах библиотеки (передискретизация, преобразование цвета и т.п.) собственные
+	циклы omp parallel for: многопоточность включается по общему порогу (WorkThreadsCount),
+	исключения из потоков собираются ThreadErrorCollector и передаются вызывающему.
+*/
+template <class F>
+void	ProcessIndependentParts(size_t n_parts, size_t work_size, const F &process_part, const char *function_name)
+{
+	RunParts(n_parts, WorkThreadsCount(n_parts, work_size), process_part, function_name);
+}
+
+} // namespace ParallelApply
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_ParallelApply_h
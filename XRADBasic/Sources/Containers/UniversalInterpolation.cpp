@@ -206,6 +206,46 @@ void	UniversalInterpolator<FILTER>::InitFilters(int in_n_filters, const Interpol
 
 
 
+//--------------------------------------------------------------
+//
+//	Методы класса SeparableInterpolationAxis
+//
+//--------------------------------------------------------------
+
+void	SeparableInterpolationAxis::InitFilters(int in_n_divisions, const InterpolationFilterGenerator<FilterKernelReal> &generator)
+{
+	if(in_n_divisions <= 0 || generator.filter_order <= 0 || generator.filter_order > max_filter_order)
+	{
+		throw invalid_argument(ssprintf("SeparableInterpolationAxis::InitFilters, invalid parameters: %d divisions, filter order %d",
+				EnsureType<int>(in_n_divisions), EnsureType<int>(generator.filter_order)));
+	}
+	// нормировка та же, что в UniversalInterpolator::InitFilters
+	vector<double>	new_weights(size_t(in_n_divisions)*generator.filter_order);
+	FilterKernelReal	filter;
+	double	average(0);
+
+	for(int i = 0; i < in_n_divisions; ++i)
+	{
+		average += generator.GenerateFilter(filter, double(i)/in_n_divisions);
+		for(int j = 0; j < generator.filter_order; ++j)
+		{
+			new_weights[i*generator.filter_order + j] = filter[j];
+		}
+	}
+	average /= in_n_divisions;
+
+	for(auto &w: new_weights)
+	{
+		w /= average;
+	}
+	weights = std::move(new_weights);
+	n_filters = in_n_divisions;
+	filter_order = generator.filter_order;
+	generator.SetOffsetCorrection(x_offset);
+}
+
+
+
 UniversalInterpolator<FilterKernelReal> interpolators::nearest_neighbour;
 UniversalInterpolator<FilterKernelReal> interpolators::linear;
 UniversalInterpolator<FilterKernelReal> interpolators::quadratic;
@@ -271,6 +311,13 @@ interpolators::interpolators()
 	hilbert_im8.InitFilters(default_interpolation_factor, HilbertFilterGenerator(8, imag_part));
 }
 
+// Действительные генераторы используются также при инициализации разделимых многомерных
+// интерполяторов (UniversalInterpolation2D.cpp, UniversalInterpolation3D.cpp)
+template double BSplineFilterGenerator<FilterKernelReal>::GenerateFilter(FilterKernelReal &, double) const;
+template double ISplineFilterGenerator<FilterKernelReal>::GenerateFilter(FilterKernelReal &, double) const;
+template SincFilterGenerator<FilterKernelReal>::SincFilterGenerator(int);
+template double SincFilterGenerator<FilterKernelReal>::GenerateFilter(FilterKernelReal &, double) const;
+
 namespace
 {
 // Помещается здесь ради вызова конструктора, в котором будут проинициализированы
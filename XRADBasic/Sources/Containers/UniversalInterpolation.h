@@ -246,6 +246,53 @@ class UniversalInterpolator
 };
 
 
+//--------------------------------------------------------------
+
+/*!
+	\brief Таблица весов одномерного действительного интерполирующего фильтра для разделимых
+	многомерных интерполяторов (SeparableInterpolator2D, SeparableInterpolator3D)
+
+	Веса всех фильтров хранятся подряд в одном массиве.
+*/
+class	SeparableInterpolationAxis
+{
+		int	n_filters;
+		int	filter_order;
+		double	x_offset;
+		vector<double>	weights;
+
+	public:
+		//! \brief Наибольший допустимый порядок фильтра
+		static	const	int	max_filter_order = 32;
+
+		SeparableInterpolationAxis(): n_filters(0), filter_order(0), x_offset(0){}
+
+		void	InitFilters(int in_n_divisions, const InterpolationFilterGenerator<FilterKernelReal> &generator);
+
+		bool	initialized() const { return n_filters > 0; }
+		int	order() const { return filter_order; }
+		void	ApplyOffsetCorrection(double &x) const { x += x_offset; }
+
+		/*!
+			\brief Веса фильтра для точки x (к которой уже применена ApplyOffsetCorrection)
+			в данных из data_size отсчетов
+
+			\param first Индекс отсчета, соответствующего первому весу; может выходить за пределы данных.
+		*/
+		const double	*GetWeights(double x, ptrdiff_t data_size, ptrdiff_t &first) const
+		{
+			// далеко за пределами данных результат не зависит от координаты;
+			// ограничение исключает переполнение при переводе в целое
+			x = range(x, -double(filter_order), double(data_size + filter_order));
+			double	x_floor = floor(x);
+			// выбор фильтра и положение первого отсчета такие же, как у UniversalInterpolator
+			// и FIRFilterKernel::Apply
+			int	dx = range(int((x - x_floor)*n_filters), 0, n_filters-1);
+			first = ptrdiff_t(x_floor) - filter_order/2 + (filter_order%2 ? 0 : 1);
+			return weights.data() + dx*filter_order;
+		}
+};
+
 //--------------------------------------------------------------
 
 //! \brief Конктретные фильтры для непосредственного пользования
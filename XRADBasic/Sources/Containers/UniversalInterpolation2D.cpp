@@ -5,6 +5,7 @@
 */
 #include "pre.h"
 #include "UniversalInterpolation2D.h"
+#include "UniversalInterpolation3D.h"
 #include <XRADBasic/Sources/Math/SpecialFunctions.h>
 #include "InterpolationAuxiliaries.h"
 
@@ -455,6 +456,7 @@ void	UniversalInterpolator2D<FILTER>::InitFilters(int in_n_divisions_v, int in_n
 const	int	interpolators2D::default_interpolator_division = 16;
 const	int	interpolators2D::default_complex_interpolator_division = 32;
 const	int	interpolators2D::default_derivative_division = 32;
+const	int	interpolators2D::default_separable_interpolator_division = 128;
 // "Дробность" интерполяторов, равная 16, может оказаться недостаточной
 // для комплексных осциллирующих данных и для вычисления производных.
 
@@ -480,6 +482,13 @@ RealInterpolator2D interpolators2D::quasi_spline_5;
 UniversalInterpolator2D <FIRFilter2DReal>interpolators2D::bessel_ddx;
 RealInterpolator2D interpolators2D::bessel_ddy;
 
+//	Separable real filters
+
+SeparableInterpolator2D interpolators2D::separable_bilinear;
+SeparableInterpolator2D interpolators2D::separable_bicubic;
+SeparableInterpolator2D interpolators2D::separable_ibicubic;
+SeparableInterpolator2D interpolators2D::separable_sinc;
+
 //	Complex filters with carrier (are applicable to complex data only)
 
 ComplexInterpolator2D	interpolators2D::complex_biquadratic;
@@ -508,6 +517,11 @@ void	interpolators2D::Init(ProgressProxy pproxy)
 	bicubic.InitFilters(default_interpolator_division, default_interpolator_division, BSplineFilterGenerator2D<FIRFilter2DReal>(3));
 	ibicubic.InitFilters(default_interpolator_division, default_interpolator_division, ISplineFilterGenerator2D<FIRFilter2DReal>(3));
 
+	separable_bilinear.InitFilters(default_separable_interpolator_division, BSplineFilterGenerator<FilterKernelReal>(1));
+	separable_bicubic.InitFilters(default_separable_interpolator_division, BSplineFilterGenerator<FilterKernelReal>(3));
+	separable_ibicubic.InitFilters(default_separable_interpolator_division, ISplineFilterGenerator<FilterKernelReal>(3));
+	separable_sinc.InitFilters(default_separable_interpolator_division, SincFilterGenerator<FilterKernelReal>(8));
+
 	++progress;
 	bessel1_isotropic.InitFilters(default_interpolator_division, default_interpolator_division, BesselFilterGenerator<FIRFilter2DReal>(10, besselRadius_ISOTROPIC));
 	++progress;
@@ -560,6 +574,7 @@ void	interpolators2D::Init(ProgressProxy pproxy)
 void	Init2DInterpolators(ProgressProxy progress)
 {
 	interpolators2D::Init(progress);
+	interpolators3D::Init();
 }
 
 XRAD_END
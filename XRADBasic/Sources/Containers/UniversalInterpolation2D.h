@@ -9,6 +9,7 @@
 
 #include <XRADBasic/FIRFilterKernelTypes2D.h>
 #include <XRADBasic/Sources/Core/FlowControl.h>
+#include "UniversalInterpolation.h"
 
 XRAD_BEGIN
 
@@ -250,6 +251,47 @@ class	UniversalInterpolator2D
 typedef UniversalInterpolator2D<FIRFilter2DReal> RealInterpolator2D;
 typedef	UniversalInterpolator2D<FIRFilter2DComplex> ComplexInterpolator2D;
 
+//--------------------------------------------------------------
+
+/*!
+	\brief Разделимый интерполятор: двумерный фильтр есть произведение одномерных фильтров по v и по h
+
+	Вместо таблицы двумерных фильтров K×K хранятся две таблицы одномерных весов, и на одну точку
+	вычисляется K+K весов вместо K*K. Свертка выполняется сначала вдоль строк, затем по столбцу.
+	Пригоден для B-сплайнов и sinc (см. соответствующие двумерные генераторы, строящие фильтр
+	как произведение одномерных), но не для изотропных фильтров (Бессель, квазисплайн).
+
+	За пределами данных функция экстраполируется последним известным значением
+	(extrapolation::by_last_value, как у двумерных фильтров по умолчанию).
+
+	Веса действительные; применим к действительным, комплексным и цветным данным.
+*/
+class	SeparableInterpolator2D
+{
+		SeparableInterpolationAxis	axis_v, axis_h;
+
+	public:
+		//Initialization
+		void	InitFilters(int in_n_divisions_v, int in_n_divisions_h,
+				const InterpolationFilterGenerator<FilterKernelReal> &generator_v,
+				const InterpolationFilterGenerator<FilterKernelReal> &generator_h)
+		{
+			axis_v.InitFilters(in_n_divisions_v, generator_v);
+			axis_h.InitFilters(in_n_divisions_h, generator_h);
+		}
+		void	InitFilters(int in_n_divisions, const InterpolationFilterGenerator<FilterKernelReal> &generator)
+		{
+			InitFilters(in_n_divisions, in_n_divisions, generator, generator);
+		}
+
+		//Work
+		void	ApplyOffsetCorrection(double &v, double &h) const{ axis_v.ApplyOffsetCorrection(v); axis_h.ApplyOffsetCorrection(h); };
+
+		//! \brief Значение в точке (v, h), к которой уже применена ApplyOffsetCorrection()
+		template<class A2D>
+		floating64_type<typename A2D::value_type>	Apply(const A2D &data, double v, double h) const;
+};
+
 struct	interpolators2D
 {
 	//! \name Constants
@@ -289,6 +331,23 @@ struct	interpolators2D
 	static	RealInterpolator2D bessel_ddy;
 	//! @}
 
+	/*!
+		\name Separable real filters
+		При неотрицательных координатах дают тот же результат, что bilinear, bicubic, ibicubic, sinc
+		(с более мелкой дискретизацией сдвига), но значительно быстрее. Целая часть отрицательной
+		координаты берется с округлением вниз (как integral_part() в Warp2D.h), а MathFunction2D::in()
+		с неразделимыми фильтрами отбрасывает дробную часть, поэтому там результаты различаются.
+		@{
+	*/
+	//! \brief Таблицы весов разделимых фильтров малы, поэтому их дискретизация мельче
+	static	const	int	default_separable_interpolator_division;
+
+	static	SeparableInterpolator2D separable_bilinear;
+	static	SeparableInterpolator2D separable_bicubic;
+	static	SeparableInterpolator2D separable_ibicubic;
+	static	SeparableInterpolator2D separable_sinc;
+	//! @}
+
 	/*!
 		\name Complex filters with carrier.
 		Самый частый вариант в ультразвуке: по первой координате
@@ -337,6 +396,8 @@ struct	interpolators2D
 
 	При необходимости (особенно во встраиваемом коде) следует инициализировать отдельные
 	интерполяторы.
+
+	Инициализирует также трехмерные интерполяторы interpolators3D (UniversalInterpolation3D.h).
 */
 void	Init2DInterpolators(ProgressProxy progress);
 
@@ -40,6 +40,66 @@ const FILTER	*UniversalInterpolator2D<FILTER>::GetNeededFilter(double v, double
 	return &(InterpolationFilters.at(dv,dh));
 }
 
+//--------------------------------------------------------------
+
+template<class A2D>
+floating64_type<typename A2D::value_type>	SeparableInterpolator2D::Apply(const A2D &data, double v, double h) const
+{
+	typedef	typename A2D::value_type value_type;
+	typedef	floating64_type<value_type> result_type;
+
+	if(!axis_v.initialized() || !axis_h.initialized())
+	{
+		throw logic_error("SeparableInterpolator2D::Apply. Interpolator not initialized. Init2DInterpolators() has not been called?");
+	}
+	result_type	result(0);
+	make_zero(result);
+
+	const ptrdiff_t	v_size = data.vsize(), h_size = data.hsize();
+	if(!v_size || !h_size)
+		return result;
+
+	ptrdiff_t	v0, h0;
+	const double	*wv = axis_v.GetWeights(v, v_size, v0);
+	const double	*wh = axis_h.GetWeights(h, h_size, h0);
+	const int	filter_order_v = axis_v.order(), filter_order_h = axis_h.order();
+
+	const value_type	*origin = &data.at(0, 0);
+	const ptrdiff_t	v_step = data.vstep_raw(), h_step = data.hstep_raw();
+
+	if(v0 >= 0 && v0 + filter_order_v <= v_size && h0 >= 0 && h0 + filter_order_h <= h_size)
+	{
+		// внутренняя область: отсчеты берутся подряд, без проверок
+		const value_type	*row = origin + v0*v_step + h0*h_step;
+		for(int i = 0; i < filter_order_v; ++i, row += v_step)
+		{
+			result_type	row_sum(0);
+			make_zero(row_sum);
+			const value_type	*it = row;
+			for(int j = 0; j < filter_order_h; ++j, it += h_step)
+			{
+				row_sum += *it*wh[j];
+			}
+			result += row_sum*wv[i];
+		}
+	}
+	else
+	{
+		for(int i = 0; i < filter_order_v; ++i)
+		{
+			const value_type	*row = origin + range(v0 + i, ptrdiff_t(0), v_size - 1)*v_step;
+			result_type	row_sum(0);
+			make_zero(row_sum);
+			for(int j = 0; j < filter_order_h; ++j)
+			{
+				row_sum += row[range(h0 + j, ptrdiff_t(0), h_size - 1)*h_step]*wh[j];
+			}
+			result += row_sum*wv[i];
+		}
+	}
+	return result;
+}
+
 XRAD_END
 
 #endif //XRAD__File_universal_interpolation_2d_cc
@@ -0,0 +1,34 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#include "pre.h"
+#include "UniversalInterpolation3D.h"
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+//
+//	Данные класса interpolators3D
+//
+//--------------------------------------------------------------
+
+// Таблицы весов разделимых фильтров малы, поэтому дискретизация сдвига такая же мелкая,
+// как у одномерных интерполяторов
+const	int	interpolators3D::default_interpolator_division = 128;
+
+SeparableInterpolator3D interpolators3D::nearest_neighbour;
+SeparableInterpolator3D interpolators3D::trilinear;
+SeparableInterpolator3D interpolators3D::tricubic;
+SeparableInterpolator3D interpolators3D::itricubic;
+
+void	interpolators3D::Init()
+{
+	nearest_neighbour.InitFilters(default_interpolator_division, BSplineFilterGenerator<FilterKernelReal>(0));
+	trilinear.InitFilters(default_interpolator_division, BSplineFilterGenerator<FilterKernelReal>(1));
+	tricubic.InitFilters(default_interpolator_division, BSplineFilterGenerator<FilterKernelReal>(3));
+	itricubic.InitFilters(default_interpolator_division, ISplineFilterGenerator<FilterKernelReal>(3));
+}
+
+XRAD_END
@@ -0,0 +1,118 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_universal_interpolation_3d_h
+#define XRAD__File_universal_interpolation_3d_h
+/*!
+	\file
+	\brief Трехмерные интерполяторы
+
+	Трехмерный интерполирующий фильтр строится как произведение одномерных фильтров по каждой из осей
+	(см. SeparableInterpolationAxis в UniversalInterpolation.h). Индексы осей соответствуют
+	порядку индексов DataArrayMD: 0 -- номер среза (z), 1 -- строка (y), 2 -- столбец (x).
+*/
+//--------------------------------------------------------------
+
+#include "UniversalInterpolation.h"
+#include "IndexVector.h"
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Трехмерный массив, представленный указателем на отсчет (0,0,0) и шагами по осям
+
+	Не владеет данными. Создается функцией MakeVolumeView() один раз перед обработкой
+	множества точек, чтобы не вычислять адрес данных через index_vector для каждой точки.
+*/
+template<class T>
+struct	volume_view_3D
+{
+	const T	*origin = nullptr;
+	ptrdiff_t	sizes[3] = {0, 0, 0};
+	ptrdiff_t	steps[3] = {0, 0, 0};
+
+	bool	empty() const { return !sizes[0] || !sizes[1] || !sizes[2]; }
+};
+
+//! \brief Представление трехмерного DataArrayMD (или наследника) для интерполяторов
+template<class ARR>
+volume_view_3D<typename ARR::value_type>	MakeVolumeView(const ARR &volume)
+{
+	if(volume.n_dimensions() != 3)
+	{
+		throw invalid_argument(ssprintf("MakeVolumeView: 3D array expected, got %zu dimensions",
+				EnsureType<size_t>(volume.n_dimensions())));
+	}
+	volume_view_3D<typename ARR::value_type>	result;
+	for(size_t i = 0; i < 3; ++i)
+	{
+		result.sizes[i] = volume.sizes(i);
+		result.steps[i] = volume.steps_raw(i);
+	}
+	if(!result.empty())
+		result.origin = &volume.at(index_vector{0, 0, 0});
+	return result;
+}
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Разделимый трехмерный интерполятор с действительными весами
+
+	За пределами данных функция экстраполируется последним известным значением.
+	Применим к действительным, комплексным и цветным данным.
+*/
+class	SeparableInterpolator3D
+{
+		SeparableInterpolationAxis	axes[3];
+
+	public:
+		//Initialization
+		void	InitFilters(int in_n_divisions, const InterpolationFilterGenerator<FilterKernelReal> &generator)
+		{
+			for(auto &axis: axes)
+				axis.InitFilters(in_n_divisions, generator);
+		}
+
+		//Work
+		void	ApplyOffsetCorrection(double &c0, double &c1, double &c2) const
+		{
+			axes[0].ApplyOffsetCorrection(c0);
+			axes[1].ApplyOffsetCorrection(c1);
+			axes[2].ApplyOffsetCorrection(c2);
+		}
+
+		//! \brief Значение в точке (c0, c1, c2), к которой уже применена ApplyOffsetCorrection()
+		template<class T>
+		floating64_type<T>	Apply(const volume_view_3D<T> &data, double c0, double c1, double c2) const;
+};
+
+//--------------------------------------------------------------
+
+struct	interpolators3D
+{
+	static	const	int	default_interpolator_division;
+
+	static	SeparableInterpolator3D nearest_neighbour;
+	static	SeparableInterpolator3D trilinear;
+	//! \brief Кубический B-сплайн (сглаживающий, как interpolators2D::bicubic)
+	static	SeparableInterpolator3D tricubic;
+	//! \brief Интерполирующий кубический сплайн (как interpolators2D::ibicubic)
+	static	SeparableInterpolator3D itricubic;
+
+	//! \brief Инициализация. Вызывается из Init2DInterpolators()
+	static	void	Init();
+};
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#include "UniversalInterpolation3D.hh"
+
+//--------------------------------------------------------------
+#endif // XRAD__File_universal_interpolation_3d_h
@@ -0,0 +1,64 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_universal_interpolation_3d_hh
+#define XRAD__File_universal_interpolation_3d_hh
+
+XRAD_BEGIN
+
+template<class T>
+floating64_type<T>	SeparableInterpolator3D::Apply(const volume_view_3D<T> &data, double c0, double c1, double c2) const
+{
+	typedef	floating64_type<T> result_type;
+
+	if(!axes[0].initialized() || !axes[1].initialized() || !axes[2].initialized())
+	{
+		throw logic_error("SeparableInterpolator3D::Apply. Interpolator not initialized. Init2DInterpolators() has not been called?");
+	}
+	result_type	result(0);
+	make_zero(result);
+	if(data.empty())
+		return result;
+
+	// смещения отсчетов по каждой оси; на краях индексы ограничиваются (экстраполяция последним значением)
+	const double	*weights[3];
+	ptrdiff_t	offsets[3][SeparableInterpolationAxis::max_filter_order];
+	const double	c[3] = {c0, c1, c2};
+	for(int axis = 0; axis < 3; ++axis)
+	{
+		ptrdiff_t	first;
+		weights[axis] = axes[axis].GetWeights(c[axis], data.sizes[axis], first);
+		const ptrdiff_t	last_index = data.sizes[axis] - 1;
+		for(int i = 0; i < axes[axis].order(); ++i)
+		{
+			offsets[axis][i] = range(first + i, ptrdiff_t(0), last_index)*data.steps[axis];
+		}
+	}
+
+	const int	order0 = axes[0].order(), order1 = axes[1].order(), order2 = axes[2].order();
+	for(int i = 0; i < order0; ++i)
+	{
+		result_type	plane_sum(0);
+		make_zero(plane_sum);
+		const T	*plane = data.origin + offsets[0][i];
+		for(int j = 0; j < order1; ++j)
+		{
+			result_type	row_sum(0);
+			make_zero(row_sum);
+			const T	*row = plane + offsets[1][j];
+			for(int k = 0; k < order2; ++k)
+			{
+				row_sum += row[offsets[2][k]]*weights[2][k];
+			}
+			plane_sum += row_sum*weights[1][j];
+		}
+		result += plane_sum*weights[0][i];
+	}
+	return result;
+}
+
+XRAD_END
+
+#endif // XRAD__File_universal_interpolation_3d_hh
@@ -15,6 +15,8 @@
 #include <XRADBasic/Sources/Containers/DataArray.h>
 #include <XRADBasic/Sources/Containers/DataArray2D.h>
 #include <XRADBasic/Sources/Containers/DataArrayMD.h>
+#include <algorithm>
+#include <cstring>
 
 XRAD_BEGIN
 
@@ -39,46 +39,277 @@ inline	size_t read_data_text(store_iter data, size_t count, FILE *file)
 	return read_count;
 }
 
-//	чтение двоичных данных из файла через буфер
+//--------------------------------------------------------------
+//
+//	двоичный ввод/вывод
+//
+//	- если тип в файле совпадает с типом в памяти, а данные массива непрерывны,
+//	данные читаются прямо в массив (и пишутся прямо из массива), при необходимости
+//	порядок байтов меняется на месте;
+//	- в остальных случаях преобразование выполняется частями через буфер
+//	ограниченного размера (io_buffer_bytes), а не через буфер на весь массив.
+//
+//--------------------------------------------------------------
+
+//! \brief Размер буфера для преобразования данных при вводе/выводе
+constexpr size_t	io_buffer_bytes = size_t(1) << 16;
+
+//! \brief Признак скалярного двоичного формата: io_type_builtin<T> или io_type_reverse<T>
+template<class io_t>
+struct io_scalar_format
+{
+	static constexpr bool scalar = false;
+	static constexpr bool reverse = false;
+};
+
+template<class T>
+struct io_scalar_format<io_type_builtin<T>>
+{
+	static constexpr bool scalar = true;
+	static constexpr bool reverse = false;
+};
+
+template<class T>
+struct io_scalar_format<io_type_reverse<T>>
+{
+	static constexpr bool scalar = true;
+	static constexpr bool reverse = true;
+};
+
+template<class U>
+inline U	byte_swap(U x);
+
+template<>
+inline uint16_t	byte_swap(uint16_t x)
+{
+	return uint16_t((x >> 8) | (x << 8));
+}
+
+template<>
+inline uint32_t	byte_swap(uint32_t x)
+{
+	return ((x >> 24) & 0xFF) | ((x >> 8) & 0xFF00) | ((x << 8) & 0xFF0000) | (x << 24);
+}
+
+template<>
+inline uint64_t	byte_swap(uint64_t x)
+{
+	return (uint64_t(byte_swap(uint32_t(x))) << 32) | byte_swap(uint32_t(x >> 32));
+}
+
+/*!
+	\brief Изменение порядка байтов count значений размером sizeof(U) на месте
+
+	Цикл без ветвлений, с доступом через memcpy (без нарушения strict aliasing),
+	компилятор векторизует его.
+*/
+template<class U>
+void	swap_bytes_kernel(uint8_t *bytes, size_t count)
+{
+	for(size_t i = 0; i < count; ++i, bytes += sizeof(U))
+	{
+		U	x;
+		memcpy(&x, bytes, sizeof(U));
+		x = byte_swap(x);
+		memcpy(bytes, &x, sizeof(U));
+	}
+}
+
+//! \brief Изменение порядка байтов count значений типа T на месте
+template<class T>
+void	swap_bytes(void *data, size_t count)
+{
+	uint8_t	*bytes = static_cast<uint8_t*>(data);
+	if constexpr(sizeof(T) == 2)
+		swap_bytes_kernel<uint16_t>(bytes, count);
+	else if constexpr(sizeof(T) == 4)
+		swap_bytes_kernel<uint32_t>(bytes, count);
+	else if constexpr(sizeof(T) == 8)
+		swap_bytes_kernel<uint64_t>(bytes, count);
+	else if constexpr(sizeof(T) > 1)
+	{
+		for(size_t i = 0; i < count; ++i, bytes += sizeof(T))
+			std::reverse(bytes, bytes + sizeof(T));
+	}
+}
+
+//! \brief Итераторы с постоянным шагом: указатели и итераторы контейнеров XRAD
+template<class iter>
+struct uniform_step_iterator : std::false_type {};
+
+template<class T>
+struct uniform_step_iterator<T*> : std::true_type {};
+
+template<class T, class CH>
+struct uniform_step_iterator<step_iterator<T, CH>> : std::true_type {};
+
+/*!
+	\brief Указатель на данные, если count элементов, задаваемых итератором, следуют в памяти подряд
+	и имеют тип T; иначе nullptr
+*/
+template<class T, class iter>
+auto	contiguous_data(iter data, size_t count)
+{
+	typedef std::remove_reference_t<typename iterator_traits<iter>::reference> element_t;
+	element_t	*result = nullptr;
+	if constexpr(uniform_step_iterator<iter>::value && is_same<std::remove_cv_t<element_t>, T>::value)
+	{
+		if(count)
+		{
+			element_t	*first = std::addressof(*data);
+			if(count == 1 || std::addressof(data[1]) == first + 1)
+				result = first;
+		}
+	}
+	return result;
+}
+
+//! \brief Преобразование count значений формата read_t из буфера в массив
 template<class read_t, class store_iter>
-size_t read_data(store_iter data, size_t count, FILE *file)
+store_iter	convert_from_buffer(store_iter data, const uint8_t *buffer, size_t count)
 {
-	DataArray<uint8_t> buffer(count*read_t::fsize());
+	typedef typename iterator_traits<store_iter>::value_type store_t;
+	if constexpr(io_scalar_format<read_t>::scalar)
+	{
+		// порядок байтов в буфере уже исправлен
+		typedef typename read_t::value_type file_t;
+		for(size_t i = 0; i < count; ++i, ++data, buffer += sizeof(file_t))
+		{
+			file_t	x;
+			memcpy(&x, buffer, sizeof(file_t));
+			*data = store_t(x);
+		}
+	}
+	else
+	{
+		for(size_t i = 0; i < count; ++i, ++data, buffer += read_t::fsize())
+			*data = store_t(read_t::get(buffer));
+	}
+	return data;
+}
 
-	size_t	read_count = fread(&buffer[0], read_t::fsize(), count, file);
+//! \brief Преобразование count значений из массива в буфер в формате write_t
+template<class write_t, class const_store_iter>
+const_store_iter	convert_to_buffer(uint8_t *buffer, const_store_iter data, size_t count)
+{
+	if constexpr(io_scalar_format<write_t>::scalar)
+	{
+		typedef typename write_t::value_type file_t;
+		uint8_t	*position = buffer;
+		for(size_t i = 0; i < count; ++i, ++data, position += sizeof(file_t))
+		{
+			file_t	x = file_t(*data);
+			memcpy(position, &x, sizeof(file_t));
+		}
+		if(io_scalar_format<write_t>::reverse)
+			swap_bytes<file_t>(buffer, count);
+	}
+	else
+	{
+		for(size_t i = 0; i < count; ++i, ++data, buffer += write_t::fsize())
+			write_t::put(buffer, typename write_t::value_type(*data));
+	}
+	return data;
+}
 
-	for(size_t i = 0; i < read_count; ++i, ++data)
+//	чтение двоичных данных из файла частями через буфер
+template<class read_t, class store_iter>
+size_t read_data_buffered(store_iter data, size_t count, FILE *file)
+{
+	typedef typename iterator_traits<store_iter>::value_type store_t;
+	size_t	chunk_size = max(size_t(1), io_buffer_bytes/read_t::fsize());
+	DataArray<uint8_t> buffer(min(count, chunk_size)*read_t::fsize());
+	size_t	read_count = 0;
+
+	while(read_count < count)
 	{
-//		*data = store_iter::value_type(read_t::get(&buffer[i*read_t::fsize()]));
-		*data = typename iterator_traits<store_iter>::value_type(read_t::get(&buffer[i*read_t::fsize()]));
+		size_t	n = min(count - read_count, chunk_size);
+		size_t	chunk_read_count = fread(&buffer[0], read_t::fsize(), n, file);
+		if constexpr(io_scalar_format<read_t>::reverse)
+			swap_bytes<typename read_t::value_type>(&buffer[0], chunk_read_count);
+		data = convert_from_buffer<read_t>(data, &buffer[0], chunk_read_count);
+		read_count += chunk_read_count;
+		if(chunk_read_count < n)
+			break;
 	}
 	for(size_t i = read_count; i < count; ++i, ++data)
 	{
-//		*data = store_iter::value_type(0);
-		*data = typename iterator_traits<store_iter>::value_type(0);
+		*data = store_t(0);
 	}
 
 	return read_count;
 }
 
+//	чтение двоичных данных из файла
+template<class read_t, class store_iter>
+size_t read_data(store_iter data, size_t count, FILE *file)
+{
+	typedef typename iterator_traits<store_iter>::value_type store_t;
+	if(!count)
+		return 0;
+
+	if constexpr(io_scalar_format<read_t>::scalar)
+	{
+		// чтение прямо в массив
+		typedef typename read_t::value_type file_t;
+		if(auto destination = contiguous_data<file_t>(data, count))
+		{
+			size_t	read_count = fread(destination, sizeof(file_t), count, file);
+			if(io_scalar_format<read_t>::reverse)
+				swap_bytes<file_t>(destination, read_count);
+			std::fill(destination + read_count, destination + count, file_t(0));
+			return read_count;
+		}
+	}
+	// для непрерывных данных преобразование через указатель, а не через итератор с шагом
+	if(auto destination = contiguous_data<store_t>(data, count))
+		return read_data_buffered<read_t>(destination, count, file);
+	return read_data_buffered<read_t>(data, count, file);
+}
+
 
 //--------------------------------------------------------------
 
-//	запись через буфер
+//	запись двоичных данных в файл частями через буфер
 template<class write_t, class const_store_iter>
-size_t write_data(const_store_iter data, size_t count, FILE *file)
+size_t write_data_buffered(const_store_iter data, size_t count, FILE *file)
 {
-	DataArray<uint8_t> buffer(count*write_t::fsize());
+	size_t	chunk_size = max(size_t(1), io_buffer_bytes/write_t::fsize());
+	DataArray<uint8_t> buffer(min(count, chunk_size)*write_t::fsize());
+	size_t	write_count = 0;
 
-	for(size_t i = 0; i < count; ++i, ++data)
+	while(write_count < count)
 	{
-		write_t::put(&buffer[i*write_t::fsize()], typename write_t::value_type(*data));
+		size_t	n = min(count - write_count, chunk_size);
+		data = convert_to_buffer<write_t>(&buffer[0], data, n);
+		size_t	chunk_write_count = fwrite(&buffer[0], write_t::fsize(), n, file);
+		write_count += chunk_write_count;
+		if(chunk_write_count < n)
+			break;
 	}
-
-	size_t	write_count = fwrite(&buffer[0], write_t::fsize(), count, file);
 	return write_count;
 }
 
+//	запись двоичных данных в файл
+template<class write_t, class const_store_iter>
+size_t write_data(const_store_iter data, size_t count, FILE *file)
+{
+	typedef typename iterator_traits<const_store_iter>::value_type store_t;
+	if(!count)
+		return 0;
+
+	if constexpr(io_scalar_format<write_t>::scalar && !io_scalar_format<write_t>::reverse)
+	{
+		// запись прямо из массива
+		typedef typename write_t::value_type file_t;
+		if(auto source = contiguous_data<file_t>(data, count))
+			return fwrite(source, sizeof(file_t), count, file);
+	}
+	if(auto source = contiguous_data<std::remove_cv_t<store_t>>(data, count))
+		return write_data_buffered<write_t>(source, count, file);
+	return write_data_buffered<write_t>(data, count, file);
+}
+
 //	запись текстовых данных прямо в файл
 template<class write_t, class const_store_iter>
 inline	size_t write_data_text(const_store_iter data, size_t count, FILE *file)
@@ -0,0 +1,115 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#include "pre.h"
+#include "ColorConversion.h"
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+using namespace ColorConversionAuxiliaries;
+
+namespace
+{
+
+void	RGBToLAB(planar_colors &colors, size_t n)
+{
+	RGBToXYZ(colors, n);
+	XYZToLAB(colors, n);
+}
+
+} // namespace
+
+//--------------------------------------------------------------
+
+void	ColorLUT3D::InitRGBToXYZ(size_t n_nodes)
+{
+	Init(n_nodes, RGBToXYZ);
+}
+
+void	ColorLUT3D::InitRGBToLAB(size_t n_nodes)
+{
+	Init(n_nodes, RGBToLAB);
+}
+
+void	ColorLUT3D::Init(size_t n_nodes, void (*convert)(planar_colors &, size_t))
+{
+	if(n_nodes < 2 || n_nodes > chunk_size)
+	{
+		throw invalid_argument(ssprintf("ColorLUT3D::Init: invalid number of nodes %zu (2..%zu expected)",
+				EnsureType<size_t>(n_nodes), EnsureType<size_t>(chunk_size)));
+	}
+	m_n_nodes = 0;
+	m_table.resize(3*n_nodes*n_nodes*n_nodes);
+	const float	step = 255.f/float(n_nodes - 1);
+
+	// одна строка узлов (r, g, все b) -- один блок planar_colors
+	planar_colors	colors;
+	float	*table = m_table.data();
+	for(size_t r = 0; r < n_nodes; ++r)
+	{
+		for(size_t g = 0; g < n_nodes; ++g)
+		{
+			for(size_t b = 0; b < n_nodes; ++b)
+			{
+				colors.c0[b] = r*step;
+				colors.c1[b] = g*step;
+				colors.c2[b] = b*step;
+			}
+			convert(colors, n_nodes);
+			for(size_t b = 0; b < n_nodes; ++b, table += 3)
+			{
+				table[0] = colors.c0[b];
+				table[1] = colors.c1[b];
+				table[2] = colors.c2[b];
+			}
+		}
+	}
+	m_scale = float(n_nodes - 1)/255.f;
+	m_n_nodes = n_nodes;
+}
+
+void	ColorLUT3D::Interpolate(planar_colors &colors, size_t n) const
+{
+	const ptrdiff_t	last_cell = ptrdiff_t(m_n_nodes) - 2;
+	const ptrdiff_t	step_b = 3;
+	const ptrdiff_t	step_g = 3*m_n_nodes;
+	const ptrdiff_t	step_r = 3*m_n_nodes*m_n_nodes;
+	const float	*table = m_table.data();
+
+	for(size_t i = 0; i < n; ++i)
+	{
+		float	x[3] = {colors.c0[i], colors.c1[i], colors.c2[i]};
+		ptrdiff_t	cell[3];
+		float	t[3];
+		for(size_t k = 0; k < 3; ++k)
+		{
+			float	v = range(x[k], 0.f, 255.f)*m_scale;
+			cell[k] = min(ptrdiff_t(v), last_cell);
+			t[k] = v - float(cell[k]);
+		}
+		const float	*p = table + cell[0]*step_r + cell[1]*step_g + cell[2]*step_b;
+		float	result[3];
+		for(size_t c = 0; c < 3; ++c)
+		{
+			const float	*q = p + c;
+			float	v00 = q[0] + t[2]*(q[step_b] - q[0]);
+			float	v01 = q[step_g] + t[2]*(q[step_g + step_b] - q[step_g]);
+			float	v10 = q[step_r] + t[2]*(q[step_r + step_b] - q[step_r]);
+			float	v11 = q[step_r + step_g] + t[2]*(q[step_r + step_g + step_b] - q[step_r + step_g]);
+			float	v0 = v00 + t[1]*(v01 - v00);
+			float	v1 = v10 + t[1]*(v11 - v10);
+			result[c] = v0 + t[0]*(v1 - v0);
+		}
+		colors.c0[i] = result[0];
+		colors.c1[i] = result[1];
+		colors.c2[i] = result[2];
+	}
+}
+
+//--------------------------------------------------------------
+
+XRAD_END
@@ -155,6 +155,8 @@ struct RGBColorSample : public RGB_TRAITS_T, public LinearVectorFixedDimensions<
 		template<class RGB2>
 		RGBColorSample(const RGBColorSample<RGB2> &sample){zero_alpha<n_pixel_components>(); red() = sample.red(), green() = sample.green(), blue() = sample.blue();}
 		RGBColorSample(const parent &sample) : parent(sample) {}
+		// при объявленном ниже operator = (const self &) неявный конструктор копирования устарел (-Wdeprecated-copy)
+		RGBColorSample(const self &) = default;
 
 		template<class RGB2>
 		self	&operator = (const RGBColorSample<RGB2> &sample){zero_alpha<n_pixel_components>(); red()=sample.red(); green()=sample.green(); blue()=sample.blue(); return *this;}
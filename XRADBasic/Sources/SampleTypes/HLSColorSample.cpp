@@ -6,6 +6,7 @@
 #include "pre.h"
 #include "HLSColorSample.h"
 #include "LABColorSample.h"
+#include "ColorConversion.h"
 
 XRAD_BEGIN
 
@@ -182,6 +183,72 @@ void	HLSColorSample::FromRGB(float r, float g, float b)
 }
 
 
+//--------------------------------------------------------------
+//
+//	преобразование блоков отсчетов (ColorConversion.h): то же, что FromRGB и ToRGB.
+//	для серых отсчетов (r == g == b) тон равен 0 (FromRGB в этом случае делит 0 на 0).
+//	выбор ветви заменен умножением на 0 или 1 (условные выражения компилятор
+//	превращает в ветвления, и цикл не векторизуется)
+//
+
+namespace ColorConversionAuxiliaries
+{
+
+void	RGBToHLS(planar_colors &colors, size_t n)
+{
+	const	float	p3 = float(pi()/3);
+	for(size_t i = 0; i < n; ++i)
+	{
+		float	r = colors.c0[i], g = colors.c1[i], b = colors.c2[i];
+		float	max_color = max(max(r, g), b);
+		float	delta = max_color - min(min(r, g), b);
+
+		int32_t	red_min = (r < g) & (r < b);
+		int32_t	green_min = (1 - red_min) & (g < b);
+		int32_t	blue_min = 1 - red_min - green_min;
+		int32_t	chromatic = delta > 0;
+		float	difference = float(red_min)*(b - g) + float(green_min)*(r - b) + float(blue_min)*(g - r);
+		float	base = p3*float(2*green_min + 4*blue_min*chromatic);
+
+		colors.c0[i] = base + p3*difference/max(delta, 1e-30f);
+		colors.c1[i] = max_color;
+		colors.c2[i] = delta/max(max_color, 1e-30f);
+	}
+}
+
+void	HLSToRGB(planar_colors &colors, size_t n)
+{
+	const	float	p3 = float(pi()/3);
+	const	float	period = float(two_pi());
+	for(size_t i = 0; i < n; ++i)
+	{
+		float	H = colors.c0[i], L = colors.c1[i], S = colors.c2[i];
+		float	turns = H/period;
+		int32_t	n_turns = int32_t(turns) - (turns < 0 ? 1 : 0);
+		float	x = (H - n_turns*period)/p3;
+		int32_t	segment = int32_t(x);
+		segment = segment < 0 ? 0 : (segment > 5 ? 5 : segment);
+
+		float	min_color = L*(1 - S);
+		float	delta_color = L*S;
+		float	increase = delta_color*(x - segment);
+		float	decrease = delta_color - increase;
+		float	w0 = float(segment == 0), w1 = float(segment == 1), w2 = float(segment == 2);
+		float	w3 = float(segment == 3), w4 = float(segment == 4), w5 = float(segment == 5);
+
+		float	r = (w2 + w3)*delta_color + w1*increase + w4*decrease;
+		float	g = (w4 + w5)*delta_color + w3*increase + w0*decrease;
+		float	b = (w0 + w1)*delta_color + w5*increase + w2*decrease;
+
+		colors.c0[i] = range(r + min_color, 0.f, 255.f);
+		colors.c1[i] = range(g + min_color, 0.f, 255.f);
+		colors.c2[i] = range(b + min_color, 0.f, 255.f);
+	}
+}
+
+} // namespace ColorConversionAuxiliaries
+
+
 #else
 //Munsell model
 
@@ -5,6 +5,8 @@
 */
 #include "pre.h"
 #include "LABColorSample.h"
+#include "ColorConversion.h"
+#include <cstring>
 
 XRAD_BEGIN
 
@@ -168,4 +170,192 @@ LABColorSample &LABColorSample :: operator=(const ColorSampleF64 &s)
 
 
 
+//--------------------------------------------------------------
+//
+//	преобразование блоков отсчетов (ColorConversion.h)
+//
+//--------------------------------------------------------------
+
+namespace ColorConversionAuxiliaries
+{
+
+namespace
+{
+
+// аппроксимации без ветвлений и вызовов функций, чтобы циклы по отсчетам векторизовались
+
+//! \brief log2(x) для x > 0, абсолютная погрешность около 2e-7
+inline float	fast_log2(float x)
+{
+	uint32_t	bits;
+	memcpy(&bits, &x, sizeof(bits));
+	float	exponent = float(int32_t((bits >> 23) & 0xff) - 127);
+	bits = (bits & 0x007fffff) | 0x3f800000;
+	float	m;
+	memcpy(&m, &bits, sizeof(m));
+	// m in [1, 2): log2(m) = 2/ln(2) * atanh(t), t = (m-1)/(m+1) in [0, 1/3)
+	float	t = (m - 1)/(m + 1);
+	float	t2 = t*t;
+	float	atanh_t = t*(1 + t2*(1.f/3 + t2*(1.f/5 + t2*(1.f/7 + t2*(1.f/9 + t2*(1.f/11))))));
+	return exponent + 2.88539008f*atanh_t;
+}
+
+//! \brief 2^y для |y| < 1000, y < 128; относительная погрешность около 2e-7, при y < -126 результат около 1e-38
+inline float	fast_exp2(float y)
+{
+	int32_t	i = int32_t(y) - (y < 0 ? 1 : 0);
+	// f in [0, 1]; 2^f = sqrt(2)*e^(d*ln(2)), |d| <= 1/2
+	float	z = (y - float(i) - 0.5f)*0.693147181f;
+	// ограничивается показатель, а не y: ограниченное y компилятор подставляет как константу,
+	// и вычисление перестает быть линейным
+	i = i < -126 ? -126 : i;
+	float	p = 1 + z*(1 + z*(1.f/2 + z*(1.f/6 + z*(1.f/24 + z*(1.f/120 + z*(1.f/720))))));
+	uint32_t	bits = uint32_t(i + 127) << 23;
+	float	scale;
+	memcpy(&scale, &bits, sizeof(scale));
+	return 1.41421356f*p*scale;
+}
+
+inline float	fast_pow(float x, float p)
+{
+	return fast_exp2(p*fast_log2(x));
+}
+
+/*!
+	\brief condition ? if_true : if_false без ветвления, condition -- 0 или 1
+
+	Условное выражение компилятор (без -ffast-math) превращает в ветвление,
+	внося в него вычисление нужной только одной ветви величины, и цикл не векторизуется.
+	Параметр типа bool также мешает векторизации, поэтому condition имеет тип float.
+*/
+inline float	blend(float condition, float if_true, float if_false)
+{
+	return if_false + condition*(if_true - if_false);
+}
+
+//! \brief Обращение гамма-коррекции sRGB, v = 0..1
+inline float	srgb_to_linear(float v)
+{
+	float	power = fast_pow((v + 0.055f)/1.055f, 2.4f);
+	return blend(v > 0.04045f, power, v/12.92f);
+}
+
+inline float	linear_to_srgb(float v)
+{
+	float	power = 1.055f*fast_pow(v, 1.f/2.4f) - 0.055f;
+	return blend(v > 0.0031308f, power, 12.92f*v);
+}
+
+inline float	clamp_255(float v)
+{
+	return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+} // namespace
+
+void	RGBToXYZ(planar_colors &colors, size_t n)
+{
+	for(size_t i = 0; i < n; ++i)
+	{
+		float	r = 100*srgb_to_linear(colors.c0[i]/255);
+		float	g = 100*srgb_to_linear(colors.c1[i]/255);
+		float	b = 100*srgb_to_linear(colors.c2[i]/255);
+		colors.c0[i] = r*0.4124f + g*0.3576f + b*0.1805f;
+		colors.c1[i] = r*0.2126f + g*0.7152f + b*0.0722f;
+		colors.c2[i] = r*0.0193f + g*0.1192f + b*0.9505f;
+	}
+}
+
+void	XYZToRGB(planar_colors &colors, size_t n)
+{
+	for(size_t i = 0; i < n; ++i)
+	{
+		float	x = colors.c0[i]/100;
+		float	y = colors.c1[i]/100;
+		float	z = colors.c2[i]/100;
+		colors.c0[i] = clamp_255(255*linear_to_srgb(x* 3.2406f + y*-1.5372f + z*-0.4986f));
+		colors.c1[i] = clamp_255(255*linear_to_srgb(x*-0.9689f + y* 1.8758f + z* 0.0415f));
+		colors.c2[i] = clamp_255(255*linear_to_srgb(x* 0.0557f + y*-0.2040f + z* 1.0570f));
+	}
+}
+
+#ifdef CIE_LAB
+
+namespace
+{
+
+inline float	lab_f(float v)
+{
+	float	root = fast_pow(v, 1.f/3);
+	return blend(v > 0.008856f, root, 7.787f*v + 16.f/116);
+}
+
+inline float	lab_f_inverse(float v)
+{
+	float	cube = v*v*v;
+	return blend(cube > 0.008856f, cube, (v - 16.f/116)/7.787f);
+}
+
+} // namespace
+
+void	XYZToLAB(planar_colors &colors, size_t n)
+{
+	for(size_t i = 0; i < n; ++i)
+	{
+		float	x = lab_f(colors.c0[i]/float(ref_X));
+		float	y = lab_f(colors.c1[i]/float(ref_Y));
+		float	z = lab_f(colors.c2[i]/float(ref_Z));
+		colors.c0[i] = 116*y - 16;
+		colors.c1[i] = 500*(x - y);
+		colors.c2[i] = 200*(y - z);
+	}
+}
+
+void	LABToXYZ(planar_colors &colors, size_t n)
+{
+	for(size_t i = 0; i < n; ++i)
+	{
+		float	y = (colors.c0[i] + 16)/116;
+		float	x = colors.c1[i]/500 + y;
+		float	z = y - colors.c2[i]/200;
+		colors.c0[i] = float(ref_X)*lab_f_inverse(x);
+		colors.c1[i] = float(ref_Y)*lab_f_inverse(y);
+		colors.c2[i] = float(ref_Z)*lab_f_inverse(z);
+	}
+}
+
+#else	//Hunter Lab
+
+void	XYZToLAB(planar_colors &colors, size_t n)
+{
+	for(size_t i = 0; i < n; ++i)
+	{
+		float	x = colors.c0[i], y = colors.c1[i], z = colors.c2[i];
+		// sqrt проверяет аргумент (errno) и не векторизуется.
+		// для черного (y = 0) результат равен 0, а не NaN, как у LABColorSample
+		float	sqrt_y = fast_pow(y, 0.5f);
+		colors.c0[i] = 10*sqrt_y;
+		colors.c1[i] = 17.5f*((1.02f*x - y)/sqrt_y);
+		colors.c2[i] = 7*((y - 0.847f*z)/sqrt_y);
+	}
+}
+
+void	LABToXYZ(planar_colors &colors, size_t n)
+{
+	for(size_t i = 0; i < n; ++i)
+	{
+		float	var_Y = colors.c0[i]/10;
+		float	var_X = (colors.c1[i]/17.5f)*var_Y;
+		float	var_Z = (colors.c2[i]/7)*var_Y;
+		float	y = var_Y*var_Y;
+		colors.c0[i] = (var_X + y)/1.02f;
+		colors.c1[i] = y;
+		colors.c2[i] = -(var_Z - y)/0.847f;
+	}
+}
+
+#endif //CIE_LAB
+
+} // namespace ColorConversionAuxiliaries
+
 XRAD_END
@@ -14,10 +14,44 @@
 
 #include "DistributionContainer.h"
 #include <XRADBasic/Sources/Containers/UniversalInterpolation.h>
+#include <XRADBasic/Sources/Containers/BasicArrayInteractions1D.h>
 
 
 XRAD_BEGIN
 
+//! \brief Кусочно-линейная функция, заданная таблицей с равномерным шагом.
+//! За пределами таблицы продолжается крайними значениями (как extrapolation::by_last_value).
+//!
+//! Объект только ссылается на данные таблицы и должен уничтожаться раньше нее.
+//! Не содержит виртуальных вызовов и предназначен для использования в плотных циклах.
+class	LinearTableLookup
+	{
+		const double	*m_table;
+		size_t	m_last;
+		double	m_x0, m_scale;
+
+	public:
+		//! \brief Значение table[i] соответствует аргументу x0 + i/scale. Пустая таблица -- исключение
+		LinearTableLookup(const RealFunctionF64 &table, double x0, double scale):
+				m_x0(x0), m_scale(scale)
+			{
+			if(table.empty())
+				throw invalid_argument("LinearTableLookup: empty table");
+			m_table = table.data();
+			m_last = table.size() - 1;
+			}
+
+		double	operator()(double x) const
+			{
+			if(!m_last)
+				return m_table[0];
+			double	position = range((x - m_x0)*m_scale, 0., double(m_last));
+			size_t	i = min(size_t(position), m_last - 1);
+			double	t = position - double(i);
+			return m_table[i] + t*(m_table[i+1] - m_table[i]);
+			}
+	};
+
 class	DistributionTransformer : public TableDistributionContainer
 	{
 		void	GenerateTransformFunction();
@@ -33,17 +67,46 @@ class	DistributionTransformer : public TableDistributionContainer
 
 		const RealFunctionF64 &transform_table(){return m_transform_table;}
 
+		//! \brief Функция распределения (преобразование в равномерное на [0,1])
+		LinearTableLookup	ToUniformLookup() const {return LinearTableLookup(cdf_table(), x0(), 1./dx());}
+		//! \brief Обратная функция распределения (преобразование из равномерного на [0,1])
+		LinearTableLookup	FromUniformLookup() const {return LinearTableLookup(m_transform_table, 0, x_factor);}
+
 		double	ToUniform(double x) const
 			{
 			// из заданного таблицей преобразует в равномерное на [0,1]
-//			return cdf_table().in((x-x0())/dx(), &interpolators::linear)
-			return cdf(x);
+			return ToUniformLookup()(x);
 			}
 
 		double	FromUniform(double x) const
 			{
 			// из равномерного на [0,1] преобразует в распределение, заданное таблицей
-			return m_transform_table.in(x*x_factor, &interpolators::linear);
+			return FromUniformLookup()(x);
+			}
+
+		//! \brief Поэлементное преобразование массива в равномерное на [0,1] распределение.
+		//! Размер result устанавливается равным размеру x, допускается &result == &x
+		template<class T1, class T2>
+		void	ToUniform(const DataArray<T1> &x, DataArray<T2> &result) const
+			{
+			TransformArray(x, result, ToUniformLookup());
+			}
+
+		//! \brief Поэлементное преобразование равномерного на [0,1] распределения в заданное таблицей.
+		//! Размер result устанавливается равным размеру uniform, допускается &result == &uniform
+		template<class T1, class T2>
+		void	FromUniform(const DataArray<T1> &uniform, DataArray<T2> &result) const
+			{
+			TransformArray(uniform, result, FromUniformLookup());
+			}
+
+	private:
+		template<class T1, class T2>
+		static	void	TransformArray(const DataArray<T1> &x, DataArray<T2> &result, const LinearTableLookup &lookup)
+			{
+			if(result.size() != x.size())
+				result.realloc(x.size());
+			Apply_AA_1D_F2(result, x, Functors::elementwise([lookup](T2 &y, const T1 &v){ y = T2(lookup(v)); }));
 			}
 	};
 
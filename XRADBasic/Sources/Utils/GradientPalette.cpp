@@ -72,7 +72,7 @@ void	GradientPalette::MoveColor(size_t color_no, double new_color_position)
 }
 
 
-ColorSampleF64 GradientPalette :: operator()(double color_position)
+ColorSampleF64 GradientPalette :: operator()(double color_position) const
 {
 	ColorSampleF64	result(0, 0, 0);
 	if(!colors.size()) return result;
@@ -85,11 +85,11 @@ ColorSampleF64 GradientPalette :: operator()(double color_position)
 		return colors[colors.size()-1].second;
 	}
 
-	size_t	n1 = 0;
-	size_t	n2 = colors.size()-1;
-
-	while(color_position > colors[n1].first && n1 < colors.size()-1) ++n1;
-	while(color_position < colors[n2].first && n2 > 0) --n2;
+	// n1 -- первый цвет с положением >= color_position, n2 -- последний с положением <= color_position
+	auto	compare_position = [](const base_color_t &c, double position){ return c.first < position; };
+	size_t	n1 = lower_bound(colors.begin(), colors.end(), color_position, compare_position) - colors.begin();
+	size_t	n2 = n1;
+	if(colors[n1].first > color_position) --n2;
 
 	double	w0 = colors[n1].first - colors[n2].first;
 	if(w0 <= 0) return colors[n1].second;
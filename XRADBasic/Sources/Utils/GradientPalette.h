@@ -33,6 +33,7 @@ XRAD_BEGIN
 	ColorFunction	f(500);
 	for(size_t i = 0; i < 500; ++i) palette[i] = gp(i);
 
+	Для раскраски изображений целиком см. PaletteLUT и ApplyPalette (PaletteLUT.h).
 */
 
 
@@ -47,9 +48,12 @@ public:
 
 	void	SetColor(size_t color_no, const base_color_t& new_color);
 	void	MoveColor(size_t color_no, double new_color_position);
-	ColorSampleF64	operator()(double color_position);
+	ColorSampleF64	operator()(double color_position) const;
 
 	size_t	size() const { return colors.size(); }
+	//! \brief Положения первого и последнего цветов. Палитра не должна быть пустой
+	double	first_position() const { return colors.front().first; }
+	double	last_position() const { return colors.back().first; }
 
 private:
 	std::vector<base_color_t>	colors;
@@ -0,0 +1,370 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_ImagePyramid_h
+#define XRAD__File_ImagePyramid_h
+/*!
+	\file
+	\brief Многомасштабное представление большого изображения, разбитого на квадратные блоки (тайлы)
+
+	Уровень 0 -- исходное изображение, каждый следующий уровень вдвое меньше предыдущего
+	по обеим осям: отсчет уровня l + 1 получается из блока 2x2 уровня l (среднее, минимум
+	или максимум). Последний уровень помещается в один тайл. Тайлы уровня строятся параллельно.
+
+	Для показа изображения с масштабом scale (экранных точек на отсчет) выбирается уровень
+	LevelForScale(scale), из него извлекается только видимая область (GetRegion).
+	Время извлечения пропорционально размеру области и не зависит от размера изображения.
+
+	~~~~
+	ImagePyramid<float>	pyramid(slide, pyramid_downsampling::maximum);
+	size_t	level = pyramid.LevelForScale(1./40);
+	RealFunction2D_F32	viewport(768, 1024);
+	pyramid.GetRegion(viewport, level, v0 >> level, h0 >> level);
+	~~~~
+*/
+//--------------------------------------------------------------
+
+#include <XRADBasic/Sources/Containers/DataArray2D.h>
+#include <XRADBasic/Sources/SampleTypes/ColorSample.h>
+#include <XRADBasic/Sources/Containers/ParallelApply.h>
+#include <vector>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+//! \brief Способ вычисления отсчета следующего уровня по блоку 2x2
+enum class pyramid_downsampling
+{
+	//! \brief Среднее значение (сглаживание)
+	mean,
+	//! \brief Минимум (для цветных отсчетов -- покомпонентно); сохраняет темные детали
+	minimum,
+	//! \brief Максимум (для цветных отсчетов -- покомпонентно); сохраняет яркие детали
+	maximum
+};
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Пирамида изображения, хранящаяся по тайлам
+
+	T -- вещественный тип или цвет с вещественными компонентами (float, double, ColorSampleF32 и т.п.).
+	Размер тайла четный, поэтому блок 2x2 никогда не пересекает границу тайлов
+	(кроме последних строки и столбца уровня нечетного размера, которые дублируются).
+*/
+template<class T>
+class	ImagePyramid
+{
+	public:
+		typedef	T value_type;
+		typedef	DataArray2D<DataArray<T>> tile_type;
+		static	const size_t	default_tile_size = 256;
+
+		ImagePyramid(){}
+		template<class A2D>
+		explicit ImagePyramid(const A2D &image, pyramid_downsampling downsampling = pyramid_downsampling::mean,
+				size_t tile_size = default_tile_size)
+		{
+			Init(image, downsampling, tile_size);
+		}
+
+		template<class A2D>
+		void	Init(const A2D &image, pyramid_downsampling downsampling = pyramid_downsampling::mean,
+				size_t tile_size = default_tile_size);
+		void	clear(){ m_levels.clear(); }
+
+		bool	empty() const { return m_levels.empty(); }
+		size_t	n_levels() const { return m_levels.size(); }
+		size_t	tile_size() const { return m_tile_size; }
+		pyramid_downsampling	downsampling() const { return m_downsampling; }
+
+		size_t	vsize(size_t level = 0) const { return m_levels[level].vsize; }
+		size_t	hsize(size_t level = 0) const { return m_levels[level].hsize; }
+		size_t	n_tile_rows(size_t level) const { return m_levels[level].n_tile_rows; }
+		size_t	n_tile_columns(size_t level) const { return m_levels[level].n_tile_columns; }
+
+		const tile_type	&tile(size_t level, size_t tile_row, size_t tile_column) const
+		{
+			const auto	&l = m_levels[level];
+			return l.tiles[tile_row*l.n_tile_columns + tile_column];
+		}
+		//! \brief Отсчет уровня level
+		const T	&at(size_t level, size_t v, size_t h) const
+		{
+			return tile(level, v/m_tile_size, h/m_tile_size).at(v%m_tile_size, h%m_tile_size);
+		}
+
+		/*!
+			\brief Самый грубый уровень, один отсчет которого занимает на экране не более одной точки
+
+			scale -- количество экранных точек на отсчет исходного изображения.
+			При scale >= 1 это уровень 0.
+		*/
+		size_t	LevelForScale(double scale) const;
+
+		/*!
+			\brief Область уровня level с левым верхним углом (v0, h0) (в отсчетах этого уровня)
+
+			Размеры области задаются размерами result. Отсчеты за пределами уровня равны нулю.
+			Обращения идут только к тайлам, пересекающимся с областью.
+		*/
+		template<class A2D_RESULT>
+		void	GetRegion(A2D_RESULT &result, size_t level, ptrdiff_t v0, ptrdiff_t h0) const;
+
+	private:
+		struct	level_type
+		{
+			size_t	vsize = 0, hsize = 0;
+			size_t	n_tile_rows = 0, n_tile_columns = 0;
+			std::vector<tile_type>	tiles;
+		};
+
+		void	AllocateLevel(level_type &level, size_t vs, size_t hs) const;
+		void	BuildLevel(size_t level_no);
+
+		std::vector<level_type>	m_levels;
+		size_t	m_tile_size = 0;
+		pyramid_downsampling	m_downsampling = pyramid_downsampling::mean;
+};
+
+//--------------------------------------------------------------
+
+namespace ImagePyramidAuxiliaries
+{
+
+template<class T>
+inline T	mean4(const T &a, const T &b, const T &c, const T &d)
+{
+	return T((a + b + c + d)*0.25f);
+}
+
+template<class T>
+inline T	min4(const T &a, const T &b, const T &c, const T &d)
+{
+	return min(min(a, b), min(c, d));
+}
+
+template<class T>
+inline T	max4(const T &a, const T &b, const T &c, const T &d)
+{
+	return max(max(a, b), max(c, d));
+}
+
+template<class RGB_TRAITS_T>
+inline RGBColorSample<RGB_TRAITS_T>	min4(const RGBColorSample<RGB_TRAITS_T> &a, const RGBColorSample<RGB_TRAITS_T> &b,
+		const RGBColorSample<RGB_TRAITS_T> &c, const RGBColorSample<RGB_TRAITS_T> &d)
+{
+	return RGBColorSample<RGB_TRAITS_T>(min4(a.red(), b.red(), c.red(), d.red()),
+			min4(a.green(), b.green(), c.green(), d.green()),
+			min4(a.blue(), b.blue(), c.blue(), d.blue()));
+}
+
+template<class RGB_TRAITS_T>
+inline RGBColorSample<RGB_TRAITS_T>	max4(const RGBColorSample<RGB_TRAITS_T> &a, const RGBColorSample<RGB_TRAITS_T> &b,
+		const RGBColorSample<RGB_TRAITS_T> &c, const RGBColorSample<RGB_TRAITS_T> &d)
+{
+	return RGBColorSample<RGB_TRAITS_T>(max4(a.red(), b.red(), c.red(), d.red()),
+			max4(a.green(), b.green(), c.green(), d.green()),
+			max4(a.blue(), b.blue(), c.blue(), d.blue()));
+}
+
+/*!
+	\brief Уменьшение блока source вдвое с записью в result начиная с (v0, h0)
+
+	Последние строка и столбец блока нечетного размера дублируются, поэтому
+	для неполных блоков 2x2 результат вычисляется по имеющимся отсчетам.
+*/
+template<class TILE, class REDUCE>
+void	DownsampleTile(TILE &result, size_t v0, size_t h0, const TILE &source, const REDUCE &reduce)
+{
+	size_t	vs = source.vsize(), hs = source.hsize();
+	for(size_t i = 0; i < (vs + 1)/2; ++i)
+	{
+		const auto	&row0 = source.row(2*i);
+		const auto	&row1 = source.row(min(2*i + 1, vs - 1));
+		auto	&result_row = result.row(v0 + i);
+		for(size_t j = 0; j < (hs + 1)/2; ++j)
+		{
+			size_t	j0 = 2*j, j1 = min(2*j + 1, hs - 1);
+			result_row[h0 + j] = reduce(row0[j0], row0[j1], row1[j0], row1[j1]);
+		}
+	}
+}
+
+} // namespace ImagePyramidAuxiliaries
+
+//--------------------------------------------------------------
+
+template<class T>
+void	ImagePyramid<T>::AllocateLevel(level_type &level, size_t vs, size_t hs) const
+{
+	level.vsize = vs;
+	level.hsize = hs;
+	level.n_tile_rows = (vs + m_tile_size - 1)/m_tile_size;
+	level.n_tile_columns = (hs + m_tile_size - 1)/m_tile_size;
+	level.tiles.resize(level.n_tile_rows*level.n_tile_columns);
+	for(size_t i = 0; i < level.n_tile_rows; ++i)
+	{
+		for(size_t j = 0; j < level.n_tile_columns; ++j)
+		{
+			level.tiles[i*level.n_tile_columns + j].realloc(
+					min(m_tile_size, vs - i*m_tile_size), min(m_tile_size, hs - j*m_tile_size));
+		}
+	}
+}
+
+template<class T>
+template<class A2D>
+void	ImagePyramid<T>::Init(const A2D &image, pyramid_downsampling in_downsampling, size_t in_tile_size)
+{
+	if(in_tile_size < 2 || in_tile_size%2)
+	{
+		throw invalid_argument(ssprintf("ImagePyramid::Init: tile size must be even, got %zu",
+				EnsureType<size_t>(in_tile_size)));
+	}
+	m_levels.clear();
+	m_tile_size = in_tile_size;
+	m_downsampling = in_downsampling;
+
+	size_t	vs = image.vsize(), hs = image.hsize();
+	if(!vs || !hs)
+		return;
+
+	size_t	n = 1;
+	for(size_t s = max(vs, hs); s > m_tile_size; s = (s + 1)/2)
+		++n;
+	m_levels.resize(n);
+
+	// уровень 0: копирование исходного изображения по тайлам
+	AllocateLevel(m_levels[0], vs, hs);
+	auto	&level0 = m_levels[0];
+	ParallelApply::ProcessIndependentParts(level0.tiles.size(), vs*hs, [&](size_t k)
+		{
+			auto	&t = level0.tiles[k];
+			size_t	v0 = (k/level0.n_tile_columns)*m_tile_size;
+			size_t	h0 = (k%level0.n_tile_columns)*m_tile_size;
+			for(size_t i = 0; i < t.vsize(); ++i)
+			{
+				const auto	&source_row = image.row(v0 + i);
+				auto	&row = t.row(i);
+				for(size_t j = 0; j < row.size(); ++j)
+					row[j] = source_row[h0 + j];
+			}
+		},
+		"ImagePyramid::Init");
+
+	for(size_t l = 1; l < n; ++l)
+		BuildLevel(l);
+}
+
+template<class T>
+void	ImagePyramid<T>::BuildLevel(size_t level_no)
+{
+	using namespace ImagePyramidAuxiliaries;
+	const auto	&source = m_levels[level_no - 1];
+	auto	&level = m_levels[level_no];
+	AllocateLevel(level, (source.vsize + 1)/2, (source.hsize + 1)/2);
+
+	// тайл (i, j) уровня строится из четырех тайлов (2i..2i+1, 2j..2j+1) предыдущего уровня,
+	// каждый из которых заполняет свою четверть
+	size_t	half = m_tile_size/2;
+	ParallelApply::ProcessIndependentParts(level.tiles.size(), source.vsize*source.hsize, [&](size_t k)
+		{
+			size_t	ti = k/level.n_tile_columns, tj = k%level.n_tile_columns;
+			auto	&t = level.tiles[k];
+			for(size_t qi = 0; qi < 2; ++qi)
+			{
+				size_t	si = 2*ti + qi;
+				if(si >= source.n_tile_rows)
+					break;
+				for(size_t qj = 0; qj < 2; ++qj)
+				{
+					size_t	sj = 2*tj + qj;
+					if(sj >= source.n_tile_columns)
+						break;
+					const auto	&s = source.tiles[si*source.n_tile_columns + sj];
+					switch(m_downsampling)
+					{
+						case pyramid_downsampling::mean:
+							DownsampleTile(t, qi*half, qj*half, s, [](const T &a, const T &b, const T &c, const T &d){ return mean4(a, b, c, d); });
+							break;
+						case pyramid_downsampling::minimum:
+							DownsampleTile(t, qi*half, qj*half, s, [](const T &a, const T &b, const T &c, const T &d){ return min4(a, b, c, d); });
+							break;
+						case pyramid_downsampling::maximum:
+							DownsampleTile(t, qi*half, qj*half, s, [](const T &a, const T &b, const T &c, const T &d){ return max4(a, b, c, d); });
+							break;
+						default:
+							throw invalid_argument("ImagePyramid::BuildLevel: invalid downsampling mode");
+					}
+				}
+			}
+		},
+		"ImagePyramid::BuildLevel");
+}
+
+template<class T>
+size_t	ImagePyramid<T>::LevelForScale(double scale) const
+{
+	size_t	level = 0;
+	// уровень level + 1 показывается с масштабом scale*2^(level + 1)
+	while(level + 1 < n_levels() && scale*double(size_t(2) << level) <= 1)
+		++level;
+	return level;
+}
+
+template<class T>
+template<class A2D_RESULT>
+void	ImagePyramid<T>::GetRegion(A2D_RESULT &result, size_t level_no, ptrdiff_t v0, ptrdiff_t h0) const
+{
+	if(level_no >= n_levels())
+	{
+		throw invalid_argument(ssprintf("ImagePyramid::GetRegion: invalid level %zu (%zu levels)",
+				EnsureType<size_t>(level_no), EnsureType<size_t>(n_levels())));
+	}
+	const auto	&level = m_levels[level_no];
+	ptrdiff_t	vs = result.vsize(), hs = result.hsize();
+	ptrdiff_t	ts = m_tile_size;
+
+	// видимая часть уровня
+	ptrdiff_t	v_begin = range(v0, ptrdiff_t(0), ptrdiff_t(level.vsize)), v_end = range(v0 + vs, ptrdiff_t(0), ptrdiff_t(level.vsize));
+	ptrdiff_t	h_begin = range(h0, ptrdiff_t(0), ptrdiff_t(level.hsize)), h_end = range(h0 + hs, ptrdiff_t(0), ptrdiff_t(level.hsize));
+	if(v_begin >= v_end || h_begin >= h_end || v_begin != v0 || h_begin != h0 || v_end != v0 + vs || h_end != h0 + hs)
+	{
+		// область выходит за пределы уровня
+		T	zero = zero_value(T());
+		for(ptrdiff_t i = 0; i < vs; ++i)
+		{
+			auto	&row = result.row(i);
+			for(ptrdiff_t j = 0; j < hs; ++j)
+				row[j] = zero;
+		}
+	}
+
+	for(ptrdiff_t ti = v_begin/ts; ti*ts < v_end; ++ti)
+	{
+		for(ptrdiff_t tj = h_begin/ts; tj*ts < h_end; ++tj)
+		{
+			const auto	&t = level.tiles[ti*level.n_tile_columns + tj];
+			ptrdiff_t	tv0 = ti*ts, th0 = tj*ts;
+			ptrdiff_t	i_begin = max(v_begin, tv0), i_end = min(v_end, tv0 + ts);
+			ptrdiff_t	j_begin = max(h_begin, th0), j_end = min(h_end, th0 + ts);
+			for(ptrdiff_t i = i_begin; i < i_end; ++i)
+			{
+				const auto	&tile_row = t.row(i - tv0);
+				auto	&row = result.row(i - v0);
+				for(ptrdiff_t j = j_begin; j < j_end; ++j)
+					row[j - h0] = tile_row[j - th0];
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_ImagePyramid_h
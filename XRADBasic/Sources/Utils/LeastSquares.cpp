@@ -7,6 +7,7 @@
 #include "LeastSquares.h"
 #include "LeastSquaresAlgorithms.h"
 #include "StatisticUtils.h"
+#include "SolveLinearSystem.h"
 
 
 
@@ -53,4 +54,85 @@ void	DetectLSUniversalWeighted(const RealFunctionF64 &samples, const abstract_LS
 
 
 
+//--------------------------------------------------------------
+
+LSBatchDetector::LSBatchDetector(size_t n_coefficients, size_t n_samples)
+	{
+	RealFunctionF64	grid(n_samples);
+	for(size_t i = 0; i < n_samples; ++i)
+		grid[i] = double(i);
+	Init(n_coefficients, grid, RealFunctionF64(), nullptr);
+	}
+
+LSBatchDetector::LSBatchDetector(size_t n_coefficients, const RealFunctionF64 &grid, const RealFunctionF64 &weights)
+	{
+	Init(n_coefficients, grid, weights, nullptr);
+	}
+
+LSBatchDetector::LSBatchDetector(size_t n_coefficients, const abstract_LS_basis_function &f, const RealFunctionF64 &grid,
+		const RealFunctionF64 &weights)
+	{
+	Init(n_coefficients, grid, weights, &f);
+	}
+
+void	LSBatchDetector::Init(size_t order, const RealFunctionF64 &grid, const RealFunctionF64 &weights, const abstract_LS_basis_function *f)
+	{
+	size_t	n_samples = grid.size();
+	if(!order || n_samples < order || (!weights.empty() && weights.size() != n_samples))
+		{
+		throw invalid_argument(ssprintf("LSBatchDetector: invalid sizes: %zu coefficients, %zu samples, %zu weights",
+				EnsureType<size_t>(order), EnsureType<size_t>(n_samples), EnsureType<size_t>(weights.size())));
+		}
+
+	basis_values.realloc(n_samples, order);
+	// транспонированная матрица значений функций, умноженных на веса
+	RealMatrixF64	weighted_basis(order, n_samples);
+	for(size_t t = 0; t < n_samples; ++t)
+		{
+		double	x = grid[t];
+		double	w = weights.empty() ? 1 : weights[t];
+		double	power = 1;
+		for(size_t k = 0; k < order; ++k)
+			{
+			double	value = f ? (*f)(x, k) : power;
+			power *= x;
+			basis_values.at(t, k) = value;
+			weighted_basis.at(k, t) = w*value;
+			}
+		}
+
+	// нормальные уравнения (B^T W B) P = B^T W для всех отсчетов сразу
+	RealMatrixF64	normal_matrix(order, order);
+	normal_matrix.matrix_multiply(weighted_basis, basis_values);
+	projector.realloc(order, n_samples);
+	try
+		{
+		SolvePositiveDefinite(projector, normal_matrix, weighted_basis);
+		}
+	catch(matrix_algorithm_error &)
+		{
+		// из-за ошибок округления (плохо обусловленная система, например, полином высокой степени)
+		// матрица может оказаться не положительно определенной
+		SolveLinearSystem(projector, normal_matrix, weighted_basis);
+		}
+	}
+
+void	LSBatchDetector::CheckSize(const char *function_name, size_t size, size_t expected) const
+	{
+	if(size != expected)
+		{
+		throw invalid_argument(ssprintf("%s: invalid size %zu, expected %zu",
+				EnsureType<const char*>(function_name), EnsureType<size_t>(size), EnsureType<size_t>(expected)));
+		}
+	}
+
+void	LSBatchDetector::Fit(RealVectorF64 &coefficients, const RealFunctionF64 &samples) const
+	{
+	CheckSize("LSBatchDetector::Fit", samples.size(), n_samples());
+	if(coefficients.size() != n_coefficients())
+		coefficients.realloc(n_coefficients());
+	for(size_t k = 0; k < n_coefficients(); ++k)
+		coefficients[k] = projector.row(k).sp(samples);
+	}
+
 XRAD_END
\ No newline at end of file
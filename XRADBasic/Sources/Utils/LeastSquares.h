@@ -106,6 +106,131 @@ void	DetectLSUniversalNonUniformGrid(const RealFunctionF64 &samples, const abstr
 void	DetectLSUniversalWeighted(const RealFunctionF64 &samples, const abstract_LS_basis_function&f, const RealFunctionF64 &grid, const RealFunctionF64 &weights, RealVectorF64 &coefficients);
 
 
+//--------------------------------------------------------------
+//
+//	аппроксимация множества сигналов одним и тем же набором функций
+//	на одной сетке с одними весами
+//
+/*!
+	\brief Пакетная аппроксимация по методу наименьших квадратов
+
+	Система нормальных уравнений составляется и решается один раз в конструкторе:
+	вычисляется матрица P размером n_coefficients x n_samples, переводящая отсчеты сигнала
+	в коэффициенты. Аппроксимация каждого сигнала -- умножение на P; для множества сигналов
+	это одно произведение матриц (MatrixProductBlocked), которое выполняется в нескольких потоках.
+
+	Коэффициенты совпадают (в пределах ошибок округления) с результатом DetectLSPolynom*
+	и DetectLSUniversal* для тех же сетки, весов и набора функций.
+
+	Сигналы могут быть расположены в строках двумерного массива (Fit, Approximate) или в столбцах
+	(FitColumns, ApproximateColumns). Второй вариант подходит для серии изображений,
+	хранящейся как трехмерный массив (t, y, x):
+
+	~~~~
+	LSBatchDetector	detector(3, time_points);	// полином второй степени по времени
+	RealFunction2D_F32	curves;
+	curves.UseData(&series.at({0, 0, 0}), series.sizes(0), series.sizes(1)*series.sizes(2));
+	RealMatrixF64	coefficients;
+	detector.FitColumns(coefficients, curves);	// 3 x (число пикселей)
+	~~~~
+*/
+class	LSBatchDetector
+	{
+	public:
+		//! \brief Полином sum(a_k*x^k), k < n_coefficients, на равномерной сетке x = 0..n_samples-1
+		LSBatchDetector(size_t n_coefficients, size_t n_samples);
+		//! \brief Полином на неравномерной сетке; пустой массив weights означает единичные веса
+		LSBatchDetector(size_t n_coefficients, const RealFunctionF64 &grid, const RealFunctionF64 &weights = RealFunctionF64());
+		//! \brief Произвольный набор функций f(x, k), k < n_coefficients
+		LSBatchDetector(size_t n_coefficients, const abstract_LS_basis_function &f, const RealFunctionF64 &grid,
+				const RealFunctionF64 &weights = RealFunctionF64());
+
+		size_t	n_coefficients() const { return projector.vsize(); }
+		size_t	n_samples() const { return projector.hsize(); }
+
+		//! \brief Матрица P: коэффициенты = P * отсчеты
+		const RealMatrixF64	&projection_matrix() const { return projector; }
+		//! \brief Значения функций набора в узлах сетки: basis().at(t, k) = f(grid[t], k)
+		const RealMatrixF64	&basis() const { return basis_values; }
+
+		//! \brief Коэффициенты одного сигнала
+		void	Fit(RealVectorF64 &coefficients, const RealFunctionF64 &samples) const;
+
+		//! \brief Коэффициенты сигналов, записанных в строках signals; строка i результата -- коэффициенты сигнала i
+		template<class A2D_RESULT, class A2D_SIGNALS>
+			void	Fit(A2D_RESULT &coefficients, const A2D_SIGNALS &signals) const;
+		//! \brief Коэффициенты сигналов, записанных в столбцах signals; столбец j результата -- коэффициенты сигнала j
+		template<class A2D_RESULT, class A2D_SIGNALS>
+			void	FitColumns(A2D_RESULT &coefficients, const A2D_SIGNALS &signals) const;
+
+		//! \brief Значения аппроксимирующих функций в узлах сетки по коэффициентам, записанным в строках
+		template<class A2D_RESULT, class A2D_COEFFICIENTS>
+			void	Approximate(A2D_RESULT &approximation, const A2D_COEFFICIENTS &coefficients) const;
+		//! \brief То же для коэффициентов, записанных в столбцах
+		template<class A2D_RESULT, class A2D_COEFFICIENTS>
+			void	ApproximateColumns(A2D_RESULT &approximation, const A2D_COEFFICIENTS &coefficients) const;
+
+	private:
+		RealMatrixF64	basis_values;
+		RealMatrixF64	projector;
+
+		void	Init(size_t order, const RealFunctionF64 &grid, const RealFunctionF64 &weights, const abstract_LS_basis_function *f);
+		void	CheckSize(const char *function_name, size_t size, size_t expected) const;
+
+		//! \brief result(i, j) = sum_p a(i, p)*b(p, j); размер result устанавливается m x n
+		template<class A2D_RESULT, class A, class B>
+			static	void	Multiply(A2D_RESULT &result, size_t m, size_t n, size_t k, const A &a, const B &b);
+	};
+
+//--------------------------------------------------------------
+
+template<class A2D_RESULT, class A, class B>
+void	LSBatchDetector::Multiply(A2D_RESULT &result, size_t m, size_t n, size_t k, const A &a, const B &b)
+	{
+	if(result.vsize() != m || result.hsize() != n)
+		result.realloc(m, n);
+	result.fill(zero_value(typename A2D_RESULT::value_type()));
+	auto	c = MatrixProductBlocked::MakeMatrixView(result);
+	MatrixProductBlocked::Multiply<double>(m, n, k, a, b, MatrixProductBlocked::plain_madd(),
+			[&c](size_t i, size_t j, double s){ c(i, j) += s; });
+	}
+
+template<class A2D_RESULT, class A2D_SIGNALS>
+void	LSBatchDetector::Fit(A2D_RESULT &coefficients, const A2D_SIGNALS &signals) const
+	{
+	CheckSize("LSBatchDetector::Fit", signals.hsize(), n_samples());
+	auto	s = MatrixProductBlocked::MakeMatrixView(signals);
+	auto	p = MatrixProductBlocked::MakeMatrixView(projector);
+	Multiply(coefficients, signals.vsize(), n_coefficients(), n_samples(),
+			s, [&p](size_t t, size_t k){ return p(k, t); });
+	}
+
+template<class A2D_RESULT, class A2D_SIGNALS>
+void	LSBatchDetector::FitColumns(A2D_RESULT &coefficients, const A2D_SIGNALS &signals) const
+	{
+	CheckSize("LSBatchDetector::FitColumns", signals.vsize(), n_samples());
+	Multiply(coefficients, n_coefficients(), signals.hsize(), n_samples(),
+			MatrixProductBlocked::MakeMatrixView(projector), MatrixProductBlocked::MakeMatrixView(signals));
+	}
+
+template<class A2D_RESULT, class A2D_COEFFICIENTS>
+void	LSBatchDetector::Approximate(A2D_RESULT &approximation, const A2D_COEFFICIENTS &coefficients) const
+	{
+	CheckSize("LSBatchDetector::Approximate", coefficients.hsize(), n_coefficients());
+	auto	b = MatrixProductBlocked::MakeMatrixView(basis_values);
+	Multiply(approximation, coefficients.vsize(), n_samples(), n_coefficients(),
+			MatrixProductBlocked::MakeMatrixView(coefficients), [&b](size_t k, size_t t){ return b(t, k); });
+	}
+
+template<class A2D_RESULT, class A2D_COEFFICIENTS>
+void	LSBatchDetector::ApproximateColumns(A2D_RESULT &approximation, const A2D_COEFFICIENTS &coefficients) const
+	{
+	CheckSize("LSBatchDetector::ApproximateColumns", coefficients.vsize(), n_coefficients());
+	Multiply(approximation, n_samples(), coefficients.hsize(), n_coefficients(),
+			MatrixProductBlocked::MakeMatrixView(basis_values), MatrixProductBlocked::MakeMatrixView(coefficients));
+	}
+
+
 XRAD_END
 
 #endif //XRAD__File_least_squares_h
@@ -0,0 +1,275 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_PaletteLUT_h
+#define XRAD__File_PaletteLUT_h
+/*!
+	\file
+	\brief Таблица цветов градиентной палитры и раскраска изображений (псевдоцвет)
+
+	GradientPalette::operator() при каждом вызове ищет пару соседних цветов и интерполирует между ними.
+	PaletteLUT вычисляет палитру один раз в заданном количестве равноотстоящих точек,
+	после чего цвет отсчета определяется одним умножением и обращением к таблице.
+
+	ApplyPalette раскрашивает изображение целиком: значения из диапазона values_range
+	(окно яркости) отображаются на палитру, значения вне диапазона получают крайние цвета.
+	Нормировка совмещена с поиском в таблице, строки обрабатываются параллельно.
+	При изменении окна таблицу пересчитывать не нужно.
+
+	~~~~
+	GradientPalette	gp({0, 0.5, 1}, {crayons::blue(), crayons::green(), crayons::red()});
+	PaletteLUT<ColorPixel>	lut(gp);
+	BitmapContainerRGB	bitmap;
+	ApplyPalette(bitmap, perfusion_map, lut, range1_F64(window_min, window_max));
+	~~~~
+*/
+//--------------------------------------------------------------
+
+#include "GradientPalette.h"
+#include "BitmapContainer.h"
+#include <XRADBasic/Sources/Containers/DataArrayMD.h>
+#include <XRADBasic/Sources/Containers/SpaceCoordinates.h>
+#include <XRADBasic/Sources/Containers/ParallelApply.h>
+#include <type_traits>
+#include <vector>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Градиентная палитра, вычисленная в size() равноотстоящих точках
+
+	Элемент 0 соответствует первому цвету палитры, элемент size() - 1 -- последнему.
+	Для целочисленных компонент COLOR_T значения округляются.
+*/
+template<class COLOR_T>
+class	PaletteLUT
+{
+	public:
+		typedef	COLOR_T color_type;
+		static	const size_t	default_size = 1024;
+
+		PaletteLUT(){}
+		explicit PaletteLUT(const GradientPalette &palette, size_t n_entries = default_size){ Init(palette, n_entries); }
+
+		void	Init(const GradientPalette &palette, size_t n_entries = default_size);
+
+		size_t	size() const { return m_table.size(); }
+		bool	empty() const { return m_table.empty(); }
+		const COLOR_T	&operator[](size_t i) const { return m_table[i]; }
+		const COLOR_T	*data() const { return m_table.data(); }
+
+	private:
+		std::vector<COLOR_T>	m_table;
+};
+
+//--------------------------------------------------------------
+
+namespace PaletteLUTAuxiliaries
+{
+
+template<class T>
+inline T	component_cast(double x, std::true_type /*is_integral*/){ return T(x + 0.5); }
+template<class T>
+inline T	component_cast(double x, std::false_type /*is_integral*/){ return T(x); }
+
+template<class COLOR_T>
+COLOR_T	color_cast(const ColorSampleF64 &c)
+{
+	typedef	typename COLOR_T::component_type component_type;
+	auto	is_integral = std::is_integral<component_type>();
+	COLOR_T	result;
+	result.red() = component_cast<component_type>(c.red(), is_integral);
+	result.green() = component_cast<component_type>(c.green(), is_integral);
+	result.blue() = component_cast<component_type>(c.blue(), is_integral);
+	return result;
+}
+
+/*!
+	\brief Номер элемента таблицы для значения x: values_range.p1() -> 0, values_range.p2() -> size - 1
+
+	Диапазон может быть "перевернутым" (p1 > p2). NaN отображается на элемент 0.
+*/
+class	palette_index
+{
+	public:
+		palette_index(size_t lut_size, const range1_F64 &values_range) : last(double(lut_size - 1))
+		{
+			if(!lut_size)
+				throw invalid_argument("ApplyPalette: palette table is not initialized");
+			if(!(values_range.delta() != 0) || !isfinite(values_range.delta()))
+			{
+				throw invalid_argument(ssprintf("ApplyPalette: invalid values range (%g, %g)",
+						EnsureType<double>(values_range.p1()), EnsureType<double>(values_range.p2())));
+			}
+			scale = last/values_range.delta();
+			// +0.5 -- округление при отбрасывании дробной части
+			offset = 0.5 - values_range.p1()*scale;
+		}
+
+		size_t	operator()(double x) const { return size_t(range(x*scale + offset, 0., last)); }
+
+	private:
+		double	scale, offset, last;
+};
+
+/*!
+	\brief Раскраска строки: result[j] = lut[index(source[j])]
+
+	Для 8- и 16-битных целочисленных отсчетов, если строк достаточно много, цвет заранее вычисляется
+	для каждого возможного значения (direct_table), и на отсчет приходится одно обращение к памяти.
+*/
+template<class COLOR_T, class T>
+class	row_painter
+{
+	public:
+		static	constexpr bool	use_direct_table = std::is_integral<T>::value && sizeof(T) <= 2;
+
+		row_painter(const PaletteLUT<COLOR_T> &in_lut, const range1_F64 &values_range, size_t n_elements):
+				lut(in_lut.data()), index(in_lut.size(), values_range)
+		{
+			if constexpr(use_direct_table)
+			{
+				const size_t	n_values = size_t(1) << (8*sizeof(T));
+				if(n_elements >= n_values)
+				{
+					direct_table.resize(n_values);
+					for(size_t i = 0; i < n_values; ++i)
+						direct_table[i] = lut[index(double(value_min + ptrdiff_t(i)))];
+				}
+			}
+			else
+			{
+				(void)n_elements;
+			}
+		}
+
+		template<class RESULT_IT, class SOURCE_IT>
+		void	operator()(RESULT_IT result_it, SOURCE_IT source_it, size_t n) const
+		{
+			if constexpr(use_direct_table)
+			{
+				if(direct_table.size())
+				{
+					const COLOR_T	*table = direct_table.data();
+					for(size_t j = 0; j < n; ++j, ++result_it, ++source_it)
+						*result_it = table[ptrdiff_t(*source_it) - value_min];
+					return;
+				}
+			}
+			for(size_t j = 0; j < n; ++j, ++result_it, ++source_it)
+				*result_it = lut[index(double(*source_it))];
+		}
+
+	private:
+		static	constexpr ptrdiff_t	value_min = ptrdiff_t(std::numeric_limits<T>::min());
+
+		const COLOR_T	*lut;
+		palette_index	index;
+		std::vector<COLOR_T>	direct_table;
+};
+
+template<class COLOR_T, class RT, class ST>
+void	MapImage(DataArray2D<RT> &result, const DataArray2D<ST> &source,
+		const PaletteLUT<COLOR_T> &lut, const range1_F64 &values_range)
+{
+	if(result.vsize() != source.vsize() || result.hsize() != source.hsize())
+		result.realloc(source.vsize(), source.hsize());
+	size_t	hs = source.hsize();
+	row_painter<COLOR_T, typename ST::value_type>	paint(lut, values_range, source.vsize()*hs);
+	ParallelApply::ProcessIndependentParts(source.vsize(), source.vsize()*hs, [&](size_t i)
+		{
+			paint(result.row(i).begin(), source.row(i).begin(), hs);
+		},
+		"ApplyPalette");
+}
+
+//! \brief Строки BMP хранятся снизу вверх: строка 0 исходного изображения попадает в последнюю строку
+template<class COLOR_T, class ST>
+void	MapImage(BitmapContainerRGB &result, const DataArray2D<ST> &source,
+		const PaletteLUT<COLOR_T> &lut, const range1_F64 &values_range)
+{
+	result.SetSizes(source.vsize(), source.hsize());
+	size_t	vs = source.vsize(), hs = source.hsize();
+	row_painter<COLOR_T, typename ST::value_type>	paint(lut, values_range, vs*hs);
+	ParallelApply::ProcessIndependentParts(vs, vs*hs, [&](size_t i)
+		{
+			paint(result.row(i).begin(), source.row(vs - 1 - i).begin(), hs);
+		},
+		"ApplyPalette");
+}
+
+template<class COLOR_T, class A2DT_RESULT, class A2DT_SOURCE>
+void	MapImage(DataArrayMD<A2DT_RESULT> &result, const DataArrayMD<A2DT_SOURCE> &source,
+		const PaletteLUT<COLOR_T> &lut, const range1_F64 &values_range)
+{
+	if(result.sizes() != source.sizes())
+		result.realloc(source.sizes());
+	size_t	n_dimensions = source.n_dimensions();
+	size_t	row_size = source.sizes(n_dimensions - 1);
+	size_t	n_rows = 1;
+	for(size_t i = 0; i + 1 < n_dimensions; ++i)
+		n_rows *= source.sizes(i);
+	if(!row_size)
+		return;
+	row_painter<COLOR_T, typename A2DT_SOURCE::value_type>	paint(lut, values_range, n_rows*row_size);
+	ParallelApply::ProcessIndependentParts(n_rows, n_rows*row_size, [&](size_t i)
+		{
+			// индекс строки: последний индекс меняется быстрее всего
+			index_vector	iv(n_dimensions);
+			iv[n_dimensions - 1] = slice_mask(0);
+			for(size_t j = n_dimensions - 1, rest = i; j-- > 0;)
+			{
+				iv[j] = rest % source.sizes(j);
+				rest /= source.sizes(j);
+			}
+			paint(result.GetRow(iv).begin(), source.GetRow(iv).begin(), row_size);
+		},
+		"ApplyPalette");
+}
+
+} // namespace PaletteLUTAuxiliaries
+
+//--------------------------------------------------------------
+
+template<class COLOR_T>
+void	PaletteLUT<COLOR_T>::Init(const GradientPalette &palette, size_t n_entries)
+{
+	if(!palette.size())
+		throw invalid_argument("PaletteLUT::Init: empty palette");
+	if(n_entries < 2)
+		throw invalid_argument(ssprintf("PaletteLUT::Init: invalid table size %zu", EnsureType<size_t>(n_entries)));
+	double	p0 = palette.first_position();
+	double	step = (palette.last_position() - p0)/double(n_entries - 1);
+	m_table.resize(n_entries);
+	for(size_t i = 0; i < n_entries; ++i)
+		m_table[i] = PaletteLUTAuxiliaries::color_cast<COLOR_T>(palette(p0 + step*double(i)));
+}
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Раскраска действительного изображения палитрой lut
+
+	Значение values_range.p1() получает первый цвет палитры, values_range.p2() -- последний.
+	Размер result устанавливается равным размеру source.
+
+	Поддерживаются:
+	- DataArray2D и наследники (RealFunction2D_F32 и т.п. -> ColorImageUI8, ColorImageF32 и т.п.);
+	- BitmapContainerRGB в качестве результата (строки переворачиваются, см. BitmapContainer.h);
+	- DataArrayMD и наследники (RealFunctionMD_F32 и т.п. -> ColorImageMD_UI8 и т.п.).
+*/
+template<class RESULT, class SOURCE, class COLOR_T>
+void	ApplyPalette(RESULT &result, const SOURCE &source, const PaletteLUT<COLOR_T> &lut, const range1_F64 &values_range)
+{
+	PaletteLUTAuxiliaries::MapImage(result, source, lut, values_range);
+}
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_PaletteLUT_h
@@ -24,6 +24,10 @@ XRAD_BEGIN
 //
 //	генераторы шумов по заданному закону
 //
+//	Помимо виртуальной Generate() классы-генераторы имеют невиртуальные методы
+//	Generate(RandomStream&) и Generate(DataArray&, RandomStream&) для использования
+//	в плотных циклах и для заполнения целых массивов.
+//
 
 
 class	RandomNoiseGenerator
@@ -39,7 +43,17 @@ class	GaussianNoiseGeneratorEssential: public RandomNoiseGenerator
 		const GaussianDistributionContainer	DistributionLaw;
 		virtual	const DistributionContainer &GetDistributionContainer(){return DistributionLaw;}
 		GaussianNoiseGeneratorEssential(double average, double sigma):DistributionLaw(average,sigma){}
-		virtual double	Generate() const {return RandomGaussian(DistributionLaw.average,DistributionLaw.sigma);}
+		virtual double	Generate() const {return Generate(ThreadRandomStream());}
+
+		double	Generate(RandomStream &stream) const
+			{
+			return DistributionLaw.average + DistributionLaw.sigma*stream.GaussianStandard();
+			}
+		template<class T>
+		void	Generate(DataArray<T> &result, RandomStream &stream = ThreadRandomStream()) const
+			{
+			FillRandomGaussian(result, DistributionLaw.average, DistributionLaw.sigma, stream);
+			}
 	};
 
 
@@ -52,9 +66,16 @@ class	GeneratorRicianEssential: public RandomNoiseGenerator
 		virtual	const DistributionContainer &GetDistributionContainer(){return DistributionLaw;}
 
 		GeneratorRicianEssential(double in_nu, double in_sigma) : g(in_nu/sqrt(2.),in_sigma), DistributionLaw(in_nu, in_sigma){}
-		virtual double	Generate() const
+		virtual double	Generate() const {return Generate(ThreadRandomStream());}
+
+		double	Generate(RandomStream &stream) const
 			{
-			return sqrt(square(g.Generate()) + square(g.Generate()));
+			return sqrt(square(g.Generate(stream)) + square(g.Generate(stream)));
+			}
+		template<class T>
+		void	Generate(DataArray<T> &result, RandomStream &stream = ThreadRandomStream()) const
+			{
+			FillRandomRician(result, DistributionLaw.nu, DistributionLaw.sigma, stream);
 			}
 	};
 
@@ -69,10 +90,20 @@ class	TableRandomNoiseGenerator: public RandomNoiseGenerator, public Distributio
 
 	public:
 
-		virtual double	Generate() const
+		virtual double	Generate() const {return Generate(ThreadRandomStream());}
+
+		double	Generate(RandomStream &stream) const
 			{
-			double index = RandomUniformF64(0, 1);
-			return FromUniform(index);
+			return FromUniform(stream.UniformF64());
+			}
+		//! \brief Заполнение массива: равномерный шум и табличное преобразование всего массива.
+		//! Равномерный шум вычисляется в буфере double: в целочисленном result он обратился бы в 0
+		template<class T>
+		void	Generate(DataArray<T> &result, RandomStream &stream = ThreadRandomStream()) const
+			{
+			DataArray<double>	uniform(result.size());
+			FillRandomUniform(uniform, 0, 1, stream);
+			FromUniform(uniform, result);
 			}
 	};
 
@@ -109,12 +140,14 @@ class	IrwingHallNoiseGenerator: public RandomNoiseGenerator
 		const IrwingHallDistribution	DistributionLaw;
 		virtual	const DistributionContainer &GetDistributionContainer(){return DistributionLaw;}
 		IrwingHallNoiseGenerator(double in_average, int in_n_components) : DistributionLaw(in_n_components, in_average){}
-		virtual double	Generate() const
+		virtual double	Generate() const {return Generate(ThreadRandomStream());}
+
+		double	Generate(RandomStream &stream) const
 			{
 			double result = 0;
 			for(int j = 0; j < DistributionLaw.n_components; ++j)
 				{
-				result += RandomUniformF64(-0.5,0.5);
+				result += stream.UniformF64(-0.5,0.5);
 				}
 			return result += DistributionLaw.average;
 			}
@@ -0,0 +1,216 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#include "pre.h"
+#include "RandomStream.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+namespace
+{
+
+//! \brief Перемешивание битов (финализатор SplitMix64)
+uint64_t	mix64(uint64_t x)
+{
+	x = (x ^ (x >> 30))*0xBF58476D1CE4E5B9ull;
+	x = (x ^ (x >> 27))*0x94D049BB133111EBull;
+	return x ^ (x >> 31);
+}
+
+mutex	seed_mutex;
+uint64_t	global_seed = default_random_seed;
+//! \brief Увеличивается при каждой смене ключа, потоки нитей при этом создаются заново
+atomic<uint64_t>	seed_generation(0);
+
+//! \brief Нить, в которой инициализирована библиотека (обычно главная нить программы)
+const thread::id	main_thread_id = this_thread::get_id();
+//! \brief Номера потоков нитей, созданных не средствами OpenMP, не пересекаются с номерами нитей OpenMP
+constexpr uint64_t	external_thread_streams = uint64_t(1) << 63;
+atomic<uint64_t>	external_thread_count(0);
+
+//! \brief Номер потока для нити, не являющейся нитью OpenMP с ненулевым номером
+uint64_t	ExternalThreadStreamId()
+{
+	if(this_thread::get_id() == main_thread_id)
+		return 0;
+	thread_local uint64_t	stream_id = external_thread_streams + external_thread_count.fetch_add(1);
+	return stream_id;
+}
+
+} // namespace
+
+//--------------------------------------------------------------
+
+RandomStream	RandomStream::Split(uint64_t index) const
+{
+	return RandomStream(m_seed, mix64(m_stream ^ mix64(index + 0x9E3779B97F4A7C15ull)));
+}
+
+double	RandomStream::GaussianStandard()
+{
+	if(m_has_spare_gaussian)
+	{
+		m_has_spare_gaussian = false;
+		return m_spare_gaussian;
+	}
+	uint32_t	w[4] = {GenerateUI32(), GenerateUI32(), GenerateUI32(), GenerateUI32()};
+	// (0, 1] -- чтобы избежать логарифмирования нуля
+	double	r = sqrt(-2.*log(RandomStreamAuxiliaries::uniform_oc(w[0], w[1])));
+	double	fi = two_pi()*RandomStreamAuxiliaries::uniform_co(w[2], w[3]);
+	m_spare_gaussian = r*sin(fi);
+	m_has_spare_gaussian = true;
+	return r*cos(fi);
+}
+
+//--------------------------------------------------------------
+
+RandomStream	&ThreadRandomStream()
+{
+	int	thread_num = omp_get_thread_num();
+	return ThreadRandomStream(thread_num ? uint64_t(thread_num) : ExternalThreadStreamId());
+}
+
+RandomStream	&ThreadRandomStream(uint64_t stream_id)
+{
+	thread_local RandomStream	stream(0);
+	thread_local uint64_t	generation = uint64_t(-1);
+	uint64_t	current_generation = seed_generation.load(memory_order_acquire);
+	if(generation != current_generation || stream.stream() != stream_id)
+	{
+		lock_guard<mutex>	lock(seed_mutex);
+		stream = RandomStream(global_seed, stream_id);
+		generation = current_generation;
+	}
+	return stream;
+}
+
+void	SetRandomSeed(uint64_t seed)
+{
+	lock_guard<mutex>	lock(seed_mutex);
+	global_seed = seed;
+	seed_generation.fetch_add(1, memory_order_release);
+}
+
+uint64_t	RandomSeed()
+{
+	lock_guard<mutex>	lock(seed_mutex);
+	return global_seed;
+}
+
+//--------------------------------------------------------------
+
+namespace RandomStreamAuxiliaries
+{
+
+uint64_t	NoiseBlocks(noise_distribution distribution, uint64_t n_elements)
+{
+	// для гауссова шума один блок дает два значения (cos и sin преобразования Бокса-Мюллера)
+	return distribution == noise_distribution::gaussian ? (n_elements + 1)/2 : n_elements;
+}
+
+namespace
+{
+
+//! \brief Равномерно распределенные величины (0, 1] и [0, 1) из блоков first_block, ..., first_block + count - 1
+void	GenerateUniformPairs(double *u1, double *u2, size_t count, const RandomStream &stream, uint64_t first_block)
+{
+	for(size_t i = 0; i < count; ++i)
+	{
+		uint32_t	w[4];
+		stream.Block(first_block + i, w);
+		u1[i] = uniform_oc(w[0], w[1]);
+		u2[i] = uniform_co(w[2], w[3]);
+	}
+}
+
+//! \brief Гауссов шум: блок k дает значения 2k (cos) и 2k+1 (sin)
+void	GenerateGaussian(double *result, size_t n, const RandomStream &stream, uint64_t base, uint64_t first,
+		double mean, double sigma)
+{
+	double	u1[noise_chunk_size/2 + 1], u2[noise_chunk_size/2 + 1];
+	double	c[noise_chunk_size/2 + 1], s[noise_chunk_size/2 + 1];
+	for(size_t done = 0; done < n;)
+	{
+		uint64_t	index = first + done;
+		size_t	count = min(n - done, noise_chunk_size);
+		uint64_t	first_block = index/2;
+		size_t	n_blocks = size_t((index + count + 1)/2 - first_block);
+		GenerateUniformPairs(u1, u2, n_blocks, stream, base + first_block);
+		for(size_t k = 0; k < n_blocks; ++k)
+		{
+			double	r = sigma*sqrt(-2.*log(u1[k]));
+			double	fi = two_pi()*u2[k];
+			c[k] = mean + r*cos(fi);
+			s[k] = mean + r*sin(fi);
+		}
+		double	*r = result + done;
+		for(size_t i = 0; i < count; ++i)
+		{
+			uint64_t	j = index + i;
+			size_t	k = size_t(j/2 - first_block);
+			r[i] = (j & 1) ? s[k] : c[k];
+		}
+		done += count;
+	}
+}
+
+} // namespace
+
+void	GenerateNoise(double *result, size_t n, const RandomStream &stream, uint64_t base, uint64_t first,
+		const noise_parameters &parameters)
+{
+	double	a = parameters.a, b = parameters.b;
+	if(parameters.distribution == noise_distribution::gaussian)
+	{
+		GenerateGaussian(result, n, stream, base, first, a, b);
+		return;
+	}
+	// сначала вычисляются равномерно распределенные величины, затем преобразование распределения;
+	// в обоих циклах нет ветвлений и зависимостей между итерациями
+	double	u1[noise_chunk_size], u2[noise_chunk_size];
+	for(size_t done = 0; done < n;)
+	{
+		size_t	count = min(n - done, noise_chunk_size);
+		GenerateUniformPairs(u1, u2, count, stream, base + first + done);
+
+		double	*r = result + done;
+		switch(parameters.distribution)
+		{
+			case noise_distribution::uniform:
+				for(size_t i = 0; i < count; ++i)
+					r[i] = a + (b - a)*u2[i];
+				break;
+
+			case noise_distribution::rayleigh:
+				for(size_t i = 0; i < count; ++i)
+					r[i] = b*sqrt(-2.*log(u1[i]));
+				break;
+
+			case noise_distribution::rician:
+				for(size_t i = 0; i < count; ++i)
+				{
+					double	amplitude = b*sqrt(-2.*log(u1[i]));
+					double	fi = two_pi()*u2[i];
+					r[i] = sqrt(square(a + amplitude*cos(fi)) + square(amplitude*sin(fi)));
+				}
+				break;
+
+			default:
+				throw invalid_argument("GenerateNoise: invalid distribution");
+		}
+		done += count;
+	}
+}
+
+} // namespace RandomStreamAuxiliaries
+
+//--------------------------------------------------------------
+
+XRAD_END
@@ -0,0 +1,394 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_RandomStream_h
+#define XRAD__File_RandomStream_h
+/*!
+	\file
+	\brief Независимые потоки псевдослучайных чисел и заполнение массивов шумом
+
+	Генератор Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", 2011)
+	основан на счетчике: блок из четырех 32-битных чисел вычисляется по ключу (seed),
+	номеру потока (stream) и номеру блока (position) без какого-либо внутреннего состояния.
+	Поэтому:
+	- потоки с разными stream независимы, их можно использовать в разных нитях без синхронизации;
+	- любой блок можно получить сразу, не генерируя предыдущие (Seek());
+	- массовое заполнение массивов (FillRandomGaussian() и т.п.) выполняется в нескольких нитях,
+		а результат зависит только от seed, stream и позиции потока, но не от количества нитей.
+
+	Функции RandomUniformF64(), RandomGaussian() и т.п. из StatisticUtils.h используют
+	ThreadRandomStream() -- отдельный поток генератора для каждой нити OpenMP.
+
+	~~~~
+	RandomStream	stream(2021);	// воспроизводимая последовательность
+	RealFunctionMD_F32	noise({100, 512, 512});
+	FillRandomGaussian(noise, 0, 10, stream);
+
+	#pragma omp parallel for
+	for(ptrdiff_t i = 0; i < n; ++i)
+	{
+		RandomStream	task_stream = stream.Split(i);	// не зависит от распределения задач по нитям
+		...
+	}
+	~~~~
+*/
+//--------------------------------------------------------------
+
+#include <XRADBasic/Sources/Containers/DataArrayMD.h>
+#include <XRADBasic/Sources/Containers/ParallelApply.h>
+#include <cmath>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+namespace RandomStreamAuxiliaries
+{
+
+//! \brief Блок Philox4x32-10: counter -- номер блока и номер потока, key -- ключ
+inline void	philox4x32(uint32_t counter[4], uint64_t key)
+{
+	uint32_t	k0 = uint32_t(key), k1 = uint32_t(key >> 32);
+	uint32_t	c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+	for(int round = 0; round < 10; ++round)
+	{
+		uint64_t	p0 = uint64_t(0xD2511F53u)*c0;
+		uint64_t	p1 = uint64_t(0xCD9E8D57u)*c2;
+		c0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+		c1 = uint32_t(p1);
+		c2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+		c3 = uint32_t(p0);
+		k0 += 0x9E3779B9u;
+		k1 += 0xBB67AE85u;
+	}
+	counter[0] = c0;
+	counter[1] = c1;
+	counter[2] = c2;
+	counter[3] = c3;
+}
+
+//! \brief Число в диапазоне [0, 1) из старших 53 бит
+inline double	uniform_co(uint32_t hi, uint32_t lo)
+{
+	return double(((uint64_t(hi) << 32) | lo) >> 11)*(1./9007199254740992.);
+}
+
+//! \brief Число в диапазоне (0, 1] из старших 53 бит (для логарифма)
+inline double	uniform_oc(uint32_t hi, uint32_t lo)
+{
+	return double((((uint64_t(hi) << 32) | lo) >> 11) + 1)*(1./9007199254740992.);
+}
+
+} // namespace RandomStreamAuxiliaries
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Поток псевдослучайных чисел, определяемый ключом seed и номером stream
+
+	Объект хранит только ключ, номер потока и позицию (номер следующего блока), копирование дешево.
+	Один объект нельзя одновременно использовать из нескольких нитей; разные объекты -- можно.
+*/
+class RandomStream
+{
+	public:
+		explicit RandomStream(uint64_t seed, uint64_t stream = 0): m_seed(seed), m_stream(stream) {}
+
+		uint64_t	seed() const { return m_seed; }
+		uint64_t	stream() const { return m_stream; }
+		//! \brief Номер следующего блока
+		uint64_t	position() const { return m_position; }
+
+		//! \brief Переход к блоку с номером position
+		void	Seek(uint64_t position) { m_position = position; m_words_left = 0; m_has_spare_gaussian = false; }
+
+		/*!
+			\brief Дочерний поток с номером index
+
+			Дочерние потоки с разными index независимы между собой и от исходного потока.
+			Удобно для параллельных задач: поток задачи определяется ее номером, а не номером нити.
+		*/
+		RandomStream	Split(uint64_t index) const;
+
+		//! \brief Блок из 4 32-битных чисел с номером position, состояние потока не меняется
+		void	Block(uint64_t position, uint32_t result[4]) const
+		{
+			result[0] = uint32_t(position);
+			result[1] = uint32_t(position >> 32);
+			result[2] = uint32_t(m_stream);
+			result[3] = uint32_t(m_stream >> 32);
+			RandomStreamAuxiliaries::philox4x32(result, m_seed);
+		}
+
+		//! \brief Зарезервировать n_blocks блоков (например, для массового заполнения). Возвращает номер первого
+		uint64_t	Reserve(uint64_t n_blocks)
+		{
+			uint64_t	first = m_position;
+			m_position += n_blocks;
+			m_words_left = 0;
+			return first;
+		}
+
+		uint32_t	GenerateUI32()
+		{
+			if(!m_words_left)
+			{
+				Block(m_position++, m_block);
+				m_words_left = 4;
+			}
+			return m_block[4 - m_words_left--];
+		}
+
+		uint64_t	GenerateUI64()
+		{
+			uint64_t	hi = GenerateUI32();
+			return (hi << 32) | GenerateUI32();
+		}
+
+		//! \brief Равномерное распределение [0, 1)
+		double	UniformF64()
+		{
+			uint32_t	hi = GenerateUI32();
+			return RandomStreamAuxiliaries::uniform_co(hi, GenerateUI32());
+		}
+
+		//! \brief Равномерное распределение [min, max)
+		double	UniformF64(double min, double max) { return min + (max - min)*UniformF64(); }
+
+		//! \brief Стандартное нормальное распределение (преобразование Бокса-Мюллера)
+		double	GaussianStandard();
+
+	private:
+		uint64_t	m_seed;
+		uint64_t	m_stream;
+		uint64_t	m_position = 0;
+
+		uint32_t	m_block[4];
+		size_t	m_words_left = 0;
+
+		bool	m_has_spare_gaussian = false;
+		double	m_spare_gaussian = 0;
+};
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Ключ генератора по умолчанию: без вызова SetRandomSeed() программа при каждом запуске получает одни и те же числа
+
+	Это только воспроизводимость между запусками: последовательности Philox не совпадают
+	с шумом, который давали прежние генераторы (Фибоначчи), ни при каком ключе.
+*/
+constexpr uint64_t default_random_seed = 0x5DEECE66Dull;
+
+/*!
+	\brief Поток генератора текущей нити
+
+	В нити OpenMP с номером omp_get_thread_num() != 0 поток имеет ключ RandomSeed() и этот номер,
+	поэтому последовательности не зависят от того, какая нить обратилась к генератору первой.
+	Главная нить программы (и вне параллельных участков, и как нить 0) использует поток 0.
+
+	Остальные нити с omp_get_thread_num() == 0, в том числе созданные std::thread, получают
+	собственные потоки с номерами из отдельного диапазона, в порядке первого обращения.
+	Их последовательности различны, но какая нить получит какую, не определено;
+	для воспроизводимости таким нитям следует использовать ThreadRandomStream(stream_id).
+	Так же следует поступать, если параллельные участки OpenMP выполняются одновременно
+	из нескольких нитей: номера нитей в них совпадают.
+*/
+RandomStream	&ThreadRandomStream();
+
+/*!
+	\brief Поток генератора текущей нити с номером stream_id, заданным вызывающим
+
+	Для нитей, созданных не средствами OpenMP (в них omp_get_thread_num() == 0):
+	каждой такой нити следует передавать собственный номер. При смене номера поток
+	создается заново.
+*/
+RandomStream	&ThreadRandomStream(uint64_t stream_id);
+
+//! \brief Установить ключ генератора для всех нитей. Потоки нитей создаются заново при следующем обращении
+void	SetRandomSeed(uint64_t seed);
+
+//! \brief Ключ генератора. По умолчанию default_random_seed
+uint64_t	RandomSeed();
+
+//--------------------------------------------------------------
+
+namespace RandomStreamAuxiliaries
+{
+
+enum class noise_distribution
+{
+	uniform,	//!< a + (b-a)*u, u из [0, 1)
+	gaussian,	//!< a + b*g, g -- стандартная нормальная величина
+	rayleigh,	//!< распределение Рэлея с параметром b
+	rician	//!< распределение Райса со смещением a и параметром b
+};
+
+struct noise_parameters
+{
+	noise_distribution	distribution;
+	double	a;
+	double	b;
+};
+
+//! \brief Количество блоков генератора для n_elements значений
+uint64_t	NoiseBlocks(noise_distribution distribution, uint64_t n_elements);
+
+/*!
+	\brief Значения с номерами first, ..., first + n - 1 из массива, для которого зарезервированы
+	блоки потока, начиная с base
+
+	Значение зависит только от потока, base и своего номера, поэтому части массива можно
+	вычислять в любом порядке и в разных нитях.
+*/
+void	GenerateNoise(double *result, size_t n, const RandomStream &stream, uint64_t base, uint64_t first,
+		const noise_parameters &parameters);
+
+//! \brief Количество значений, вычисляемых за один вызов GenerateNoise() при заполнении массивов
+constexpr size_t noise_chunk_size = 1024;
+
+//! \brief Массивы с меньшим количеством элементов заполняются в одной нити
+constexpr size_t noise_parallel_min_elements = size_t(1) << 14;
+
+template <class Iterator>
+void	FillNoiseRange(Iterator it, size_t count, const RandomStream &stream, uint64_t base, uint64_t first,
+		const noise_parameters &parameters)
+{
+	typedef typename iterator_traits<Iterator>::value_type value_type;
+	double	buffer[noise_chunk_size];
+	for(size_t done = 0; done < count;)
+	{
+		size_t	n = min(noise_chunk_size, count - done);
+		GenerateNoise(buffer, n, stream, base, first + done, parameters);
+		for(size_t i = 0; i < n; ++i, ++it)
+			*it = value_type(buffer[i]);
+		done += n;
+	}
+}
+
+/*!
+	\brief Заполнение n_parts частей массива из n_elements элементов
+
+	fill_part(i, fill_range) вызывает fill_range(iterator, count, first) для части i,
+	first -- номер первого элемента части в массиве.
+*/
+template <class F>
+void	FillNoiseParts(size_t n_parts, size_t n_elements, const F &fill_part, RandomStream &stream,
+		const noise_parameters &parameters)
+{
+	uint64_t	base = stream.Reserve(NoiseBlocks(parameters.distribution, n_elements));
+	size_t	n_threads = n_elements < noise_parallel_min_elements || omp_in_parallel() ?
+			1 : size_t(omp_get_max_threads());
+	ParallelApply::RunParts(n_parts, n_threads, [&](size_t i)
+		{
+			fill_part(i, [&](auto it, size_t count, size_t first)
+			{
+				FillNoiseRange(it, count, stream, base, first, parameters);
+			});
+		},
+		"FillRandom");
+}
+
+template <class T>
+void	FillNoise(DataArray<T> &array, RandomStream &stream, const noise_parameters &parameters)
+{
+	size_t	n = array.size();
+	size_t	part_size = noise_parallel_min_elements;
+	FillNoiseParts((n + part_size - 1)/part_size, n, [&](size_t i, const auto &fill_range)
+		{
+			size_t	first = i*part_size;
+			fill_range(array.begin() + first, min(part_size, n - first), first);
+		},
+		stream, parameters);
+}
+
+template <class T>
+void	FillNoise(DataArray2D<T> &array, RandomStream &stream, const noise_parameters &parameters)
+{
+	size_t	hs = array.hsize();
+	FillNoiseParts(array.vsize(), array.vsize()*hs, [&](size_t i, const auto &fill_range)
+		{
+			fill_range(array.row(i).begin(), hs, i*hs);
+		},
+		stream, parameters);
+}
+
+template <class A2DT>
+void	FillNoise(DataArrayMD<A2DT> &array, RandomStream &stream, const noise_parameters &parameters)
+{
+	size_t	n_dimensions = array.n_dimensions();
+	size_t	row_size = array.sizes(n_dimensions - 1);
+	size_t	n_rows = 1;
+	for(size_t i = 0; i + 1 < n_dimensions; ++i)
+		n_rows *= array.sizes(i);
+	FillNoiseParts(row_size ? n_rows : 0, n_rows*row_size, [&](size_t i, const auto &fill_range)
+		{
+			// индекс строки: последний индекс меняется быстрее всего
+			index_vector	iv(n_dimensions);
+			iv[n_dimensions - 1] = slice_mask(0);
+			for(size_t j = n_dimensions - 1, rest = i; j-- > 0;)
+			{
+				iv[j] = rest % array.sizes(j);
+				rest /= array.sizes(j);
+			}
+			auto	row = array.GetRow(iv);
+			fill_range(row.begin(), row_size, i*row_size);
+		},
+		stream, parameters);
+}
+
+} // namespace RandomStreamAuxiliaries
+
+//--------------------------------------------------------------
+
+/*!
+	\name Заполнение массивов (DataArray, DataArray2D, DataArrayMD и наследников) случайными значениями
+
+	Элементы нумеруются в порядке хранения (последний индекс меняется быстрее всего),
+	значение элемента определяется потоком и своим номером. Заполнение больших массивов
+	выполняется в нескольких нитях; результат от количества нитей не зависит.
+	Поток stream продвигается на количество использованных блоков.
+	@{
+*/
+
+//! \brief Равномерное распределение [min, max)
+template <class ARR>
+void	FillRandomUniform(ARR &array, double min, double max, RandomStream &stream = ThreadRandomStream())
+{
+	using namespace RandomStreamAuxiliaries;
+	FillNoise(array, stream, noise_parameters{noise_distribution::uniform, min, max});
+}
+
+//! \brief Нормальное распределение с математическим ожиданием mean и СКО sigma
+template <class ARR>
+void	FillRandomGaussian(ARR &array, double mean, double sigma, RandomStream &stream = ThreadRandomStream())
+{
+	using namespace RandomStreamAuxiliaries;
+	FillNoise(array, stream, noise_parameters{noise_distribution::gaussian, mean, sigma});
+}
+
+//! \brief Распределение Рэлея (модуль комплексного гауссова шума с СКО компонент sigma), см. rayleigh_pdf()
+template <class ARR>
+void	FillRandomRayleigh(ARR &array, double sigma, RandomStream &stream = ThreadRandomStream())
+{
+	using namespace RandomStreamAuxiliaries;
+	FillNoise(array, stream, noise_parameters{noise_distribution::rayleigh, 0, sigma});
+}
+
+//! \brief Распределение Райса (модуль сигнала nu с комплексным гауссовым шумом), см. rician_pdf()
+template <class ARR>
+void	FillRandomRician(ARR &array, double nu, double sigma, RandomStream &stream = ThreadRandomStream())
+{
+	using namespace RandomStreamAuxiliaries;
+	FillNoise(array, stream, noise_parameters{noise_distribution::rician, nu, sigma});
+}
+
+//! @}
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_RandomStream_h
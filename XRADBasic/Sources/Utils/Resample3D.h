@@ -0,0 +1,266 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_Resample3D_h
+#define XRAD__File_Resample3D_h
+/*!
+	\file
+	\brief Передискретизация трехмерных массивов: приведение к изотропному шагу, аффинные
+	преобразования, наклонные срезы (MPR)
+
+	Индексы осей соответствуют порядку индексов DataArrayMD: 0 -- номер среза (z), 1 -- строка (y),
+	2 -- столбец (x). Интерполяторы -- interpolators3D (UniversalInterpolation3D.h), их нужно
+	предварительно инициализировать вызовом Init2DInterpolators().
+
+	~~~~
+	RealFunctionMD_F32	volume = acquisition.load_ordered_slices();
+	RealFunctionMD_F32	isotropic;
+	double	spacing = ResampleIsotropic(isotropic, volume, acquisition.scales());
+
+	// наклонный срез по требованию, без вычисления всего объема
+	VolumeResampler<RealFunctionMD_F32>	mpr(volume,
+			affine_transform_3D::from_axes(origin, direction_slices, direction_v, direction_h),
+			{n_slices, 512, 512}, &interpolators3D::trilinear);
+	RealFunction2D_F32	slice;
+	mpr.GetSlice(slice, 10);
+	~~~~
+*/
+//--------------------------------------------------------------
+
+#include <XRADBasic/Sources/Containers/UniversalInterpolation3D.h>
+#include <XRADBasic/Sources/Containers/DataArrayMD.h>
+#include <XRADBasic/Sources/Containers/SpaceCoordinates.h>
+#include <XRADBasic/Sources/Containers/ParallelApply.h>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Аффинное преобразование индексов результата r в координаты исходного массива s:
+	s[i] = sum_j matrix[i][j]*r[j] + offset[i]
+
+	По умолчанию тождественное.
+*/
+struct	affine_transform_3D
+{
+	double	matrix[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+	double	offset[3] = {0, 0, 0};
+
+	point3_F64	operator()(double r0, double r1, double r2) const
+	{
+		return point3_F64(
+				matrix[0][0]*r0 + matrix[0][1]*r1 + matrix[0][2]*r2 + offset[0],
+				matrix[1][0]*r0 + matrix[1][1]*r1 + matrix[1][2]*r2 + offset[1],
+				matrix[2][0]*r0 + matrix[2][1]*r1 + matrix[2][2]*r2 + offset[2]);
+	}
+
+	//! \brief Растяжение по осям: s[i] = factors[i]*r[i] + shift[i]
+	static	affine_transform_3D	scaling(const point3_F64 &factors, const point3_F64 &shift = point3_F64(0))
+	{
+		affine_transform_3D	result;
+		for(size_t i = 0; i < 3; ++i)
+		{
+			result.matrix[i][i] = factors[i];
+			result.offset[i] = shift[i];
+		}
+		return result;
+	}
+
+	/*!
+		\brief Преобразование, заданное направлениями осей результата в координатах исходного массива:
+		s = origin + r0*axis0 + r1*axis1 + r2*axis2
+
+		Для наклонных срезов (MPR) axis1, axis2 -- направления строк и столбцов плоскости среза,
+		axis0 -- шаг между соседними срезами.
+	*/
+	static	affine_transform_3D	from_axes(const point3_F64 &origin, const point3_F64 &axis0, const point3_F64 &axis1, const point3_F64 &axis2)
+	{
+		affine_transform_3D	result;
+		for(size_t i = 0; i < 3; ++i)
+		{
+			result.matrix[i][0] = axis0[i];
+			result.matrix[i][1] = axis1[i];
+			result.matrix[i][2] = axis2[i];
+			result.offset[i] = origin[i];
+		}
+		return result;
+	}
+};
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Вычисление результата аффинного преобразования трехмерного массива по срезам
+
+	Объект ссылается на исходный массив, который должен существовать, пока используется объект.
+	Срезы результата вычисляются по требованию (GetSlice), что позволяет показывать наклонные
+	срезы, не вычисляя весь объем. GetVolume вычисляет весь результат.
+
+	Вычисления выполняются параллельно блоками строк (tile_rows строк одного среза).
+*/
+template<class ARR_SOURCE>
+class	VolumeResampler
+{
+	public:
+		typedef	typename ARR_SOURCE::value_type value_type;
+
+		//! \brief Количество строк в блоке, обрабатываемом одним потоком
+		static	const	size_t	tile_rows = 16;
+
+		VolumeResampler(const ARR_SOURCE &source, const affine_transform_3D &transform, const index_vector &result_sizes,
+				const SeparableInterpolator3D *interpolator);
+
+		const index_vector	&sizes() const { return m_sizes; }
+		const affine_transform_3D	&transform() const { return m_transform; }
+
+		//! \brief Срез k результата; размер slice устанавливается равным (sizes()[1], sizes()[2])
+		template<class A2D>
+		void	GetSlice(A2D &slice, size_t k) const;
+
+		//! \brief Весь результат; размер устанавливается равным sizes()
+		template<class ARR_RESULT>
+		void	GetVolume(ARR_RESULT &result) const;
+
+	private:
+		volume_view_3D<value_type>	m_source;
+		affine_transform_3D	m_transform;
+		index_vector	m_sizes;
+		const SeparableInterpolator3D	*m_interpolator;
+
+		template<class ROW>
+		void	FillRow(ROW &row, size_t k, size_t i) const;
+};
+
+//--------------------------------------------------------------
+
+template<class ARR_SOURCE>
+VolumeResampler<ARR_SOURCE>::VolumeResampler(const ARR_SOURCE &source, const affine_transform_3D &transform,
+		const index_vector &result_sizes, const SeparableInterpolator3D *interpolator):
+	m_source(MakeVolumeView(source)),
+	m_transform(transform),
+	m_sizes(result_sizes),
+	m_interpolator(interpolator)
+{
+	if(m_sizes.size() != 3)
+	{
+		throw invalid_argument(ssprintf("VolumeResampler: 3D result expected, got %zu dimensions",
+				EnsureType<size_t>(m_sizes.size())));
+	}
+	XRAD_ASSERT_THROW(m_interpolator);
+	// поправку интерполятора учитываем в преобразовании один раз, а не в каждой точке
+	m_interpolator->ApplyOffsetCorrection(m_transform.offset[0], m_transform.offset[1], m_transform.offset[2]);
+}
+
+template<class ARR_SOURCE>
+template<class ROW>
+void	VolumeResampler<ARR_SOURCE>::FillRow(ROW &row, size_t k, size_t i) const
+{
+	const auto	&m = m_transform.matrix;
+	const auto	&o = m_transform.offset;
+	double	c0 = m[0][0]*k + m[0][1]*i + o[0];
+	double	c1 = m[1][0]*k + m[1][1]*i + o[1];
+	double	c2 = m[2][0]*k + m[2][1]*i + o[2];
+	auto	it = row.begin();
+	for(size_t j = 0; j < row.size(); ++j, ++it)
+	{
+		// координаты вычисляются заново, а не накапливаются, чтобы не копить ошибку округления
+		*it = m_interpolator->Apply(m_source, c0 + m[0][2]*j, c1 + m[1][2]*j, c2 + m[2][2]*j);
+	}
+}
+
+template<class ARR_SOURCE>
+template<class A2D>
+void	VolumeResampler<ARR_SOURCE>::GetSlice(A2D &slice, size_t k) const
+{
+	if(slice.vsize() != m_sizes[1] || slice.hsize() != m_sizes[2])
+		slice.realloc(m_sizes[1], m_sizes[2]);
+	const size_t	n_tiles = (m_sizes[1] + tile_rows - 1)/tile_rows;
+	ParallelApply::ProcessIndependentParts(n_tiles, m_sizes[1]*m_sizes[2], [&](size_t n)
+		{
+			for(size_t i = n*tile_rows; i < min((n + 1)*tile_rows, m_sizes[1]); ++i)
+				FillRow(slice.row(i), k, i);
+		},
+		"VolumeResampler::GetSlice");
+}
+
+template<class ARR_SOURCE>
+template<class ARR_RESULT>
+void	VolumeResampler<ARR_SOURCE>::GetVolume(ARR_RESULT &result) const
+{
+	if(result.sizes() != m_sizes)
+		result.realloc(m_sizes);
+	const size_t	tiles_per_slice = (m_sizes[1] + tile_rows - 1)/tile_rows;
+	ParallelApply::ProcessIndependentParts(m_sizes[0]*tiles_per_slice, m_sizes[0]*m_sizes[1]*m_sizes[2], [&](size_t n)
+		{
+			size_t	k = n/tiles_per_slice;
+			size_t	first_row = (n%tiles_per_slice)*tile_rows;
+			for(size_t i = first_row; i < min(first_row + tile_rows, m_sizes[1]); ++i)
+			{
+				auto	row = result.GetRow({k, i, slice_mask(0)});
+				FillRow(row, k, i);
+			}
+		},
+		"VolumeResampler::GetVolume");
+}
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Аффинное преобразование трехмерного массива: result(r) = source(transform(r))
+
+	Размеры результата задаются заранее.
+*/
+template<class ARR_RESULT, class ARR_SOURCE>
+void	Resample(ARR_RESULT &result, const ARR_SOURCE &source, const affine_transform_3D &transform,
+		const SeparableInterpolator3D *interpolator = &interpolators3D::trilinear)
+{
+	VolumeResampler<ARR_SOURCE>(source, transform, result.sizes(), interpolator).GetVolume(result);
+}
+
+/*!
+	\brief Приведение трехмерного массива к одинаковому шагу spacing по всем осям
+
+	\param scales Шаги исходного массива по осям (например, TomogramAcquisition::scales()).
+	\param spacing Шаг результата; если 0, берется наименьший из scales.
+	\return Шаг результата.
+
+	Первый отсчет результата совпадает с первым отсчетом исходного массива,
+	последний не выходит за пределы исходного массива.
+*/
+template<class ARR_RESULT, class ARR_SOURCE>
+double	ResampleIsotropic(ARR_RESULT &result, const ARR_SOURCE &source, const point3_F64 &scales, double spacing = 0,
+		const SeparableInterpolator3D *interpolator = &interpolators3D::trilinear)
+{
+	if(!spacing)
+		spacing = min(scales[0], min(scales[1], scales[2]));
+	if(!(spacing > 0) || !(scales[0] > 0) || !(scales[1] > 0) || !(scales[2] > 0))
+	{
+		throw invalid_argument(ssprintf("ResampleIsotropic: invalid scales (%g, %g, %g) or spacing %g",
+				EnsureType<double>(scales[0]), EnsureType<double>(scales[1]), EnsureType<double>(scales[2]),
+				EnsureType<double>(spacing)));
+	}
+	if(source.n_dimensions() != 3)
+	{
+		throw invalid_argument(ssprintf("ResampleIsotropic: 3D array expected, got %zu dimensions",
+				EnsureType<size_t>(source.n_dimensions())));
+	}
+	index_vector	sizes(3);
+	point3_F64	factors;
+	for(size_t i = 0; i < 3; ++i)
+	{
+		factors[i] = spacing/scales[i];
+		// небольшой допуск, чтобы ошибка округления не отбрасывала последний отсчет
+		sizes[i] = source.sizes(i) ? size_t(floor((source.sizes(i) - 1)/factors[i] + 1e-6)) + 1 : 0;
+	}
+	VolumeResampler<ARR_SOURCE>(source, affine_transform_3D::scaling(factors), sizes, interpolator).GetVolume(result);
+	return spacing;
+}
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_Resample3D_h
@@ -38,91 +38,287 @@ inline void PrepareSolution(MathMatrix<XRAD__MathMatrix_template_args> &m)
 	PrepareSolutionMMImpl(m, (typename MathMatrix<XRAD__MathMatrix_template_args>::field_tag*)nullptr);
 }
 
+template<class T>
+inline double DiagonalValueImpl(const T &x, AlgebraicStructures::FieldTagScalar *)
+{
+	return double(x);
+}
+
+template<class T>
+inline double DiagonalValueImpl(const T &x, AlgebraicStructures::FieldTagComplex *)
+{
+	return real(x);
+}
+
+//! \brief Действительная часть диагонального элемента эрмитовой матрицы
+template<XRAD__MathMatrix_template>
+inline double DiagonalValue(const MathMatrix<XRAD__MathMatrix_template_args> &m, size_t i)
+{
+	return DiagonalValueImpl(m.at(i,i), (typename MathMatrix<XRAD__MathMatrix_template_args>::field_tag*)nullptr);
+}
+
+//! \brief Ширина полосы столбцов, обрабатываемой без блочного умножения в LU- и LL^H-разложении
+const size_t	decomposition_block_size = 64;
+
+template<XRAD__MathMatrix_template, XRAD__MathMatrix_template1>
+void	CheckSolutionSize(const char *function_name, const MathMatrix<XRAD__MathMatrix_template_args> &solution,
+		const MathMatrix <XRAD__MathMatrix_template_args1> &matrix)
+	{
+	size_t order = matrix.vsize();
+	if(matrix.hsize() < order || matrix.hsize() - order != solution.hsize() || solution.vsize() != order)
+		{
+		string problem_description = ssprintf("%s -- Invalid matrix dimensions (%zu:%zu) or solution size (%zu,%zu)",
+				EnsureType<const char*>(function_name),
+				EnsureType<size_t>(order), EnsureType<size_t>(matrix.hsize()),
+				EnsureType<size_t>(solution.vsize()), EnsureType<size_t>(solution.hsize()));
+		ForceDebugBreak();
+		throw matrix_algorithm_error(problem_description);
+		}
+	}
+
+/*!
+	\brief Обратный ход: решение системы с верхней треугольной матрицей matrix(0..n-1, 0..n-1),
+	правые части в столбцах n..n+k-1
+
+	Результат (до PrepareSolution) пишется в solution.
+*/
+template<XRAD__MathMatrix_template, XRAD__MathMatrix_template1>
+void	SolveUpperTriangular(MathMatrix<XRAD__MathMatrix_template_args> &solution, const MathMatrix <XRAD__MathMatrix_template_args1> &matrix)
+	{
+	size_t order = matrix.vsize();
+	size_t	n_equations = solution.hsize();
+	for(size_t i = order; i-- > 0;)
+		{
+		auto	&x_row = solution.row(i);
+		for(size_t e = 0; e < n_equations; ++e)
+			x_row[e] = matrix.at(i, order + e);
+		// вычитание строк решения, умноженных на элементы i-й строки матрицы: обращения только к строкам
+		for(size_t j = i+1; j < order; ++j)
+			{
+			T1	factor = matrix.at(i,j);
+			const auto	&xj_row = solution.row(j);
+			for(size_t e = 0; e < n_equations; ++e)
+				x_row[e] -= factor*xj_row[e];
+			}
+		T	factor = T(1.) / matrix.at(i,i);
+		for(size_t e = 0; e < n_equations; ++e)
+			x_row[e] *= factor;
+		}
+	}
+
 template<XRAD__MathMatrix_template, XRAD__MathMatrix_template1>
 	void	SolveLinearSystemDestructive(MathMatrix<XRAD__MathMatrix_template_args> &solution, MathMatrix <XRAD__MathMatrix_template_args1> &matrix)
 	{
-	// простейший алгоритм решения линейной системы по методу гаусса:
+	// решение линейной системы по методу Гаусса с выбором главного элемента по столбцу;
 	// получает матрицу размером (n,n+k);
 	// на входе k правых столбцов содержат правую часть
 	// на выходе в столбцах матрицы solution размером n x k находятся k векторов решений.
-	// как-то учитывается возможное наличие нулевых коэффициентов на главной диагонали;
 	// при несовместности системы дается исключение
 	//
 	// входная матрица разрушается.
 	// эта функция используется в качестве основы для "недеструктивных" нижеобъявленных функций.
 	// также ее можно использовать самостоятельно в тех случаях, когда сохранение
 	// исходной матрицы не требуется, а дополнительное выделение памяти под буферы нежелательно.
+	//
+	// исключение выполняется блоками по decomposition_block_size столбцов: сначала полоса
+	// столбцов обрабатывается поэлементно, затем остальная часть матрицы (включая правые части)
+	// изменяется одним блочным произведением матриц (MatrixProductBlocked), которое
+	// при большом порядке выполняется в нескольких потоках.
 
-	typedef	T value_type;
+	typedef	T1 value_type;
 
+	CheckSolutionSize("SolveLinearSystemDestructive", solution, matrix);
 	size_t order = matrix.vsize();
-	size_t	n_equations = solution.hsize();
-	if(matrix.hsize() - order != n_equations || solution.vsize() != order)
-		{
-		string problem_description = ssprintf("SolveLinearSystemDestructive -- Invalid matrix dimensions (%d:%d) or solution size (%d,%d)", order, matrix.hsize(), solution.vsize(), solution.hsize());
-		ForceDebugBreak();
-		throw matrix_algorithm_error(problem_description);
-		}
+	size_t	width = matrix.hsize();
 
-	for(size_t i = 0; i < order; ++i)
+	for(size_t b0 = 0; b0 < order; b0 += decomposition_block_size)
 		{
-		// проходим по очереди все столбцы и зануляем все элементы
-		// кроме лежащего на главной диагонали.
-		// i - номер очищаемого столбца
+		size_t	b1 = min(b0 + decomposition_block_size, order);
 
-		if(!fast_norma(matrix.at(i,i)))
+		// 1. полоса столбцов b0..b1-1
+		for(size_t i = b0; i < b1; ++i)
 			{
-			// учет нулевого значения на главной диагонали: находим наибольшее по модулю значение
-			// в i-м столбце; соответствующую ему строку прибавляем к i-й строке.
-			size_t max_position = 0;
-			bool	inconsistent = false;
-			if(i==order-1) inconsistent = true;
-			else
+			// выбор наибольшего по модулю элемента i-го столбца
+			size_t	pivot = i;
+			double	max_abs = norma(matrix.at(i,i));
+			for(size_t j = i+1; j < order; ++j)
 				{
-// 				MathFunctionF64	maxfinder;
-				LinearVector<XRAD__MathMatrix_template_args1>	maxfinder;
-				maxfinder.UseDataFragment(matrix.col(i), i+1, order, 1);
-				double	max_abs = MaxAbsoluteValue(maxfinder, &max_position);
-				if(!max_abs) inconsistent = true;
-				}
-			if(inconsistent)
+				double	a = norma(matrix.at(j,i));
+				if(a > max_abs)
 					{
-					// несовместность системы уравнений. кидается особое исключение
-					string problem_description = ssprintf("SolveLinearSystemDestructive -- Linear equations system is inconsistent, matrix range is %d (order is %d)", i, order);
-					ForceDebugBreak();
-					throw matrix_algorithm_error(problem_description);
+					max_abs = a;
+					pivot = j;
 					}
+				}
+			if(!max_abs)
+				{
+				// несовместность системы уравнений. кидается особое исключение
+				string problem_description = ssprintf("SolveLinearSystemDestructive -- Linear equations system is inconsistent, matrix range is %zu (order is %zu)",
+						EnsureType<size_t>(i), EnsureType<size_t>(order));
+				ForceDebugBreak();
+				throw matrix_algorithm_error(problem_description);
+				}
+			if(pivot != i)
+				{
+				// перестановка строк целиком, вместе с правыми частями и уже вычисленными множителями
+				auto	&row_i = matrix.row(i);
+				auto	&row_p = matrix.row(pivot);
+				for(size_t k = 0; k < width; ++k)
+					std::swap(row_i[k], row_p[k]);
+				}
 
-			// прибавляем строку, содержащую наибольшее значение
-			matrix.row(i) += matrix.row(max_position+i+1);
+			value_type	inverse_pivot = value_type(1.) / matrix.at(i,i);
+			for(size_t j = i+1; j < order; ++j)
+				{
+				// множитель сохраняется на месте исключенного элемента
+				value_type	factor = matrix.at(j,i)*inverse_pivot;
+				matrix.at(j,i) = factor;
+				for(size_t k = i+1; k < b1; ++k)
+					matrix.at(j,k) -= factor*matrix.at(i,k);
+				}
 			}
 
-		MathMatrix<XRAD__MathMatrix_template_args1>	sub;
-		sub.UseDataFragment(matrix, 0, i+1, order, matrix.hsize());
-		LinearVector<XRAD__MathMatrix_template_args1>	sub_decrement(matrix.hsize()-(i+1));
+		// 2. строки b0..b1-1 правее полосы (включая правые части): исключение внутри полосы
+		for(size_t i = b0; i < b1; ++i)
+			{
+			auto	&row_i = matrix.row(i);
+			for(size_t j = i+1; j < b1; ++j)
+				{
+				value_type	factor = matrix.at(j,i);
+				auto	&row_j = matrix.row(j);
+				for(size_t k = b1; k < width; ++k)
+					row_j[k] -= factor*row_i[k];
+				}
+			}
 
-		for(size_t j = 0; j < order; ++j)
+		// 3. остальные строки: A22 -= L21*U12
+		if(b1 < order)
 			{
-			if(j!=i)
+			auto	l21 = MatrixProductBlocked::MakeMatrixView(matrix, b1, b0);
+			auto	u12 = MatrixProductBlocked::MakeMatrixView(matrix, b0, b1);
+			auto	a22 = MatrixProductBlocked::MakeMatrixView(matrix, b1, b1);
+			MatrixProductBlocked::Multiply<value_type>(order - b1, width - b1, b1 - b0, l21, u12,
+					MatrixProductBlocked::plain_madd(),
+					[&a22](size_t i, size_t j, const value_type &s){ a22(i, j) -= s; });
+			}
+		}
+
+	SolveUpperTriangular(solution, matrix);
+	//для комплексных матриц получается сопряженное решение. "выпрямляем" его
+	PrepareSolution(solution);
+	}
+
+template<XRAD__MathMatrix_template, XRAD__MathMatrix_template1>
+	void	SolvePositiveDefiniteDestructive(MathMatrix<XRAD__MathMatrix_template_args> &solution, MathMatrix <XRAD__MathMatrix_template_args1> &matrix)
+	{
+	// решение линейной системы с симметричной (эрмитовой) положительно определенной матрицей
+	// разложением Холецкого A = L*L^H. формат данных такой же, как у SolveLinearSystemDestructive:
+	// матрица (n,n+k), k правых столбцов содержат правые части.
+	//
+	// используется только нижний треугольник матрицы (включая диагональ);
+	// на выходе в нем находится L. требует вдвое меньше действий, чем SolveLinearSystemDestructive.
+	// если матрица не является положительно определенной, дается исключение
+
+	typedef	T1 value_type;
+
+	CheckSolutionSize("SolvePositiveDefiniteDestructive", solution, matrix);
+	size_t order = matrix.vsize();
+	size_t	width = matrix.hsize();
+	size_t	n_equations = width - order;
+
+	for(size_t b0 = 0; b0 < order; b0 += decomposition_block_size)
+		{
+		size_t	b1 = min(b0 + decomposition_block_size, order);
+
+		// 1. диагональный блок и правые части строк b0..b1-1 (прямой ход L*y = b)
+		for(size_t i = b0; i < b1; ++i)
+			{
+			auto	&row_i = matrix.row(i);
+			for(size_t j = b0; j < i; ++j)
+				{
+				auto	&row_j = matrix.row(j);
+				// L(i,j) = (A(i,j) - sum L(i,k)*conj(L(j,k))) / L(j,j)
+				value_type	s(0);
+				for(size_t k = b0; k < j; ++k)
+					scalar_product_action(s, row_i[k], row_j[k]);
+				row_i[j] = (row_i[j] - s) / row_j[j];
+				}
+			double	d = DiagonalValue(matrix, i);
+			for(size_t k = b0; k < i; ++k)
+				d -= quadratic_norma(row_i[k]);
+			if(!(d > 0))
 				{
-				sub_decrement.CopyData(sub.row(i));
-//				double factor = matrix[j,i]/matrix[i,i];
-				value_type factor = matrix.at(j,i)/matrix.at(i,i);
-				sub_decrement *= factor;
-				sub.row(j) -= sub_decrement;
-				matrix.at(j,i) = 0;
+				string problem_description = ssprintf("SolvePositiveDefiniteDestructive -- Matrix is not positive definite (diagonal element %zu, order is %zu)",
+						EnsureType<size_t>(i), EnsureType<size_t>(order));
+				ForceDebugBreak();
+				throw matrix_algorithm_error(problem_description);
 				}
+			row_i[i] = value_type(sqrt(d));
+
+			for(size_t j = b0; j < i; ++j)
+				{
+				value_type	factor = row_i[j];
+				const auto	&row_j = matrix.row(j);
+				for(size_t k = order; k < width; ++k)
+					row_i[k] -= factor*row_j[k];
+				}
+			value_type	inverse_diagonal = value_type(1./sqrt(d));
+			for(size_t k = order; k < width; ++k)
+				row_i[k] *= inverse_diagonal;
+			}
+
+		if(b1 == order)
+			break;
+
+		// 2. столбцы b0..b1-1 ниже диагонального блока: L21 = A21 * L11^(-H). строки независимы
+		auto	l11 = MatrixProductBlocked::MakeMatrixView(matrix, b0, b0);
+		auto	l21 = MatrixProductBlocked::MakeMatrixView(matrix, b1, b0);
+		ParallelApply::ProcessIndependentParts(order - b1, (order - b1)*square(b1 - b0)/2, [&](size_t i)
+				{
+				for(size_t j = 0; j < b1 - b0; ++j)
+					{
+					value_type	s(0);
+					for(size_t k = 0; k < j; ++k)
+						scalar_product_action(s, l21(i, k), l11(j, k));
+					l21(i, j) = (l21(i, j) - s) / l11(j, j);
+					}
+				},
+				"SolvePositiveDefiniteDestructive");
+
+		// 3. A22 -= L21*L21^H (нижний треугольник), правые части: b2 -= L21*y1
+		auto	a22 = MatrixProductBlocked::MakeMatrixView(matrix, b1, b1);
+		MatrixProductBlocked::Multiply<value_type>(order - b1, order - b1, b1 - b0, l21,
+				[&l21](size_t k, size_t j){ return l21(j, k); },
+				MatrixProductBlocked::scalar_product_madd(),
+				[&a22](size_t i, size_t j, const value_type &s){ if(j <= i) a22(i, j) -= s; },
+				true);
+		if(n_equations)
+			{
+			auto	y1 = MatrixProductBlocked::MakeMatrixView(matrix, b0, order);
+			auto	b2 = MatrixProductBlocked::MakeMatrixView(matrix, b1, order);
+			MatrixProductBlocked::Multiply<value_type>(order - b1, n_equations, b1 - b0, l21, y1,
+					MatrixProductBlocked::plain_madd(),
+					[&b2](size_t i, size_t j, const value_type &s){ b2(i, j) -= s; });
 			}
 		}
-	for(size_t i = 0; i < order; ++i)
+
+	// обратный ход L^H*x = y
+	for(size_t i = order; i-- > 0;)
 		{
-		value_type	factor = value_type(1.) / matrix.at(i,i);
-		for(size_t j = 0; j < n_equations; ++j)
+		auto	&x_row = solution.row(i);
+		for(size_t e = 0; e < n_equations; ++e)
+			x_row[e] = matrix.at(i, order + e);
+		for(size_t j = i+1; j < order; ++j)
 			{
-			solution.at(i,j) = matrix.at(i,j+order) * factor;
+			// элемент L^H(i,j) = conj(L(j,i))
+			const auto	&xj_row = solution.row(j);
+			for(size_t e = 0; e < n_equations; ++e)
+				scalar_product_action(x_row[e], -xj_row[e], matrix.at(j,i));
 			}
+		T	factor = T(1.) / matrix.at(i,i);
+		for(size_t e = 0; e < n_equations; ++e)
+			x_row[e] *= factor;
 		}
-	//для комплексных матриц получается сопряженное решение. "выпрямляем" его
 	PrepareSolution(solution);
 	}
 
@@ -140,6 +336,41 @@ void	SolveLinearSystemDestructive(LinearVector<XRAD__LinearVector_template_args>
 	SolveLinearSystemDestructive(matrix_solution, in_matrix);
 	}
 
+template<XRAD__LinearVector_template, XRAD__MathMatrix_template1>
+void	SolvePositiveDefiniteDestructive(LinearVector<XRAD__LinearVector_template_args> &solution,
+		MathMatrix <XRAD__MathMatrix_template_args1> &in_matrix)
+	{
+	// то же для одной правой части: in_matrix размером n x n+1
+	MathMatrix<XRAD__MathMatrix_template_args1> matrix_solution;
+	size_t	order = solution.size();
+	matrix_solution.UseData(&solution.at(0), order, 1, solution.step(), order*solution.step());
+	SolvePositiveDefiniteDestructive(matrix_solution, in_matrix);
+	}
+
+//! \brief Матрица (n, n+k), составленная из матрицы системы n x n и k столбцов правых частей
+template<XRAD__MathMatrix_template, XRAD__MathMatrix_template1, class RIGHT_PART>
+void	MakeAugmentedMatrix(MathMatrix<XRAD__MathMatrix_template_args> &matrix,
+		const MathMatrix <XRAD__MathMatrix_template_args1> &in_matrix,
+		const RIGHT_PART &right_part, size_t n_equations, const char *function_name)
+	{
+	size_t order = in_matrix.vsize();
+	if(in_matrix.hsize() != order || right_part.vsize() != order || right_part.hsize() != n_equations)
+		{
+		string problem_description = ssprintf("%s -- Invalid matrix dimensions (%zu:%zu) or right part size (%zu,%zu)",
+				EnsureType<const char*>(function_name),
+				EnsureType<size_t>(in_matrix.vsize()), EnsureType<size_t>(in_matrix.hsize()),
+				EnsureType<size_t>(right_part.vsize()), EnsureType<size_t>(right_part.hsize()));
+		ForceDebugBreak();
+		throw matrix_algorithm_error(problem_description);
+		}
+	matrix.realloc(order, order + n_equations);
+	for(size_t i = 0; i < order; ++i)
+		{
+		matrix.row(i).GetDataFragment(0, order).CopyData(in_matrix.row(i));
+		matrix.row(i).GetDataFragment(order, order + n_equations).CopyData(right_part.row(i));
+		}
+	}
+
 }//namespace SolveLinearSystemNS
 
 
@@ -243,6 +474,37 @@ void	SolveLinearSystem(LinearVector<XRAD__LinearVector_template_args> &solution,
 	SolveLinearSystemNS::SolveLinearSystemDestructive(solution, matrix);
 	}
 
+/*!
+	\brief Решение k линейных систем с симметричной (эрмитовой) положительно определенной матрицей
+	(например, нормальных уравнений метода наименьших квадратов)
+
+	in_matrix размером n x n, right_part размером n x k, solution размером n x k.
+	Используется разложение Холецкого; читается только нижний треугольник in_matrix.
+	Если матрица не является положительно определенной, дается исключение matrix_algorithm_error.
+*/
+template<XRAD__MathMatrix_template, XRAD__MathMatrix_template1, XRAD__MathMatrix_template2>
+void	SolvePositiveDefinite(MathMatrix<XRAD__MathMatrix_template_args> &solution,
+		const MathMatrix <XRAD__MathMatrix_template_args1> &in_matrix,
+		const MathMatrix <XRAD__MathMatrix_template_args2> &right_part)
+	{
+	MathMatrix <XRAD__MathMatrix_template_args>	matrix;
+	SolveLinearSystemNS::MakeAugmentedMatrix(matrix, in_matrix, right_part, right_part.hsize(), "SolvePositiveDefinite");
+	SolveLinearSystemNS::SolvePositiveDefiniteDestructive(solution, matrix);
+	}
+
+//! \brief То же для одной правой части
+template<XRAD__LinearVector_template, XRAD__MathMatrix_template1, XRAD__LinearVector_template2>
+void	SolvePositiveDefinite(LinearVector<XRAD__LinearVector_template_args> &solution,
+		const MathMatrix <XRAD__MathMatrix_template_args1> &in_matrix,
+		const LinearVector <XRAD__LinearVector_template_args2> &right_part)
+	{
+	MathMatrix <XRAD__LinearVector_template_args>	matrix;
+	MathMatrix <XRAD__LinearVector_template_args2>	right_column(right_part.size(), 1);
+	right_column.col(0).CopyData(right_part);
+	SolveLinearSystemNS::MakeAugmentedMatrix(matrix, in_matrix, right_column, 1, "SolvePositiveDefinite");
+	SolveLinearSystemNS::SolvePositiveDefiniteDestructive(solution, matrix);
+	}
+
 XRAD_END
 
 #endif //XRAD__File_SolveLinearSystem_h
\ No newline at end of file
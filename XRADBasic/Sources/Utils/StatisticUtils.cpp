@@ -8,64 +8,36 @@
 //--------------------------------------------------------------
 #include "pre.h"
 #include "StatisticUtils.h"
-#include "FibonacciRandoms.h"
 #include <XRADBasic/Sources/Math/SpecialFunctions.h>
 
 
 XRAD_BEGIN
 
 
-namespace
-{
-const FibonacciRandomGenerator<double>	default_generator_F64(107, 378);
-const FibonacciRandomGenerator<uint32_t>	default_generator_UI32(83, 258);
-const FibonacciRandomGenerator<uint16_t>	default_generator_UI16(30, 127);
-}//namespace
-
 uint16_t	RandomUniformUI16()
 {
-	return	default_generator_UI16.Generate();
+	return	uint16_t(ThreadRandomStream().GenerateUI32() >> 16);
 }
 
 uint32_t	RandomUniformUI32()
 {
-	return	default_generator_UI32.Generate();
+	return	ThreadRandomStream().GenerateUI32();
 }
 
 int16_t	RandomUniformI16()
 {
-	uint16_t	result = default_generator_UI16.Generate();
-
-#if XRAD_COMPILER_MSC
-	return result;
-#else
-	// встроенное преобразование unsigned->signed зависит от платформы.
-	// неизвестно, даст ли оно правильное заполнение всего диапазона. то, что здесь написано,
-	// как-то это делает. наверное, можно сделать лучше. подумать.
-	// то же и для 32-битного числа ниже
-	return	result < numeric_limits<int16_t>::max() ?
-		static_cast<uint16_t>(result) :
-		-static_cast<uint16_t>(result-numeric_limits<int16_t>::max());
-#endif //XRAD_COMPILER_MSC
+	return	int16_t(RandomUniformUI16());
 }
 
 int32_t	RandomUniformI32()
 {
-	uint32_t	result = default_generator_UI32.Generate();
-
-#if XRAD_COMPILER_MSC
-	return result;
-#else
-	return	result < numeric_limits<int32_t>::max() ?
-		static_cast<uint32_t>(result) :
-		-static_cast<uint32_t>(result-numeric_limits<int32_t>::max());
-#endif //XRAD_COMPILER_MSC
+	return	int32_t(RandomUniformUI32());
 }
 
 
 double RandomUniformF64()
 {
-	return default_generator_F64.Generate();
+	return ThreadRandomStream().UniformF64();
 }
 
 double RandomUniformF64(double min, double max)
@@ -87,30 +59,8 @@ double RandomUniformF64(double min, double max)
 
 double RandomGaussianStandard()
 {
-// генерируется стандартная гауссова величина с дисперсией 1 через преобразование Бокса-Мюллера.
-// чтобы избежать логарифмирования нуля, магнитуду порождаем с помощью дискретного генератора,
-// а результат его увеличиваем на 1
-
-	static const FibonacciRandomGenerator<uint32_t> &magnitude_generator(default_generator_UI32);
-	static const double	factor = 1./(double(magnitude_generator.MaxValue()) + 1.);
-
-	static double	r_exp, r, fi;
-	static bool generate = true;
-
-	if(generate)
-	{
-		r_exp = (double(magnitude_generator.Generate()) + 1.) * factor;
-		r = sqrt(-2.*log(r_exp));
-		fi = two_pi() * RandomUniformF64();
-
-		generate = false;
-		return cos(fi) * r;
-	}
-	else
-	{
-		generate = true;
-		return sin(fi) * r;
-	}
+	// состояние преобразования Бокса-Мюллера хранится в потоке генератора своей нити
+	return ThreadRandomStream().GaussianStandard();
 }
 
 
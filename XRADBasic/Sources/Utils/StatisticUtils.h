@@ -11,6 +11,7 @@
 
 #include <XRADBasic/MathFunctionTypes.h>
 #include "DistributionContainer.h"
+#include "RandomStream.h"
 
 XRAD_BEGIN
 
@@ -32,6 +33,10 @@ inline double	coin_flip()
 //	чисел в заданном диапазоне [min;max) (не включая max, требуется min<=max).
 //
 //	для плавающей запятой функция без аргументов возвращает в диапазоне [0,1)
+//
+//	функции можно вызывать одновременно из разных нитей: каждая нить использует
+//	собственный поток генератора ThreadRandomStream() (RandomStream.h).
+//	для заполнения массивов шумом см. FillRandomUniform(), FillRandomGaussian() и т.п.
 double RandomUniformF64();
 double RandomUniformF64(double min, double max);
 //
@@ -0,0 +1,160 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_Warp2D_h
+#define XRAD__File_Warp2D_h
+/*!
+	\file
+	\brief Геометрические преобразования изображения целиком: аффинное (Resample) и заданное полем координат (Warp)
+
+	Значение каждого отсчета результата интерполируется из исходного изображения в точке,
+	координаты которой задает преобразование. Строки результата обрабатываются параллельно.
+	Интерполятор -- SeparableInterpolator2D (быстрый путь) или любой UniversalInterpolator2D.
+
+	~~~~
+	RealFunction2D_F32	moved(fixed.vsize(), fixed.hsize());
+	affine_transform_2D	t;
+	t.v0 = 1.5; t.h0 = -3.25;
+	Resample(moved, moving, t, &interpolators2D::separable_bicubic);
+	~~~~
+*/
+//--------------------------------------------------------------
+
+#include <XRADBasic/Sources/Containers/UniversalInterpolation2D.h>
+#include <XRADBasic/Sources/Containers/SpaceCoordinates.h>
+#include <XRADBasic/Sources/Containers/ParallelApply.h>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Аффинное преобразование координат результата (v, h) в координаты исходного изображения:
+
+	v_source = vv*v + vh*h + v0,
+	h_source = hv*v + hh*h + h0.
+
+	По умолчанию тождественное.
+*/
+struct	affine_transform_2D
+{
+	double	vv = 1, vh = 0, v0 = 0;
+	double	hv = 0, hh = 1, h0 = 0;
+
+	affine_transform_2D(){}
+	affine_transform_2D(double in_vv, double in_vh, double in_v0, double in_hv, double in_hh, double in_h0):
+			vv(in_vv), vh(in_vh), v0(in_v0), hv(in_hv), hh(in_hh), h0(in_h0){}
+
+	point2_F64	operator()(double v, double h) const { return point2_F64(vv*v + vh*h + v0, hv*v + hh*h + h0); }
+};
+
+//--------------------------------------------------------------
+
+namespace Warp2DAuxiliaries
+{
+
+template<class A2D>
+auto	Interpolate(const A2D &source, double v, double h, const SeparableInterpolator2D *interpolator)
+{
+	interpolator->ApplyOffsetCorrection(v, h);
+	return interpolator->Apply(source, v, h);
+}
+
+//! \brief То же, что MathFunction2D::in(v, h, interpolator), для произвольного двумерного массива
+template<class A2D, class FILTER>
+auto	Interpolate(const A2D &source, double v, double h, const UniversalInterpolator2D<FILTER> *interpolator)
+{
+	interpolator->ApplyOffsetCorrection(v, h);
+	const FILTER	*filter = interpolator->GetNeededFilter(v, h);
+	return filter->Apply(source, integral_part(v), integral_part(h));
+}
+
+} // namespace Warp2DAuxiliaries
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Аффинное преобразование изображения
+
+	Размеры результата задаются заранее: result.at(v, h) = source(transform(v, h)).
+*/
+template<class A2D_RESULT, class A2D_SOURCE, class INTERPOLATOR>
+void	Resample(A2D_RESULT &result, const A2D_SOURCE &source, const affine_transform_2D &transform, const INTERPOLATOR *interpolator)
+{
+	ParallelApply::ProcessIndependentParts(result.vsize(), result.vsize()*result.hsize(), [&](size_t i)
+		{
+			auto	&row = result.row(i);
+			double	v = transform.vv*i + transform.v0;
+			double	h = transform.hv*i + transform.h0;
+			for(size_t j = 0; j < row.size(); ++j)
+			{
+				// координаты вычисляются заново, а не накапливаются, чтобы не копить ошибку округления
+				row[j] = Warp2DAuxiliaries::Interpolate(source, v + transform.vh*j, h + transform.hh*j, interpolator);
+			}
+		},
+		"Resample");
+}
+
+/*!
+	\brief Преобразование изображения, заданное полем координат
+
+	result.at(v, h) = source(v_coordinates.at(v, h), h_coordinates.at(v, h)).
+	Размеры результата устанавливаются равными размерам полей координат.
+*/
+template<class A2D_RESULT, class A2D_SOURCE, class A2D_COORDINATES, class INTERPOLATOR>
+void	Warp(A2D_RESULT &result, const A2D_SOURCE &source,
+		const A2D_COORDINATES &v_coordinates, const A2D_COORDINATES &h_coordinates,
+		const INTERPOLATOR *interpolator)
+{
+	if(v_coordinates.vsize() != h_coordinates.vsize() || v_coordinates.hsize() != h_coordinates.hsize())
+	{
+		throw invalid_argument(ssprintf("Warp: coordinate field sizes differ: (%zu, %zu) vs (%zu, %zu)",
+				EnsureType<size_t>(v_coordinates.vsize()), EnsureType<size_t>(v_coordinates.hsize()),
+				EnsureType<size_t>(h_coordinates.vsize()), EnsureType<size_t>(h_coordinates.hsize())));
+	}
+	if(result.vsize() != v_coordinates.vsize() || result.hsize() != v_coordinates.hsize())
+		result.realloc(v_coordinates.vsize(), v_coordinates.hsize());
+
+	ParallelApply::ProcessIndependentParts(result.vsize(), result.vsize()*result.hsize(), [&](size_t i)
+		{
+			auto	&row = result.row(i);
+			const auto	&v_row = v_coordinates.row(i);
+			const auto	&h_row = h_coordinates.row(i);
+			for(size_t j = 0; j < row.size(); ++j)
+			{
+				row[j] = Warp2DAuxiliaries::Interpolate(source, v_row[j], h_row[j], interpolator);
+			}
+		},
+		"Warp");
+}
+
+/*!
+	\brief Преобразование изображения, заданное полем координат (y -- координата v, x -- координата h)
+*/
+template<class A2D_RESULT, class A2D_SOURCE, class PT, class PST, class PFT, class INTERPOLATOR>
+void	Warp(A2D_RESULT &result, const A2D_SOURCE &source,
+		const DataArray2D<DataArray<point_2<PT, PST, PFT>>> &coordinates,
+		const INTERPOLATOR *interpolator)
+{
+	if(result.vsize() != coordinates.vsize() || result.hsize() != coordinates.hsize())
+		result.realloc(coordinates.vsize(), coordinates.hsize());
+
+	ParallelApply::ProcessIndependentParts(result.vsize(), result.vsize()*result.hsize(), [&](size_t i)
+		{
+			auto	&row = result.row(i);
+			const auto	&c_row = coordinates.row(i);
+			for(size_t j = 0; j < row.size(); ++j)
+			{
+				row[j] = Warp2DAuxiliaries::Interpolate(source, c_row[j].y(), c_row[j].x(), interpolator);
+			}
+		},
+		"Warp");
+}
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_Warp2D_h
@@ -0,0 +1,147 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+/*!
+	\file
+	\brief Тест: многопоточные Apply_* (ParallelApply.h) над перекрывающимися операндами
+	дают тот же результат, что и последовательный цикл
+
+	Приемник и источник -- сдвинутые друг относительно друга фрагменты одного массива.
+	Результат такой операции зависит от порядка обхода, поэтому Apply_* должны выполнять ее
+	последовательно при любом количестве потоков. Ошибка проявляется не при каждом запуске,
+	поэтому каждый случай повторяется несколько раз.
+
+	Программа возвращает 0, если все проверки пройдены.
+*/
+//--------------------------------------------------------------
+
+#include <XRADBasic/MathFunctionTypes.h>
+#include <XRADBasic/MathFunctionTypes2D.h>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace xrad;
+
+//--------------------------------------------------------------
+
+namespace
+{
+
+const size_t	n_repetitions = 10;
+
+//! \brief Количество различающихся элементов после операции op(a), выполненной в несколько потоков и в один
+template <class Array, class Operation>
+size_t	CountParallelDifferences(const Array &original, Operation op)
+{
+	Array	parallel_result(original), serial_result(original);
+	{
+		ApplyParallelThresholdScope	scope(0);
+		op(parallel_result);
+	}
+	{
+		ApplyParallelThresholdScope	scope(size_t(-1));
+		op(serial_result);
+	}
+	size_t	n_differences = 0;
+	auto	it_s = serial_result.begin();
+	for(auto it_p = parallel_result.begin(); it_p != parallel_result.end(); ++it_p, ++it_s)
+	{
+		if(*it_p != *it_s)
+			++n_differences;
+	}
+	return n_differences;
+}
+
+bool	Check(const char *test_name, size_t n_differences)
+{
+	if(n_differences)
+		printf("%s: %zu elements differ from the serial result\n", test_name, n_differences);
+	return n_differences == 0;
+}
+
+//--------------------------------------------------------------
+
+bool	TestShiftedFragments1D()
+{
+	const size_t	n = 1000000;
+	RealFunctionF64	original(n + 1);
+	for(size_t i = 0; i < original.size(); ++i)
+		original[i] = double(i%97);
+
+	bool	result = true;
+	for(size_t r = 0; r < n_repetitions; ++r)
+	{
+		// приемник после источника: последовательный цикл накапливает сумму
+		result &= Check("1D, destination after source", CountParallelDifferences(original, [n](RealFunctionF64 &a)
+			{
+				a.GetDataFragment<RealFunctionF64>(1, n + 1) += a.GetDataFragment<RealFunctionF64>(0, n);
+			}));
+		// приемник перед источником: последовательный цикл читает еще не измененные элементы
+		result &= Check("1D, destination before source", CountParallelDifferences(original, [n](RealFunctionF64 &a)
+			{
+				a.GetDataFragment<RealFunctionF64>(0, n) += a.GetDataFragment<RealFunctionF64>(1, n + 1);
+			}));
+		result &= Check("1D, three operands", CountParallelDifferences(original, [n](RealFunctionF64 &a)
+			{
+				a.GetDataFragment<RealFunctionF64>(1, n + 1).CopyData(a.GetDataFragment<RealFunctionF64>(0, n), Functors::assign());
+				RealFunctionF64	destination = a.GetDataFragment<RealFunctionF64>(1, n + 1);
+				Apply_AAA_1D_F3(destination, a.GetDataFragment<RealFunctionF64>(0, n), a.GetDataFragment<RealFunctionF64>(0, n),
+						Functors::plus_assign_multiply());
+			}));
+	}
+	return result;
+}
+
+bool	TestShiftedFragments2D()
+{
+	const size_t	vs = 1000, hs = 1000;
+	RealFunction2D_F64	original(vs + 1, hs);
+	for(size_t i = 0; i < original.vsize(); ++i)
+	{
+		for(size_t j = 0; j < hs; ++j)
+			original.at(i, j) = double((i*hs + j)%97);
+	}
+
+	bool	result = true;
+	for(size_t r = 0; r < n_repetitions; ++r)
+	{
+		result &= Check("2D, rows shifted", CountParallelDifferences(original, [](RealFunction2D_F64 &a)
+			{
+				a.GetDataFragment<RealFunction2D_F64>(1, 0, vs + 1, hs) += a.GetDataFragment<RealFunction2D_F64>(0, 0, vs, hs);
+			}));
+	}
+	return result;
+}
+
+bool	TestSameOperands()
+{
+	// совпадающие операнды перекрытием не считаются
+	const size_t	n = 1000000;
+	RealFunctionF64	original(n);
+	for(size_t i = 0; i < n; ++i)
+		original[i] = double(i%97);
+	return Check("1D, same operands", CountParallelDifferences(original, [](RealFunctionF64 &a)
+		{
+			a += a;
+		}));
+}
+
+} // namespace
+
+//--------------------------------------------------------------
+
+int	main()
+{
+	// частичное перекрытие проявляется только при нескольких потоках
+	if(omp_get_max_threads() < 4)
+		omp_set_num_threads(4);
+
+	bool	result = true;
+	result &= TestShiftedFragments1D();
+	result &= TestShiftedFragments2D();
+	result &= TestSameOperands();
+	printf(result ? "ParallelApplyAliasingTest: passed\n" : "ParallelApplyAliasingTest: FAILED\n");
+	return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -44,6 +44,8 @@
 // for compress image
 #include <dcmtk/dcmjpeg/djencode.h>
 #include <dcmtk/dcmjpeg/djrplol.h>
+// JPEG-LS
+#include <dcmtk/dcmjpls/djencode.h>
 
 // словарь тегов
 #include <dcmtk/dcmdata/dcdict.h>
@@ -22,7 +22,9 @@ namespace Dicom
 	std::mutex DCMTKDecoderJPEGLSInitialize;
 
 	size_t dcmtkCodec::numOpenedDCMTKEncoderJPEG = 0;
+	size_t dcmtkCodec::numOpenedDCMTKEncoderJPEGLS = 0;
 	std::mutex DCMTKEncoderJPEGInitialize;
+	std::mutex DCMTKEncoderJPEGLSInitialize;
 
 	dcmtkCodec::dcmtkCodec(dcmtk_codec_regime_e regime_in, const string &codec_code_string, const string &codec_code_string_current)
 		: codding_regime(regime_in), codec_type(recognizeCodecType(codec_code_string)), codec_type_coded(recognizeCodecType(codec_code_string_current))
@@ -70,15 +72,24 @@ namespace Dicom
 	{
 		switch (codec_type_in)
 		{
-		case e_jpeg_lossless: //case e_jpeg_ls_lossless:
+		case e_jpeg_lossless:
 		{
 			std::lock_guard<std::mutex> guard(DCMTKEncoderJPEGInitialize);
 			if (numOpenedDCMTKEncoderJPEG++ == 0)
-				DJEncoderRegistration::registerCodecs(); // register JPEG and JPEG-LS encoder
+				DJEncoderRegistration::registerCodecs(); // register JPEG encoder
 			break;
 		}
 
-		case e_jpeg2k:
+		case e_jpeg_ls: case e_jpeg_ls_lossless:
+		{
+			std::lock_guard<std::mutex> guard(DCMTKEncoderJPEGLSInitialize);
+			if (numOpenedDCMTKEncoderJPEGLS++ == 0)
+				DJLSEncoderRegistration::registerCodecs(); // register JPEG-LS encoder
+			break;
+		}
+
+		case e_jpeg2k: case e_jpeg2k_lossless:
+			// кодер JPEG2000 в DCMTK отсутствует, сжатие выполняется через OpenJPEG (encodePixelDataJPEG2000)
 			break;
 
 		case e_unknown: //todo (Kovbas) этот вариант, скорее всего, вообще не нужен. Т.к. если не известен, то не кодируем.
@@ -227,6 +238,27 @@ namespace Dicom
 		}
 	}
 
+	E_TransferSyntax dcmtkCodec::getEncodingTransferSyntax(e_compression_type_t encoding)
+	{
+		switch (encoding)
+		{
+		case e_uncompressed:
+			return EXS_LittleEndianExplicit;
+
+		case e_jpeg_lossless:
+			return EXS_JPEGProcess14SV1;
+
+		case e_jpeg_ls_lossless:
+			return EXS_JPEGLSLossless;
+
+		case e_jpeg2k_lossless:
+			return EXS_JPEG2000LosslessOnly;
+
+		default:
+			throw invalid_argument(ssprintf("dcmtkCodec::getEncodingTransferSyntax, invalid compression = %d. You cannot use this codec.", int(encoding)));
+		}
+	}
+
 	void dcmtkCodec::decoder_uninitializer(e_compression_type_t codec_type_in)
 	{
 		switch (codec_type_in)
@@ -255,15 +287,23 @@ namespace Dicom
 	{
 		switch (codec_type_in)
 		{
-		case e_jpeg_lossless: //case e_jpeg_ls_lossless:
+		case e_jpeg_lossless:
 		{
 			std::lock_guard<std::mutex> guard(DCMTKEncoderJPEGInitialize);
 			if (--numOpenedDCMTKEncoderJPEG == 0)
-				DJEncoderRegistration::cleanup(); // unregister JPEG and JPEG-LS encoder
+				DJEncoderRegistration::cleanup(); // unregister JPEG encoder
 		}
 		break;
 
-		case e_jpeg2k:
+		case e_jpeg_ls: case e_jpeg_ls_lossless:
+		{
+			std::lock_guard<std::mutex> guard(DCMTKEncoderJPEGLSInitialize);
+			if (--numOpenedDCMTKEncoderJPEGLS == 0)
+				DJLSEncoderRegistration::cleanup(); // unregister JPEG-LS encoder
+		}
+		break;
+
+		case e_jpeg2k: case e_jpeg2k_lossless:
 			break;
 		}
 	}
@@ -286,7 +326,7 @@ namespace Dicom
 	}
 
 	// получение изображения и декодирование его чисто средствами dcmtk (для не JPEG2000)
-	bool getPixelsConventional(DcmDataset &dcmDataset, unique_ptr<char[]> &pixeldata, size_t &vs_in, size_t &hs_in, size_t &bpp, bool &signedness, size_t &ncomp, size_t numOfFrame = 0)
+	bool getPixelsConventional(DcmDataset &dcmDataset, unique_ptr<char[]> &pixeldata, size_t &vs_in, size_t &hs_in, size_t &bpp, bool &signedness, size_t &ncomp, size_t numOfFrame = 0, bool apply_modality_transformation = true)
 	{
 		//	try
 		{
@@ -303,7 +343,10 @@ namespace Dicom
 			//при использовании, например, ключа CIF_UsePartialAccessToPixelData извлечение изображений куда быстрее, но к ним применены преобразования, которые нам не требуются
 			//note (Kovbas) последняя договорённость, что мы забираем изображения с уже применёнными преобразованиями
 			//unique_ptr<DicomImage> image(new DicomImage(&dcmDataset, xfer, CIF_IgnoreModalityTransformation, unsigned long(numOfFrame), 1 /* fcount */));
-			unique_ptr<DicomImage> image(new DicomImage(&dcmDataset, xfer, CIF_UsePartialAccessToPixelData, (unsigned long)(numOfFrame), 1 /* fcount */));
+			//для целочисленных томограмм (см. RescaledVolume) требуются исходные значения, slope и intercept применяются отдельно
+			unsigned long	flags = CIF_UsePartialAccessToPixelData;
+			if(!apply_modality_transformation) flags |= CIF_IgnoreModalityTransformation;
+			unique_ptr<DicomImage> image(new DicomImage(&dcmDataset, xfer, flags, (unsigned long)(numOfFrame), 1 /* fcount */));
 			vs_in = image->getHeight();
 			hs_in = image->getWidth();
 			ncomp = image->isMonochrome() ? 1 : 3;
@@ -369,7 +412,119 @@ namespace Dicom
 		}
 	}
 
-	bool getPixelDataAsRAW(DcmDataset &dcmDataSet, Uint8* &pixData, size_t &length, size_t numOfFrame = 0)
+	size_t encapsulated_frame::length() const
+	{
+		size_t	result = 0;
+		for(auto &fragment: fragments) result += fragment.second;
+		return result;
+	}
+
+	// таблица кадров инкапсулированных данных
+	// Элемент 0 последовательности -- Basic Offset Table, далее фрагменты. Если фрагментов столько же,
+	// сколько кадров, каждый кадр занимает один фрагмент. Иначе границы кадров определяются
+	// по Basic Offset Table (смещения отсчитываются от начала первого фрагмента, включая 8 байт заголовка каждого элемента)
+	bool getEncapsulatedFrameIndex(DcmDataset &dcmDataSet, vector<encapsulated_frame> &frames)
+	{
+		frames.clear();
+
+		DcmStack stack;
+		if (dcmDataSet.search(DCM_PixelData, stack, ESM_fromHere, OFFalse /*searchIntoSub*/).bad())
+			throw runtime_error("Pixel data not found");
+		DcmPixelData *pixelData = (DcmPixelData *)stack.top();
+		if (pixelData == nullptr) throw runtime_error("Pixel data not found");
+
+		E_TransferSyntax xfer = EXS_Unknown;
+		const DcmRepresentationParameter *repParam = nullptr;
+		pixelData->getOriginalRepresentationKey(xfer, repParam);
+		if ((xfer == EXS_Unknown) || !DcmXfer(xfer).isEncapsulated())
+			throw runtime_error("Pixel data is not encapsulated");
+
+		DcmPixelSequence *pixelSeq = nullptr;
+		if (pixelData->getEncapsulatedRepresentation(xfer, repParam, pixelSeq).bad() || (pixelSeq == nullptr))
+			throw runtime_error("Can't get encapsulated pixel data");
+
+		long n_frames = 1;
+		if (dcmDataSet.tagExists(DCM_NumberOfFrames))
+			if (dcmDataSet.findAndGetLongInt(DCM_NumberOfFrames, n_frames).bad() || n_frames < 1)
+				n_frames = 1;
+
+		size_t n_items = pixelSeq->card();
+		if (n_items < 2) throw runtime_error("Encapsulated pixel data contains no fragments");
+
+		vector<pair<const Uint8*, size_t>> fragments;
+		fragments.reserve(n_items - 1);
+		for (size_t i = 1; i < n_items; ++i)
+		{
+			DcmPixelItem* pixitem = nullptr;
+			Uint8	*data = nullptr;
+			if (pixelSeq->getItem(pixitem, Uint32(i)).bad() || pixitem == nullptr)
+				throw runtime_error(ssprintf("Can't get pixel item %zu", i));
+			if (pixitem->getUint8Array(data).bad()) throw runtime_error("Cant get RAW array");
+			fragments.emplace_back(data, size_t(pixitem->getLength()));
+		}
+
+		frames.resize(n_frames);
+
+		if (fragments.size() == size_t(n_frames))
+		{
+			for (size_t i = 0; i < fragments.size(); ++i)
+				frames[i].fragments.push_back(fragments[i]);
+			return true;
+		}
+
+		if (n_frames == 1)
+		{
+			frames[0].fragments = std::move(fragments);
+			return true;
+		}
+
+		// несколько фрагментов на кадр: нужна Basic Offset Table
+		DcmPixelItem* offset_table = nullptr;
+		Uint8	*offset_data = nullptr;
+		if (pixelSeq->getItem(offset_table, 0).bad() || offset_table == nullptr ||
+				offset_table->getLength() < n_frames*sizeof(Uint32) || offset_table->getUint8Array(offset_data).bad())
+		{
+			throw runtime_error(ssprintf("Can't determine frame boundaries: %zu fragments, %ld frames, no offset table",
+					fragments.size(), n_frames));
+		}
+
+		size_t	fragment_offset = 0;
+		size_t	frame_no = 0;
+		for (auto &fragment: fragments)
+		{
+			// ищем последний кадр, начинающийся не позже текущего фрагмента
+			while (frame_no + 1 < size_t(n_frames))
+			{
+				Uint32	next_frame_offset;
+				memcpy(&next_frame_offset, offset_data + (frame_no + 1)*sizeof(Uint32), sizeof(Uint32));
+				if (next_frame_offset > fragment_offset) break;
+				++frame_no;
+			}
+			frames[frame_no].fragments.push_back(fragment);
+			fragment_offset += fragment.second + 8;
+		}
+
+		return true;
+	}
+
+	// сжатые данные одного кадра: указатель на единственный фрагмент или склеенные фрагменты в buffer
+	const Uint8 *getFrameCodestream(const encapsulated_frame &frame, vector<Uint8> &buffer, size_t &length)
+	{
+		if (frame.fragments.empty()) throw runtime_error("Frame contains no fragments");
+		if (frame.fragments.size() == 1)
+		{
+			length = frame.fragments.front().second;
+			return frame.fragments.front().first;
+		}
+		buffer.resize(frame.length());
+		auto	it = buffer.begin();
+		for (auto &fragment: frame.fragments)
+			it = std::copy(fragment.first, fragment.first + fragment.second, it);
+		length = buffer.size();
+		return buffer.data();
+	}
+
+	bool getPixelDataAsRAW(DcmDataset &dcmDataSet, const Uint8* &pixData, size_t &length, vector<Uint8> &buffer, size_t numOfFrame = 0)
 	{
 #if 0
 		OFCondition dcmRes;
@@ -414,53 +569,12 @@ namespace Dicom
 
 		return true;
 #else
-		// source https://groups.google.com/forum/#!topic/comp.protocols.dicom/UPECrdJYyAU
-		/*in order to access the original JPEG compressed pixel data you cannot use the
-			DicomImage class.Instead, you should use the lower level dcmdata routines as
-			follows(assuming that the "dataset" variable already contains the DICOM data) :
-		*/
-		DcmStack stack;
-		/* search for PixelData element on top-level */
-		if (dcmDataSet.search(DCM_PixelData, stack, ESM_fromHere, OFFalse /*searchIntoSub*/).good())
-		{
-			DcmPixelData *pixelData = (DcmPixelData *)stack.top();
-			if (pixelData != nullptr)
-			{
-				/* get pixel data sequence (if available) */
-				E_TransferSyntax xfer = EXS_Unknown;
-				const DcmRepresentationParameter *repParam = nullptr;
-				pixelData->getOriginalRepresentationKey(xfer, repParam);
-				if ((xfer != EXS_Unknown) && DcmXfer(xfer).isEncapsulated())
-				{
-					DcmPixelSequence *pixelSeq = nullptr;
-					if (pixelData->getEncapsulatedRepresentation(xfer, repParam, pixelSeq).good() && (pixelSeq != nullptr))
-					{
-						DcmPixelItem* pixitem = nullptr;
-						/* now "pixelSeq" points to the sequence of pixel items */
-						/* pixelSeq->card() returns the number of pixel items and */
-						/* pixelSeq->getItem() allows to access a particular pixel item */
-						long nFrame = 1;
-						//if (dcmDataSet.tagExists(DCM_NumberOfFrames) && dcmDataSet.findAndGetLongInt(DCM_NumberOfFrames, nFrame).good())
-						if (dcmDataSet.tagExists(DCM_NumberOfFrames))
-							if (dcmDataSet.findAndGetLongInt(DCM_NumberOfFrames, nFrame).good())
-								if (nFrame > 0)
-									nFrame = long(numOfFrame); //преобразуем к типу, используемому в DCMTK
-
-
-						if (pixelSeq->getItem(pixitem, nFrame).good())
-						{
-							length = pixitem->getLength();
-							if (pixitem->getUint8Array(pixData).bad()) throw runtime_error("Cant get RAW array");
-						}
-						else
-						{
-							throw runtime_error("Can't get pixelItem for JPEG2000");
-						}
-
-					}
-				}
-			}
-		}
+		// номера кадров отсчитываются от 0, элемент 0 последовательности фрагментов -- Basic Offset Table
+		vector<encapsulated_frame>	frames;
+		getEncapsulatedFrameIndex(dcmDataSet, frames);
+		if (numOfFrame >= frames.size())
+			throw runtime_error(ssprintf("Frame number %zu is out of range, frames number = %zu", numOfFrame, frames.size()));
+		pixData = getFrameCodestream(frames[numOfFrame], buffer, length);
 
 		return true;
 #endif
@@ -473,7 +587,7 @@ namespace Dicom
 		memcpy(p_buffer, p_user_data, p_nb_bytes);
 		return p_nb_bytes;
 	}
-	opj_image_t* decodeJPEG2000(Uint8 *pixData, size_t length)
+	opj_image_t* decodeJPEG2000(const Uint8 *pixData, size_t length)
 	{
 		string msgHdr = "[DecodeJPEG2000PixData] - ";
 		OPJ_BOOL opRes;
@@ -494,7 +608,7 @@ namespace Dicom
 			//p_stream = opj_stream_default_create(OPJ_TRUE);
 		}
 
-		opj_stream_set_user_data(p_stream, pixData, nullptr);
+		opj_stream_set_user_data(p_stream, const_cast<Uint8*>(pixData), nullptr);
 		opj_stream_set_user_data_length(p_stream, length);
 
 		// декодировать данные
@@ -513,16 +627,11 @@ namespace Dicom
 		return image;
 	}
 
-	bool getPixelsJpeg2000(DcmDataset &dcmDataset, unique_ptr<char[]> &pixeldata, size_t &vs_in, size_t &hs_in, size_t &bpp, bool &signedness, size_t &ncomp, size_t numOfFrame = 0)
+	// декодирование одного кадра JPEG2000. К DcmDataset не обращается, может вызываться из нескольких потоков
+	bool getPixelsJpeg2000(const Uint8 *pixDataArr, size_t codedPixLen, unique_ptr<char[]> &pixeldata, size_t &vs_in, size_t &hs_in, size_t &bpp, bool &signedness, size_t &ncomp)
 	{
 		try
 		{
-			// забираем данные
-			size_t codedPixLen;
-			// забираем закодированные данные
-			Uint8* pixDataArr;
-			getPixelDataAsRAW(dcmDataset, pixDataArr, codedPixLen, numOfFrame);
-
 			// раскодируем
 			opj_image_t* image = decodeJPEG2000(pixDataArr, codedPixLen);
 
@@ -612,7 +721,39 @@ namespace Dicom
 		}
 	}
 
-	bool dcmtkCodec::getPixelData(DcmDataset &dataset, unique_ptr<char[]> &pixeldata, size_t &vs, size_t &hs, size_t &bpp, bool &signedness, size_t &ncomp, size_t numOfFrame)
+	bool getPixelsJpeg2000(DcmDataset &dcmDataset, unique_ptr<char[]> &pixeldata, size_t &vs_in, size_t &hs_in, size_t &bpp, bool &signedness, size_t &ncomp, size_t numOfFrame = 0)
+	{
+		try
+		{
+			// забираем закодированные данные
+			size_t codedPixLen;
+			const Uint8* pixDataArr;
+			vector<Uint8>	buffer;
+			getPixelDataAsRAW(dcmDataset, pixDataArr, codedPixLen, buffer, numOfFrame);
+
+			return getPixelsJpeg2000(pixDataArr, codedPixLen, pixeldata, vs_in, hs_in, bpp, signedness, ncomp);
+		}
+
+		catch (exception &)
+		{
+			return false; //todo (Kovbas) Обработать ошибку
+		}
+	}
+
+	bool dcmtkCodec::getEncapsulatedFrameIndex(DcmDataset &dataset, vector<encapsulated_frame> &frames)
+	{
+		return Dicom::getEncapsulatedFrameIndex(dataset, frames);
+	}
+
+	bool dcmtkCodec::getFramePixelDataJpeg2000(const encapsulated_frame &frame, unique_ptr<char[]> &pixeldata, size_t &vs, size_t &hs, size_t &bpp, bool &signedness, size_t &ncomp)
+	{
+		vector<Uint8>	buffer;
+		size_t	length = 0;
+		const Uint8	*codestream = getFrameCodestream(frame, buffer, length);
+		return getPixelsJpeg2000(codestream, length, pixeldata, vs, hs, bpp, signedness, ncomp);
+	}
+
+	bool dcmtkCodec::getPixelData(DcmDataset &dataset, unique_ptr<char[]> &pixeldata, size_t &vs, size_t &hs, size_t &bpp, bool &signedness, size_t &ncomp, size_t numOfFrame, bool apply_modality_transformation)
 	{
 		switch (codec_type)
 		{
@@ -623,7 +764,7 @@ namespace Dicom
 			return getPixelsJpeg2000(dataset, pixeldata, vs, hs, bpp, signedness, ncomp, numOfFrame);
 
 		default:
-			return getPixelsConventional(dataset, pixeldata, vs, hs, bpp, signedness, ncomp, numOfFrame);
+			return getPixelsConventional(dataset, pixeldata, vs, hs, bpp, signedness, ncomp, numOfFrame, apply_modality_transformation);
 		}
 	}
 
@@ -631,8 +772,9 @@ namespace Dicom
 	{
 		if (codec_type != e_uncompressed)
 		{
-			Uint8* pixData;
-			getPixelDataAsRAW(dataset, pixData, length);
+			const Uint8* pixData;
+			vector<Uint8>	buffer;
+			getPixelDataAsRAW(dataset, pixData, length, buffer);
 			pixelData = make_unique<char[]>(length);
 			memcpy(pixelData.get(), pixData, length);
 
@@ -774,7 +916,7 @@ namespace Dicom
 	//bool CompressJPEG2Ko(DICOMDataObject* pDDO, int j2kQuality)
 	//bool encodeJPEG2000(unique_ptr<char[]> &dst, size_t &dstLen, const unique_ptr<char[]> &src, const size_t &srcLen, opj_image_cmptparm_t *cmptparms)
 #define MAX_NUM_COMPS 3
-	bool encodeJPEG2000(unique_ptr<char[]> &dst, size_t &dstLen, const unique_ptr<char[]> &src, size_t srcLen, opj_image_cmptparm_t *cmptparms_in)
+	bool encodeJPEG2000(unique_ptr<char[]> &dst, size_t &dstLen, const char *src, size_t srcLen, opj_image_cmptparm_t *cmptparms_in)
 	{
 		string msgHdr = "[OpenJPEG] - ";
 		int j2kQuality = 100;
@@ -841,8 +983,10 @@ namespace Dicom
 		//frameBufferStream.pData = (OPJ_UINT8 *)imageData.frameBuffer;
 		//frameBufferStream.dataSize = imageData.frameSize;
 		//frameBufferStream.offset = 0;
-		frameBufferStream.pData = (OPJ_UINT8*)malloc(srcLen * sizeof(OPJ_UINT8));
-		frameBufferStream.dataSize = srcLen;
+		// сжатый поток для шумных данных может оказаться длиннее исходного, поэтому буфер берется с запасом
+		const size_t	frameBufferSize = srcLen + srcLen/2 + 4096;
+		frameBufferStream.pData = (OPJ_UINT8*)malloc(frameBufferSize * sizeof(OPJ_UINT8));
+		frameBufferStream.dataSize = frameBufferSize;
 		frameBufferStream.offset = 0;
 		//Create comment for codestream buffer, use spareBuffer so imageData will free.
 		//clen = strlen(comment);//Made comment above, strnlen not needed.
@@ -1003,7 +1147,7 @@ namespace Dicom
 			// переносим данные исходного изображения в объект изображения, который пойдёт на обработку
 			for (size_t cntcomps = 0; cntcomps < image->numcomps; cntcomps++)
 			{
-				char* ptrSrc = src.get();
+				const char* ptrSrc = src;
 				OPJ_INT32* ptrImg = image->comps[cntcomps].data;
 
 				for (size_t cntEl = 0; cntEl < image->y1*image->x1; cntEl++)
@@ -1118,7 +1262,7 @@ namespace Dicom
 		return true;
 	}
 
-	bool dcmtkCodec::compressPixelDataJPEG2000(unique_ptr<char[]> &dst, size_t &dst_len, const unique_ptr<char[]> &src, size_t src_len, size_t hs, size_t vs, size_t prec, size_t bpp, bool sign)
+	bool dcmtkCodec::compressPixelDataJPEG2000(unique_ptr<char[]> &dst, size_t &dst_len, const char *src, size_t src_len, size_t hs, size_t vs, size_t prec, size_t bpp, bool sign)
 	{
 		opj_image_cmptparm_t imgParams;
 		imgParams.dx = 1; //0;
@@ -1136,6 +1280,62 @@ namespace Dicom
 		return true;
 	}
 
+	bool dcmtkCodec::encodePixelDataJPEG2000(DcmDataset &dataset)
+	{
+		Uint16	rows = 0, columns = 0, bits_allocated = 0, bits_stored = 0, pixel_representation = 0, samples_per_pixel = 1;
+		Sint32	n_frames = 1;
+		if (dataset.findAndGetUint16(DCM_Rows, rows).bad() || dataset.findAndGetUint16(DCM_Columns, columns).bad() ||
+			dataset.findAndGetUint16(DCM_BitsAllocated, bits_allocated).bad())
+			throw runtime_error(msgHdr + "Cannot compress image to JPEG2000: image attributes are missing.");
+		if (dataset.findAndGetUint16(DCM_BitsStored, bits_stored).bad())
+			bits_stored = bits_allocated;
+		dataset.findAndGetUint16(DCM_PixelRepresentation, pixel_representation);
+		dataset.findAndGetUint16(DCM_SamplesPerPixel, samples_per_pixel);
+		if (dataset.findAndGetSint32(DCM_NumberOfFrames, n_frames).bad() || n_frames < 1)
+			n_frames = 1;
+
+		if (samples_per_pixel != 1)
+			throw runtime_error(msgHdr + "Cannot compress image to JPEG2000: only monochrome images are supported.");
+		if (bits_allocated != 8 && bits_allocated != 16)
+			throw runtime_error(ssprintf("%sCannot compress image to JPEG2000: unsupported bits allocated = %d.", msgHdr.c_str(), int(bits_allocated)));
+
+		DcmElement	*element = nullptr;
+		if (dataset.findAndGetElement(DCM_PixelData, element).bad() || !element)
+			throw runtime_error(msgHdr + "There is no pixel data in dataset!");
+		DcmPixelData	*pixel_data = dynamic_cast<DcmPixelData*>(element);
+		if (!pixel_data)
+			throw runtime_error(msgHdr + "Invalid pixel data element.");
+
+		// кадры читаются из несжатого представления по одному, сжатые кадры сразу помещаются в последовательность фрагментов
+		const size_t	frame_size = size_t(rows)*columns*(bits_allocated/CHAR_BIT);
+		auto	frame_buffer = make_unique<char[]>(frame_size);
+
+		unique_ptr<DcmPixelSequence>	sequence = make_unique<DcmPixelSequence>(DcmTag(DCM_PixelData, EVR_OB));
+		DcmPixelItem	*offset_table = new DcmPixelItem(DcmTag(DCM_Item, EVR_OB));
+		sequence->insert(offset_table);
+		DcmOffsetList	offsets;
+
+		for (Sint32 frame = 0; frame < n_frames; ++frame)
+		{
+			Uint32	start_fragment = 0;
+			OFString	color_model;
+			if (pixel_data->getUncompressedFrame(&dataset, Uint32(frame), start_fragment, frame_buffer.get(), Uint32(frame_size), color_model).bad())
+				throw runtime_error(ssprintf("%sCannot read uncompressed frame %d.", msgHdr.c_str(), int(frame)));
+
+			unique_ptr<char[]>	compressed;
+			size_t	compressed_length = 0;
+			compressPixelDataJPEG2000(compressed, compressed_length, frame_buffer.get(), frame_size, columns, rows, bits_stored, bits_allocated, pixel_representation != 0);
+
+			if (sequence->storeCompressedFrame(offsets, reinterpret_cast<Uint8*>(compressed.get()), Uint32(compressed_length), 0).bad())
+				throw runtime_error(ssprintf("%sCannot store compressed frame %d.", msgHdr.c_str(), int(frame)));
+		}
+		offset_table->createOffsetTable(offsets);
+
+		// после этого сжатое представление становится исходным, несжатое удаляется
+		pixel_data->putOriginalRepresentation(EXS_JPEG2000LosslessOnly, nullptr, sequence.release());
+		return true;
+	}
+
 }//namespace Dicom
 
 XRAD_END
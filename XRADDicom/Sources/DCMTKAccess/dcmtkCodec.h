@@ -22,6 +22,17 @@ Dicom::e_compression_type_t	recognizeCodecType(const E_TransferSyntax transf_syn
 
 namespace Dicom
 {
+	/*!
+		\brief Фрагменты одного кадра инкапсулированных (сжатых) данных
+
+		Указатели ссылаются на память DcmDataset и действительны, пока набор данных не изменен.
+	*/
+	struct encapsulated_frame
+	{
+		vector<pair<const Uint8*, size_t>>	fragments;
+		//! \brief Суммарная длина сжатых данных кадра
+		size_t	length() const;
+	};
 
 
 	class dcmtkCodec
@@ -50,9 +61,25 @@ namespace Dicom
 
 		//methods
 		//извлечение изображений
-		bool getPixelData(DcmDataset &dataset, unique_ptr<char[]> &pixeldata, size_t &vertical_size, size_t &horizontal_size, size_t &bpp, bool &signedness, size_t &ncomponents, size_t numOfFrame = 0);
+		//! \param apply_modality_transformation Если false, данные возвращаются в том виде, как они хранятся в файле
+		//!	(без rescale slope/intercept). Для JPEG2000 данные всегда возвращаются без преобразования
+		bool getPixelData(DcmDataset &dataset, unique_ptr<char[]> &pixeldata, size_t &vertical_size, size_t &horizontal_size, size_t &bpp, bool &signedness, size_t &ncomponents, size_t numOfFrame = 0, bool apply_modality_transformation = true);
 		bool getPixelData_compressed(DcmDataset &dataset, unique_ptr<char[]> &pixData, size_t &length);
 
+		//! \brief Таблица кадров инкапсулированных данных: строится за один проход по фрагментам,
+		//!	после чего любой кадр доступен без повторного поиска. Номера кадров отсчитываются от 0
+		static bool getEncapsulatedFrameIndex(DcmDataset &dataset, vector<encapsulated_frame> &frames);
+		//! \brief Декодирование одного кадра JPEG2000 из таблицы кадров. К DcmDataset не обращается,
+		//!	поэтому разные кадры можно декодировать одновременно в нескольких потоках
+		static bool getFramePixelDataJpeg2000(const encapsulated_frame &frame, unique_ptr<char[]> &pixeldata, size_t &vertical_size, size_t &horizontal_size, size_t &bpp, bool &signedness, size_t &ncomponents);
+
+		//! \brief Синтаксис передачи, соответствующий выбранному при записи сжатию. Для неподдерживаемых значений кидает invalid_argument
+		static E_TransferSyntax getEncodingTransferSyntax(e_compression_type_t encoding);
+
+		//! \brief Сжатие всех кадров несжатого набора данных в JPEG2000 без потерь средствами OpenJPEG
+		//!	(в DCMTK кодер JPEG2000 отсутствует). Поддерживаются монохромные изображения 8 и 16 бит
+		bool encodePixelDataJPEG2000(DcmDataset &dataset);
+
 	private:
 		std::string msgHdr = "[dcmtkCodec] - ";
 
@@ -60,6 +87,7 @@ namespace Dicom
 		static size_t numOpenedDCMTKDecoderJPEG;
 		static size_t numOpenedDCMTKDecoderJPEGLS;
 		static size_t numOpenedDCMTKEncoderJPEG;
+		static size_t numOpenedDCMTKEncoderJPEGLS;
 
 		const e_compression_type_t codec_type;
 		const e_compression_type_t codec_type_coded;
@@ -77,7 +105,7 @@ namespace Dicom
 		void encoder_uninitializer(e_compression_type_t codec_type_in);
 
 		//компрессия/декомпрессия изображений
-		bool compressPixelDataJPEG2000(unique_ptr<char[]> &dst, size_t &dst_len, const unique_ptr<char[]> &src, size_t src_len, size_t hs, size_t vs, size_t prec, size_t bpp, bool sign);
+		bool compressPixelDataJPEG2000(unique_ptr<char[]> &dst, size_t &dst_len, const char *src, size_t src_len, size_t hs, size_t vs, size_t prec, size_t bpp, bool sign);
 	};
 
 } //namespace Dicom
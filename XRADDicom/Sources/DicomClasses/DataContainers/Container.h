@@ -34,6 +34,73 @@ namespace Dicom
 
 
 
+	/*!
+		\brief Отсчеты изображения в том виде, как их вернул декодер: целые числа
+		со знаком или без знака, 1, 2 или 4 байта на отсчет, строки подряд без промежутков
+	*/
+	struct decoded_pixeldata
+	{
+		unique_ptr<char[]>	data;
+		size_t	vsize = 0;
+		size_t	hsize = 0;
+		size_t	bpp = 0;
+		bool	is_signed = false;
+		size_t	ncomp = 0;
+
+		size_t	bytes_per_pixel() const { return (bpp + (CHAR_BIT - 1)) / CHAR_BIT; }
+	};
+
+	/*!
+		\brief Перенос декодированных отсчетов в двумерный массив за один проход.
+		Элемент массива получает значение f(x), где x -- отсчет во встроенном
+		целочисленном типе, соответствующем формату данных
+	*/
+	template<class ARR2D, class F>
+	void	CopyDecodedPixeldata(ARR2D &img, const decoded_pixeldata &pixeldata, const F &f)
+	{
+		if (!pixeldata.data) throw logic_error("pixeldata is empty!");
+		if (pixeldata.vsize != img.vsize() || pixeldata.hsize != img.hsize())
+		{
+			ForceDebugBreak();
+			throw invalid_argument("Image object has incorrect size(s).");
+		}
+		const char	*data = pixeldata.data.get();
+		if (pixeldata.is_signed)
+		{
+			switch (pixeldata.bytes_per_pixel())
+			{
+			case(1):
+				img.CopyData(reinterpret_cast<const int8_t*>(data), 1, f);
+				break;
+			case(2):
+				img.CopyData(reinterpret_cast<const int16_t*>(data), 1, f);
+				break;
+			case(4):
+				img.CopyData(reinterpret_cast<const int32_t*>(data), 1, f);
+				break;
+			default:
+				throw logic_error(ssprintf("Wrong reinterpret value  = %zu", pixeldata.bytes_per_pixel()));
+			}
+		}
+		else
+		{
+			switch (pixeldata.bytes_per_pixel())
+			{
+			case(1):
+				img.CopyData(reinterpret_cast<const uint8_t*>(data), 1, f);
+				break;
+			case(2):
+				img.CopyData(reinterpret_cast<const uint16_t*>(data), 1, f);
+				break;
+			case(4):
+				img.CopyData(reinterpret_cast<const uint32_t*>(data), 1, f);
+				break;
+			default:
+				throw logic_error(ssprintf("Wrong reinterpret value  = %zu", pixeldata.bytes_per_pixel()));
+			}
+		}
+	}
+
 	class Container
 	{
 	protected:
@@ -94,6 +161,21 @@ namespace Dicom
 
 		virtual bool	get_pixeldata(RealFunction2D_F32 &img_in, size_t &bpp, bool &is_signed, size_t &ncomp, size_t num_of_frame = 0) const = 0;
 		virtual bool get_color_pixeldata(ColorImageF32& img) const = 0;
+
+		//! \brief Декодирование набора кадров мультифрейма непосредственно в срезы трехмерного массива:
+		//!	кадр frames[i].first помещается в срез frames[i].second. Результат для каждого кадра тот же,
+		//!	что у get_pixeldata. Кадры JPEG2000 декодируются параллельно
+		virtual bool	get_pixeldata_frames(RealFunctionMD_F32 &img, const vector<pair<size_t, size_t>> &frames) const = 0;
+
+		//! \brief Декодирование изображения без переноса в массив XRAD. Позволяет совместить
+		//!	перенос данных с первой попиксельной операцией (см. CopyDecodedPixeldata).
+		//!	При apply_modality_transformation == false slope и intercept не применяются
+		virtual bool	get_decoded_pixeldata(decoded_pixeldata &pixeldata, size_t num_of_frame = 0, bool apply_modality_transformation = true) const = 0;
+
+		//! \brief Извлечение изображения в том виде, как оно хранится в файле (без учета slope и intercept),
+		//!	без промежуточного преобразования в float. Знаковость буфера должна соответствовать данным файла
+		virtual bool	get_stored_pixeldata(RealFunction2D_I16 &img_in, size_t num_of_frame = 0) const = 0;
+		virtual bool	get_stored_pixeldata(RealFunction2D_UI16 &img_in, size_t num_of_frame = 0) const = 0;
 		virtual wstring get_elements_to_wstring(bool by_lib) const = 0;
 		virtual elemsmap_t get_elements_list() const = 0;
 
@@ -102,6 +184,13 @@ namespace Dicom
 		virtual void	set_pixeldata(const RealFunction2D_F32 &img_in, size_t bpp, bool is_signed, size_t ncomp) = 0;
 		virtual void set_pixeldata_mf(const RealFunctionMD_F32 &img_in, size_t bpp, bool is_signed, size_t ncomp) = 0;
 
+		//! \brief Запись хранимых (без slope и intercept) 16-разрядных данных без промежуточных преобразований.
+		//!	Теги bits allocated/stored и pixel representation приводятся в соответствие с типом данных
+		virtual void	set_stored_pixeldata(const RealFunction2D_I16 &img_in) = 0;
+		virtual void	set_stored_pixeldata(const RealFunction2D_UI16 &img_in) = 0;
+		virtual void	set_stored_pixeldata_mf(const RealFunctionMD_I16 &img_in) = 0;
+		virtual void	set_stored_pixeldata_mf(const RealFunctionMD_UI16 &img_in) = 0;
+
 		virtual void set_rescaled_tags_mf(const size_t& new_size, const double& current, const double& thickness) = 0;
 
 		virtual bool set_wstring(tag_e id, const wstring &new_value, size_t num_of_frame = 0, bool set_only_if_exist = false) = 0;
@@ -322,20 +322,7 @@ namespace Dicom
 		try
 		{
 			//разбор сжатия/несжатия изображений
-			E_TransferSyntax transfer_syntax = EXS_LittleEndianExplicit;
-			switch (encoding)
-			{
-			case e_uncompressed:
-				transfer_syntax = EXS_LittleEndianExplicit;
-				break;
-
-			case e_jpeg_lossless:
-				transfer_syntax = EXS_JPEGProcess14SV1;
-				break;
-
-			default:
-				throw invalid_argument(classname() + "::save_to_file, invalid compression. You cannot use this codec. File was not saved. File " + convert_to_string(full_file_path));
-			}
+			E_TransferSyntax transfer_syntax = Dicom::dcmtkCodec::getEncodingTransferSyntax(encoding);
 
 			// регистрируем кодер (через наш класс кодека, чтобы автоматически отключался)
 			//lock_guard<mutex> lck{ dicom_file_mutex };
@@ -344,7 +331,20 @@ namespace Dicom
 			// задаём тип компрессии в объекте файла
 			// нужно обязательно задавать transfer_syntax, иначе не будет сохранять
 
-			SetTransferSyntax(transfer_syntax);
+			if (transfer_syntax == EXS_JPEG2000LosslessOnly)
+			{
+				// кодера JPEG2000 в DCMTK нет: если данные еще не в этом представлении,
+				// переводим их в несжатый вид и сжимаем кадры средствами OpenJPEG
+				if (m_dicom_file->getDataset()->chooseRepresentation(transfer_syntax, nullptr).bad())
+				{
+					SetTransferSyntax(EXS_LittleEndianExplicit);
+					codec.encodePixelDataJPEG2000(*m_dicom_file->getDataset());
+				}
+			}
+			else
+			{
+				SetTransferSyntax(transfer_syntax);
+			}
 
 			if (!m_dicom_file->getDataset()->canWriteXfer(transfer_syntax))
 			{
@@ -974,7 +974,7 @@ namespace Dicom
 	}
 
 
-	bool ContainerDCMTK::get_pixeldata(RealFunction2D_F32 &img_in, size_t &bpp, bool &is_signed, size_t &ncomp, size_t num_of_frame) const
+	bool ContainerDCMTK::get_decoded_pixeldata(decoded_pixeldata &pixeldata, size_t num_of_frame, bool apply_modality_transformation) const
 	{
 		try
 		{
@@ -996,77 +996,188 @@ namespace Dicom
 			if(dcmDataset == NULL) throw runtime_error("DcmDataset is NULL");
 
 			//забираем изображение со всеми параметрами
-			unique_ptr<char[]> pixeldata;
-
-			size_t vs = 0;
-			size_t hs = 0;
-			//size_t ncomp = 1;
-			dcmCodec_ptr->getPixelData(*dcmDataset, pixeldata, vs, hs, bpp, is_signed, ncomp, num_of_frame);
+			pixeldata = decoded_pixeldata();
+			// декодер JPEG2000 берет знаковость из файла, а не из потока
+			pixeldata.is_signed = get_uint(e_pixel_representation) != 0;
+			dcmCodec_ptr->getPixelData(*dcmDataset, pixeldata.data, pixeldata.vsize, pixeldata.hsize,
+					pixeldata.bpp, pixeldata.is_signed, pixeldata.ncomp, num_of_frame, apply_modality_transformation);
 
 			// Разблокируем dicom_file_mutex, дальше блокировка не требуется.
 			lck.unlock();
 
-			if (!pixeldata) throw logic_error("pixeldata is empty!");
-			if (!vs || !hs) throw logic_error(ssprintf("Wrong size value  = %d x %d", vs, hs));
+			if (!pixeldata.data) throw logic_error("pixeldata is empty!");
+			if (!pixeldata.vsize || !pixeldata.hsize) throw logic_error(ssprintf("Wrong size value  = %zu x %zu", pixeldata.vsize, pixeldata.hsize));
 
-			size_t bytes_per_pixel = (bpp + (CHAR_BIT - 1)) / CHAR_BIT;
+			return true;
+		}
+		catch(exception &ex)
+		{
+			logger.putLogMessage(classname() + "::get_decoded_pixeldata problem =\t'" + string(ex.what()) + "'");
+			return false;
+		}
+	}
 
-			if(img_in.empty()) img_in.realloc(vs, hs);
 
-			//инициализируем наш массив, в который будут положены данные
-			if (vs != img_in.vsize() || hs != img_in.hsize())
+	bool ContainerDCMTK::get_pixeldata(RealFunction2D_F32 &img_in, size_t &bpp, bool &is_signed, size_t &ncomp, size_t num_of_frame) const
+	{
+		try
+		{
+			decoded_pixeldata	pixeldata;
+			if (!get_decoded_pixeldata(pixeldata, num_of_frame)) return false;
+
+			bpp = pixeldata.bpp;
+			is_signed = pixeldata.is_signed;
+			ncomp = pixeldata.ncomp;
+
+			if(img_in.empty()) img_in.realloc(pixeldata.vsize, pixeldata.hsize);
+
+			//переносим изображение в нашу переменную
+			CopyDecodedPixeldata(img_in, pixeldata, [](const auto &x) { return static_cast<float>(x); });
+
+			return true;
+		}
+		catch(exception &ex)
+		{
+			logger.putLogMessage(classname() + "::get_pixeldata problem =\t'" + string(ex.what()) + "'\tFile:\t"/* + convert_to_string(m_last_opened_file_path)*/);//m_last_opened_file_path в функции не задействован
+			return false;
+		}
+	}
+
+
+	bool ContainerDCMTK::get_pixeldata_frames(RealFunctionMD_F32 &img, const vector<pair<size_t, size_t>> &frames) const
+	{
+		try
+		{
+			if (img.n_dimensions() != 3) throw invalid_argument(ssprintf("Invalid dimensions number = %zu", img.n_dimensions()));
+			for (auto &frame: frames)
 			{
-				ForceDebugBreak();
-				throw invalid_argument("Image object has incorrect size(s).");
+				if (frame.second >= img.sizes(0))
+					throw invalid_argument(ssprintf("Slice number %zu is out of range, slices number = %zu", frame.second, img.sizes(0)));
 			}
-			//img_in.realloc(vs, hs);
 
-			//переносим изображение в нашу переменную
-			if (is_signed)
+			unique_lock<mutex> lck{ dicom_file_mutex };
+
+			if(m_dicom_file->isEmpty()) throw invalid_argument("File is empty.");
+
+			string xferstr = convert_to_string(get_wstring(DcmTag_to_element_id(DCM_TransferSyntaxUID)));
+			e_compression_type_t	codec_type = xferstr == "" ?
+					recognizeCodecType(m_dicom_file->getDataset()->getCurrentXfer()) :
+					recognizeCodecType(xferstr);
+
+			if (codec_type != e_jpeg2k)
 			{
-				switch (bytes_per_pixel)
+				// DCMTK декодирует набор данных целиком и не допускает одновременного обращения из нескольких потоков,
+				// кадры переносятся последовательно
+				lck.unlock();
+				for (auto &frame: frames)
 				{
-				case(1):
-					img_in.CopyData(reinterpret_cast<int8_t*>(pixeldata.get()), 1);
-					break;
-				case(2):
-					img_in.CopyData(reinterpret_cast<int16_t*>(pixeldata.get()), 1);
-					break;
-				case(4):
-					img_in.CopyData(reinterpret_cast<int32_t*>(pixeldata.get()), 1);
-					break;
-				default:
-					throw logic_error(ssprintf("Wrong reinterpret value  = %d", is_signed));
+					decoded_pixeldata	pixeldata;
+					if (!get_decoded_pixeldata(pixeldata, frame.first))
+						throw runtime_error(ssprintf("Cannot decode frame %zu", frame.first));
+					auto	slice = img.GetSlice({ frame.second, slice_mask(0), slice_mask(1) });
+					CopyDecodedPixeldata(slice.ref(), pixeldata, [](const auto &x) { return static_cast<float>(x); });
 				}
+				return true;
 			}
-			else
+
+			DcmDataset *dcmDataset = m_dicom_file->getDataset();
+			if(dcmDataset == NULL) throw runtime_error("DcmDataset is NULL");
+
+			// таблица кадров строится один раз, дальше каждый кадр декодируется независимо.
+			// Блокировка сохраняется до конца декодирования: таблица ссылается на память набора данных
+			vector<encapsulated_frame>	frame_index;
+			dcmtkCodec::getEncapsulatedFrameIndex(*dcmDataset, frame_index);
+			for (auto &frame: frames)
+			{
+				if (frame.first >= frame_index.size())
+					throw invalid_argument(ssprintf("Frame number %zu is out of range, frames number = %zu", frame.first, frame_index.size()));
+			}
+			const bool	is_signed = get_uint(e_pixel_representation) != 0;
+
+			ThreadErrorCollector ec("ContainerDCMTK::get_pixeldata_frames");
+			#pragma omp parallel for schedule (guided)
+			for (ptrdiff_t i = 0; i < ptrdiff_t(frames.size()); ++i)
 			{
-				switch (bytes_per_pixel)
+				if (ec.HasErrors())
+					continue;
+				ThreadSetup ts; (void)ts;
+				try
+				{
+					decoded_pixeldata	pixeldata;
+					// декодер JPEG2000 берет знаковость из файла, а не из потока
+					pixeldata.is_signed = is_signed;
+					if (!dcmtkCodec::getFramePixelDataJpeg2000(frame_index[frames[i].first], pixeldata.data,
+							pixeldata.vsize, pixeldata.hsize, pixeldata.bpp, pixeldata.is_signed, pixeldata.ncomp))
+					{
+						throw runtime_error(ssprintf("Cannot decode frame %zu", frames[i].first));
+					}
+					auto	slice = img.GetSlice({ frames[i].second, slice_mask(0), slice_mask(1) });
+					CopyDecodedPixeldata(slice.ref(), pixeldata, [](const auto &x) { return static_cast<float>(x); });
+				}
+				catch (...)
 				{
-				case(1):
-					img_in.CopyData(reinterpret_cast<uint8_t*>(pixeldata.get()), 1);
-					break;
-				case(2):
-					img_in.CopyData(reinterpret_cast<uint16_t*>(pixeldata.get()), 1);
-					break;
-				case(4):
-					img_in.CopyData(reinterpret_cast<uint32_t*>(pixeldata.get()), 1);
-					break;
-				default:
-					throw logic_error(ssprintf("Wrong reinterpret value  = %d", is_signed));
+					ec.CatchException();
 				}
 			}
+			ec.ThrowIfErrors();
 
 			return true;
 		}
 		catch(exception &ex)
 		{
-			logger.putLogMessage(classname() + "::get_pixeldata problem =\t'" + string(ex.what()) + "'\tFile:\t"/* + convert_to_string(m_last_opened_file_path)*/);//m_last_opened_file_path в функции не задействован
+			logger.putLogMessage(classname() + "::get_pixeldata_frames problem =\t'" + string(ex.what()) + "'");
 			return false;
 		}
 	}
 
 
+	template<class ARR2D>
+	bool ContainerDCMTK::get_stored_pixeldata_internal(ARR2D &img_in, size_t num_of_frame) const
+	{
+		typedef typename ARR2D::value_type stored_type;
+		try
+		{
+			decoded_pixeldata	pixeldata;
+			// modality transformation не применяется: slope и intercept хранятся отдельно от данных
+			if (!get_decoded_pixeldata(pixeldata, num_of_frame, false)) return false;
+
+			if (pixeldata.ncomp != 1) throw invalid_argument(ssprintf("Stored pixel data can be extracted for monochrome images only, ncomp = %zu", pixeldata.ncomp));
+
+			size_t bytes_per_pixel = pixeldata.bytes_per_pixel();
+			if (bytes_per_pixel > sizeof(stored_type))
+				throw invalid_argument(ssprintf("Stored pixel data (%zu bits) do not fit into %zu-bit buffer.", pixeldata.bpp, sizeof(stored_type)*CHAR_BIT));
+			if (pixeldata.is_signed && !std::is_signed<stored_type>::value)
+				throw invalid_argument("Signed stored pixel data cannot be put into unsigned buffer.");
+			if (!pixeldata.is_signed && std::is_signed<stored_type>::value && bytes_per_pixel == sizeof(stored_type)
+					&& get_uint(e_bits_stored, 0, pixeldata.bpp) >= sizeof(stored_type)*CHAR_BIT)
+			{
+				throw invalid_argument("Unsigned stored pixel data do not fit into signed buffer.");
+			}
+
+			if(img_in.empty()) img_in.realloc(pixeldata.vsize, pixeldata.hsize);
+
+			CopyDecodedPixeldata(img_in, pixeldata, [](const auto &x) { return static_cast<stored_type>(x); });
+
+			return true;
+		}
+		catch(exception &ex)
+		{
+			logger.putLogMessage(classname() + "::get_stored_pixeldata problem =\t'" + string(ex.what()) + "'");
+			return false;
+		}
+	}
+
+	bool ContainerDCMTK::get_stored_pixeldata(RealFunction2D_I16 &img_in, size_t num_of_frame) const
+	{
+		return get_stored_pixeldata_internal(img_in, num_of_frame);
+	}
+
+	bool ContainerDCMTK::get_stored_pixeldata(RealFunction2D_UI16 &img_in, size_t num_of_frame) const
+	{
+		return get_stored_pixeldata_internal(img_in, num_of_frame);
+	}
+
+
 	bool ContainerDCMTK::get_color_pixeldata(ColorImageF32& img) const
 	{
 
@@ -1479,6 +1590,99 @@ namespace Dicom
 	}
 
 
+	//! \brief Указатель на непрерывный блок данных изображения. Если данные лежат в памяти с разрывами
+	//!	(например, изображение является срезом многомерного массива), они копируются в buffer
+	template<class ARR2D>
+	const typename ARR2D::value_type *contiguous_pixeldata(const ARR2D &img, ARR2D &buffer)
+	{
+		if(img.hstep_raw() == 1 && img.vstep_raw() == ptrdiff_t(img.hsize()))
+			return &img.at(0, 0);
+		buffer.MakeCopy(img);
+		return &buffer.at(0, 0);
+	}
+
+	template<class ARR_MD>
+	const typename ARR_MD::value_type *contiguous_pixeldata_mf(const ARR_MD &img, ARR_MD &buffer)
+	{
+		if(img.steps_raw(2) == 1 && img.steps_raw(1) == ptrdiff_t(img.sizes(2)) && img.steps_raw(0) == ptrdiff_t(img.sizes(1)*img.sizes(2)))
+			return &img.at({0, 0, 0});
+		buffer.MakeCopy(img);
+		return &buffer.at({0, 0, 0});
+	}
+
+	//! \brief Наименьшее значение BitsStored, при котором все отсчеты data представимы
+	template<class T>
+	Uint16 stored_bits_required(const T *data, size_t n)
+	{
+		T	min_value = 0, max_value = 0;
+		for(size_t i = 0; i < n; ++i)
+		{
+			if(data[i] < min_value) min_value = data[i];
+			else if(data[i] > max_value) max_value = data[i];
+		}
+		Uint16	bits = 1;
+		if(std::is_signed<T>::value)
+		{
+			// для знаковых данных нужен еще знаковый разряд
+			while(bits < sizeof(T)*CHAR_BIT && (int64_t(max_value) >= (int64_t(1) << (bits - 1)) || int64_t(min_value) < -(int64_t(1) << (bits - 1))))
+				++bits;
+		}
+		else
+		{
+			while(bits < sizeof(T)*CHAR_BIT && uint64_t(max_value) >= (uint64_t(1) << bits))
+				++bits;
+		}
+		return bits;
+	}
+
+	template<class T>
+	void ContainerDCMTK::set_stored_pixeldata_internal(const T *data, size_t n_pixels, size_t n_frames)
+	{
+		static_assert(sizeof(T) == sizeof(Uint16), "Only 16-bit stored pixel data are supported.");
+		DcmDataset	*dataset = m_dicom_file->getDataset();
+		const Uint16	bits = Uint16(sizeof(T)*CHAR_BIT);
+
+		// BitsStored файла сохраняется (например, 12 разрядов у КТ), если только новые данные
+		// в него не помещаются. Отсчеты записываются выровненными по младшему разряду, поэтому HighBit = BitsStored - 1
+		Uint16	bits_stored = 0;
+		if(dataset->findAndGetUint16(DCM_BitsStored, bits_stored).bad() || bits_stored < 1 || bits_stored > bits)
+			bits_stored = bits;
+		bits_stored = std::max(bits_stored, stored_bits_required(data, n_pixels*n_frames));
+
+		dataset->putAndInsertUint16(DCM_BitsAllocated, bits);
+		dataset->putAndInsertUint16(DCM_BitsStored, bits_stored);
+		dataset->putAndInsertUint16(DCM_HighBit, Uint16(bits_stored - 1));
+		dataset->putAndInsertUint16(DCM_PixelRepresentation, std::is_signed<T>::value ? 1 : 0);
+		// данные передаются как есть, без промежуточного буфера и без потерь
+		auto condition = dataset->putAndInsertUint16Array(DCM_PixelData, reinterpret_cast<const Uint16*>(data), (unsigned long)(n_pixels*n_frames));
+		if(condition.bad()) throw runtime_error(classname() + "::set_stored_pixeldata, cannot put pixel data: " + condition.text());
+	}
+
+	void ContainerDCMTK::set_stored_pixeldata(const RealFunction2D_I16 &img_in)
+	{
+		RealFunction2D_I16	buffer;
+		set_stored_pixeldata_internal(contiguous_pixeldata(img_in, buffer), img_in.vsize()*img_in.hsize(), 1);
+	}
+
+	void ContainerDCMTK::set_stored_pixeldata(const RealFunction2D_UI16 &img_in)
+	{
+		RealFunction2D_UI16	buffer;
+		set_stored_pixeldata_internal(contiguous_pixeldata(img_in, buffer), img_in.vsize()*img_in.hsize(), 1);
+	}
+
+	void ContainerDCMTK::set_stored_pixeldata_mf(const RealFunctionMD_I16 &img_in)
+	{
+		RealFunctionMD_I16	buffer;
+		set_stored_pixeldata_internal(contiguous_pixeldata_mf(img_in, buffer), img_in.sizes(1)*img_in.sizes(2), img_in.sizes(0));
+	}
+
+	void ContainerDCMTK::set_stored_pixeldata_mf(const RealFunctionMD_UI16 &img_in)
+	{
+		RealFunctionMD_UI16	buffer;
+		set_stored_pixeldata_internal(contiguous_pixeldata_mf(img_in, buffer), img_in.sizes(1)*img_in.sizes(2), img_in.sizes(0));
+	}
+
+
 	list<int32_t>	GetTagList(Container &dcm_generic)
 	{
 		auto &dcm(dynamic_cast<ContainerDCMTK&>(dcm_generic));
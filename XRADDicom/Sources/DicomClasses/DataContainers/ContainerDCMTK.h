@@ -55,6 +55,10 @@ namespace Dicom
 
 		virtual bool get_pixeldata(RealFunction2D_F32 &img_in, size_t &bpp, bool &is_signed, size_t &ncomp, size_t num_of_frame = 0) const override;
 		virtual bool get_color_pixeldata(ColorImageF32& img) const override;
+		virtual bool get_decoded_pixeldata(decoded_pixeldata &pixeldata, size_t num_of_frame = 0, bool apply_modality_transformation = true) const override;
+		virtual bool get_pixeldata_frames(RealFunctionMD_F32 &img, const vector<pair<size_t, size_t>> &frames) const override;
+		virtual bool get_stored_pixeldata(RealFunction2D_I16 &img_in, size_t num_of_frame = 0) const override;
+		virtual bool get_stored_pixeldata(RealFunction2D_UI16 &img_in, size_t num_of_frame = 0) const override;
 		virtual wstring get_elements_to_wstring(bool byDCMTK) const override;
 		virtual elemsmap_t get_elements_list() const override;
 
@@ -74,6 +78,10 @@ namespace Dicom
 		*/
 		virtual void set_pixeldata(const RealFunction2D_F32 &img_in, size_t bpp, bool is_signed, size_t ncomp)  override;
 		virtual void set_pixeldata_mf(const RealFunctionMD_F32 &img_in, size_t bpp, bool is_signed, size_t ncomp) override;
+		virtual void set_stored_pixeldata(const RealFunction2D_I16 &img_in) override;
+		virtual void set_stored_pixeldata(const RealFunction2D_UI16 &img_in) override;
+		virtual void set_stored_pixeldata_mf(const RealFunctionMD_I16 &img_in) override;
+		virtual void set_stored_pixeldata_mf(const RealFunctionMD_UI16 &img_in) override;
 		virtual bool exist_element(tag_e id) const override;
 		bool exist_element(const DcmTag &dcmTag) const;
 
@@ -100,6 +108,11 @@ namespace Dicom
 		DcmSequenceOfItems *m_per_frame_data_ptr;
 
 		void	SetTransferSyntax(E_TransferSyntax transfer_syntax);
+
+		template<class ARR2D>
+		bool	get_stored_pixeldata_internal(ARR2D &img_in, size_t num_of_frame) const;
+		template<class T>
+		void	set_stored_pixeldata_internal(const T *data, size_t n_pixels, size_t n_frames);
 		void	ForceUTF8Charset();
 
 		unique_ptr<DcmFileFormat> m_dicom_file;
@@ -14,6 +14,9 @@
 #include "Instances/LoadGenericClasses.h"
 #include <XRADBasic/Sources/Utils/ProgressIndicatorScheduler.h>
 #include <XRADBasic/Sources/Utils/ParallelProcessor.h>
+#include <functional>
+#include <atomic>
+#include <mutex>
 
 XRAD_BEGIN
 
@@ -99,6 +102,95 @@ template<class PATIENTS>
 struct PatientsProcessor : public AbstractProcessor<PATIENTS, PatientProcessor<typename PATIENTS::patient_t>>{};
 
 
+//! \brief Одна единица работы при многопоточной обработке иерархической структуры
+struct ProcessingTask
+{
+	std::function<void()>	action;
+	//! \brief Относительная трудоемкость (число instances), используется для балансировки и индикатора прогресса
+	double	cost;
+};
+
+/*!
+	\brief Многопоточное выполнение набора задач с индикатором прогресса, учитывающим их трудоемкость
+
+	Задачи упорядочиваются по убыванию трудоемкости и раздаются потокам по одной по мере их освобождения,
+	поэтому одна "тяжелая" задача не задерживает обработку остальных. Индикатор прогресса обновляется
+	только из основного потока.
+*/
+inline void	PerformProcessingTasks(vector<ProcessingTask> &tasks, const string &message, ProgressProxy pp)
+{
+	if(tasks.empty()) return;
+	std::stable_sort(tasks.begin(), tasks.end(), [](const ProcessingTask &a, const ProcessingTask &b){ return a.cost > b.cost; });
+
+	double	total_cost = 0;
+	for(auto &task: tasks) total_cost += task.cost;
+
+	RandomProgressBar	progress(pp);
+	progress.start(message, total_cost);
+
+	std::atomic<size_t>	next_task(0);
+	std::mutex	done_mutex;
+	double	done_cost = 0;
+
+#ifdef XRAD_DEBUG
+	const bool	parallel = false;
+#else
+	const bool	parallel = true;
+#endif
+
+	ThreadErrorCollector	ec("PerformProcessingTasks");
+	#pragma omp parallel if(parallel)
+	{
+		const bool	master = omp_get_thread_num() == 0;
+		for(;;)
+		{
+			if(ec.HasErrors())
+				break;
+			size_t	i = next_task++;
+			if(i >= tasks.size())
+				break;
+			ThreadSetup ts; (void)ts;
+			try
+			{
+				tasks[i].action();
+				double	position;
+				{
+					std::lock_guard<std::mutex>	lock(done_mutex);
+					position = (done_cost += tasks[i].cost);
+				}
+				if(master)
+					progress.set_position(position);
+			}
+			catch(...)
+			{
+				ec.CatchException();
+			}
+		}
+	}
+	ec.ThrowIfErrors();
+	progress.end();
+}
+
+/*!
+	\brief Интерфейс обработчика, умеющего разложить обработку своих данных на независимые задачи
+
+	Реализуется классом ProcessorRecursive. Позволяет обработчику верхнего уровня собрать задачи
+	со всех вложенных уровней и выполнить их в одном многопоточном цикле.
+
+	Задачи, собранные с вложенного обработчика, выполняются вместо вызова его Apply().
+	Поэтому CollectTasks() должна выполнять ту же обработку, что и Apply() этого объекта.
+*/
+template<class DATA_T>
+struct ProcessingTasksCollector
+{
+	virtual ~ProcessingTasksCollector(){}
+	virtual	bool	parallel() const = 0;
+	//! \brief Добавить в tasks задачи для обработки data
+	virtual	void	CollectTasks(DATA_T &data, vector<ProcessingTask> &tasks) = 0;
+};
+
+
+
 //!	Удаление пустых подсписков. необходимо вызывать после каждой обработки
 inline void	RemoveEmptySublists(Dicom::acquisition_loader &){}// функция, на которой обрывается рекурсия. по хорошему, ей надо быть от шаблона acquisition<>, но пока не удается
 
@@ -115,14 +207,28 @@ void	RemoveEmptySublists(T &data)
 
 
 
-//! Класс, обеспечивающий рекурсивную обработку иерархической структуры
+/*!
+	\brief Класс, обеспечивающий рекурсивную обработку иерархической структуры
+
+	Если обработка на каком-либо уровне разрешена многопоточной (parallel), Apply() собирает
+	задачи со всех вложенных уровней (см. ProcessingTasksCollector) и выполняет их в одном
+	многопоточном цикле. Так все ядра загружены независимо от того, как instances распределены
+	по study/series/stack/acquisition. Элементы списков перебираются итераторами, произвольный
+	доступ к ним не требуется.
+
+	Apply() вложенных рекурсивных обработчиков при сборе задач не вызывается, поэтому
+	переопределять его в производных классах нельзя (Apply() объявлен final). Дополнительную
+	обработку уровня следует выполнять в обработчике элементов (element_processor)
+	или в собственной реализации AbstractProcessor, которая вызывает ProcessorRecursive.
+*/
 template<class PROC_TYPE>
-class ProcessorRecursive : public PROC_TYPE
+class ProcessorRecursive : public PROC_TYPE, public ProcessingTasksCollector<typename PROC_TYPE::data_t>
 {
 	typedef PROC_TYPE processor_t;
 	typedef typename processor_t::data_t data_t;
 	//typedef typename processor_t::element_t element_t;
 	typedef typename processor_t::element_processor_t element_processor_t;
+	typedef typename element_processor_t::data_t element_data_t;
 	shared_ptr<element_processor_t>	element_processor;
 
 	template<class T>
@@ -133,32 +239,55 @@ class ProcessorRecursive : public PROC_TYPE
 	//! brief Член, определяющий возможность многопоточной обработки. По умолчанию false для обработчиков всех уровней, кроме acquisition
 	bool	m_parallel;
 
-	//	Произвольный доступ к элементам списка, нужный для многопоточной обработки.
-	//	Считаем, что выигрыш от многопоточности превышает потери от обхода списка
-	template<class T> T &nth(vector<T> &data, size_t i){ return data[i]; }
-	template<class T> T &nth(list<T> &data, size_t i)
+	//! \brief Обработчик следующего уровня, если он сам может разложить обработку на задачи
+	ProcessingTasksCollector<element_data_t>	*element_collector()
 	{
-		auto it = data.begin();
-		while(i) { ++it; --i; }
-		return *it;
+		return dynamic_cast<ProcessingTasksCollector<element_data_t>*>(element_processor.get());
 	}
 
 public:
 	ProcessorRecursive(shared_ptr<element_processor_t> in_pr, bool parallel = false) : element_processor(in_pr), m_parallel(parallel){}
 
-	//! \brief Выполнить обработку списка, затем удалить пустые элементы. Допускается многопоточная обработка
-	virtual	void Apply(data_t &data, ProgressProxy pp) override
+	virtual	bool	parallel() const override
 	{
-		if(m_parallel)
+		auto	collector = dynamic_cast<const ProcessingTasksCollector<element_data_t>*>(element_processor.get());
+		return m_parallel || (collector && collector->parallel());
+	}
+
+	/*!
+		\brief Сбор задач. Если следующий уровень тоже рекурсивный, задачи собираются с него,
+		иначе каждый элемент списка становится отдельной задачей
+
+		Если этот уровень многопоточный, а вложенные нет, задачи формируются на этом уровне, чтобы
+		не нарушить последовательную обработку внутри элементов.
+	*/
+	virtual	void	CollectTasks(data_t &data, vector<ProcessingTask> &tasks) override
+	{
+		auto	collector = element_collector();
+		if(collector && (collector->parallel() || !m_parallel))
 		{
-			ParallelProcessor	processor;
-			processor.init(data.size(), ParallelProcessor::e_auto);
+			for(auto &next_level : data)
+				collector->CollectTasks(next_level, tasks);
+			return;
+		}
+		auto	processor = element_processor.get();
+		for(auto &next_level : data)
+		{
+			auto	item = &next_level;
+			tasks.push_back({[item, processor](){ processor->Apply(*item, VoidProgressProxy()); }, double(complexity(next_level))});
+		}
+	}
 
-			auto	lambda = [&data, this](size_t frame_no)
-			{
-				element_processor->Apply(nth(data, frame_no), VoidProgressProxy());
-			};
-			processor.perform(lambda, L"Processing", pp);
+	//! \brief Выполнить обработку списка, затем удалить пустые элементы. Допускается многопоточная обработка
+	//!
+	//! final: вложенный обработчик вызывается через CollectTasks() (см. описание класса)
+	virtual	void Apply(data_t &data, ProgressProxy pp) override final
+	{
+		if(parallel())
+		{
+			vector<ProcessingTask>	tasks;
+			CollectTasks(data, tasks);
+			PerformProcessingTasks(tasks, "Processing", pp);
 		}
 		else
 		{
@@ -399,12 +528,18 @@ public:
 		auto current_context = ContextCat(context, const_cast<std::add_const_t<data_t*>>(&data));
 		if(m_parallel)
 		{
+			// Указатели на элементы собираются за один проход, чтобы не обходить список для каждого номера
+			vector<decltype(&*data.begin())>	elements;
+			elements.reserve(data.size());
+			for(auto &element: data)
+				elements.push_back(&element);
+
 			ParallelProcessor	processor;
-			processor.init(data.size(), ParallelProcessor::e_auto);
+			processor.init(elements.size(), ParallelProcessor::e_auto);
 
-			auto	lambda = [&current_context, &data, this](size_t frame_no)
+			auto	lambda = [&current_context, &elements, this](size_t frame_no)
 			{
-				element_processor->Apply(current_context, nth(data, frame_no), VoidProgressProxy());
+				element_processor->Apply(current_context, *elements[frame_no], VoidProgressProxy());
 			};
 			processor.perform(lambda, L"Processing", pp);
 		}
@@ -441,29 +576,6 @@ private:
 
 	size_t	complexity(const cloning_ptr<Dicom::instance >&) { return 1; }
 
-	// Произвольный доступ к элементам списка, нужный для многопоточной обработки.
-	// Считаем, что выигрыш от многопоточности превышает потери от обхода списка.
-	template<class T> std::add_const_t<T> &nth(const vector<T> &data, size_t i)
-	{
-		return data[i];
-	}
-	template<class T> T &nth(vector<T> &data, size_t i)
-	{
-		return data[i];
-	}
-	template<class T> std::add_const_t<T> &nth(const list<T> &data, size_t i)
-	{
-		auto it = data.begin();
-		std::advance(it, i);
-		return *it;
-	}
-	template<class T> T &nth(list<T> &data, size_t i)
-	{
-		auto it = data.begin();
-		std::advance(it, i);
-		return *it;
-	}
-
 private:
 	shared_ptr<element_processor_t> element_processor;
 	//! \brief Флаг, определяющий возможность многопоточной обработки.
@@ -66,9 +66,6 @@ namespace Dicom
 			//size_t ncomponents = 0;
 			size_t ncomponents = dicom_container()->get_uint(e_samples_per_pixel);
 			dicom_container()->get_pixeldata(image_p, bpp, signedness, ncomponents, m_frame_no);
-
-			// Важно: копирование в существующий массив без переаллокирования
-			image_p.CopyData(image_p/*, [&intercept, &slope](auto &y, const auto &x){y = x*slope + intercept;}*/);
 		}
 		virtual void get_image(ColorImageF32& image_p) const
 		{
@@ -79,9 +76,6 @@ namespace Dicom
 			}
 
 			dicom_container()->get_color_pixeldata(image_p);
-
-			// Важно: копирование в существующий массив без переаллокирования
-			image_p.CopyData(image_p/*, [&intercept, &slope](auto &y, const auto &x){y = x*slope + intercept;}*/);
 		}
 		virtual void get_image(RealFunction2D_F32 &image_p, size_t frame_no) const
 		{
@@ -90,7 +84,6 @@ namespace Dicom
 				ForceDebugBreak();
 				throw invalid_argument("Dicom::image::load_image, invalid buffer dimensions");
 			}
-;
 
 			//получаем изображение из файла
 			size_t bpp = dicom_container()->get_uint(e_bits_allocated);
@@ -98,10 +91,90 @@ namespace Dicom
 			//size_t ncomponents = 0;
 			size_t ncomponents = dicom_container()->get_uint(e_samples_per_pixel);
 			dicom_container()->get_pixeldata(image_p, bpp, signedness, ncomponents, frame_no);
+		}
+
+		//! \brief Получение набора кадров мультифрейма непосредственно в срезы трехмерного массива:
+		//!	кадр frames[i].first помещается в срез frames[i].second. Кадры JPEG2000 декодируются параллельно
+		void get_frames(RealFunctionMD_F32 &images_p, const vector<pair<size_t, size_t>> &frames) const
+		{
+			if (images_p.n_dimensions() != 3 || images_p.sizes(1) != vsize() || images_p.sizes(2) != hsize())
+			{
+				ForceDebugBreak();
+				throw invalid_argument("Dicom::image::get_frames, invalid buffer dimensions");
+			}
+			if(!dicom_container()->get_pixeldata_frames(images_p, frames))
+				throw runtime_error("Dicom::image::get_frames, cannot decode frames");
+		}
+
+		/*!
+			\brief Получение изображения с учетом slope и intercept, совмещенное с первой попиксельной
+			операцией вызывающего кода (например, окно или ограничение диапазона)
+
+			Декодированные отсчеты переносятся в буфер за один проход: image_p = f(x*slope + intercept),
+			где x -- хранимое значение, f принимает double. Используется только линейное преобразование
+			rescale slope/intercept, таблицы Modality LUT не поддерживаются.
+		*/
+		template<class ARR2D, class F>
+		void get_image(ARR2D &image_p, size_t frame_no, const F &f) const
+		{
+			if (image_p.vsize() != vsize() || image_p.hsize() != hsize())
+			{
+				ForceDebugBreak();
+				throw invalid_argument("Dicom::image::load_image, invalid buffer dimensions");
+			}
+			decoded_pixeldata	pixeldata;
+			if(!dicom_container()->get_decoded_pixeldata(pixeldata, frame_no, false))
+				throw runtime_error("Dicom::image::get_image, cannot decode pixel data");
 
-			// Важно: копирование в существующий массив без переаллокирования
-			image_p.CopyData(image_p/*, [&intercept, &slope](auto &y, const auto &x){y = x*slope + intercept;}*/);
+			const double	slope = rescale_slope(frame_no);
+			const double	intercept = rescale_intercept(frame_no);
+			CopyDecodedPixeldata(image_p, pixeldata, [&f, slope, intercept](const auto &x) { return f(x*slope + intercept); });
+		}
+
+		//! \brief Получение изображения в том виде, как оно хранится в файле (без учета slope и intercept).
+		//!	Значения в единицах модальности (например, HU): x*rescale_slope(frame_no) + rescale_intercept(frame_no)
+		template<class ARR2D>
+		void get_stored_image(ARR2D &image_p, size_t frame_no) const
+		{
+			if (image_p.vsize() != vsize() || image_p.hsize() != hsize())
+			{
+				ForceDebugBreak();
+				throw invalid_argument("Dicom::image::get_stored_image, invalid buffer dimensions");
+			}
+			if(!dicom_container()->get_stored_pixeldata(image_p, frame_no))
+				throw runtime_error("Dicom::image::get_stored_image, cannot extract stored pixel data");
+		}
+		template<class ARR2D>
+		void get_stored_image(ARR2D &image_p) const { get_stored_image(image_p, m_frame_no); }
+
+		//! \brief Выгрузка хранимых значений (без slope и intercept) без промежуточного преобразования в float.
+		//!	rescale_slope и rescale_intercept в файле не меняются
+		template<class ARR2D>
+		void set_stored_image(const ARR2D &image_p)
+		{
+			set_vsize(image_p.vsize());
+			set_hsize(image_p.hsize());
+			dicom_container()->set_stored_pixeldata(image_p);
+		}
+		//! \brief Выгрузка хранимых значений мультифрейма (без slope и intercept)
+		template<class ARR_MD>
+		void set_stored_mf_images(const ARR_MD &image_p)
+		{
+			set_vsize(image_p.sizes(1));
+			set_hsize(image_p.sizes(2));
+			dicom_container()->set_stored_pixeldata_mf(image_p);
+		}
+
+		//! \brief Коэффициенты перевода хранимых значений в единицы модальности.
+		//!	При отсутствии тегов в файле возвращаются 1 и 0 соответственно
+		double rescale_slope(size_t frame_no) const
+		{
+			double	slope = dicom_container()->get_double(e_rescale_slope, frame_no, 1);
+			return slope ? slope : 1;
 		}
+		double rescale_intercept(size_t frame_no) const { return dicom_container()->get_double(e_rescale_intercept, frame_no, 0); }
+		double rescale_slope() const { return rescale_slope(m_frame_no); }
+		double rescale_intercept() const { return rescale_intercept(m_frame_no); }
 
 		//! \brief Получение изображения с учетом поправок slope и intercept во вновь создаваемый буфер
 		virtual  RealFunction2D_F32 get_image() const
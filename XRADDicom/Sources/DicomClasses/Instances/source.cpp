@@ -12,6 +12,8 @@
 #include "source.h"
 
 #include <XRADDicom/Sources/Utils/Utils.h>
+#include <XRADDicom/Sources/DCMTKAccess/dcmtkCodec.h>
+#include <XRADBasic/Sources/Utils/ParallelProcessor.h>
 
 XRAD_BEGIN
 
@@ -222,6 +224,77 @@ namespace Dicom
 		m_init_from_preindex = false;
 	}
 
+
+
+
+	//batch_writer--------------------------------------------------------------------------------
+	batch_writer::batch_writer(e_compression_type_t encoding)
+		: m_encoding(encoding),
+		// кодер остается зарегистрированным, пока существует этот объект
+		m_codec(make_unique<dcmtkCodec>(dcmtkCodec::e_encode, dcmtkCodec::getEncodingTransferSyntax(encoding)))
+	{
+	}
+
+	batch_writer::~batch_writer()
+	{
+	}
+
+	void batch_writer::add(source &s, const wstring &full_file_path)
+	{
+		if (full_file_path == L"")
+			throw runtime_error("batch_writer::add, full file path is empty!");
+		if (contains(s))
+			throw invalid_argument("batch_writer::add, the container is already queued.");
+		m_queue.emplace_back(s.dicom_container(), full_file_path);
+	}
+
+	bool batch_writer::contains(const source &s) const
+	{
+		auto	container = s.dicom_container().get();
+		for (auto &item: m_queue)
+		{
+			if (item.first.get() == container)
+				return true;
+		}
+		return false;
+	}
+
+	void batch_writer::flush(ProgressProxy pp)
+	{
+		if (m_queue.empty())
+			return;
+		// очередь очищается в любом случае, чтобы после ошибки не повторять запись
+		auto	queue = std::move(m_queue);
+		m_queue.clear();
+
+#ifdef XRAD_DEBUG
+		auto	mode = ParallelProcessor::e_force_plain;
+#else
+		auto	mode = ParallelProcessor::e_auto;
+#endif
+		ParallelProcessor	processor;
+		processor.init(queue.size(), mode, 1);
+		// Сжатие одного файла занимает значительное время, поэтому порцию не укрупняем.
+		// Ошибка в одном файле не должна прерывать запись остальных.
+		processor.set_error_process_mode(ParallelProcessor::skip_nothing);
+
+		auto	lambda = [&queue, this](size_t i)
+		{
+			if (!queue[i].first->save_to_file(queue[i].second, m_encoding))
+				throw runtime_error("Can't save a new dicom file " + convert_to_string(queue[i].second));
+		};
+		map<size_t, wstring>	errors;
+		processor.perform(lambda, L"Saving Dicom files", pp, errors);
+
+		if (!errors.empty())
+		{
+			wstring	message = ssprintf(L"Errors while saving %zu of %zu files:", errors.size(), queue.size());
+			for (auto &e: errors)
+				message += L"\n" + e.second;
+			throw runtime_error(convert_to_string(message));
+		}
+	}
+
 }//namespace Dicom
 
 XRAD_END
@@ -124,6 +124,43 @@ namespace Dicom
 		shared_ptr<Container> m_dicom_container;
 	};
 
+
+
+	class dcmtkCodec;
+
+	/*!
+		\brief Пакетная запись Dicom-данных в файлы
+
+		Накопленные в очереди контейнеры сжимаются и записываются параллельно (flush()).
+		Кодеры регистрируются один раз на все время существования объекта, а не при записи каждого файла.
+
+		Контейнер не должен изменяться, пока он стоит в очереди. Если несколько источников используют
+		общий контейнер (кадры мультифрейма), перед изменением контейнера следует проверить contains()
+		и при необходимости вызвать flush().
+	*/
+	class batch_writer
+	{
+	public:
+		batch_writer(e_compression_type_t encoding = e_uncompressed);
+		batch_writer(const batch_writer &) = delete;
+		batch_writer &operator=(const batch_writer &) = delete;
+		~batch_writer();
+
+		//! \brief Поставить в очередь на запись. Запись выполняется при вызове flush()
+		void	add(source &s, const wstring &full_file_path);
+		//! \brief true, если контейнер источника уже стоит в очереди
+		bool	contains(const source &s) const;
+		size_t	size() const { return m_queue.size(); }
+
+		//! \brief Записать все файлы очереди и очистить ее. При ошибках кидает исключение после записи остальных файлов
+		void	flush(ProgressProxy pp = VoidProgressProxy());
+
+	private:
+		e_compression_type_t	m_encoding;
+		unique_ptr<dcmtkCodec>	m_codec;
+		vector<pair<shared_ptr<Container>, wstring>>	m_queue;
+	};
+
 }//namespace Dicom
 
 
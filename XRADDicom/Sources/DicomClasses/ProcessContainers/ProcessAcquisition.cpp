@@ -43,8 +43,14 @@ void ProcessAcquisition::save_to_file (const wstring &folder_path, e_saving_deci
 	if (m_acquisition_loader->front()->frames_number() != 0)
 		saving_decision = e_save_to_new_file;
 
-	ProgressBar	progress(pp);
-	progress.start("Saving " + classname(), n_elements());
+	// Данные помещаются в контейнеры последовательно, сжатие и запись файлов выполняются параллельно
+	// одним пакетом (кодеры регистрируются один раз на весь пакет)
+	Dicom::batch_writer	writer(compression);
+
+	RandomProgressBar	progress(pp);
+	progress.start("Saving " + classname(), 1);
+	ProgressBar	prepare_progress(progress.subprogress(0, 0.2));
+	prepare_progress.start("Preparing " + classname(), n_elements());
 	for (size_t i = 0; i < n_elements(); i++)
 	{
 		//создаём объект, который поместит в себя данные и сохранит их в файл
@@ -52,6 +58,11 @@ void ProcessAcquisition::save_to_file (const wstring &folder_path, e_saving_deci
 		//Dicom::instance_ptr instance{ m_acquisition_loader->front() };
 		Dicom::instance_ptr instance{ (*m_acquisition_loader)[i] };
 
+		// кадры мультифрейма используют общий контейнер: прежде чем менять его,
+		// нужно записать уже поставленные в очередь данные
+		if (writer.contains(*instance))
+			writer.flush();
+
 		wstring	filename;
 		if(saving_decision == e_save_to_new_file)
 		{
@@ -76,7 +87,7 @@ void ProcessAcquisition::save_to_file (const wstring &folder_path, e_saving_deci
 		if(instance->instance_storage()->type() == Dicom::instancestorage_t::file)
 		{
 			//filename = folder_path + L"/" + dynamic_cast<Dicom::instancestorage_file&>(*instance->instance_storage()).file_name();
-			instance->save_to_file(filename, compression);
+			writer.add(*instance, filename);
 		}
 		else
 		{
@@ -86,8 +97,11 @@ void ProcessAcquisition::save_to_file (const wstring &folder_path, e_saving_deci
 		//instance->clear();
 		//instance->close_instancestorage(true); //todo (Kovbas) либо закрывает тот, кто открыл, либо использовать контейнер, который сам закрое при выходе из функции
 
-		++progress;
+		++prepare_progress;
 	}
+	prepare_progress.end();
+
+	writer.flush(progress.subprogress(0.2, 1));
 }
 /*
 void set_file_objects_for_multiframe(Dicom::acquisition_loader& source_tomogram)
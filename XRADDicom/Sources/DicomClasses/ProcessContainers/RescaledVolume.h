@@ -0,0 +1,200 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_RescaledVolume_h
+#define XRAD__File_RescaledVolume_h
+/*!
+	\file
+	\brief Томограмма, хранящая целочисленные отсчеты в том виде, как они записаны в Dicom-файлах,
+	и коэффициенты rescale slope/intercept для каждого среза
+*/
+//--------------------------------------------------------------
+
+#include <XRADBasic/MathFunctionTypes.h>
+#include <XRADBasic/MathFunctionTypesMD.h>
+#include <limits>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Трехмерный массив целочисленных хранимых значений (например, int16) с коэффициентами
+	перевода в единицы модальности (HU для КТ)
+
+	Значение в единицах модальности: stored*slope(z) + intercept(z).
+
+	Занимает вдвое меньше памяти, чем RealFunctionMD_F32. Перевод в единицы модальности
+	выполняется "на лету" по срезам (GetRescaledSlice, ForEachRescaledSlice) или поэлементно
+	(rescaled_value), полный массив float создается только по явному запросу (rescaled()).
+
+	Запись обратно в Dicom (image::set_stored_image) происходит без потерь и без промежуточного
+	массива float.
+*/
+template<class ARR_MD>
+class RescaledVolume
+{
+public:
+	typedef RescaledVolume<ARR_MD> self;
+	typedef ARR_MD stored_array_type;
+	typedef typename ARR_MD::value_type stored_value_type;
+	typedef typename ARR_MD::slice_type stored_slice_type;
+	typedef typename ARR_MD::slice_type_invariable stored_slice_type_invariable;
+
+	//! \name Конструкторы и инициализация
+	//! @{
+	RescaledVolume(){}
+	explicit RescaledVolume(const index_vector &in_sizes){ realloc(in_sizes); }
+
+	//! \brief Выделение памяти. Коэффициенты slope, intercept устанавливаются в 1 и 0
+	void	realloc(const index_vector &in_sizes)
+	{
+		if(in_sizes.size() != 3)
+			throw invalid_argument(ssprintf("RescaledVolume::realloc, invalid dimensions number = %zu", in_sizes.size()));
+		m_stored.realloc(in_sizes);
+		m_slopes.realloc(in_sizes[0], 1);
+		m_intercepts.realloc(in_sizes[0], 0);
+	}
+	//! @}
+
+	//! \name Info
+	//! @{
+	bool	empty() const { return m_stored.empty(); }
+	const index_vector	&sizes() const { return m_stored.sizes(); }
+	size_t	sizes(size_t dim) const { return m_stored.sizes(dim); }
+	size_t	n_slices() const { return m_stored.sizes(0); }
+	//! @}
+
+	//! \name Доступ к хранимым данным и коэффициентам
+	//! @{
+	stored_array_type	&stored(){ return m_stored; }
+	const stored_array_type	&stored() const { return m_stored; }
+
+	const RealFunctionF64	&slopes() const { return m_slopes; }
+	const RealFunctionF64	&intercepts() const { return m_intercepts; }
+	double	slope(size_t slice_no) const { return m_slopes[slice_no]; }
+	double	intercept(size_t slice_no) const { return m_intercepts[slice_no]; }
+
+	void	set_rescale(size_t slice_no, double in_slope, double in_intercept)
+	{
+		if(!in_slope)
+			throw invalid_argument("RescaledVolume::set_rescale, zero slope");
+		m_slopes[slice_no] = in_slope;
+		m_intercepts[slice_no] = in_intercept;
+	}
+
+	//! \brief true, если у всех срезов одинаковые slope и intercept
+	bool	uniform_rescale() const
+	{
+		for(size_t i = 1; i < n_slices(); ++i)
+		{
+			if(m_slopes[i] != m_slopes[0] || m_intercepts[i] != m_intercepts[0])
+				return false;
+		}
+		return true;
+	}
+	//! @}
+
+	//! \name Значения в единицах модальности
+	//! @{
+
+	//! \brief Значение одного элемента. Медленный способ, для массовой обработки следует использовать срезы
+	double	rescaled_value(const index_vector &iv) const
+	{
+		return m_stored.at(iv)*m_slopes[iv[0]] + m_intercepts[iv[0]];
+	}
+
+	//! \brief Перевод одного среза в единицы модальности в заранее подготовленный буфер
+	template<class ARR2D>
+	void	GetRescaledSlice(ARR2D &slice, size_t slice_no) const
+	{
+		const double	s = m_slopes[slice_no];
+		const double	i = m_intercepts[slice_no];
+		if(slice.vsize() != sizes(1) || slice.hsize() != sizes(2))
+			throw invalid_argument("RescaledVolume::GetRescaledSlice, invalid buffer dimensions");
+		slice.CopyData(stored_slice(slice_no), [s, i](auto &y, const stored_value_type &x){ y = x*s + i; });
+	}
+
+	//! \brief Запись среза в единицах модальности с обратным преобразованием, округлением
+	//!	и ограничением диапазоном хранимого типа
+	template<class ARR2D>
+	void	SetRescaledSlice(size_t slice_no, const ARR2D &slice)
+	{
+		const double	s = m_slopes[slice_no];
+		const double	i = m_intercepts[slice_no];
+		const double	min_value = numeric_limits<stored_value_type>::min();
+		const double	max_value = numeric_limits<stored_value_type>::max();
+		auto	destination = m_stored.GetSlice({slice_no, slice_mask(0), slice_mask(1)});
+		destination.CopyData(slice, [s, i, min_value, max_value](stored_value_type &y, const auto &x)
+			{
+				y = static_cast<stored_value_type>(range(round_n((double(x) - i)/s), min_value, max_value));
+			});
+	}
+
+	/*!
+		\brief Обработка всех срезов в единицах модальности без создания полного массива float
+
+		Функтор вызывается как f(const RealFunction2D_F32 &rescaled_slice, size_t slice_no).
+		При omp == e_use_omp срезы обрабатываются параллельно (каждый поток использует
+		собственный буфер размером в один срез), функтор должен быть потокобезопасным.
+	*/
+	template<class F>
+	void	ForEachRescaledSlice(const F &f, omp_usage_t omp = e_use_omp) const
+	{
+		ThreadErrorCollector ec("RescaledVolume::ForEachRescaledSlice");
+		#pragma omp parallel if(omp == e_use_omp)
+		{
+			RealFunction2D_F32	buffer(sizes(1), sizes(2));
+			#pragma omp for schedule (guided)
+			for(ptrdiff_t z = 0; z < ptrdiff_t(n_slices()); ++z)
+			{
+				if (ec.HasErrors())
+					continue;
+				ThreadSetup ts; (void)ts;
+				try
+				{
+					GetRescaledSlice(buffer, z);
+					f(buffer, size_t(z));
+				}
+				catch (...)
+				{
+					ec.CatchException();
+				}
+			}
+		}
+		ec.ThrowIfErrors();
+	}
+
+	//! \brief Полный перевод в единицы модальности. Требует памяти на весь массив float
+	RealFunctionMD_F32	rescaled() const
+	{
+		RealFunctionMD_F32	result(sizes());
+		for(size_t z = 0; z < n_slices(); ++z)
+		{
+			auto	slice = result.GetSlice({z, slice_mask(0), slice_mask(1)});
+			GetRescaledSlice(slice, z);
+		}
+		return result;
+	}
+	//! @}
+
+	//! \brief Ссылка на срез хранимых значений
+	auto	stored_slice(size_t slice_no) { return m_stored.GetSlice({slice_no, slice_mask(0), slice_mask(1)}); }
+	auto	stored_slice(size_t slice_no) const { return m_stored.GetSlice({slice_no, slice_mask(0), slice_mask(1)}); }
+
+private:
+	stored_array_type	m_stored;
+	RealFunctionF64	m_slopes;
+	RealFunctionF64	m_intercepts;
+};
+
+typedef RescaledVolume<RealFunctionMD_I16> RescaledVolumeI16;
+typedef RescaledVolume<RealFunctionMD_UI16> RescaledVolumeUI16;
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_RescaledVolume_h
@@ -14,6 +14,7 @@
 #include <XRADDicom/Sources/DicomClasses/Instances/ct_slice.h>
 
 #include <XRADBasic/Sources/Utils/ParallelProcessor.h>
+#include <map>
 //#include <XRADDicom/DicomClasses/DicomStorageAnalyze.h>
 
 XRAD_BEGIN
@@ -318,6 +319,10 @@ RealFunctionMD_F32    TomogramAcquisition::load_ordered_slices(
 
 	slices.realloc({ slice_order.size(),first_slice.vsize(), first_slice.hsize() });
 
+	// кадры мультифреймов собираются по экземплярам и декодируются одним вызовом (параллельно для JPEG2000):
+	// номер экземпляра -> список пар (номер кадра, номер среза)
+	map<size_t, vector<pair<size_t, size_t>>>	multiframe_slices;
+
 	for (size_t i = 0; i < slice_order.size(); i++)
 	{
 		auto instance_index = slice_order[i].first;
@@ -336,14 +341,58 @@ RealFunctionMD_F32    TomogramAcquisition::load_ordered_slices(
 
 		else
 		{
-			current_slice.get_image(slices.GetSlice({ i, slice_mask(0), slice_mask(1) }).ref(), slice_order[i].second);
+			multiframe_slices[instance_index].emplace_back(slice_order[i].second, i);
 		}
 	}
 
+	for (auto &instance_frames: multiframe_slices)
+	{
+		auto el = (*m_acquisition_loader)[instance_frames.first];
+		Dicom::tomogram_slice &current_slice = dynamic_cast<Dicom::tomogram_slice&>(*el);
+		current_slice.get_frames(slices, instance_frames.second);
+	}
+
 	return slices;
 }
 
 
+template<class RV>
+void	TomogramAcquisition::load_ordered_stored_slices(RV &volume,
+	const vector<pair<size_t, size_t>> &slice_order) const
+{
+	Dicom::tomogram_slice &first_slice = dynamic_cast<Dicom::tomogram_slice&>(*(m_acquisition_loader->front()));
+
+	volume.realloc({ slice_order.size(), first_slice.vsize(), first_slice.hsize() });
+
+	for (size_t i = 0; i < slice_order.size(); i++)
+	{
+		auto instance_index = slice_order[i].first;
+
+		XRAD_ASSERT_THROW_M(instance_index < slice_order.size(), runtime_error,
+			"Invalid slice order data: index is too big.");
+
+		auto el = (*m_acquisition_loader)[instance_index];
+		Dicom::tomogram_slice &current_slice = dynamic_cast<Dicom::tomogram_slice&>(*el);
+
+		size_t	frame_no = current_slice.get_m_frame_no() ? slice_order[i].second : 0;
+		auto	destination = volume.stored_slice(i);
+		current_slice.get_stored_image(destination.ref(), frame_no);
+		volume.set_rescale(i, current_slice.rescale_slope(frame_no), current_slice.rescale_intercept(frame_no));
+	}
+}
+
+void	TomogramAcquisition::load_ordered_slices(RescaledVolumeI16 &volume,
+	const vector<pair<size_t, size_t>> &slice_order) const
+{
+	load_ordered_stored_slices(volume, slice_order);
+}
+
+void	TomogramAcquisition::load_ordered_slices(RescaledVolumeUI16 &volume,
+	const vector<pair<size_t, size_t>> &slice_order) const
+{
+	load_ordered_stored_slices(volume, slice_order);
+}
+
 vector<pair<size_t, size_t>> TomogramAcquisition::determine_slice_order() const
 {
 	size_t sort_axis = 0;
@@ -13,6 +13,7 @@
 //--------------------------------------------------------------
 
 #include "ProcessAcquisition.h"
+#include "RescaledVolume.h"
 #include <XRADBasic/LinearVectorTypes.h>
 #include <XRADBasic/MathFunctionTypesMD.h>
 #include <XRADBasic/Sources/Containers/VectorFunction.h>
@@ -66,12 +67,24 @@ public:
 	//! \brief Загрузить данные, упорядоченные в соответствии с determine_slice_order()
 	RealFunctionMD_F32	load_ordered_slices() const;
 	RealFunctionMD_F32	load_ordered_slices(const vector<pair<size_t, size_t>> &slice_order) const;
+
+	//! \brief Загрузить хранимые целочисленные значения срезов вместе с коэффициентами
+	//!	rescale slope/intercept каждого среза, без промежуточного массива float
+	void	load_ordered_slices(RescaledVolumeI16 &volume, const vector<pair<size_t, size_t>> &slice_order) const;
+	void	load_ordered_slices(RescaledVolumeUI16 &volume, const vector<pair<size_t, size_t>> &slice_order) const;
+	void	load_ordered_slices(RescaledVolumeI16 &volume) const { load_ordered_slices(volume, determine_slice_order()); }
+	void	load_ordered_slices(RescaledVolumeUI16 &volume) const { load_ordered_slices(volume, determine_slice_order()); }
+
 	vector<pair<size_t, size_t>> determine_slice_order() const;
 	vector<pair<size_t, size_t>>	non_sorted_slice_order() const;
 
 	//! \brief Определяет ось, по которой следует производить сортировку срезов томограммы.
 	//! Выбирает ту ось, по которой происходит самая большая разница
 	bool sort_axis(size_t &sort_axis_p) const;
+
+private:
+	template<class RV>
+	void	load_ordered_stored_slices(RV &volume, const vector<pair<size_t, size_t>> &slice_order) const;
 };
 
 //--------------------------------------------------------------
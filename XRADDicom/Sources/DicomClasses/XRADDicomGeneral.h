@@ -45,7 +45,9 @@ namespace Dicom
 		e_jpeg2k,
 
 		// используются для компрессии
-		e_jpeg_lossless
+		e_jpeg_lossless,
+		e_jpeg_ls_lossless,
+		e_jpeg2k_lossless
 	};
 
 
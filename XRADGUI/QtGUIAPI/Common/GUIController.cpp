@@ -427,7 +427,9 @@ void GUIController::InitDialogs()
 	make_connection_bc(request_SetProgressPosition, do_SetProgressPosition);
 	make_connection_bc(request_EndProgress, do_EndProgress);
 
-	make_connection_bc(request_UpdateConsole, do_UpdateConsole);
+	// обновление консоли не должно задерживать счет. сигналы от рабочего потока к одному получателю
+	// обрабатываются в порядке отправки, поэтому следующие за ним blocking запросы его не обгонят
+	make_connection_qc(request_UpdateConsole, do_UpdateConsole);
 
 	make_connection_bc(request_CloseDataWindow, do_CloseDataWindow);
 	make_connection_bc(request_HideDataWindow, do_HideDataWindow);
@@ -445,6 +447,8 @@ void GUIController::InitDialogs()
 
 	make_connection_bc(request_CreateRasterImageSet, do_CreateRasterImageSet);
 	make_connection_bc(request_SetupImageFrame, do_SetupImageFrame);
+	make_connection_bc(request_SetImageFrameProvider, do_SetImageFrameProvider);
+	make_connection_bc(request_SetImageUpdateChannel, do_SetImageUpdateChannel);
 	make_connection_bc(request_AddImageFrames, do_AddImageFrames);
 	make_connection_bc(request_SetupImageLabels, do_SetupImageLabels);
 	make_connection_bc(request_SetupImageDefaultRanges, do_SetupImageDefaultRanges);
@@ -12,6 +12,7 @@
 *********************************************************************/
 
 #include "FrameBitmapContainer.h"
+#include <XRADBasic/Sources/Utils/ImagePyramid.h>
 
 namespace XRAD_GUI
 {
@@ -89,9 +90,28 @@ class MultimodalFrameContainer
 		xrad::DataArray2D<xrad::DataArray<complexI32> >		complex_i32;
 		xrad::DataArray2D<xrad::DataArray<complexI16> >		complex_i16;
 
+		// большие вещественные и цветные кадры хранятся только в виде пирамиды из тайлов
+		// (см. ImagePyramid.h), соответствующий массив выше при этом пуст
+		xrad::ImagePyramid<float>			gray_pyramid;
+		xrad::ImagePyramid<ColorSampleF32>	rgb_pyramid;
+		display_sample_type	pyramid_sample_type = gray_sample_f32;
+
 		display_sample_type	ContainerMode();
 
 	public:
+		//! \brief Кадры, у которых хотя бы одна сторона больше этого размера, хранятся по тайлам
+		static	const int	tiled_frame_size = 4096;
+
+		//! \brief Кадр хранится по тайлам: показывать следует только видимую область (GenerateRegionBitmap)
+		bool	Tiled() const { return !gray_pyramid.empty() || !rgb_pyramid.empty(); }
+		//! \brief Уровень пирамиды для масштаба scale (экранных точек на отсчет), см. ImagePyramid::LevelForScale
+		size_t	TiledLevel(double scale) const;
+		size_t	TiledLevelVSize(size_t level) const;
+		size_t	TiledLevelHSize(size_t level) const;
+		//! \brief Растр области уровня level размером vs*hs с левым верхним углом (v0, h0) (в отсчетах уровня)
+		void	GenerateRegionBitmap(FrameBitmapContainer &bitmap, size_t level, ptrdiff_t v0, ptrdiff_t h0, size_t vs, size_t hs,
+				double min_value, double max_value, double gamma, bool transpose);
+
 
 		QString	GetValueLegend(int row_no, int col_no);
 		void	ImportFrame(const void *in_data, int n_rows, int n_columns, display_sample_type sample_type);
@@ -12,6 +12,12 @@ namespace XRAD_GUI
 
 inline void XRAD_GUI::MultimodalFrameContainer::GenerateBitmap(FrameBitmapContainer &bitmap, double min_value, double max_value, double gamma, bool transpose)
 	{
+	if(Tiled())
+		{
+		GenerateRegionBitmap(bitmap, 0, 0, 0, TiledLevelVSize(0), TiledLevelHSize(0), min_value, max_value, gamma, transpose);
+		return;
+		}
+
 	brightness_correction_functor<uint8_t> functor(min_value, max_value, gamma);
 
 	switch(ContainerMode())
@@ -71,6 +77,45 @@ inline void XRAD_GUI::MultimodalFrameContainer::GenerateBitmap(FrameBitmapContai
 		}
 	}
 
+inline size_t MultimodalFrameContainer::TiledLevel(double scale) const
+	{
+	return gray_pyramid.empty() ? rgb_pyramid.LevelForScale(scale) : gray_pyramid.LevelForScale(scale);
+	}
+
+inline size_t MultimodalFrameContainer::TiledLevelVSize(size_t level) const
+	{
+	return gray_pyramid.empty() ? rgb_pyramid.vsize(level) : gray_pyramid.vsize(level);
+	}
+
+inline size_t MultimodalFrameContainer::TiledLevelHSize(size_t level) const
+	{
+	return gray_pyramid.empty() ? rgb_pyramid.hsize(level) : gray_pyramid.hsize(level);
+	}
+
+inline void MultimodalFrameContainer::GenerateRegionBitmap(FrameBitmapContainer &bitmap, size_t level, ptrdiff_t v0, ptrdiff_t h0, size_t vs, size_t hs,
+		double min_value, double max_value, double gamma, bool transpose)
+	{
+	brightness_correction_functor<uint8_t> functor(min_value, max_value, gamma);
+
+	// в растр попадает только запрошенная область, отсчеты берутся из пересекающихся с ней тайлов
+	if(!gray_pyramid.empty())
+		{
+		xrad::DataArray2D<xrad::DataArray<float> >	region(vs, hs);
+		gray_pyramid.GetRegion(region, level, v0, h0);
+		bitmap.SetFrameData(region, transpose, functor);
+		}
+	else if(!rgb_pyramid.empty())
+		{
+		xrad::DataArray2D<xrad::DataArray<ColorSampleF32> >	region(vs, hs);
+		rgb_pyramid.GetRegion(region, level, v0, h0);
+		bitmap.SetFrameData(region, transpose, functor);
+		}
+	else
+		{
+		throw invalid_argument("MultimodalFrameContainer::GenerateRegionBitmap, frame is not tiled");
+		}
+	}
+
 
 inline display_sample_type MultimodalFrameContainer::ContainerMode()
 	{
@@ -89,6 +134,8 @@ inline display_sample_type MultimodalFrameContainer::ContainerMode()
 	if(complex_f64.ready()) ++counter;
 	if(complex_i32.ready()) ++counter;
 	if(complex_i16.ready()) ++counter;
+	if(!gray_pyramid.empty()) ++counter;
+	if(!rgb_pyramid.empty()) ++counter;
 
 	if(counter != 1)
 		{
@@ -148,6 +195,14 @@ inline display_sample_type MultimodalFrameContainer::ContainerMode()
 		{
 		return complex_sample_i16;
 		}
+	if(!gray_pyramid.empty())
+		{
+		return pyramid_sample_type;
+		}
+	if(!rgb_pyramid.empty())
+		{
+		return rgb_sample_f32;
+		}
 
 
 	// попадание сюда логикой исключается, но во избежание предупреждений генерируем исключение
@@ -170,6 +225,8 @@ inline void MultimodalFrameContainer::ImportFrame( const void *in_data, int n_ro
 	if(sample_type != complex_sample_f64) complex_f64.realloc(0,0);
 	if(sample_type != complex_sample_i32) complex_i32.realloc(0,0);
 	if(sample_type != complex_sample_i16) complex_i16.realloc(0,0);
+	gray_pyramid.clear();
+	rgb_pyramid.clear();
 
 	if(sample_type == gray_sample_ui8 || sample_type == indexed_color_sample_ui8)
 		{
@@ -236,6 +293,23 @@ inline void MultimodalFrameContainer::ImportFrame( const void *in_data, int n_ro
 		complex_i16.realloc(n_rows, n_columns);
 		complex_i16.CopyData(static_cast<const complexI16*>(in_data));
 		}
+
+	// большой кадр переносится в пирамиду, показывается только его видимая часть
+	if(max(n_rows, n_columns) > tiled_frame_size)
+		{
+		if(sample_type == gray_sample_f32 || sample_type == gray_sample_f64)
+			{
+			auto	&gray = sample_type == gray_sample_f32 ? gray_f32 : gray_f64;
+			gray_pyramid.Init(gray);
+			pyramid_sample_type = sample_type;
+			gray.realloc(0,0);
+			}
+		if(sample_type == rgb_sample_f32)
+			{
+			rgb_pyramid.Init(rgb_f32);
+			rgb_f32.realloc(0,0);
+			}
+		}
 	}
 
 inline int display_value_order(double a){return a>1e3 ? log10(a) : log10(a)-1;}
@@ -276,6 +350,11 @@ inline string RGBValueLegend(RGBColorSample<RGB_T> v)
 inline QString MultimodalFrameContainer::GetValueLegend( int row_no, int col_no )
 	{
 	string	result;
+	if(!gray_pyramid.empty())
+		return QString::fromStdString(ssprintf("%g", gray_pyramid.at(0, row_no, col_no)));
+	if(!rgb_pyramid.empty())
+		return QString::fromStdString(RGBValueLegend(rgb_pyramid.at(0, row_no, col_no)));
+
 	switch(ContainerMode())
 		{
 		case rgba_sample_ui8:
@@ -341,8 +420,32 @@ inline QString MultimodalFrameContainer::GetValueLegend( int row_no, int col_no
 	}
 
 
+template<class T>
+inline double TiledMaxComponentValue(const xrad::ImagePyramid<T> &pyramid)
+	{
+	double	result = -max_double();
+	for(size_t i = 0; i < pyramid.n_tile_rows(0); ++i)
+		for(size_t j = 0; j < pyramid.n_tile_columns(0); ++j)
+			result = max(result, xrad::MaxComponentValue(pyramid.tile(0, i, j)));
+	return result;
+	}
+
+template<class T>
+inline double TiledMinComponentValue(const xrad::ImagePyramid<T> &pyramid)
+	{
+	double	result = max_double();
+	for(size_t i = 0; i < pyramid.n_tile_rows(0); ++i)
+		for(size_t j = 0; j < pyramid.n_tile_columns(0); ++j)
+			result = min(result, xrad::MinComponentValue(pyramid.tile(0, i, j)));
+	return result;
+	}
+
+
 inline double MultimodalFrameContainer::MaxComponentValue()
 	{
+	if(Tiled())
+		return gray_pyramid.empty() ? TiledMaxComponentValue(rgb_pyramid) : TiledMaxComponentValue(gray_pyramid);
+
 	switch(ContainerMode())
 		{
 		case rgba_sample_ui8:
@@ -405,6 +508,9 @@ inline double MultimodalFrameContainer::MaxComponentValue()
 
 inline double MultimodalFrameContainer::MinComponentValue()
 	{
+	if(Tiled())
+		return gray_pyramid.empty() ? TiledMinComponentValue(rgb_pyramid) : TiledMinComponentValue(gray_pyramid);
+
 	switch(ContainerMode())
 		{
 		case rgba_sample_ui8:
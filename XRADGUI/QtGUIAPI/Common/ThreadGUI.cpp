@@ -539,10 +539,25 @@ bool ThreadGUI::do_AddImageFrames(ImageWindow* img, size_t n_frames)
 bool ThreadGUI::do_SetupImageFrame(ImageWindow* img, int in_frame_no, const void* data, display_sample_type pt)
 {
 	if (!gui_controller.WidgetExists(img)) return false;
+	// кадры, отправленные раньше через канал (см. do_SetImageUpdateChannel), не должны заменить этот
+	img->ApplyFrameUpdates();
 	img->SetupFrame(in_frame_no, data, pt);
 	return true;
 }
 
+bool ThreadGUI::do_SetImageFrameProvider(ImageWindow* img, shared_ptr<FrameProvider> provider)
+{
+	if (!gui_controller.WidgetExists(img)) return false;
+	return img->SetFrameProvider(provider);
+}
+
+bool ThreadGUI::do_SetImageUpdateChannel(ImageWindow* img, shared_ptr<FrameUpdateChannel> channel)
+{
+	if (!gui_controller.WidgetExists(img)) return false;
+	img->SetUpdateChannel(channel);
+	return true;
+}
+
 bool ThreadGUI::do_SetupImageLabels(ImageWindow* img, const QString& title, const QString& z_label, const QString& y_label, const QString& x_label, const QString& value_label)
 {
 	if (!gui_controller.WidgetExists(img)) return false;
@@ -679,6 +694,7 @@ void ThreadGUI::do_SetProgressPosition(double position)
 
 void ThreadGUI::do_UpdateConsole()
 {
+	gui_controller.work_thread->ConsoleUpdateStarted();
 	if (!main_window)
 		return;
 	main_window->UpdateConsole();
@@ -110,6 +110,8 @@ public slots:
 	ImageWindow* do_CreateRasterImageSet(const QString& title, int vs, int hs);
 	bool	do_AddImageFrames(ImageWindow* img, size_t n_frames);
 	bool	do_SetupImageFrame(ImageWindow*, int, const void*, display_sample_type);
+	bool	do_SetImageFrameProvider(ImageWindow*, shared_ptr<FrameProvider>);
+	bool	do_SetImageUpdateChannel(ImageWindow*, shared_ptr<FrameUpdateChannel>);
 	bool	do_SetupImageLabels(ImageWindow* img, const QString& title, const QString& z_label, const QString& y_label, const QString& x_label, const QString& value_label);
 	bool	do_SetupImageDefaultRanges(ImageWindow* img, double min_value, double max_value, double gamma);
 	bool	do_SetImageAxesScales(ImageWindow* img, double z0, double dz, double y0, double dy, double x0, double dx);
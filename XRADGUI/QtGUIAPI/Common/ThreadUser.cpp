@@ -148,7 +148,10 @@ void ThreadUser::ForceUpdateGUI_noexcept(const physical_time &update_interval)
 
 	if (delay >= update_interval)
 	{
-		emit request_UpdateConsole();
+		// сигнал не ждет поток GUI (см. GUIController::InitDialogs), поэтому не посылается,
+		// пока не обработан предыдущий: очередь не растет, если GUI не успевает
+		if(!console_update_pending.exchange(true))
+			emit request_UpdateConsole();
 		previous = current;
 	}
 
@@ -79,10 +79,14 @@ protected:
 	QWaitCondition waitCondition; //!< переменная для координации потоков (ввод в режим ожидания,разблокирования ресурсов)
 	bool	workthread_is_running;
 	atomic_bool break_on_gui_return = false;
+	//! \brief Сигнал request_UpdateConsole отправлен, но еще не обработан потоком GUI
+	atomic_bool console_update_pending = false;
 
 public:
 	bool BreakOnGUIReturn() { return break_on_gui_return.load(); }
 	void SetBreakOnGUIReturn(bool value) { break_on_gui_return.store(value); }
+	//! \brief Вызывается потоком GUI перед обновлением консоли: следующий ForceUpdateGUI снова может его запросить
+	void ConsoleUpdateStarted() { console_update_pending.store(false); }
 
 	// сигналы интерфейсных функций (см. XRADGUI.h) и методы их вызова
 public:
@@ -165,6 +169,8 @@ signals:
 
 	bool	request_AddImageFrames(ImageWindow* img, size_t n_frames);
 	bool	request_SetupImageFrame(ImageWindow*, int, const void*, display_sample_type);
+	bool	request_SetImageFrameProvider(ImageWindow*, shared_ptr<FrameProvider>);
+	bool	request_SetImageUpdateChannel(ImageWindow*, shared_ptr<FrameUpdateChannel>);
 	bool	request_SetupImageLabels(ImageWindow* img, const QString& title, const QString& z_label, const QString& y_label, const QString& x_label, const QString& value_label);
 	bool	request_SetupImageDefaultRanges(ImageWindow* img, double min_value, double max_value, double gamma);
 	bool	request_SetImageAxesScales(ImageWindow*, double, double, double, double, double, double);
@@ -787,6 +787,40 @@ bool	api_InsertImageFrame(ImageWindowContainer& risc, int after_frame_no, const
 	else return false;
 }
 
+bool	api_SetImageFrameProvider(ImageWindowContainer& risc, shared_ptr<FrameProvider> provider)
+{
+	api_ForceUpdateGUI(sec(0));
+	if (IsPointerAValidGUIWidget(risc.window_ptr))
+	{
+		try
+		{
+			return emit work_thread().request_SetImageFrameProvider(static_cast<ImageWindow*>(risc.window_ptr), provider);
+		}
+		catch (...)
+		{
+			return false;
+		}
+	}
+	else return false;
+}
+
+bool	api_SetImageUpdateChannel(ImageWindowContainer& risc, shared_ptr<FrameUpdateChannel> channel)
+{
+	api_ForceUpdateGUI(sec(0));
+	if (IsPointerAValidGUIWidget(risc.window_ptr))
+	{
+		try
+		{
+			return emit work_thread().request_SetImageUpdateChannel(static_cast<ImageWindow*>(risc.window_ptr), channel);
+		}
+		catch (...)
+		{
+			return false;
+		}
+	}
+	else return false;
+}
+
 bool	api_SetImageLabels(ImageWindowContainer& risc, const wstring& wtitle, const wstring& wz_label, const wstring& wy_label, const wstring& wx_label, const wstring& wvalue_label)
 {
 	api_ForceUpdateGUI(sec(0));
@@ -17,6 +17,8 @@
 #include <XRADGUI/Sources/Core/GUICore.h>
 #include <XRADGUI/Sources/GUI/GUIValue.h>
 #include <XRADGUI/Sources/GUI/DisplaySampleType.h>
+#include <XRADGUI/Sources/GUI/FrameProvider.h>
+#include <XRADGUI/Sources/GUI/FrameUpdateChannel.h>
 #include <XRADBasic/Sources/Containers/SpaceCoordinates.h>
 #include <XRADBasic/Sources/Utils/PhysicalUnits.h>
 #include <XRADBasic/Sources/Containers/DataArray.h>
@@ -169,6 +171,10 @@ bool	api_SetImageAxesScales(ImageWindowContainer&, double in_z0, double in_dz, d
 bool	api_SetImageDefaultBrightness(ImageWindowContainer&, double in_black, double in_white, double in_gamma);
 bool	api_SetupImageFrame(ImageWindowContainer&, int in_frame_no, const void* data, display_sample_type pt);
 bool	api_InsertImageFrame(ImageWindowContainer&, int after_frame_no, const void* data, display_sample_type pt);
+//! \brief Подключить источник кадров (nullptr -- отключить, см. RasterImageSet::SetFrameProvider)
+bool	api_SetImageFrameProvider(ImageWindowContainer&, shared_ptr<FrameProvider> provider);
+//! \brief Подключить канал кадров, которые окно забирает по своему таймеру (см. FrameUpdateChannel.h)
+bool	api_SetImageUpdateChannel(ImageWindowContainer&, shared_ptr<FrameUpdateChannel> channel);
 bool	api_SetImageLabels(ImageWindowContainer&, const wstring& in_title, const wstring& in_z_label, const wstring& in_y_label, const wstring& in_x_label, const wstring& in_value_label);
 
 TextWindowContainer api_CreateTextDisplayer(const wstring& title, bool fixed_width, bool editable);
@@ -0,0 +1,146 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#include "pre.h"
+#include "CurveEnvelope.h"
+
+#include <XRADBasic/Sources/Containers/ParallelApply.h>
+#include <algorithm>
+
+namespace XRAD_GUI
+{
+
+XRAD_USING
+
+namespace
+{
+
+//! \name Значение a лучше b в качестве минимума (максимума). Отсчет NaN выбирается, только если других в блоке нет
+//! @{
+inline bool	better_min(double a, double b)
+{
+	return a < b || (isnan(b) && !isnan(a));
+}
+
+inline bool	better_max(double a, double b)
+{
+	return a > b || (isnan(b) && !isnan(a));
+}
+//! @}
+
+}//namespace
+
+void	CurveEnvelope::Init(const DataArray<double> &x, const DataArray<double> &y)
+{
+	data_x = &x;
+	data_y = &y;
+	levels.clear();
+	size_t	n = min(x.size(), y.size());
+
+	x_monotonic = true;
+	for(size_t i = 0; i < n && x_monotonic; ++i)
+	{
+		if(isnan(x[i]) || (i && x[i] < x[i - 1]))
+			x_monotonic = false;
+	}
+	if(!x_monotonic || n < 2*bucket_size)
+		return;
+
+	// уровень 0 -- по исходным отсчетам, последний неполный блок не включается
+	levels.emplace_back(n/bucket_size);
+	ParallelApply::ProcessIndependentParts(levels[0].size(), n, [&](size_t b)
+		{
+			size_t	i0 = b*bucket_size;
+			extrema	e = {i0, i0};
+			for(size_t i = i0 + 1; i < i0 + bucket_size; ++i)
+			{
+				if(better_min(y[i], y[e.i_min]))
+					e.i_min = i;
+				if(better_max(y[i], y[e.i_max]))
+					e.i_max = i;
+			}
+			levels[0][b] = e;
+		},
+		"CurveEnvelope::Init");
+
+	// уровень k+1 объединяет пары блоков уровня k
+	while(levels.back().size() >= 4)
+	{
+		const auto	&previous = levels.back();
+		std::vector<extrema>	level(previous.size()/2);
+		ParallelApply::ProcessIndependentParts(level.size(), previous.size(), [&](size_t b)
+			{
+				const extrema	&e1 = previous[2*b], &e2 = previous[2*b + 1];
+				level[b].i_min = better_min(y[e2.i_min], y[e1.i_min]) ? e2.i_min : e1.i_min;
+				level[b].i_max = better_max(y[e2.i_max], y[e1.i_max]) ? e2.i_max : e1.i_max;
+			},
+			"CurveEnvelope::Init");
+		levels.push_back(std::move(level));
+	}
+}
+
+void	CurveEnvelope::AddSamples(std::vector<size_t> &indices, size_t i1, size_t i2) const
+{
+	for(size_t i = i1; i < i2; ++i)
+		indices.push_back(i);
+}
+
+void	CurveEnvelope::Decimate(std::vector<size_t> &indices, double x1, double x2, size_t n_pixels) const
+{
+	indices.clear();
+	if(!data_x || !data_y)
+		return;
+	size_t	n = min(data_x->size(), data_y->size());
+	if(!x_monotonic || levels.empty())
+	{
+		AddSamples(indices, 0, n);
+		return;
+	}
+	if(x1 > x2)
+		std::swap(x1, x2);
+
+	// видимые отсчеты i1..i2-1 и по одному соседнему с каждой стороны
+	const double	*x = &data_x->at(0);
+	size_t	i1 = std::lower_bound(x, x + n, x1) - x;
+	size_t	i2 = std::upper_bound(x, x + n, x2) - x;
+	i1 = i1 ? i1 - 1 : 0;
+	i2 = min(i2 + 1, n);
+	if(i2 <= i1)
+		return;
+
+	// уровень с наибольшими блоками, не превышающими половины пикселя: тогда отрезок между
+	// экстремумами соседних блоков не выходит за соседний столбец пикселей
+	size_t	samples_per_pixel = (i2 - i1)/max(n_pixels, size_t(1));
+	size_t	level = 0, block = bucket_size;
+	if(samples_per_pixel < 2*bucket_size)
+	{
+		AddSamples(indices, i1, i2);
+		return;
+	}
+	while(level + 1 < levels.size() && 4*block <= samples_per_pixel)
+	{
+		++level;
+		block *= 2;
+	}
+
+	const auto	&buckets = levels[level];
+	size_t	b1 = (i1 + block - 1)/block;
+	size_t	b2 = min(i2/block, buckets.size());
+	indices.reserve(2*(b2 - b1) + 2*block);
+
+	// неполные блоки по краям рисуются по исходным отсчетам
+	AddSamples(indices, i1, b1*block);
+	for(size_t b = b1; b < b2; ++b)
+	{
+		size_t	first = min(buckets[b].i_min, buckets[b].i_max);
+		size_t	second = max(buckets[b].i_min, buckets[b].i_max);
+		indices.push_back(first);
+		if(second != first)
+			indices.push_back(second);
+	}
+	AddSamples(indices, max(b2*block, b1*block), i2);
+}
+
+}//namespace XRAD_GUI
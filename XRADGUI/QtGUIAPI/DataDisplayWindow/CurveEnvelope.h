@@ -0,0 +1,76 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_CurveEnvelope_h
+#define XRAD__File_CurveEnvelope_h
+//--------------------------------------------------------------
+//
+//	purpose:	многоуровневая огибающая (минимумы и максимумы) кривой графика.
+//				позволяет рисовать кривые из миллионов отсчетов за время,
+//				зависящее от ширины окна, а не от количества отсчетов
+//
+//--------------------------------------------------------------
+
+#include <XRADBasic/Sources/Containers/DataArray.h>
+#include <vector>
+
+namespace XRAD_GUI
+{
+
+XRAD_USING
+
+/*!
+	\brief Огибающая кривой y(x) с неубывающими x
+
+	Уровень 0 содержит номера минимального и максимального отсчетов для каждого блока
+	из bucket_size соседних отсчетов, каждый следующий уровень -- для вдвое больших блоков.
+	Огибающая строится один раз (в нескольких потоках), после чего Decimate() для любого
+	видимого интервала x выбирает уровень, в котором блок занимает не больше половины пикселя.
+	Для каждого блока рисуются минимум и максимум в порядке следования: все экстремумы
+	попадают на рисунок, и он отличается от рисунка по всем отсчетам не более чем
+	на соседний столбец пикселей.
+
+	Если x не монотонны (параметрическая кривая) или содержат NaN, прореживание
+	не выполняется: Decimate() возвращает все отсчеты.
+*/
+class	CurveEnvelope
+{
+	public:
+		CurveEnvelope(){}
+
+		//! \brief Построение огибающей. Массивы должны существовать, пока используется Decimate()
+		void	Init(const DataArray<double> &x, const DataArray<double> &y);
+
+		//! \brief Прореживание возможно (x не убывают)
+		bool	decimation_enabled() const { return x_monotonic; }
+		size_t	n_levels() const { return levels.size(); }
+
+		/*!
+			\brief Номера отсчетов, достаточных для рисования участка x1..x2 шириной n_pixels пикселей
+
+			Включаются также ближайшие отсчеты за пределами участка, чтобы линия доходила до краев.
+		*/
+		void	Decimate(std::vector<size_t> &indices, double x1, double x2, size_t n_pixels) const;
+
+		//! \brief Количество отсчетов в блоке уровня 0
+		static	const size_t	bucket_size = 16;
+
+	private:
+		struct	extrema
+		{
+			size_t	i_min, i_max;
+		};
+
+		const DataArray<double>	*data_x = nullptr;
+		const DataArray<double>	*data_y = nullptr;
+		bool	x_monotonic = false;
+		std::vector<std::vector<extrema>>	levels;
+
+		void	AddSamples(std::vector<size_t> &indices, size_t i1, size_t i2) const;
+};
+
+}//namespace XRAD_GUI
+
+#endif // XRAD__File_CurveEnvelope_h
@@ -9,8 +9,10 @@
 #include "ThreadGUI.h"
 #include "GUIController.h"
 #include "FileSaveUtils.h"
+#include "CurveEnvelope.h"
 #include <XRADQt/QtStringConverters.h>
 #include <XRADSystem/TextFile.h>
+#include <qwt_series_data.h>
 
 namespace XRAD_GUI
 {
@@ -515,6 +517,89 @@ RealFunctionF64	SafeValuesCurve(const RealFunctionF64 &in_values)
 	return result;
 }
 
+namespace
+{
+
+/*!
+	\brief Отсчеты кривой для Qwt, прореживаемые по огибающей CurveEnvelope
+
+	Qwt сообщает видимую область через setRectOfInterest() при каждом изменении шкал
+	(масштабирование, прокрутка), и кривая отдает только отсчеты, нужные для рисования
+	этой области при текущей ширине окна. Огибающая строится один раз при задании данных.
+*/
+class	DecimatedCurveData : public QwtSeriesData<QPointF>
+{
+	public:
+		DecimatedCurveData(const RealFunctionF64 &in_x, const RealFunctionF64 &in_y, const QwtPlot *in_plot):
+				x(SafeValuesCurve(in_x)), y(SafeValuesCurve(in_y)), plot(in_plot)
+		{
+			envelope.Init(x, y);
+			d_boundingRect = ComputeBoundingRect();
+			if(envelope.decimation_enabled() && x.size())
+				envelope.Decimate(indices, x[0], x[x.size() - 1], default_width);
+		}
+
+		virtual size_t	size() const override
+		{
+			return envelope.decimation_enabled() ? indices.size() : x.size();
+		}
+
+		virtual QPointF	sample(size_t i) const override
+		{
+			size_t	j = envelope.decimation_enabled() ? indices[i] : i;
+			return QPointF(x[j], y[j]);
+		}
+
+		virtual QRectF	boundingRect() const override
+		{
+			return d_boundingRect;
+		}
+
+		virtual void	setRectOfInterest(const QRectF &rect) override
+		{
+			if(!envelope.decimation_enabled())
+				return;
+			int	width = plot ? plot->canvas()->width() : 0;
+			envelope.Decimate(indices, rect.left(), rect.right(), width > 0 ? size_t(width) : default_width);
+		}
+
+	private:
+		//! \brief Ширина окна в пикселях, пока она неизвестна
+		static	constexpr size_t	default_width = 2048;
+
+		RealFunctionF64	x, y;
+		const QwtPlot	*plot;
+		CurveEnvelope	envelope;
+		std::vector<size_t>	indices;
+
+		//! \brief Границы по всем отсчетам, кроме NaN
+		QRectF	ComputeBoundingRect() const
+		{
+			double	x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+			bool	found = false;
+			for(size_t i = 0; i < x.size(); ++i)
+			{
+				if(isnan(x[i]) || isnan(y[i]))
+					continue;
+				if(!found)
+				{
+					x1 = x2 = x[i];
+					y1 = y2 = y[i];
+					found = true;
+					continue;
+				}
+				x1 = min(x1, x[i]);
+				x2 = max(x2, x[i]);
+				y1 = min(y1, y[i]);
+				y2 = max(y2, y[i]);
+			}
+			// прямоугольник с отрицательными размерами Qwt считает некорректным
+			return found ? QRectF(x1, y1, x2 - x1, y2 - y1) : QRectF(1, 1, -2, -2);
+		}
+};
+
+}//namespace
+
 void	GraphWindow::SetupCurve(int curve_no,
 		const DataArray<double> &in_data_y,
 		const DataArray<double> &in_data_x,
@@ -646,10 +731,8 @@ void	GraphWindow::UpdateTransformedCurves()
 
 void	GraphWindow::SetCurveValues(size_t curve_no)
 {
-	RealFunctionF64	display_data_x = SafeValuesCurve(data_x[curve_no]);
-	RealFunctionF64	display_data_y = SafeValuesCurve(data_y_transformed[curve_no]);
-
-	curves[curve_no]->setSamples(&display_data_x[0], &display_data_y[0], int(display_data_x.size()));
+	// кривая становится владельцем данных
+	curves[curve_no]->setData(new DecimatedCurveData(data_x[curve_no], data_y_transformed[curve_no], plot));
 	curves[curve_no]->setTitle(yLabelTransformed(graph_labels[curve_no]));
 }
 
@@ -20,6 +20,52 @@ namespace XRAD_GUI
 
 XRAD_USING
 
+namespace
+{
+
+//! \brief Количество кадров, загружаемых заранее от FrameProvider в каждую сторону от показанного
+const size_t	frames_prefetch = 4;
+
+//! \brief Память под кадры, загруженные от FrameProvider
+const size_t	frame_cache_bytes = size_t(256) << 20;
+
+//! \brief Период проверки канала кадров FrameUpdateChannel, мс
+const int	frame_updates_interval_ms = 40;
+
+//! \brief Размер отсчета при хранении в MultimodalFrameContainer
+size_t	frame_sample_size(display_sample_type pt)
+{
+	switch(pt)
+	{
+		case gray_sample_ui8:
+		case indexed_color_sample_ui8:
+			return sizeof(uint8_t);
+		case gray_sample_i16:
+		case gray_sample_ui16:
+			return sizeof(int16_t);
+		case gray_sample_i32:
+		case gray_sample_ui32:
+		case gray_sample_f32:
+		case gray_sample_f64:
+			return sizeof(float);
+		case rgba_sample_ui8:
+			return sizeof(ColorPixel);
+		case rgb_sample_f32:
+			return sizeof(ColorSampleF32);
+		case complex_sample_f32:
+		case complex_sample_f64:
+			return sizeof(complexF32);
+		case complex_sample_i32:
+			return sizeof(complexI32);
+		case complex_sample_i16:
+			return sizeof(complexI16);
+		default:
+			return sizeof(complexF64);
+	}
+}
+
+}//namespace
+
 
 
 point2_I32	ImageWindow::LocalMousePosition(QEvent *event)
@@ -125,6 +171,15 @@ ImageWindow::ImageWindow(QString title, size_t vs, size_t hs, GUIController &gc)
 		animation_mode = e_forward;
 
 		QObject::connect(animation_timer, SIGNAL(timeout()), this, SLOT(AnimationUpdate()));
+
+		max_cached_frames = 0;
+		browse_direction = 1;
+		closed = false;
+		prefetch_timer = new QTimer(this);
+		prefetch_timer->setSingleShot(true);
+		QObject::connect(prefetch_timer, SIGNAL(timeout()), this, SLOT(PrefetchFrames()));
+		update_timer = new QTimer(this);
+		QObject::connect(update_timer, SIGNAL(timeout()), this, SLOT(ApplyFrameUpdates()));
 		QObject::connect(dt_zoom_box, SIGNAL(valueChanged(double)), this, SLOT(UpdateAnimationTimer()));
 
 		x0 = 0;
@@ -133,6 +188,11 @@ ImageWindow::ImageWindow(QString title, size_t vs, size_t hs, GUIController &gc)
 		dy = 1;
 
 		mouse_drag_mode = mouse_drag_none;
+		viewport_shown = false;
+		viewport_center_v = n_rows/2.;
+		viewport_center_h = n_columns/2.;
+		viewport_v0 = viewport_h0 = 0;
+		viewport_level = 0;
 		frames_slider->setFocus();
 
 		installEventFilter(this);
@@ -152,6 +212,8 @@ ImageWindow::~ImageWindow()
 {
 	//удаляем объект из массива диалогов (ушло в родителя)
 //	gui_controller.RemoveWidget(this);
+	if(update_channel)
+		update_channel->Close();
 }
 
 //--------------------------------------------------------------
@@ -220,19 +282,26 @@ void ImageWindow::SetFrameLegend()
 
 void ImageWindow::RebuildPixmap()
 {
+	viewport_shown = false;
 	if(in_range(current_frame, 0, n_frames-1))
 	{
 		try
 		{
-			frames[current_frame]->GenerateBitmap(current_frame_bitmap, internal_black, internal_white, control_gamma(), transposed());
+			auto	&frame = Frame(current_frame);
+			if(frame.Tiled())
+				RebuildViewportBitmap(frame);
+			else
+				frame.GenerateBitmap(current_frame_bitmap, internal_black, internal_white, control_gamma(), transposed());
 		}
 		catch(...)
 		{
 		}
 	}
 
-	int	new_x_size = max(32., current_frame_bitmap.hsize()*x_zoom());
-	int	new_y_size = max(32., current_frame_bitmap.vsize()*y_zoom());
+	// отсчет растра, построенного по уровню пирамиды, соответствует 2^level отсчетам кадра
+	double	sample_size = viewport_shown ? double(size_t(1) << viewport_level) : 1;
+	int	new_x_size = max(32., current_frame_bitmap.hsize()*sample_size*x_zoom());
+	int	new_y_size = max(32., current_frame_bitmap.vsize()*sample_size*y_zoom());
 	raster->setFixedHeight(new_y_size);
 	raster->setFixedWidth(new_x_size);
 
@@ -243,6 +312,45 @@ void ImageWindow::RebuildPixmap()
 	setFixedSize(minimumSizeHint());
 }
 
+QSize	ImageWindow::MaxViewportSize() const
+{
+	QRect	screen_rect = QGuiApplication::primaryScreen()->availableGeometry();
+	return QSize(screen_rect.width()*3/4, screen_rect.height()*3/4);
+}
+
+void ImageWindow::RebuildViewportBitmap(MultimodalFrameContainer &frame)
+{
+	// масштаб и размеры экрана по осям кадра (y_zoom_box относится к строкам и при транспонировании)
+	double	v_zoom = y_zoom_box->value(), h_zoom = x_zoom_box->value();
+	QSize	max_size = MaxViewportSize();
+	double	max_v = transposed() ? max_size.width() : max_size.height();
+	double	max_h = transposed() ? max_size.height() : max_size.width();
+
+	// самый грубый уровень, отсчет которого по обеим осям не больше экранной точки
+	size_t	level = frame.TiledLevel(max(v_zoom, h_zoom));
+	size_t	step = size_t(1) << level;
+	size_t	level_vs = frame.TiledLevelVSize(level), level_hs = frame.TiledLevelHSize(level);
+
+	// видимая область в отсчетах уровня. время построения растра определяется
+	// ее размером, а не размером кадра
+	size_t	vs = v_zoom > 0 ? size_t(min(double(level_vs), ceil(max_v/(v_zoom*step)))) : level_vs;
+	size_t	hs = h_zoom > 0 ? size_t(min(double(level_hs), ceil(max_h/(h_zoom*step)))) : level_hs;
+	vs = max(vs, size_t(1));
+	hs = max(hs, size_t(1));
+	ptrdiff_t	v0 = range(ptrdiff_t(floor(viewport_center_v/step - vs/2.)), ptrdiff_t(0), ptrdiff_t(level_vs - vs));
+	ptrdiff_t	h0 = range(ptrdiff_t(floor(viewport_center_h/step - hs/2.)), ptrdiff_t(0), ptrdiff_t(level_hs - hs));
+
+	frame.GenerateRegionBitmap(current_frame_bitmap, level, v0, h0, vs, hs, internal_black, internal_white, control_gamma(), transposed());
+
+	viewport_level = level;
+	viewport_v0 = v0*step;
+	viewport_h0 = h0*step;
+	// центр, вышедший за край кадра, возвращается к краю
+	viewport_center_v = range(viewport_center_v, (v0 + vs/2.)*step - step, (v0 + vs/2.)*step + step);
+	viewport_center_h = range(viewport_center_h, (h0 + hs/2.)*step - step, (h0 + hs/2.)*step + step);
+	viewport_shown = true;
+}
+
 void ImageWindow::SetAxesScales(double in_z0, double in_dz, double in_y0, double in_dy, double in_x0, double in_dx)
 {
 	z0 = in_z0;
@@ -304,7 +412,11 @@ void ImageWindow::SetWindowPosition()
 	layout()->getContentsMargins(&l, &t, &r, &b);
 	int	dh = 12;// наобум, чтобы картинка целиком помещалась. примерно
 	// компенсирует место под лейблу что ли?
-	setGeometry(QRect(QPoint(corner.x(), corner.y()), QSize(int(n_columns)+l+r, int(n_rows) + t+b + dh)));
+	QSize	image_size(int(n_columns), int(n_rows));
+	// большие кадры показываются по частям (см. RebuildViewportBitmap)
+	if(max(n_rows, n_columns) > size_t(MultimodalFrameContainer::tiled_frame_size))
+		image_size = image_size.boundedTo(MaxViewportSize());
+	setGeometry(QRect(QPoint(corner.x(), corner.y()), QSize(image_size.width()+l+r, image_size.height() + t+b + dh)));
 }
 
 
@@ -316,6 +428,7 @@ void ImageWindow::SetWindowPosition()
 
 void ImageWindow::AddFrames(size_t n)
 {
+	DetachFrameProvider();
 	for(size_t i = 0; i < n; ++i)
 	{
 		frames.push_back(make_shared<MultimodalFrameContainer>());
@@ -361,6 +474,7 @@ void ImageWindow::SetupFrame(int in_frame_no, const void* in_data, display_sampl
 	int	frame_no = in_frame_no;
 	try
 	{
+		DetachFrameProvider();
 		if(!in_data)
 		{
 			EraseFrame(frame_no);
@@ -385,6 +499,132 @@ void ImageWindow::SetupFrame(int in_frame_no, const void* in_data, display_sampl
 		// также принудительно перерисовываем, если это первый из сформированных кадров
 }
 
+bool	ImageWindow::SetFrameProvider(shared_ptr<FrameProvider> provider)
+{
+	if(!provider)
+	{
+		ReleaseFrameProvider();
+		return true;
+	}
+	if(provider->vsize() != n_rows || provider->hsize() != n_columns)
+		return false;
+
+	// прежние кадры заменяются, загружать их незачем
+	prefetch_timer->stop();
+	frame_provider.reset();
+	cached_frames.clear();
+	frames.clear();
+	n_frames = 0;
+	current_frame = -1;
+	AddFrames(provider->n_frames());
+
+	frame_provider = provider;
+	size_t	frame_bytes = max(n_samples_total*frame_sample_size(provider->sample_type()), size_t(1));
+	max_cached_frames = max(frame_cache_bytes/frame_bytes, 2*frames_prefetch + 1);
+	if(n_frames)
+	{
+		frames_slider->setValue(0);
+		ShowFrame(0);
+	}
+	return true;
+}
+
+void	ImageWindow::SetUpdateChannel(shared_ptr<FrameUpdateChannel> channel)
+{
+	if(update_channel && update_channel != channel)
+	{
+		ApplyFrameUpdates();
+		update_channel->Close();
+	}
+	update_channel = channel;
+	if(!update_channel)
+	{
+		update_timer->stop();
+		return;
+	}
+	if(closed)
+	{
+		update_channel->Close();
+		return;
+	}
+	update_timer->start(frame_updates_interval_ms);
+}
+
+void	ImageWindow::ReleaseFrameProvider()
+{
+	if(!frame_provider)
+		return;
+	if(!closed)
+	{
+		try
+		{
+			// источник копирует свои данные, и окно по-прежнему вычисляет кадры по мере показа
+			if(frame_provider->DetachSource())
+				return;
+		}
+		catch(...)
+		{
+		}
+	}
+	DetachFrameProvider();
+}
+
+void	ImageWindow::DetachFrameProvider()
+{
+	if(!frame_provider)
+		return;
+	prefetch_timer->stop();
+	if(!closed)
+	{
+		try
+		{
+			vector<bool>	loaded(n_frames, false);
+			for(auto frame_no: cached_frames)
+				loaded[frame_no] = true;
+			for(size_t i = 0; i < n_frames; ++i)
+			{
+				if(!loaded[i])
+					frames[i]->ImportFrame(frame_provider->GetFrame(i), int(n_rows), int(n_columns), frame_provider->sample_type());
+			}
+		}
+		catch(...)
+		{
+		}
+	}
+	// после отключения данные источника могут быть уничтожены, поэтому он освобождается в любом случае
+	frame_provider.reset();
+	cached_frames.clear();
+}
+
+bool	ImageWindow::FrameCached(size_t frame_no) const
+{
+	return std::find(cached_frames.begin(), cached_frames.end(), frame_no) != cached_frames.end();
+}
+
+void	ImageWindow::LoadFrame(size_t frame_no)
+{
+	frames[frame_no]->ImportFrame(frame_provider->GetFrame(frame_no), int(n_rows), int(n_columns), frame_provider->sample_type());
+	cached_frames.push_front(frame_no);
+	while(cached_frames.size() > max_cached_frames)
+	{
+		frames[cached_frames.back()] = make_shared<MultimodalFrameContainer>();
+		cached_frames.pop_back();
+	}
+}
+
+MultimodalFrameContainer	&ImageWindow::Frame(size_t frame_no)
+{
+	if(frame_provider)
+	{
+		auto	found = std::find(cached_frames.begin(), cached_frames.end(), frame_no);
+		if(found != cached_frames.end())
+			cached_frames.splice(cached_frames.begin(), cached_frames, found);
+		else
+			LoadFrame(frame_no);
+	}
+	return *frames[frame_no];
+}
+
 
 
 //--------------------------------------------------------------
@@ -589,16 +829,20 @@ void ImageWindow::RasterEvent(QEvent *event)
 		// нажата кнопка мыши
 		case QEvent::MouseButtonPress:
 			if(mouse_drag_mode==mouse_drag_value_analyze) EndCurrentValueDraw(event);
-			StartFreehandBrightnessChange(event);
+			// правая кнопка перемещает видимую часть большого кадра
+			if(viewport_shown && static_cast<QMouseEvent*>(event)->button() == Qt::RightButton) StartViewportDrag(event);
+			else StartFreehandBrightnessChange(event);
 			break;
 
 			// отпущена кнопка мыши
 		case QEvent::MouseButtonRelease:
-			EndFreehandBrightnessChange(event);
+			if(mouse_drag_mode==mouse_drag_viewport) EndViewportDrag(event);
+			else EndFreehandBrightnessChange(event);
 			break;
 
 		case QEvent::MouseMove:
 			if(mouse_drag_mode==mouse_drag_contrast_change) FreehandBrightnessChange(event);
+			if(mouse_drag_mode==mouse_drag_viewport) ViewportDrag(event);
 
 			break;
 
@@ -622,6 +866,13 @@ void ImageWindow::RasterEvent(QEvent *event)
 
 void ImageWindow::closeEvent(QCloseEvent *event)
 {
+	// кадры от источника после закрытия не нужны (см. DetachFrameProvider)
+	closed = true;
+	prefetch_timer->stop();
+	// рабочий поток перестает копировать кадры для закрытого окна
+	update_timer->stop();
+	if(update_channel)
+		update_channel->Close();
 	QDialog::closeEvent(event);
 }
 
@@ -663,6 +914,11 @@ void ImageWindow::DrawCurrentValue(QEvent *event)
 	int	row_no = current_cursor_position.y() / y_zoom();
 
 	if(transposed()) std::swap(col_no, row_no);
+	if(viewport_shown)
+	{
+		row_no += int(viewport_v0);
+		col_no += int(viewport_h0);
+	}
 
 	try
 	{
@@ -673,7 +929,7 @@ void ImageWindow::DrawCurrentValue(QEvent *event)
 			double	y = y0 + row_no*dy;
 			setCursor(Qt::CrossCursor);
 			//TODO сделать, чтобы отображались и колонки, и координаты
-			QString value_legend = frames[current_frame]->GetValueLegend(row_no, col_no);
+			QString value_legend = Frame(current_frame).GetValueLegend(row_no, col_no);
 			QString	label = QString("row=%1, col=%2, %3[%4]").arg(row_no).arg(col_no).arg(value_label).arg(value_legend);
 			bool	linefeed(true);
 
@@ -761,11 +1017,25 @@ void	ImageWindow::ResetBrightnessFull()
 	double	max_value = -max_double();
 	double	min_value = max_double();
 
-	for(size_t i = 0; i < n_frames; ++i)
+	auto	add_frame = [&](const MultimodalFrameContainer &frame)
+	{
+		max_value = max(frame.MaxComponentValue(), max_value);
+		min_value = min(frame.MinComponentValue(), min_value);
+	};
+	if(frame_provider)
+	{
+		// загрузка всех кадров ради диапазона свела бы на нет вычисление по запросу,
+		// поэтому диапазон определяется по кадрам, которые уже есть в памяти
+		for(auto frame_no: cached_frames)
+			add_frame(*frames[frame_no]);
+	}
+	else
 	{
-		max_value = max(frames[i]->MaxComponentValue(), max_value);
-		min_value = min(frames[i]->MinComponentValue(), min_value);
+		for(size_t i = 0; i < n_frames; ++i)
+			add_frame(*frames[i]);
 	}
+	if(min_value > max_value)
+		return;
 
 	UpdateBrightness(min_value, max_value, control_gamma());
 	RebuildPixmap();
@@ -845,6 +1115,43 @@ void ImageWindow::EndCurrentValueDraw(QEvent *)
 
 
 
+//--------------------------------------------------------------
+//
+//	перемещение видимой части большого кадра
+//
+
+void ImageWindow::StartViewportDrag(QEvent *event)
+{
+	mouse_drag_mode = mouse_drag_viewport;
+	setCursor(Qt::ClosedHandCursor);
+	start_cursor_position = LocalMousePosition(event);
+	start_viewport_center_v = viewport_center_v;
+	start_viewport_center_h = viewport_center_h;
+}
+
+void ImageWindow::ViewportDrag(QEvent *event)
+{
+	point2_I32  current_cursor_position = LocalMousePosition(event);
+	if(x_zoom() <= 0 || y_zoom() <= 0) return;
+
+	// изображение следует за курсором
+	double	d_col = -(current_cursor_position.x() - start_cursor_position.x())/x_zoom();
+	double	d_row = -(current_cursor_position.y() - start_cursor_position.y())/y_zoom();
+	if(transposed()) std::swap(d_col, d_row);
+
+	viewport_center_v = start_viewport_center_v + d_row;
+	viewport_center_h = start_viewport_center_h + d_col;
+	RebuildPixmap();
+}
+
+void ImageWindow::EndViewportDrag(QEvent *)
+{
+	setCursor(Qt::ArrowCursor);
+	mouse_drag_mode = mouse_drag_none;
+}
+
+
+
 //--------------------------------------------------------------
 //
 //	slots
@@ -855,12 +1162,56 @@ void	ImageWindow::ShowFrame(int in_frame_no)
 	if(!in_range(in_frame_no, 0, n_frames-1)) return;
 
 	//	QVector<qreal> values(n_samples_total);
+	if(current_frame >= 0 && in_frame_no != current_frame)
+		browse_direction = in_frame_no > current_frame ? 1 : -1;
 	current_frame = in_frame_no;
 	SetFrameLegend();
 	//		frames_slider->setValue(in_frame_no);
 
 	// заполняем данными
 	RebuildPixmap();
+	if(frame_provider)
+		prefetch_timer->start(0);
+}
+
+void	ImageWindow::ApplyFrameUpdates()
+{
+	if(!update_channel)
+		return;
+	// в канале не более одного снимка на кадр: промежуточные версии кадра уже отброшены
+	for(auto &snapshot: update_channel->Take())
+	{
+		if(snapshot->vsize() == n_rows && snapshot->hsize() == n_columns)
+			SetupFrame(snapshot->frame_no, snapshot->data(), snapshot->sample_type());
+		update_channel->Release(std::move(snapshot));
+	}
+}
+
+void	ImageWindow::PrefetchFrames()
+{
+	if(!frame_provider || !in_range(current_frame, 0, int(n_frames)-1))
+		return;
+	// сначала в направлении просмотра. за один вызов загружается один кадр,
+	// чтобы не задерживать обработку событий
+	for(size_t d = 1; d <= frames_prefetch; ++d)
+	{
+		for(int sign: {browse_direction, -browse_direction})
+		{
+			ptrdiff_t	frame_no = current_frame + sign*ptrdiff_t(d);
+			if(!in_range(frame_no, 0, ptrdiff_t(n_frames)-1) || FrameCached(frame_no))
+				continue;
+			try
+			{
+				LoadFrame(frame_no);
+			}
+			catch(...)
+			{
+				return;
+			}
+			prefetch_timer->start(0);
+			return;
+		}
+	}
 }
 
 void ImageWindow::SetImageLabels(const QString &in_title, const QString &in_z_label, const QString &in_y_label, const QString &in_x_label, const QString &in_value_label)
@@ -17,6 +17,8 @@
 #include "FrameBitmapContainer.h"
 #include "MultimodalFrameContainer.h"
 #include <XRADBasic/Sources/Utils/PhysicalUnits.h>
+#include <XRADGUI/Sources/GUI/FrameProvider.h>
+#include <XRADGUI/Sources/GUI/FrameUpdateChannel.h>
 #include <QTimer>
 
 //--------------------------------------------------------------
@@ -45,6 +47,10 @@ class ImageWindow :  public DataDisplayWindow, public Ui::ImageWindow
 		void	SetFrameLegend();
 		void	SetupFrame(int in_frame_no, const void* data, display_sample_type pt);
 		void	AddFrames(size_t n = 1);
+		//! \brief Кадры вычисляются источником по мере показа (nullptr -- отключить источник)
+		bool	SetFrameProvider(shared_ptr<FrameProvider> provider);
+		//! \brief Кадры из канала показываются по таймеру окна (nullptr -- отключить канал)
+		void	SetUpdateChannel(shared_ptr<FrameUpdateChannel> channel);
 		virtual void	SetWindowPosition() override;
 		void	SetImageLabels(const QString &in_title, const QString &in_z_label, const QString &in_y_label, const QString &in_x_label, const QString &in_value_label);
 		//void	SetWindowTitle(QString title);
@@ -72,10 +78,45 @@ class ImageWindow :  public DataDisplayWindow, public Ui::ImageWindow
 
 		FrameBitmapContainer	current_frame_bitmap;
 
+		//	кадры, вычисляемые по запросу (см. FrameProvider.h). загруженные кадры перечислены
+		//	в cached_frames в порядке последнего обращения, давно не использованные удаляются.
+		//	после показа кадра соседние загружаются заранее по таймеру, по одному за раз
+		shared_ptr<FrameProvider>	frame_provider;
+		list<size_t>	cached_frames;
+		size_t	max_cached_frames;
+		QTimer	*prefetch_timer;
+		int	browse_direction;
+		bool	closed;
+
+		//	кадры, оставленные рабочим потоком в канале (см. FrameUpdateChannel.h), забираются по таймеру
+		shared_ptr<FrameUpdateChannel>	update_channel;
+		QTimer	*update_timer;
+
+		//	доступ к кадру с загрузкой от источника при необходимости
+		MultimodalFrameContainer	&Frame(size_t frame_no);
+		bool	FrameCached(size_t frame_no) const;
+		void	LoadFrame(size_t frame_no);
+		//	если окно открыто, перед отключением источника загружаются все кадры
+		void	DetachFrameProvider();
+		//	отключение по запросу владельца данных: открытое окно оставляет источник, если тот
+		//	может перейти на собственную копию данных (FrameProvider::DetachSource), иначе DetachFrameProvider
+		void	ReleaseFrameProvider();
+
 		size_t	n_frames;
 		int	current_frame;
 		const size_t n_rows, n_columns, n_samples_total;
 
+		//	большие кадры (MultimodalFrameContainer::Tiled) показываются по частям: растр занимает
+		//	не больше MaxViewportSize(), отсчеты берутся из уровня пирамиды, соответствующего масштабу.
+		//	видимая область перемещается перетаскиванием правой кнопкой мыши
+		bool	viewport_shown;	// последний построенный растр -- часть кадра
+		double	viewport_center_v, viewport_center_h;	// центр видимой области в отсчетах кадра
+		size_t	viewport_v0, viewport_h0;	// левый верхний угол показанной области в отсчетах кадра
+		size_t	viewport_level;	// уровень пирамиды, из которого построен растр
+
+		QSize	MaxViewportSize() const;
+		void	RebuildViewportBitmap(MultimodalFrameContainer &frame);
+
 		physical_time t0; // Заплата для обработчика клавиши Space
 
 
@@ -140,7 +181,8 @@ class ImageWindow :  public DataDisplayWindow, public Ui::ImageWindow
 		{
 			mouse_drag_none,
 			mouse_drag_value_analyze,
-			mouse_drag_contrast_change
+			mouse_drag_contrast_change,
+			mouse_drag_viewport
 		};
 
 		mouse_drag_mode_t	mouse_drag_mode;
@@ -165,12 +207,24 @@ class ImageWindow :  public DataDisplayWindow, public Ui::ImageWindow
 		void FreehandBrightnessChange(QEvent *event);
 		void EndFreehandBrightnessChange(QEvent *event); // выключение режима
 
+		//	перемещение видимой части большого кадра
+
+		double	start_viewport_center_v, start_viewport_center_h;
+
+		void StartViewportDrag(QEvent *event);
+		void ViewportDrag(QEvent *event);
+		void EndViewportDrag(QEvent *event);
+
 		void ResetBrightnessControlsLimits();
 		void SetBrightnessControlsLimits();
 		void SetBrightnessContrastCursor();
 
 		//	слоты и сигналы
 
+	public slots:
+		//! \brief Показать кадры, ожидающие в канале (вызывается также перед SetupFrame для сохранения порядка)
+		void ApplyFrameUpdates();
+
 		protected slots:
 		void ShowFrame(int in_frame_no);
 		void RebuildPixmap();
@@ -181,6 +235,7 @@ class ImageWindow :  public DataDisplayWindow, public Ui::ImageWindow
 		void SaveVideo();
 		void AnimationUpdate();
 		void UpdateAnimationTimer();
+		void PrefetchFrames();
 
 	signals:
 		void signal_esc();
@@ -0,0 +1,133 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_FrameProvider_h
+#define XRAD__File_FrameProvider_h
+/*!
+	\file
+	\brief Источник кадров для окна изображений, вычисляющий кадры по запросу
+
+	Окно запрашивает кадр, когда его нужно показать, и несколько соседних кадров заранее.
+	Окно хранит ограниченное число кадров, поэтому открытие набора из тысяч кадров
+	не требует их предварительного вычисления, а расход памяти не зависит от числа кадров.
+
+	Кадры запрашиваются из потока GUI. Данные, по которым они вычисляются, должны
+	существовать и не изменяться, пока источник подключен к окну (см. RasterImageSet::SetFrameProvider()).
+*/
+
+#include "DisplaySampleType.h"
+#include <XRADBasic/Sources/Containers/DataArray2D.h>
+#include <functional>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+class	FrameProvider
+{
+	public:
+		virtual	~FrameProvider() = default;
+
+		virtual	size_t	n_frames() const = 0;
+		virtual	size_t	vsize() const = 0;
+		virtual	size_t	hsize() const = 0;
+		virtual	display_sample_type	sample_type() const = 0;
+
+		/*!
+			\brief Данные кадра frame_no: vsize()*hsize() отсчетов типа sample_type(), записанных по строкам
+
+			Указатель действителен до следующего вызова.
+		*/
+		virtual	const void	*GetFrame(size_t frame_no) = 0;
+
+		/*!
+			\brief Перестать зависеть от внешних данных, сохранив их собственную копию
+
+			Вызывается при отключении источника, пока внешние данные еще существуют.
+			После успешного вызова окно продолжает запрашивать кадры по мере показа.
+			false, если источник этого не умеет: тогда окно загружает все кадры сразу.
+		*/
+		virtual	bool	DetachSource() { return false; }
+};
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Источник кадров, вычисляемых функцией function(frame, frame_no)
+
+	Функция заполняет кадр размером vs*hs, размещенный заранее. Вызовы выполняются по одному,
+	поэтому функция может пользоваться собственными буферами без блокировок.
+	Необязательная detach_function реализует DetachSource(): копирует данные, на которые
+	ссылается function, и переключает function на копию.
+*/
+template<class PIXEL_T>
+class	FunctionFrameProvider : public FrameProvider
+{
+	public:
+		typedef	DataArray2D<DataArray<PIXEL_T>> frame_type;
+		typedef	std::function<void (frame_type &frame, size_t frame_no)> frame_function;
+
+		FunctionFrameProvider(size_t in_n_frames, size_t vs, size_t hs, frame_function in_function,
+				std::function<void ()> in_detach_function = nullptr):
+				m_n_frames(in_n_frames), buffer(vs, hs), function(std::move(in_function)),
+				detach_function(std::move(in_detach_function)){}
+
+		virtual	size_t	n_frames() const override { return m_n_frames; }
+		virtual	size_t	vsize() const override { return buffer.vsize(); }
+		virtual	size_t	hsize() const override { return buffer.hsize(); }
+		virtual	display_sample_type	sample_type() const override { return DisplaySampleType<PIXEL_T>(); }
+
+		virtual	const void	*GetFrame(size_t frame_no) override
+		{
+			if(frame_no >= m_n_frames)
+			{
+				throw out_of_range(ssprintf("FunctionFrameProvider::GetFrame: frame %zu of %zu requested",
+						EnsureType<size_t>(frame_no), EnsureType<size_t>(m_n_frames)));
+			}
+			size_t	vs = buffer.vsize(), hs = buffer.hsize();
+			function(buffer, frame_no);
+			if(buffer.vsize() != vs || buffer.hsize() != hs || buffer.row_step() != 1 || buffer.column_step() != ptrdiff_t(hs))
+			{
+				// окно копирует кадр как непрерывный массив
+				throw logic_error(ssprintf("FunctionFrameProvider::GetFrame: frame layout changed, size (%zu, %zu) -> (%zu, %zu)",
+						EnsureType<size_t>(vs), EnsureType<size_t>(hs),
+						EnsureType<size_t>(buffer.vsize()), EnsureType<size_t>(buffer.hsize())));
+			}
+			return buffer.data();
+		}
+
+		virtual	bool	DetachSource() override
+		{
+			if(!detach_function)
+				return false;
+			detach_function();
+			detach_function = nullptr;
+			return true;
+		}
+
+	private:
+		const size_t	m_n_frames;
+		frame_type	buffer;
+		frame_function	function;
+		std::function<void ()>	detach_function;
+};
+
+template<class PIXEL_T, class F>
+shared_ptr<FrameProvider>	MakeFrameProvider(size_t n_frames, size_t vs, size_t hs, F &&function)
+{
+	return make_shared<FunctionFrameProvider<PIXEL_T>>(n_frames, vs, hs, std::forward<F>(function));
+}
+
+template<class PIXEL_T, class F, class D>
+shared_ptr<FrameProvider>	MakeFrameProvider(size_t n_frames, size_t vs, size_t hs, F &&function, D &&detach_function)
+{
+	return make_shared<FunctionFrameProvider<PIXEL_T>>(n_frames, vs, hs, std::forward<F>(function), std::forward<D>(detach_function));
+}
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_FrameProvider_h
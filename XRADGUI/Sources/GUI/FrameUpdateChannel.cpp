@@ -0,0 +1,94 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#include "pre.h"
+#include "FrameUpdateChannel.h"
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+shared_ptr<FrameSnapshot>	FrameUpdateChannel::GetSpare(display_sample_type sample_type, size_t vs, size_t hs)
+{
+	lock_guard<mutex>	lock(m_mutex);
+	for(auto it = m_spare.begin(); it != m_spare.end(); ++it)
+	{
+		if((*it)->sample_type() == sample_type && (*it)->vsize() == vs && (*it)->hsize() == hs)
+		{
+			auto	result = std::move(*it);
+			m_spare.erase(it);
+			return result;
+		}
+	}
+	return nullptr;
+}
+
+void	FrameUpdateChannel::Put(shared_ptr<FrameSnapshot> snapshot)
+{
+	lock_guard<mutex>	lock(m_mutex);
+	if(m_closed)
+		return;
+	++m_n_posted;
+	for(auto &pending: m_pending)
+	{
+		if(pending->frame_no == snapshot->frame_no)
+		{
+			// окно еще не показало предыдущий снимок этого кадра: он больше не нужен
+			++m_n_dropped;
+			if(m_spare.size() < max_spare_snapshots)
+				m_spare.push_back(std::move(pending));
+			pending = std::move(snapshot);
+			return;
+		}
+	}
+	m_pending.push_back(std::move(snapshot));
+}
+
+vector<shared_ptr<FrameSnapshot>>	FrameUpdateChannel::Take()
+{
+	vector<shared_ptr<FrameSnapshot>>	result;
+	lock_guard<mutex>	lock(m_mutex);
+	result.swap(m_pending);
+	return result;
+}
+
+void	FrameUpdateChannel::Release(shared_ptr<FrameSnapshot> snapshot)
+{
+	if(!snapshot)
+		return;
+	lock_guard<mutex>	lock(m_mutex);
+	if(!m_closed && m_spare.size() < max_spare_snapshots)
+		m_spare.push_back(std::move(snapshot));
+}
+
+void	FrameUpdateChannel::Close()
+{
+	lock_guard<mutex>	lock(m_mutex);
+	m_closed = true;
+	m_pending.clear();
+	m_spare.clear();
+}
+
+bool	FrameUpdateChannel::closed() const
+{
+	lock_guard<mutex>	lock(m_mutex);
+	return m_closed;
+}
+
+size_t	FrameUpdateChannel::n_posted() const
+{
+	lock_guard<mutex>	lock(m_mutex);
+	return m_n_posted;
+}
+
+size_t	FrameUpdateChannel::n_dropped() const
+{
+	lock_guard<mutex>	lock(m_mutex);
+	return m_n_dropped;
+}
+
+//--------------------------------------------------------------
+
+XRAD_END
@@ -0,0 +1,130 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_FrameUpdateChannel_h
+#define XRAD__File_FrameUpdateChannel_h
+/*!
+	\file
+	\brief Передача кадров из рабочего потока в окно изображения без ожидания потока GUI
+
+	RasterImageSet::SetupFrame ждет, пока поток GUI скопирует кадр и перерисует окно, поэтому
+	показ каждой итерации алгоритма замедляет сам алгоритм. Через канал рабочий поток только
+	оставляет копию кадра (снимок) и сразу продолжает работу, а окно забирает снимки по своему таймеру.
+	Непоказанный снимок кадра заменяется более новым: итерации, которые окно не успело показать,
+	пропускаются.
+
+	Буферы показанных и замененных снимков возвращаются в канал и используются повторно,
+	так что в установившемся режиме память под снимки не выделяется.
+*/
+
+#include "DisplaySampleType.h"
+#include <XRADBasic/Sources/Containers/DataArray2D.h>
+#include <mutex>
+#include <vector>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+//! \brief Копия кадра, переданная окну
+class	FrameSnapshot
+{
+	public:
+		virtual	~FrameSnapshot() = default;
+
+		int	frame_no = 0;
+
+		virtual	size_t	vsize() const = 0;
+		virtual	size_t	hsize() const = 0;
+		virtual	display_sample_type	sample_type() const = 0;
+		//! \brief vsize()*hsize() отсчетов типа sample_type(), записанных по строкам
+		virtual	const void	*data() const = 0;
+};
+
+template<class PIXEL_T>
+class	TypedFrameSnapshot : public FrameSnapshot
+{
+	public:
+		typedef	DataArray2D<DataArray<PIXEL_T>> frame_type;
+
+		TypedFrameSnapshot(size_t vs, size_t hs) : frame(vs, hs){}
+
+		virtual	size_t	vsize() const override { return frame.vsize(); }
+		virtual	size_t	hsize() const override { return frame.hsize(); }
+		virtual	display_sample_type	sample_type() const override { return DisplaySampleType<PIXEL_T>(); }
+		virtual	const void	*data() const override { return frame.data(); }
+
+		frame_type	frame;
+};
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Канал снимков кадров одного окна
+
+	Post вызывается из рабочего потока, Take, Release и Close -- из потока GUI.
+	Блокировка удерживается только на время обмена указателями, данные копируются вне ее.
+*/
+class	FrameUpdateChannel
+{
+	public:
+		/*!
+			\brief Отправка копии кадра frame с номером frame_no
+
+			Возвращает false, если окно закрыто (Close()); кадр при этом не копируется.
+		*/
+		template<class PIXEL_T, class ROW_T>
+		bool	Post(int frame_no, const DataArray2D<ROW_T> &frame);
+
+		//! \brief Снимки, отправленные после предыдущего вызова, не более одного на кадр
+		std::vector<shared_ptr<FrameSnapshot>>	Take();
+		//! \brief Возврат буфера показанного снимка для повторного использования
+		void	Release(shared_ptr<FrameSnapshot> snapshot);
+		//! \brief Окно закрыто: последующие вызовы Post ничего не делают
+		void	Close();
+
+		bool	closed() const;
+		size_t	n_posted() const;
+		//! \brief Количество снимков, замененных более новыми до показа
+		size_t	n_dropped() const;
+
+	private:
+		//! \brief Свободный буфер с заданными типом и размерами или nullptr
+		shared_ptr<FrameSnapshot>	GetSpare(display_sample_type sample_type, size_t vs, size_t hs);
+		void	Put(shared_ptr<FrameSnapshot> snapshot);
+
+		static	const size_t	max_spare_snapshots = 4;
+
+		mutable std::mutex	m_mutex;
+		//! \brief Неполученные снимки, по одному на кадр, в порядке отправки
+		std::vector<shared_ptr<FrameSnapshot>>	m_pending;
+		std::vector<shared_ptr<FrameSnapshot>>	m_spare;
+		bool	m_closed = false;
+		size_t	m_n_posted = 0, m_n_dropped = 0;
+};
+
+//--------------------------------------------------------------
+
+template<class PIXEL_T, class ROW_T>
+bool	FrameUpdateChannel::Post(int frame_no, const DataArray2D<ROW_T> &frame)
+{
+	if(closed())
+		return false;
+	// разные типы отсчетов могут показываться одинаково (DisplaySampleType), поэтому тип буфера проверяется
+	auto	snapshot = dynamic_pointer_cast<TypedFrameSnapshot<PIXEL_T>>(
+			GetSpare(DisplaySampleType<PIXEL_T>(), frame.vsize(), frame.hsize()));
+	if(!snapshot)
+		snapshot = make_shared<TypedFrameSnapshot<PIXEL_T>>(frame.vsize(), frame.hsize());
+	snapshot->frame_no = frame_no;
+	snapshot->frame.CopyData(frame);
+	Put(std::move(snapshot));
+	return true;
+}
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_FrameUpdateChannel_h
@@ -10,7 +10,6 @@
 #include <XRADBasic/Sources/Containers/DataArrayAnalyzeMD.h>
 #include <XRADBasic/Sources/Containers/ComplexArrayAnalyzeFunctors.h>
 #include <XRADBasic/Sources/Utils/ExponentialBlurAlgorithms.h>
-#include <XRADBasic/Sources/Utils/ParallelProcessor.h>
 
 XRAD_BEGIN
 
@@ -195,14 +194,6 @@ void	MathFunction3DDisplayer<A3DT>::DisplayAnimationBase(const index_vector &iv,
 		(Decide2(window_title + L": scan conversion options:", L"Raw data", L"Scan converter", SavedGUIValue<size_t>(1)) ? true:false) :
 		false;
 
-	bool	progress_needed = !IsProgressActive();
-
-	shared_ptr<ProgressProxyCore> progress_proxy;
-	if(progress_needed)
-		progress_proxy = GUIProgressProxy();
-	else
-		progress_proxy = VoidProgressProxy();
-
 	axis_legend zlegend(0, 1, "frame");
 	axis_legend ylegend(0, 1, "row");
 	axis_legend xlegend(0, 1, "col");
@@ -210,53 +201,54 @@ void	MathFunction3DDisplayer<A3DT>::DisplayAnimationBase(const index_vector &iv,
 	size_t	rvs;
 	size_t	rhs;
 
+	// кадры вычисляются по мере показа (см. FrameProvider.h): окно открывается сразу
+	// при любом количестве срезов, и в памяти хранится ограниченное число кадров.
+	// array_md не изменяется, пока существует animation. при отключении источника в ее деструкторе
+	// массив копируется в source->copy, и оставшееся открытым окно вычисляет кадры из копии
+	struct animation_source
+	{
+		const array_3d_type	*data;
+		array_3d_type	copy;
+	};
+	auto	source = make_shared<animation_source>();
+	source->data = &array_md;
+	auto	detach_source = [source]()
+	{
+		source->copy.MakeCopy(*source->data);
+		source->data = &source->copy;
+	};
 
 	if(scan_conversion)
 	{
-
-
 		physical_length	vmin, vmax, hmin, hmax;
-		scan_converter_type	SC(size_coord_1, size_coord_2);
-		SC.CopyScanConverterOptions(sco_12);
-		SC.InitScanConverter();
+		auto	SC = make_shared<scan_converter_type>(size_coord_1, size_coord_2);
+		SC->CopyScanConverterOptions(sco_12);
+		SC->InitScanConverter();
 
-		SC.GetRasterDimensions(vmin, vmax, hmin, hmax);
-		rvs = SC.GetConvertedImage().vsize();
-		rhs = SC.GetConvertedImage().hsize();
+		SC->GetRasterDimensions(vmin, vmax, hmin, hmax);
+		rvs = SC->GetConvertedImage().vsize();
+		rhs = SC->GetConvertedImage().hsize();
 
 		ylegend = axis_legend(vmin.cm(), (vmax-vmin).cm()/rvs, "cm");
 		xlegend = axis_legend(hmin.cm(), (hmax-hmin).cm()/rhs, "cm");
 
 		RasterImageSet	animation(window_title, rvs, rhs);
-		bool	frames_added = animation.AddFrames(n_slices);
 
 		animation.SetAxesScales(zlegend.min_value, zlegend.step,ylegend.min_value, ylegend.step, xlegend.min_value, xlegend.step);
 		animation.SetLabels(window_title, zlegend.label, ylegend.label, xlegend.label, vlegend.label);
 		animation.SetDefaultBrightness(vlegend.display_range.p1(), vlegend.display_range.p2(), vlegend.gamma);
 
-		ParallelProcessor	proc;
- 		auto	mode = frames_added ? ParallelProcessor::e_force_parallel:ParallelProcessor::e_force_plain;
-		proc.init(n_slices, mode);
-
-		vector<unique_ptr<scan_converter_type>> scs(proc.n_threads());
-		for(auto &scp: scs)
-		{
-			scp = make_unique<scan_converter_type>(size_coord_1, size_coord_2);
-			scp->CopyScanConverterOptions(sco_12);
-			scp->InitScanConverter();
-		}
-
-		auto	lambda = [&](size_t slice_no)
-		{
-			auto	slice_iv(iv);
-			slice_iv[animation_coordinate] = slice_no;
-			size_t	thread_no = proc.thread_no(slice_no);
-
-			scs[thread_no]->CopyData(array_md.GetSlice(slice_iv), Functors::assign_f1(functor));
-			scs[thread_no]->BuildConvertedImage();
-			animation.SetupFrame(int(slice_no), scs[thread_no]->GetConvertedImage());
-		};
-		proc.perform(lambda, L"Creating animation", progress_proxy);
+		animation.SetFrameProvider(MakeFrameProvider<pixel_type>(n_slices, rvs, rhs,
+				[source, iv, animation_coordinate, functor, SC](DataArray2D<DataArray<pixel_type>> &frame, size_t slice_no)
+				{
+					auto	slice_iv(iv);
+					slice_iv[animation_coordinate] = slice_no;
+
+					SC->CopyData(source->data->GetSlice(slice_iv), Functors::assign_f1(functor));
+					SC->BuildConvertedImage();
+					frame.CopyData(SC->GetConvertedImage());
+				},
+				detach_source));
 		animation.Display(true);
 	}
 	else
@@ -270,26 +262,20 @@ void	MathFunction3DDisplayer<A3DT>::DisplayAnimationBase(const index_vector &iv,
 		rhs = slice_ref_prototype.hsize();
 
 		RasterImageSet	animation(window_title, rvs, rhs);
-		bool	frames_added = animation.AddFrames(n_slices);
 
 		animation.SetAxesScales(zlegend.min_value, zlegend.step, ylegend.min_value, ylegend.step, xlegend.min_value, xlegend.step);
 		animation.SetLabels(window_title, zlegend.label, ylegend.label, xlegend.label, vlegend.label);
 		animation.SetDefaultBrightness(vlegend.display_range.p1(), vlegend.display_range.p2(), vlegend.gamma);
 
-		ParallelProcessor	proc;
-		auto	mode = frames_added ? ParallelProcessor::e_force_parallel:ParallelProcessor::e_force_plain;
-		proc.init(n_slices, mode);
+		animation.SetFrameProvider(MakeFrameProvider<pixel_type>(n_slices, rvs, rhs,
+				[source, iv, animation_coordinate, functor](DataArray2D<DataArray<pixel_type>> &frame, size_t slice_no)
+				{
+					auto	slice_iv(iv);
+					slice_iv[animation_coordinate] = slice_no;
 
-		auto	lambda = [&](size_t slice_no)
-		{
-			auto	slice_iv(iv);
-			slice_iv[animation_coordinate] = slice_no;
-
-			DataArray2D<DataArray<pixel_type> > raster;
-			MakeCopy(raster, array_md.GetSlice(slice_iv), Functors::assign_f1(functor));
-			animation.SetupFrame(int(slice_no), raster);
-		};
-		proc.perform(lambda, L"Creating animation", progress_proxy);
+					MakeCopy(frame, source->data->GetSlice(slice_iv), Functors::assign_f1(functor));
+				},
+				detach_source));
 		animation.Display(true);
 	}
 }
@@ -14,6 +14,7 @@
 
 #include "PixelNormalizers.h"
 #include <XRADBasic/Sources/Containers/DataArrayMD.h>
+#include <XRADBasic/Sources/Containers/DataArrayStatistics.h>
 #include <XRADBasic/Sources/Utils/ImageUtils.h>
 
 XRAD_BEGIN
@@ -513,18 +514,20 @@ assign_color_lightness_normalized<T, PT> GetColorLightnessRectifierRange(color_r
 
 
 
-template<class A2T, class F>
-void	ComputeDisplayRanges(const DataArray2D<A2T> &image, range1_F64 &recommended_range, range1_F64 &absolute_range, const F& functor)
+//! \brief Диапазоны отображения по результатам ComputeArrayStatistics
+inline void	DisplayRangesFromStatistics(const ArrayStatistics &stats, range1_F64 &recommended_range, range1_F64 &absolute_range)
 {
-	using namespace XRAD_PixelNormalizers;
-
-	absolute_range.x1() = MinValueTransformed(image, functor);
-	absolute_range.x2() = MaxValueTransformed(image, functor);
-	RealFunctionF64	histogram(10000);
+	absolute_range = stats.values_range();
+	if(stats.histogram.empty())
+	{
+		recommended_range = absolute_range;
+		return;
+	}
 	try
 	{
-		ComputeHistogramTransformed(image, histogram, absolute_range, functor);
-		recommended_range = ComputeQuantilesRange(histogram, absolute_range, range1_F64(MinDisplayTreshold(), MaxDisplayTreshold()));
+		RealFunctionF64	histogram;
+		histogram.MakeCopy(stats.histogram);
+		recommended_range = ComputeQuantilesRange(histogram, stats.histogram_range, range1_F64(MinDisplayTreshold(), MaxDisplayTreshold()));
 	}
 	catch(...)
 	{
@@ -532,23 +535,24 @@ void	ComputeDisplayRanges(const DataArray2D<A2T> &image, range1_F64 &recommended
 	}
 }
 
+//! \brief Параметры запроса статистики для ComputeDisplayRanges: экстремумы и гистограмма за два параллельных прохода
+inline ArrayStatisticsRequest	DisplayRangesStatisticsRequest()
+{
+	ArrayStatisticsRequest	request;
+	request.histogram_size = 10000;
+	return request;
+}
+
 template<class A2T, class F>
-void	ComputeDisplayRanges(const DataArrayMD<A2T> &image_md, range1_F64 &recommended_range, range1_F64 &absolute_range, const F& functor)
+void	ComputeDisplayRanges(const DataArray2D<A2T> &image, range1_F64 &recommended_range, range1_F64 &absolute_range, const F& functor)
 {
-	using namespace XRAD_PixelNormalizers;
+	DisplayRangesFromStatistics(ComputeArrayStatistics(image, DisplayRangesStatisticsRequest(), functor), recommended_range, absolute_range);
+}
 
-	absolute_range.x1() = MinValueTransformed(image_md, functor);
-	absolute_range.x2() = MaxValueTransformed(image_md, functor);
-	RealFunctionF64	histogram(10000);
-	try
-	{
-		ComputeHistogramTransformed(image_md, histogram, absolute_range, functor);
-		recommended_range = ComputeQuantilesRange(histogram, absolute_range, range1_F64(MinDisplayTreshold(), MaxDisplayTreshold()));
-	}
-	catch(...)
-	{
-		recommended_range = absolute_range;
-	}
+template<class A2T, class F>
+void	ComputeDisplayRanges(const DataArrayMD<A2T> &image_md, range1_F64 &recommended_range, range1_F64 &absolute_range, const F& functor)
+{
+	DisplayRangesFromStatistics(ComputeArrayStatistics(image_md, DisplayRangesStatisticsRequest(), functor), recommended_range, absolute_range);
 }
 
 
@@ -25,6 +25,12 @@ RasterImageSet::RasterImageSet(const wstring &title, size_t vs, size_t hs) : m_v
 	window.reset(new ImageWindowContainer(api_CreateRasterImageSet(title, vs, hs)));
 }
 
+RasterImageSet::~RasterImageSet()
+{
+	if(m_frame_provider_set)
+		api_SetImageFrameProvider(image_container(), nullptr);
+}
+
 bool RasterImageSet::AddFrames(size_t n_frames)
 {
 	return api_AddImageFrames(image_container(), n_frames);
@@ -51,6 +57,34 @@ bool RasterImageSet::InsertFrame(int after_frame_no, const void* data, display_s
 	return api_InsertImageFrame(image_container(), after_frame_no, data, pt);
 }
 
+bool	RasterImageSet::SetFrameProvider(shared_ptr<FrameProvider> provider)
+{
+	if(provider && (provider->vsize() != vsize() || provider->hsize() != hsize()))
+	{
+		throw invalid_argument(ssprintf("RasterImageSet::SetFrameProvider: frame size (%zu, %zu) differs from image size (%zu, %zu)",
+				EnsureType<size_t>(provider->vsize()), EnsureType<size_t>(provider->hsize()),
+				EnsureType<size_t>(vsize()), EnsureType<size_t>(hsize())));
+	}
+	bool	result = api_SetImageFrameProvider(image_container(), provider);
+	m_frame_provider_set = result && provider;
+	return result;
+}
+
+
+FrameUpdateChannel	*RasterImageSet::UpdateChannel()
+{
+	// как и при SetupFrame, здесь проверяются прерывание и пауза счета
+	api_ForceUpdateGUI(sec(0.1));
+	if(!m_update_channel)
+	{
+		auto	channel = make_shared<FrameUpdateChannel>();
+		if(!api_SetImageUpdateChannel(image_container(), channel))
+			return nullptr;
+		m_update_channel = channel;
+	}
+	return m_update_channel->closed() ? nullptr : m_update_channel.get();
+}
+
 
 bool RasterImageSet::SetLabels(const wstring &in_title, const wstring &in_z_label, const wstring &in_y_label, const wstring &in_x_label, const wstring &in_value_label)
 {
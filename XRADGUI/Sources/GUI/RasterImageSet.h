@@ -14,6 +14,8 @@
 
 #include "DataDisplayer.h"
 #include "DisplaySampleType.h"
+#include "FrameProvider.h"
+#include "FrameUpdateChannel.h"
 #include <XRADBasic/MathFunctionTypes2D.h>
 
 XRAD_BEGIN
@@ -30,10 +32,16 @@ class	RasterImageSet : public DataDisplayer
 	bool	InsertFrame(int after_frame_no, const void* frame_data, display_sample_type pt);
 
 	const size_t	m_vsize, m_hsize;
+	bool	m_frame_provider_set = false;
+	shared_ptr<FrameUpdateChannel>	m_update_channel;
+
+	//! \brief Канал кадров окна, создается при первом вызове PostFrame (nullptr, если окно закрыто)
+	FrameUpdateChannel	*UpdateChannel();
 
 public:
 	RasterImageSet(const wstring &title, size_t vs, size_t hs);
-	~RasterImageSet() = default;
+	//! \brief Отключает источник кадров (см. SetFrameProvider()), если он был задан
+	~RasterImageSet();
 
 
 	size_t	vsize() const { return m_vsize; }
@@ -51,6 +59,30 @@ public:
 	template<class ROW_T>
 	bool InsertFrame(int after_frame_no, const DataArray2D<ROW_T> &frame);
 	bool DeleteFrame(int in_frame_no);
+
+	/*!
+		\brief Кадры вычисляются источником по запросу окна, а не передаются заранее
+
+		Заменяет все кадры окна кадрами источника. Размеры кадров источника должны совпадать
+		с vsize(), hsize(). Источник отключается при уничтожении объекта RasterImageSet;
+		если окно в этот момент еще открыто, источник копирует свои данные (FrameProvider::DetachSource)
+		и окно продолжает вычислять кадры по мере показа. Источник, не умеющий этого,
+		сразу отдает окну все недостающие кадры.
+		До отключения данные, которыми пользуется источник, должны оставаться неизменными.
+	*/
+	bool	SetFrameProvider(shared_ptr<FrameProvider> provider);
+
+	/*!
+		\brief Передать кадр окну, не дожидаясь его показа
+
+		В отличие от SetupFrame, копирует кадр и сразу возвращает управление; окно показывает
+		переданные кадры по своему таймеру (см. FrameUpdateChannel.h). Если окно не успело показать
+		кадр с номером in_frame_no до следующего вызова с тем же номером, показывается только последний.
+		Предназначено для показа промежуточных результатов на каждой итерации алгоритма.
+		Возвращает false, если окно закрыто.
+	*/
+	template<class ROW_T>
+	bool	PostFrame(int in_frame_no, const DataArray2D<ROW_T> &frame);
 };
 
 
@@ -90,6 +122,19 @@ bool RasterImageSet::SetupFrame(int in_frame_no, const DataArray2D<ROW_T> &frame
 	}
 }
 
+template<class ROW_T>
+bool	RasterImageSet::PostFrame(int in_frame_no, const DataArray2D<ROW_T> &frame)
+{
+	if(frame.vsize() != vsize() || frame.hsize() != hsize())
+	{
+		throw invalid_argument(ssprintf("RasterImageSet::PostFrame: frame size (%zu, %zu) differs from image size (%zu, %zu)",
+				EnsureType<size_t>(frame.vsize()), EnsureType<size_t>(frame.hsize()),
+				EnsureType<size_t>(vsize()), EnsureType<size_t>(hsize())));
+	}
+	FrameUpdateChannel	*channel = UpdateChannel();
+	return channel && channel->Post<typename ROW_T::value_type_variable>(in_frame_no, frame);
+}
+
 //--------------------------------------------------------------
 
 XRAD_END
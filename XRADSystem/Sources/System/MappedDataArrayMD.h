@@ -0,0 +1,174 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_MappedDataArrayMD_h
+#define XRAD__File_MappedDataArrayMD_h
+/*!
+	\file
+	\brief Многомерный массив, данные которого находятся в отображенном в память файле
+
+	Открытие тома не читает данные: страницы файла загружаются при первом обращении к ним,
+	поэтому из многогигабайтного тома можно быстро получить несколько срезов.
+
+	~~~~
+	MappedDataArrayMD<RealFunctionMD_I16>	volume;
+	MapRawVolume(volume, L"volume.raw", {2000, 512, 512});
+	auto	slice = volume.array().GetSlice({100, slice_mask(0), slice_mask(1)}); // только чтение
+	RealFunction2D_I16	slice_copy(slice);
+	~~~~
+
+	NIfTI: см. map_nifti() в nifti_to_data_array.h.
+*/
+//--------------------------------------------------------------
+
+#include "MappedFile.h"
+#include <XRADBasic/Sources/Containers/DataArrayMD.h>
+#include <memory>
+#include <type_traits>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Массив ARR (наследник DataArrayMD), использующий данные отображенного файла
+
+	Массив ссылается на данные файла как на внешние данные (UseData). Файл остается
+	отображенным, пока существует объект MappedDataArrayMD или другие владельцы shared_ptr<MappedFile>.
+	Срезы и ссылки на данные, полученные через array().GetSlice, UseData и т.п., должны
+	уничтожаться раньше объекта.
+
+	Массив доступен только через array() (чтение) и writable_array() (изменение элементов,
+	только при отображении mapped_file_mode::copy_on_write; запись в отображение read_only
+	привела бы к ошибке доступа). Присваивание элементов и перемещение данных в обычный ARR
+	поэтому невозможны: обычный массив остался бы ссылаться на отображение после его закрытия.
+	Копия данных в собственной памяти: ARR copy(mapped.array()).
+*/
+template<class ARR>
+class MappedDataArrayMD : private ARR
+{
+	private:
+		PARENT(ARR);
+	public:
+		typedef ARR array_type;
+		typedef typename parent::value_type value_type;
+
+		MappedDataArrayMD() = default;
+		MappedDataArrayMD(const MappedDataArrayMD &) = delete;
+		MappedDataArrayMD &operator=(const MappedDataArrayMD &) = delete;
+		//! \brief Перемещение передает и данные, и владение отображением
+		MappedDataArrayMD(MappedDataArrayMD &&) = default;
+		MappedDataArrayMD &operator=(MappedDataArrayMD &&) = default;
+
+		/*!
+			\brief Использовать данные файла, начиная с offset байт от начала файла
+
+			Данные записаны подряд, последний индекс меняется быстрее всего,
+			порядок байтов little endian.
+		*/
+		void	MapData(shared_ptr<MappedFile> file, file_offset_t offset, const index_vector &sizes);
+
+		//! \brief Освободить отображение, массив становится пустым
+		void	Unmap();
+
+		const shared_ptr<MappedFile>	&mapped_file() const { return m_file; }
+		bool	is_mapped() const { return m_file && parent::uses_external_data(); }
+
+		const ARR	&array() const { return *this; }
+		/*!
+			\brief Массив с изменяемыми элементами. Для отображения mapped_file_mode::read_only -- исключение
+
+			Перемещать данные из этого массива в другой нельзя (см. описание класса).
+		*/
+		ARR	&writable_array();
+
+		const index_vector	&sizes() const { return parent::sizes(); }
+		size_t	sizes(size_t s) const { return parent::sizes(s); }
+		size_t	n_dimensions() const { return parent::n_dimensions(); }
+		bool	empty() const { return parent::empty(); }
+
+	private:
+		shared_ptr<MappedFile>	m_file;
+};
+
+//--------------------------------------------------------------
+
+template<class ARR>
+void	MappedDataArrayMD<ARR>::MapData(shared_ptr<MappedFile> file, file_offset_t offset, const index_vector &sizes)
+{
+	typedef remove_const_t<value_type> sample_type;
+	static_assert(is_trivially_copyable<sample_type>::value,
+			"MappedDataArrayMD: file data can be used only for trivially copyable types.");
+	XRAD_ASSERT_THROW(file);
+
+	size_t	element_count = 1;
+	for(size_t i = 0; i < sizes.size(); ++i)
+		element_count *= sizes[i];
+	const wstring	&filename = file->filename();
+
+	if(sizeof(sample_type) > 1 && XRAD_ENDIAN != XRAD_LITTLE_ENDIAN)
+	{
+		throw runtime_error(ssprintf("MappedDataArrayMD::MapData, \"%s\": little endian data can't be mapped on this platform.",
+				EnsureType<const char*>(convert_to_string(filename).c_str())));
+	}
+	if(offset < 0 || file_size_t(offset) > file->size() ||
+			element_count > (file->size() - file_size_t(offset))/sizeof(sample_type))
+	{
+		throw invalid_argument(ssprintf("MappedDataArrayMD::MapData, \"%s\": data (offset %lli, %zu elements of %zu bytes) exceed file size %llu.",
+				EnsureType<const char*>(convert_to_string(filename).c_str()),
+				static_cast<long long>(offset),
+				EnsureType<size_t>(element_count),
+				EnsureType<size_t>(sizeof(sample_type)),
+				static_cast<unsigned long long>(file->size())));
+	}
+	// начало отображения выровнено на границу страницы
+	if(offset % alignof(sample_type))
+	{
+		throw invalid_argument(ssprintf("MappedDataArrayMD::MapData, \"%s\": offset %lli is not aligned to %zu bytes.",
+				EnsureType<const char*>(convert_to_string(filename).c_str()),
+				static_cast<long long>(offset),
+				EnsureType<size_t>(alignof(sample_type))));
+	}
+
+	parent::UseData(reinterpret_cast<value_type*>(file->data() + offset), sizes, 1);
+	m_file = std::move(file);
+}
+
+template<class ARR>
+ARR	&MappedDataArrayMD<ARR>::writable_array()
+{
+	if(m_file && m_file->mode() == mapped_file_mode::read_only)
+	{
+		throw logic_error(ssprintf("MappedDataArrayMD::writable_array, \"%s\": file is mapped read-only, use mapped_file_mode::copy_on_write.",
+				EnsureType<const char*>(convert_to_string(m_file->filename()).c_str())));
+	}
+	return *this;
+}
+
+template<class ARR>
+void	MappedDataArrayMD<ARR>::Unmap()
+{
+	parent::realloc(index_vector());
+	m_file.reset();
+}
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Отобразить в массив "сырой" файл: элементы value_type без заголовка (или с заголовком
+	размером offset байт), little endian, последний индекс меняется быстрее всего
+*/
+template<class ARR>
+void	MapRawVolume(MappedDataArrayMD<ARR> &result, const wstring &filename, const index_vector &sizes,
+		file_offset_t offset = 0, mapped_file_mode mode = mapped_file_mode::read_only)
+{
+	result.MapData(make_shared<MappedFile>(filename, mode), offset, sizes);
+}
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_MappedDataArrayMD_h
@@ -0,0 +1,142 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#include "pre.h"
+#include "MappedFile.h"
+#include "FileNameOperations.h"
+#include "SystemConfig.h"
+#include <stdexcept>
+
+#if defined(XRAD_USE_CFILE_WIN32_VERSION)
+	#include <windows.h>
+#elif defined(XRAD_USE_CFILE_UNIX_VERSION)
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#include <cstring>
+#else
+	#error Unknown platform.
+#endif
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+namespace
+{
+
+[[noreturn]] void	ThrowMappingError(const wstring &filename, const string &reason)
+{
+	throw runtime_error(ssprintf("MappedFile: file \"%s\" could not be mapped: %s",
+			EnsureType<const char*>(convert_to_string(GetPathNativeFromAutodetect(filename)).c_str()),
+			EnsureType<const char*>(reason.c_str())));
+}
+
+} // namespace
+
+//--------------------------------------------------------------
+
+#if defined(XRAD_USE_CFILE_WIN32_VERSION)
+
+MappedFile::MappedFile(const wstring &filename, mapped_file_mode mode):
+	m_filename(filename), m_mode(mode)
+{
+	HANDLE	file = CreateFileW(GetPathSystemRawFromAutodetect(filename).c_str(), GENERIC_READ,
+			FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file == INVALID_HANDLE_VALUE)
+		ThrowMappingError(filename, ssprintf("CreateFile error %lu", GetLastError()));
+
+	LARGE_INTEGER	size;
+	if(!GetFileSizeEx(file, &size))
+	{
+		DWORD	error = GetLastError();
+		CloseHandle(file);
+		ThrowMappingError(filename, ssprintf("GetFileSizeEx error %lu", error));
+	}
+	m_file_handle = file;
+	m_size = file_size_t(size.QuadPart);
+	if(!m_size)
+		return;
+
+	// копирование при записи: PAGE_WRITECOPY и FILE_MAP_COPY
+	HANDLE	mapping = CreateFileMappingW(file, NULL,
+			mode == mapped_file_mode::read_only ? PAGE_READONLY : PAGE_WRITECOPY, 0, 0, NULL);
+	if(!mapping)
+	{
+		DWORD	error = GetLastError();
+		CloseHandle(file);
+		ThrowMappingError(filename, ssprintf("CreateFileMapping error %lu", error));
+	}
+	void	*data = MapViewOfFile(mapping,
+			mode == mapped_file_mode::read_only ? FILE_MAP_READ : FILE_MAP_COPY, 0, 0, 0);
+	if(!data)
+	{
+		DWORD	error = GetLastError();
+		CloseHandle(mapping);
+		CloseHandle(file);
+		ThrowMappingError(filename, ssprintf("MapViewOfFile error %lu", error));
+	}
+	m_mapping_handle = mapping;
+	m_data = static_cast<char*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+	if(m_data)
+		UnmapViewOfFile(m_data);
+	if(m_mapping_handle)
+		CloseHandle(m_mapping_handle);
+	if(m_file_handle)
+		CloseHandle(m_file_handle);
+}
+
+#elif defined(XRAD_USE_CFILE_UNIX_VERSION)
+
+MappedFile::MappedFile(const wstring &filename, mapped_file_mode mode):
+	m_filename(filename), m_mode(mode)
+{
+	int	fd = ::open(convert_to_string(GetPathSystemRawFromAutodetect(filename)).c_str(), O_RDONLY);
+	if(fd < 0)
+		ThrowMappingError(filename, strerror(errno));
+
+	struct stat	st;
+	if(fstat(fd, &st))
+	{
+		int	error = errno;
+		::close(fd);
+		ThrowMappingError(filename, strerror(error));
+	}
+	m_size = file_size_t(st.st_size);
+	if(m_size)
+	{
+		// MAP_PRIVATE: изменения не попадают в файл (копирование при записи)
+		void	*data = mmap(nullptr, m_size,
+				mode == mapped_file_mode::read_only ? PROT_READ : PROT_READ | PROT_WRITE,
+				MAP_PRIVATE, fd, 0);
+		if(data == MAP_FAILED)
+		{
+			int	error = errno;
+			::close(fd);
+			ThrowMappingError(filename, strerror(error));
+		}
+		m_data = static_cast<char*>(data);
+	}
+	// отображение остается действительным после закрытия файла
+	::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if(m_data)
+		munmap(m_data, m_size);
+}
+
+#endif
+
+//--------------------------------------------------------------
+
+XRAD_END
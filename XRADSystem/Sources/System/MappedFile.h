@@ -0,0 +1,67 @@
+﻿/*
+	Copyright (c) 2021, Moscow Center for Diagnostics & Telemedicine
+	All rights reserved.
+	This file is licensed under BSD-3-Clause license. See LICENSE file for details.
+*/
+#ifndef XRAD__File_MappedFile_h
+#define XRAD__File_MappedFile_h
+/*!
+	\file
+	\brief Отображение файла в память
+*/
+//--------------------------------------------------------------
+
+#include "FileSystemDefs.h"
+#include <string>
+
+XRAD_BEGIN
+
+//--------------------------------------------------------------
+
+enum class mapped_file_mode
+{
+	//! \brief Данные только читаются. Запись в отображенную память приводит к ошибке доступа
+	read_only,
+	//! \brief Измененные страницы копируются в память процесса, файл не изменяется
+	copy_on_write
+};
+
+/*!
+	\brief Файл, целиком отображенный в адресное пространство процесса
+
+	Открытие файла не читает данные: страницы загружаются с диска при первом обращении к ним.
+	Отображение сохраняется до уничтожения объекта. Объект не копируется;
+	для совместного владения используется shared_ptr<MappedFile>.
+*/
+class MappedFile
+{
+	public:
+		//! \brief Открыть и отобразить файл. В случае ошибки исключение
+		MappedFile(const wstring &filename, mapped_file_mode mode);
+		~MappedFile();
+
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		//! \brief Начало отображенных данных. Для пустого файла nullptr
+		char	*data() { return m_data; }
+		const char	*data() const { return m_data; }
+		file_size_t	size() const { return m_size; }
+		mapped_file_mode	mode() const { return m_mode; }
+		const wstring	&filename() const { return m_filename; }
+
+	private:
+		wstring	m_filename;
+		mapped_file_mode	m_mode;
+		char	*m_data = nullptr;
+		file_size_t	m_size = 0;
+		//! \brief Системные дескрипторы (Win32: HANDLE файла и отображения)
+		void	*m_file_handle = nullptr;
+		void	*m_mapping_handle = nullptr;
+};
+
+//--------------------------------------------------------------
+
+XRAD_END
+
+#endif // XRAD__File_MappedFile_h
@@ -10,6 +10,7 @@
 */
 
 #include <XRADSystem/sources/nifti/nifti_datatypes.h>
+#include <XRADSystem/sources/nifti/nifti_gzip.h>
 
 #include <XRADSystem/ThirdParty/nifti/niftilib/nifti1.h>
 //#include <XRADSystem/ThirdParty/nifti/niftilib/nifti1_io.h>
@@ -71,7 +72,7 @@ nifti_1_header CreateNiftiHeader(const ARR& array, const RealFunctionF32& scales
 		hdr.pixdim[n_dimensions-i] = scales[i];
 	}
 
-	using sample_type = typename remove_cv<ARR::value_type>::type;
+	using sample_type = typename remove_cv<typename ARR::value_type>::type;
 
 	hdr.datatype = nifti_datatype<sample_type>();
 	hdr.bitpix = nifti_sample_size(sample_type());
@@ -97,7 +98,7 @@ nifti_1_header CreateNiftiHeader(const ARR& array, const RealFunctionF32& scales
 		hdr.xyzt_units = NIFTI_UNITS_MM;
 	}
 
-	if(type == nifti_file_type::nii)
+	if(type != nifti_file_type::img_hdr)
 	{
 		strncpy(hdr.magic, "n+1\0", 4);
 		hdr.vox_offset = float(NII_HEADER_SIZE);
@@ -115,6 +116,35 @@ nifti_1_header CreateNiftiHeader(const ARR& array, const RealFunctionF32& scales
 
 
 
+//! \brief Запись данных изображения построчно: строки преобразуются и сразу сжимаются
+template<class ARR_T>
+void write_nifti_data(gzip_parallel_writer &writer, const ARR_T &array)
+{
+	using sample_type = typename remove_cv<typename ARR_T::value_type>::type;
+	using codec = nifti_codec<nifti_datatype<sample_type>()>;
+	using file_type = typename codec::file_type;
+
+	vector<uint8_t>	buffer;
+	for_each_nifti_row(array, [&](auto &&row)
+	{
+		size_t	n = row.size();
+		if constexpr(codec::raw)
+		{
+			// строка в памяти уже имеет формат файла
+			if(auto data = DataArrayIOAuxiliaries::contiguous_data<file_type>(row.begin(), n))
+			{
+				writer.Write(data, n*codec::size);
+				return;
+			}
+		}
+		buffer.resize(n*codec::size);
+		auto	it = row.begin();
+		for(size_t i = 0; i < n; ++i, ++it)
+			codec::put(&buffer[i*codec::size], file_type(*it));
+		writer.Write(buffer.data(), buffer.size());
+	});
+}
+
 template<class ARR_T>
 void write_nifti_util(const ARR_T& array, wstring filename, RealFunctionF32 scales = RealFunctionF32(), nifti_file_type type = nifti_file_type::nii)
 {
@@ -137,6 +167,18 @@ void write_nifti_util(const ARR_T& array, wstring filename, RealFunctionF32 scal
 //		nii_writer.write(nifti_data.data(), (size_t)(hdr.bitpix/8), array.element_count());
 	}
 
+	/********** if nii.gz, compress header and image data in blocks, several blocks at a time */
+	else if(type == nifti_file_type::nii_gz)
+	{
+		gzip_parallel_writer	writer(filename + L".nii.gz");
+		writer.Write(&hdr, MIN_HEADER_SIZE);
+
+		nifti1_extender pad={0,0,0,0};
+		writer.Write(&pad, 4);
+		write_nifti_data(writer, array);
+		writer.Finish();
+	}
+
 	/********** if hdr/img, close .hdr and write image data to .img */
 	else
 	{
@@ -12,6 +12,8 @@
 
 #include <XRADSystem/ThirdParty/nifti/niftilib/nifti1.h>
 #include <XRADBasic/Sources/DataArrayIO/DataArrayIOEnum.h>
+#include <XRADBasic/DataArrayIO.h>
+#include <cstring>
 
 XRAD_BEGIN
 
@@ -138,11 +140,189 @@ inline constexpr short	nifti_sample_size(const ColorSampleF64&) { return static_
 
 enum class nifti_file_type
 {
-	nii, img_hdr
+	nii, img_hdr, nii_gz
 };
 
 
 
+/*!
+	\brief Преобразование отсчетов между представлением в файле NIfTI (little endian) и в памяти
+
+	Используется при потоковом чтении и записи, когда данные проходят через буфер в памяти
+	(.nii.gz). file_type -- тип отсчета в памяти, соответствующий типу данных файла;
+	raw == true, если представление в файле совпадает с представлением file_type в памяти.
+*/
+template<class FILE_T, class COMPONENT_T = FILE_T>
+struct nifti_raw_codec
+{
+	typedef FILE_T file_type;
+	static constexpr size_t size = sizeof(FILE_T);
+	static constexpr bool raw = XRAD_ENDIAN == XRAD_LITTLE_ENDIAN || sizeof(COMPONENT_T) == 1;
+
+	static file_type	get(const uint8_t *buffer)
+	{
+		file_type	x;
+		memcpy(&x, buffer, size);
+		if constexpr(!raw)
+			DataArrayIOAuxiliaries::swap_bytes<COMPONENT_T>(&x, size/sizeof(COMPONENT_T));
+		return x;
+	}
+	static void	put(uint8_t *buffer, file_type x)
+	{
+		if constexpr(!raw)
+			DataArrayIOAuxiliaries::swap_bytes<COMPONENT_T>(&x, size/sizeof(COMPONENT_T));
+		memcpy(buffer, &x, size);
+	}
+};
+
+//! \brief DT_RGB24: байты r, g, b
+struct nifti_rgb24_codec
+{
+	typedef ColorSampleUI8 file_type;
+	static constexpr size_t size = 3;
+	static constexpr bool raw = false;
+
+	static file_type	get(const uint8_t *buffer) { return file_type(buffer[0], buffer[1], buffer[2]); }
+	static void	put(uint8_t *buffer, const file_type &x) { buffer[0] = x.red(); buffer[1] = x.green(); buffer[2] = x.blue(); }
+};
+
+//! \brief DT_RGBA32: байты r, g, b, a
+struct nifti_rgba32_codec
+{
+	typedef ColorPixel file_type;
+	static constexpr size_t size = 4;
+	static constexpr bool raw = false;
+
+	static file_type	get(const uint8_t *buffer)
+	{
+		file_type	result(buffer[0], buffer[1], buffer[2]);
+		result.alpha() = buffer[3];
+		return result;
+	}
+	static void	put(uint8_t *buffer, const file_type &x) { buffer[0] = x.red(); buffer[1] = x.green(); buffer[2] = x.blue(); buffer[3] = x.alpha(); }
+};
+
+//! \brief Преобразование для типа данных NIfTI DT. Набор типов такой же, как в nifti_format_to_io_enum()
+template<int16_t DT> struct nifti_codec;
+
+template<> struct nifti_codec<DT_FLOAT32> : nifti_raw_codec<float> {};
+template<> struct nifti_codec<DT_FLOAT64> : nifti_raw_codec<double> {};
+template<> struct nifti_codec<DT_UINT8> : nifti_raw_codec<uint8_t> {};
+template<> struct nifti_codec<DT_INT8> : nifti_raw_codec<int8_t> {};
+template<> struct nifti_codec<DT_UINT16> : nifti_raw_codec<uint16_t> {};
+template<> struct nifti_codec<DT_INT16> : nifti_raw_codec<int16_t> {};
+template<> struct nifti_codec<DT_UINT32> : nifti_raw_codec<uint32_t> {};
+template<> struct nifti_codec<DT_INT32> : nifti_raw_codec<int32_t> {};
+template<> struct nifti_codec<DT_UINT64> : nifti_raw_codec<uint64_t> {};
+template<> struct nifti_codec<DT_INT64> : nifti_raw_codec<int64_t> {};
+template<> struct nifti_codec<DT_COMPLEX64> : nifti_raw_codec<complexF32, float> {};
+template<> struct nifti_codec<DT_COMPLEX128> : nifti_raw_codec<complexF64, double> {};
+template<> struct nifti_codec<DT_RGB24> : nifti_rgb24_codec {};
+template<> struct nifti_codec<DT_RGBA32> : nifti_rgba32_codec {};
+
+//! \brief Вызов f(nifti_codec<DT>()) для типа данных, известного только во время выполнения
+template<class F>
+void	nifti_datatype_dispatch(int16_t nifti_datatype, size_t bitpix, F f)
+{
+	auto	call = [&](auto codec)
+	{
+		XRAD_ASSERT_THROW(decltype(codec)::size*CHAR_BIT == bitpix);
+		f(codec);
+	};
+	switch(nifti_datatype)
+	{
+		case DT_FLOAT32: call(nifti_codec<DT_FLOAT32>()); break;
+		case DT_FLOAT64: call(nifti_codec<DT_FLOAT64>()); break;
+		case DT_UINT8: call(nifti_codec<DT_UINT8>()); break;
+		case DT_INT8: call(nifti_codec<DT_INT8>()); break;
+		case DT_UINT16: call(nifti_codec<DT_UINT16>()); break;
+		case DT_INT16: call(nifti_codec<DT_INT16>()); break;
+		case DT_UINT32: call(nifti_codec<DT_UINT32>()); break;
+		case DT_INT32: call(nifti_codec<DT_INT32>()); break;
+		case DT_UINT64: call(nifti_codec<DT_UINT64>()); break;
+		case DT_INT64: call(nifti_codec<DT_INT64>()); break;
+		case DT_COMPLEX64: call(nifti_codec<DT_COMPLEX64>()); break;
+		case DT_COMPLEX128: call(nifti_codec<DT_COMPLEX128>()); break;
+		case DT_RGB24: call(nifti_codec<DT_RGB24>()); break;
+		case DT_RGBA32: call(nifti_codec<DT_RGBA32>()); break;
+
+		default:
+			throw invalid_argument("Unknown or unsupported nifti data format");
+	}
+}
+
+/*!
+	\brief Вызов f(row) для каждой строки массива (одномерного среза по последнему индексу)
+	в порядке хранения данных в файле NIfTI
+*/
+template<class T, class F>
+void	for_each_nifti_row(DataArray<T> &array, F f)
+{
+	f(array);
+}
+
+template<class T, class F>
+void	for_each_nifti_row(const DataArray<T> &array, F f)
+{
+	f(array);
+}
+
+template<class T, class F>
+void	for_each_nifti_row(DataArray2D<T> &array, F f)
+{
+	for(size_t i = 0; i < array.vsize(); ++i)
+		f(array.row(i));
+}
+
+template<class T, class F>
+void	for_each_nifti_row(const DataArray2D<T> &array, F f)
+{
+	for(size_t i = 0; i < array.vsize(); ++i)
+		f(array.row(i));
+}
+
+template<class MD, class F>
+void	for_each_nifti_row_md(MD &array, F f)
+{
+	size_t	n_dimensions = array.n_dimensions();
+	for(size_t i = 0; i < n_dimensions; ++i)
+	{
+		if(!array.sizes(i))
+			return;
+	}
+	index_vector	iv(n_dimensions);
+	for(size_t i = 0; i < n_dimensions - 1; ++i)
+		iv[i] = 0;
+	iv[n_dimensions - 1] = slice_mask(0);
+	for(;;)
+	{
+		f(array.GetRow(iv));
+		size_t	i = n_dimensions - 1;
+		for(; i > 0; --i)
+		{
+			if(++iv[i - 1] < array.sizes(i - 1))
+				break;
+			iv[i - 1] = 0;
+		}
+		if(!i)
+			break;
+	}
+}
+
+template<class ARR2T, class F>
+void	for_each_nifti_row(DataArrayMD<ARR2T> &array, F f)
+{
+	for_each_nifti_row_md(array, f);
+}
+
+template<class ARR2T, class F>
+void	for_each_nifti_row(const DataArrayMD<ARR2T> &array, F f)
+{
+	for_each_nifti_row_md(array, f);
+}
+
+
+
 
 XRAD_END
 
@@ -0,0 +1,479 @@
+﻿#ifndef nifti_gzip_h__
+#define nifti_gzip_h__
+
+/*!
+	\file
+	\brief Потоковое чтение и запись файлов gzip (.nii.gz) с ограниченным расходом памяти
+
+	Запись: данные накапливаются в буфере из нескольких блоков по gzip_block_size байт,
+	блоки сжимаются одновременно в разных потоках (OpenMP), как в pigz. Каждый блок --
+	независимый поток deflate, завершенный Z_SYNC_FLUSH; в качестве словаря используются
+	последние 32 КБ предыдущих данных, поэтому степень сжатия практически не отличается
+	от однопоточной. Результат -- обычный файл gzip, читаемый любыми программами.
+
+	Чтение: распаковка выполняется в отдельном потоке и опережает использование данных
+	на несколько блоков (конвейер), преобразование распакованных данных в массив
+	идет параллельно с распаковкой следующих.
+
+	Для использования требуется zlib (заголовок zlib.h и библиотека в настройках проекта).
+*/
+
+#include <XRADSystem/CFile.h>
+#include <XRADSystem/Sources/System/FileNameOperations.h>
+#include <XRADSystem/Sources/System/SystemConfig.h>
+#include <XRADBasic/Sources/Core/ThreadSetup.h>
+#include <zlib.h>
+#include <omp.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+XRAD_BEGIN
+
+namespace nifti_aux
+{
+
+//! \brief Размер блока, сжимаемого одним потоком
+constexpr size_t gzip_block_size = size_t(128) << 10;
+
+//! \brief Размер словаря deflate
+constexpr size_t gzip_dictionary_size = size_t(32) << 10;
+
+//! \brief Количество блоков на поток, накапливаемых перед сжатием
+constexpr size_t gzip_blocks_per_thread = 4;
+
+//! \brief Размер блока распакованных данных при чтении и количество блоков, на которое распаковка опережает чтение
+constexpr size_t gunzip_chunk_size = size_t(1) << 20;
+constexpr size_t gunzip_chunks_ahead = 4;
+
+//! \brief Проверка сигнатуры gzip в начале файла
+inline bool	is_gzip_file(const wstring &filename)
+{
+	shared_cfile	file(filename, L"rb");
+	uint8_t	signature[2] = {0, 0};
+	return file.read(signature, 1, 2) == 2 && signature[0] == 0x1f && signature[1] == 0x8b;
+}
+
+/*!
+	\brief Чтение начала распакованных данных (например, заголовка) функцией gzread, без потока распаковки
+
+	Возвращает количество прочитанных байт (меньше size, если данные короче).
+*/
+inline size_t	gzip_read_prefix(const wstring &filename, void *data, size_t size)
+{
+#if defined(XRAD_USE_CFILE_WIN32_VERSION)
+	gzFile	file = gzopen_w(GetPathSystemRawFromAutodetect(filename).c_str(), "rb");
+#else
+	gzFile	file = gzopen(convert_to_string(GetPathSystemRawFromAutodetect(filename)).c_str(), "rb");
+#endif
+	if(!file)
+	{
+		throw runtime_error(ssprintf("gzip_read_prefix: can't open file \"%s\"",
+				EnsureType<const char*>(convert_to_string(filename).c_str())));
+	}
+	int	n = gzread(file, data, unsigned(size));
+	gzclose(file);
+	if(n < 0)
+	{
+		throw runtime_error(ssprintf("gzip_read_prefix: read error, file \"%s\"",
+				EnsureType<const char*>(convert_to_string(filename).c_str())));
+	}
+	return size_t(n);
+}
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Запись файла gzip с многопоточным сжатием
+
+	Данные передаются функцией Write() порциями произвольного размера. Finish() сжимает
+	остаток и записывает завершение файла; без вызова Finish() файл остается неполным.
+*/
+class gzip_parallel_writer
+{
+	public:
+		explicit gzip_parallel_writer(const wstring &filename, int level = Z_DEFAULT_COMPRESSION):
+			m_filename(filename), m_level(level)
+		{
+			size_t	n_threads = max(size_t(omp_get_max_threads()), size_t(1));
+			m_input.reserve(gzip_dictionary_size + n_threads*gzip_blocks_per_thread*gzip_block_size);
+			m_input_capacity = n_threads*gzip_blocks_per_thread*gzip_block_size;
+			m_file.open(filename, L"wb");
+
+			// заголовок gzip: без имени файла и времени, OS = unknown
+			const uint8_t	header[10] = {0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xff};
+			WriteBytes(header, sizeof(header));
+		}
+
+		gzip_parallel_writer(const gzip_parallel_writer &) = delete;
+		gzip_parallel_writer &operator=(const gzip_parallel_writer &) = delete;
+
+		void	Write(const void *data, size_t size)
+		{
+			XRAD_ASSERT_THROW(!m_finished);
+			const uint8_t	*bytes = static_cast<const uint8_t*>(data);
+			while(size)
+			{
+				size_t	n = min(size, m_dictionary_size + m_input_capacity - m_input.size());
+				m_input.insert(m_input.end(), bytes, bytes + n);
+				bytes += n;
+				size -= n;
+				if(m_input.size() == m_dictionary_size + m_input_capacity)
+					CompressInput(false);
+			}
+		}
+
+		void	Finish()
+		{
+			XRAD_ASSERT_THROW(!m_finished);
+			CompressInput(true);
+			uint8_t	trailer[8];
+			for(size_t i = 0; i < 4; ++i)
+			{
+				trailer[i] = uint8_t(m_crc >> (8*i));
+				trailer[4 + i] = uint8_t(m_total_size >> (8*i));
+			}
+			WriteBytes(trailer, sizeof(trailer));
+			m_file.close();
+			m_finished = true;
+		}
+
+	private:
+		struct compressed_block
+		{
+			vector<uint8_t>	data;
+			uLong	crc;
+			size_t	size;
+		};
+
+		//! \brief Сжатие накопленных данных (кроме словаря в начале m_input) и запись в файл
+		void	CompressInput(bool final)
+		{
+			size_t	data_size = m_input.size() - m_dictionary_size;
+			// последний блок должен существовать даже для пустого файла: он содержит признак конца потока
+			size_t	n_blocks = max((data_size + gzip_block_size - 1)/gzip_block_size, size_t(final ? 1 : 0));
+			m_blocks.resize(n_blocks);
+
+			ThreadErrorCollector	ec("gzip_parallel_writer::CompressInput");
+			#pragma omp parallel for schedule (dynamic)
+			for(ptrdiff_t i = 0; i < ptrdiff_t(n_blocks); ++i)
+			{
+				if(ec.HasErrors())
+					continue;
+				ThreadSetup ts; (void)ts;
+				try
+				{
+					size_t	begin = m_dictionary_size + size_t(i)*gzip_block_size;
+					size_t	end = min(begin + gzip_block_size, m_input.size());
+					size_t	dictionary_begin = begin - min(begin, gzip_dictionary_size);
+					CompressBlock(m_blocks[i], m_input.data() + dictionary_begin, begin - dictionary_begin,
+							m_input.data() + begin, end - begin, final && size_t(i) == n_blocks - 1);
+				}
+				catch(...)
+				{
+					ec.CatchException();
+				}
+			}
+			ec.ThrowIfErrors();
+
+			for(auto &block: m_blocks)
+			{
+				WriteBytes(block.data.data(), block.data.size());
+				m_crc = crc32_combine(m_crc, block.crc, z_off_t(block.size));
+				m_total_size += block.size;
+			}
+
+			// конец данных становится словарем для следующего блока
+			size_t	dictionary_begin = m_input.size() - min(m_input.size(), gzip_dictionary_size);
+			m_input.erase(m_input.begin(), m_input.begin() + dictionary_begin);
+			m_dictionary_size = m_input.size();
+		}
+
+		void	CompressBlock(compressed_block &block,
+				const uint8_t *dictionary, size_t dictionary_size,
+				const uint8_t *data, size_t size, bool last)
+		{
+			z_stream	stream;
+			memset(&stream, 0, sizeof(stream));
+			// отрицательный windowBits: "сырой" deflate без заголовка zlib
+			if(deflateInit2(&stream, m_level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+				throw runtime_error("gzip_parallel_writer: deflateInit2 error");
+			if(dictionary_size)
+				deflateSetDictionary(&stream, dictionary, uInt(dictionary_size));
+
+			// запас на маркер Z_SYNC_FLUSH
+			block.data.resize(deflateBound(&stream, uLong(size)) + 16);
+			stream.next_in = const_cast<Bytef*>(data);
+			stream.avail_in = uInt(size);
+			stream.next_out = block.data.data();
+			stream.avail_out = uInt(block.data.size());
+			int	status = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+			size_t	compressed_size = block.data.size() - stream.avail_out;
+			deflateEnd(&stream);
+			if(status != (last ? Z_STREAM_END : Z_OK) || stream.avail_in)
+				throw runtime_error(ssprintf("gzip_parallel_writer: deflate error %d", status));
+
+			block.data.resize(compressed_size);
+			block.crc = crc32(crc32(0, Z_NULL, 0), data, uInt(size));
+			block.size = size;
+		}
+
+		void	WriteBytes(const void *data, size_t size)
+		{
+			if(size && m_file.write(data, 1, size) != size)
+			{
+				throw runtime_error(ssprintf("gzip_parallel_writer: write error, file \"%s\"",
+						EnsureType<const char*>(convert_to_string(m_filename).c_str())));
+			}
+		}
+
+	private:
+		wstring	m_filename;
+		shared_cfile	m_file;
+		int	m_level;
+		bool	m_finished = false;
+
+		//! \brief Словарь (последние данные предыдущих блоков) и накопленные несжатые данные
+		vector<uint8_t>	m_input;
+		size_t	m_dictionary_size = 0;
+		size_t	m_input_capacity;
+		vector<compressed_block>	m_blocks;
+
+		uLong	m_crc = crc32(0, Z_NULL, 0);
+		size_t	m_total_size = 0;
+};
+
+//--------------------------------------------------------------
+
+/*!
+	\brief Чтение файла gzip с распаковкой в отдельном потоке
+
+	Файлы из нескольких последовательных потоков gzip (в т.ч. созданные pigz) читаются целиком.
+	Нулевые байты после конца потока (дополнение файла до размера блока) считаются концом данных.
+	Ошибки распаковки передаются в вызывающий поток из Read().
+*/
+class gzip_pipelined_reader
+{
+	public:
+		explicit gzip_pipelined_reader(const wstring &filename):
+			m_filename(filename), m_file(filename, L"rb")
+		{
+			m_thread = thread([this]() { InflateThread(); });
+		}
+
+		~gzip_pipelined_reader()
+		{
+			{
+				lock_guard<mutex>	lock(m_mutex);
+				m_stop = true;
+			}
+			m_cv.notify_all();
+			m_thread.join();
+		}
+
+		gzip_pipelined_reader(const gzip_pipelined_reader &) = delete;
+		gzip_pipelined_reader &operator=(const gzip_pipelined_reader &) = delete;
+
+		//! \brief Чтение size байт. Возвращает количество прочитанных байт (меньше size в конце данных)
+		size_t	Read(void *data, size_t size)
+		{
+			uint8_t	*bytes = static_cast<uint8_t*>(data);
+			size_t	result = 0;
+			while(result < size)
+			{
+				if(m_position == m_current.size() && !NextChunk())
+					break;
+				size_t	n = min(size - result, m_current.size() - m_position);
+				if(bytes)
+					memcpy(bytes + result, m_current.data() + m_position, n);
+				m_position += n;
+				result += n;
+			}
+			return result;
+		}
+
+		//! \brief Чтение ровно size байт, иначе исключение
+		void	ReadExact(void *data, size_t size)
+		{
+			if(Read(data, size) != size)
+			{
+				throw runtime_error(ssprintf("gzip_pipelined_reader: unexpected end of data, file \"%s\"",
+						EnsureType<const char*>(convert_to_string(m_filename).c_str())));
+			}
+		}
+
+		void	Skip(size_t size)
+		{
+			if(Read(nullptr, size) != size)
+			{
+				throw runtime_error(ssprintf("gzip_pipelined_reader: unexpected end of data, file \"%s\"",
+						EnsureType<const char*>(convert_to_string(m_filename).c_str())));
+			}
+		}
+
+	private:
+		//! \brief Получение следующего распакованного блока. false -- данные закончились
+		bool	NextChunk()
+		{
+			unique_lock<mutex>	lock(m_mutex);
+			if(m_current.capacity())
+				m_free.push_back(std::move(m_current));
+			m_current = vector<uint8_t>();
+			m_position = 0;
+			m_cv.notify_all();
+			m_cv.wait(lock, [this]() { return !m_ready.empty() || m_finished; });
+			if(m_ready.empty())
+			{
+				if(m_error)
+					rethrow_exception(m_error);
+				return false;
+			}
+			m_current = std::move(m_ready.front());
+			m_ready.pop_front();
+			m_cv.notify_all();
+			return true;
+		}
+
+		void	InflateThread()
+		{
+			try
+			{
+				Inflate();
+			}
+			catch(...)
+			{
+				lock_guard<mutex>	lock(m_mutex);
+				m_error = current_exception();
+			}
+			{
+				lock_guard<mutex>	lock(m_mutex);
+				m_finished = true;
+			}
+			m_cv.notify_all();
+		}
+
+		void	Inflate()
+		{
+			z_stream	stream;
+			memset(&stream, 0, sizeof(stream));
+			// 16 + MAX_WBITS: формат gzip
+			if(inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+				throw runtime_error("gzip_pipelined_reader: inflateInit2 error");
+			unique_ptr<z_stream, int(*)(z_streamp)>	stream_guard(&stream, inflateEnd);
+
+			vector<uint8_t>	input(gunzip_chunk_size);
+			vector<uint8_t>	output;
+			bool	input_end = false;
+			bool	stream_end = false;
+			for(;;)
+			{
+				if(!stream.avail_in && !input_end)
+				{
+					size_t	n = m_file.read(input.data(), 1, input.size());
+					input_end = !n;
+					stream.next_in = input.data();
+					stream.avail_in = uInt(n);
+				}
+				if(stream_end)
+				{
+					// нулевые байты после конца потока -- дополнение, а не начало следующего потока
+					while(stream.avail_in && !*stream.next_in)
+					{
+						++stream.next_in;
+						--stream.avail_in;
+					}
+					if(!stream.avail_in)
+					{
+						if(input_end)
+							break;
+						continue;
+					}
+					// следующий поток gzip в том же файле
+					inflateReset(&stream);
+					stream_end = false;
+				}
+				if(output.empty())
+				{
+					if(!AcquireBuffer(output))
+						return;
+					output.resize(gunzip_chunk_size);
+					stream.next_out = output.data();
+					stream.avail_out = uInt(output.size());
+				}
+				int	status = inflate(&stream, Z_NO_FLUSH);
+				if(status == Z_STREAM_END)
+				{
+					stream_end = true;
+				}
+				else if(status == Z_BUF_ERROR && input_end && !stream.avail_in)
+				{
+					throw runtime_error(ssprintf("gzip_pipelined_reader: unexpected end of file \"%s\"",
+							EnsureType<const char*>(convert_to_string(m_filename).c_str())));
+				}
+				else if(status != Z_OK && status != Z_BUF_ERROR)
+				{
+					throw runtime_error(ssprintf("gzip_pipelined_reader: inflate error %d, file \"%s\"",
+							status, EnsureType<const char*>(convert_to_string(m_filename).c_str())));
+				}
+				if(!stream.avail_out)
+					PublishBuffer(output, output.size());
+			}
+			if(!output.empty())
+				PublishBuffer(output, output.size() - stream.avail_out);
+		}
+
+		//! \brief Ожидание свободного места в очереди. false -- чтение прекращено
+		bool	AcquireBuffer(vector<uint8_t> &buffer)
+		{
+			unique_lock<mutex>	lock(m_mutex);
+			m_cv.wait(lock, [this]() { return m_stop || m_ready.size() < gunzip_chunks_ahead; });
+			if(m_stop)
+				return false;
+			if(!m_free.empty())
+			{
+				buffer = std::move(m_free.back());
+				m_free.pop_back();
+			}
+			return true;
+		}
+
+		void	PublishBuffer(vector<uint8_t> &buffer, size_t size)
+		{
+			buffer.resize(size);
+			{
+				lock_guard<mutex>	lock(m_mutex);
+				m_ready.push_back(std::move(buffer));
+			}
+			buffer = vector<uint8_t>();
+			m_cv.notify_all();
+		}
+
+	private:
+		wstring	m_filename;
+		shared_cfile	m_file;
+
+		//! \brief Блок, из которого читает Read(), и позиция в нем
+		vector<uint8_t>	m_current;
+		size_t	m_position = 0;
+
+		mutex	m_mutex;
+		condition_variable	m_cv;
+		deque<vector<uint8_t>>	m_ready;
+		vector<vector<uint8_t>>	m_free;
+		bool	m_finished = false;
+		bool	m_stop = false;
+		exception_ptr	m_error;
+
+		thread	m_thread;
+};
+
+}//namespace nifti_aux
+
+XRAD_END
+
+#endif // nifti_gzip_h__
@@ -13,9 +13,13 @@
 //------------------------------------------------------------------
 
 #include <XRADSystem/sources/nifti/nifti_datatypes.h>
+#include <XRADSystem/sources/nifti/nifti_gzip.h>
 
 #include <XRADSystem/CFile.h>
+#include <XRADSystem/Sources/System/FileNameOperations.h>
+#include <XRADSystem/Sources/System/MappedDataArrayMD.h>
 #include <XRADBasic/ContainersAlgebra.h>
+#include <cstring>
 
 namespace xrad
 {
@@ -45,15 +49,9 @@ namespace nifti_aux
 	}
 
 
-	template<class ARR>
-	void load_nifti_util(ARR &result, RealFunctionF64 &scales, wstring filename)
+	//! \brief Разбор заголовка: размеры (последний индекс соответствует dim[1]) и шаги сетки
+	inline void	parse_nifti_header(const nifti_1_header &hdr, index_vector &sizes, RealFunctionF64 &scales)
 	{
-		shared_cfile	header_file(filename, L"rb");
-		nifti_1_header hdr;
-		index_vector	sizes;
-		header_file.read(&hdr, sizeof(nifti_1_header), 1);
-		// FILE *file = fopen(name, "rb"); fread(file, buffer, n, 1);
-
 		XRAD_ASSERT_THROW(hdr.sizeof_hdr==sizeof(nifti_1_header));
 		XRAD_ASSERT_THROW(hdr.dim[0] < 7);
 
@@ -61,27 +59,148 @@ namespace nifti_aux
 		sizes.realloc(hdr.dim[0]);
 		std::copy(hdr.dim + 1, hdr.dim + sizes.size()+1, sizes.rbegin());
 		std::copy(hdr.pixdim + 1, hdr.pixdim + scales.size()+1, scales.rbegin());
+	}
 
-		realloc_array(result, sizes);
+	//! \brief Чтение заголовка файла: размеры (последний индекс соответствует dim[1]) и шаги сетки
+	inline nifti_1_header	read_nifti_header(shared_cfile &header_file, index_vector &sizes, RealFunctionF64 &scales)
+	{
+		nifti_1_header hdr;
+		header_file.read(&hdr, sizeof(nifti_1_header), 1);
+		// FILE *file = fopen(name, "rb"); fread(file, buffer, n, 1);
+		parse_nifti_header(hdr, sizes, scales);
+		return hdr;
+	}
 
-		shared_cfile	data_file;
+	//! \brief Чтение заголовка из файла .nii, .hdr или .nii.gz
+	inline nifti_1_header	read_nifti_file_header(const wstring &filename)
+	{
+		nifti_1_header hdr;
+		if(is_gzip_file(filename))
+		{
+			if(gzip_read_prefix(filename, &hdr, sizeof(nifti_1_header)) != sizeof(nifti_1_header))
+			{
+				throw runtime_error(ssprintf("NIfTI file \"%s\": unexpected end of data",
+						EnsureType<const char*>(convert_to_string(filename).c_str())));
+			}
+		}
+		else
+		{
+			shared_cfile	header_file(filename, L"rb");
+			header_file.read(&hdr, sizeof(nifti_1_header), 1);
+		}
+		return hdr;
+	}
 
+	//! \brief Файл, содержащий данные изображения, и смещение данных в нем
+	inline wstring	nifti_data_filename(const wstring &filename, const nifti_1_header &hdr, file_offset_t &offset)
+	{
 		if(!strcmp(hdr.magic, "n+1"))
 		{
-			data_file = header_file;
-	//		data_file.seek(sizeof(nifti1_extender) + sizeof(nifti_1_header), SEEK_SET);//fseek
-			data_file.seek(hdr.vox_offset, SEEK_SET);//fseek
+			offset = file_offset_t(hdr.vox_offset);
+			return filename;
 		}
 		else if(!strcmp(hdr.magic, "ni1"))
 		{
-			wstring	img_filename = file_path(filename) + wpath_separator() + filename_without_extension(filename) + L".img";
-			data_file.open(img_filename, L"rb");
-			data_file.seek(0, SEEK_SET);//fseek
+			offset = 0;
+			return file_path(filename) + wpath_separator() + filename_without_extension(filename) + L".img";
 		}
+		throw invalid_argument(ssprintf("NIfTI file \"%s\": unknown magic string",
+				EnsureType<const char*>(convert_to_string(filename).c_str())));
+	}
 
+	//! \brief Чтение данных изображения построчно по мере распаковки
+	template<class codec, class ARR>
+	void read_nifti_rows(gzip_pipelined_reader &reader, ARR &result, const nifti_1_header &hdr)
+	{
+		using file_type = typename codec::file_type;
+		vector<uint8_t>	buffer;
+		for_each_nifti_row(result, [&](auto &&row)
+		{
+			using sample_type = typename remove_reference_t<decltype(row)>::value_type;
+			if constexpr(!is_constructible<sample_type, file_type>::value)
+			{
+				throw invalid_argument(ssprintf("NIfTI file data type (%d) can't be converted to the array type",
+						int(hdr.datatype)));
+			}
+			else
+			{
+				size_t	n = row.size();
+				if constexpr(codec::raw && is_same<sample_type, file_type>::value)
+				{
+					// распаковка прямо в массив
+					if(auto data = DataArrayIOAuxiliaries::contiguous_data<file_type>(row.begin(), n))
+					{
+						reader.ReadExact(data, n*codec::size);
+						return;
+					}
+				}
+				buffer.resize(n*codec::size);
+				reader.ReadExact(buffer.data(), buffer.size());
+				auto	it = row.begin();
+				for(size_t i = 0; i < n; ++i, ++it)
+					*it = sample_type(codec::get(&buffer[i*codec::size]));
+			}
+		});
+	}
 
+	template<class ARR>
+	void read_nifti_data(gzip_pipelined_reader &reader, ARR &result, const nifti_1_header &hdr)
+	{
+		nifti_datatype_dispatch(hdr.datatype, hdr.bitpix, [&](auto codec)
+		{
+			read_nifti_rows<decltype(codec)>(reader, result, hdr);
+		});
+	}
+
+	template<class ARR>
+	void load_nifti_gz_util(ARR &result, RealFunctionF64 &scales, const wstring &filename)
+	{
+		gzip_pipelined_reader	reader(filename);
+		nifti_1_header	hdr;
+		reader.ReadExact(&hdr, sizeof(nifti_1_header));
+		index_vector	sizes;
+		parse_nifti_header(hdr, sizes, scales);
+		if(strcmp(hdr.magic, "n+1") || hdr.vox_offset < float(sizeof(nifti_1_header)))
+		{
+			throw invalid_argument(ssprintf("NIfTI file \"%s\": compressed file must contain image data after the header",
+					EnsureType<const char*>(convert_to_string(filename).c_str())));
+		}
+		reader.Skip(size_t(hdr.vox_offset) - sizeof(nifti_1_header));
+
+		realloc_array(result, sizes);
+		read_nifti_data(reader, result, hdr);
+	}
+
+	template<class ARR>
+	void load_nifti_util(ARR &result, RealFunctionF64 &scales, wstring filename)
+	{
+		if(is_gzip_file(filename))
+		{
+			load_nifti_gz_util(result, scales, filename);
+			return;
+		}
+		shared_cfile	header_file(filename, L"rb");
+		index_vector	sizes;
+		nifti_1_header	hdr = read_nifti_header(header_file, sizes, scales);
+
+		realloc_array(result, sizes);
+
+		shared_cfile	data_file;
+		file_offset_t	offset;
+		wstring	data_filename = nifti_data_filename(filename, hdr, offset);
+
+		if(data_filename == filename)
+		{
+			data_file = header_file;
+	//		data_file.seek(sizeof(nifti1_extender) + sizeof(nifti_1_header), SEEK_SET);//fseek
+			data_file.seek(offset, SEEK_SET);//fseek
+		}
+		else
+		{
+			data_file.open(data_filename, L"rb");
+			data_file.seek(offset, SEEK_SET);//fseek
+		}
 
-		
 		data_file.read_numbers(result, nifti_format_to_io_enum(hdr.datatype, hdr.bitpix));
 
 		//TODO hdr.scl_slope, hdr.scl_inter сейчас никак не учтены. С точки зрения CT тестовый датасет некорректен (intercept должен был бы быть равен -1000 или 1000 или наподобие)
@@ -108,9 +227,7 @@ enum number_complexity_e
 
 inline void	get_nifti_info(const wstring &filename, index_vector &sizes, number_complexity_e &format, size_t &bits_per_number)
 {
-	shared_cfile	header_file(filename, L"rb");
-	nifti_1_header hdr;
-	header_file.read(&hdr, sizeof(nifti_1_header), 1);
+	nifti_1_header hdr = nifti_aux::read_nifti_file_header(filename);
 	sizes.realloc(hdr.dim[0]);
 	std::copy(hdr.dim + 1, hdr.dim + sizes.size()+1, sizes.rbegin());
 
@@ -177,6 +294,46 @@ void load_nifti(DataArrayMD<SLICE_T>& result, RealFunctionF64& scales, wstring f
 	nifti_aux::load_nifti_util(result, scales, filename);
 }
 
+/*!
+	\brief Отображение в память тома NIfTI (.nii или .hdr/.img) без чтения данных
+
+	Тип элементов массива должен точно соответствовать типу данных в файле
+	(преобразование типов выполняет load_nifti). Данные читаются с диска при первом обращении.
+	hdr.scl_slope, hdr.scl_inter не учитываются, как и в load_nifti.
+	Сжатые файлы (.nii.gz) отобразить нельзя, их следует читать load_nifti.
+*/
+template<class ARR>
+void map_nifti(MappedDataArrayMD<ARR> &result, RealFunctionF64 &scales, const wstring &filename,
+		mapped_file_mode mode = mapped_file_mode::read_only)
+{
+	typedef remove_const_t<typename ARR::value_type> sample_type;
+
+	if(nifti_aux::is_gzip_file(filename))
+	{
+		throw invalid_argument(ssprintf("map_nifti, \"%s\": compressed file can't be mapped, use load_nifti",
+				EnsureType<const char*>(convert_to_string(filename).c_str())));
+	}
+
+	index_vector	sizes;
+	nifti_1_header	hdr;
+	{
+		shared_cfile	header_file(filename, L"rb");
+		hdr = nifti_aux::read_nifti_header(header_file, sizes, scales);
+	}
+	if(hdr.datatype != nifti_datatype<sample_type>() || hdr.bitpix != nifti_sample_size(sample_type()))
+	{
+		throw invalid_argument(ssprintf("map_nifti, \"%s\": file data type (%d, %d bits) differs from the array type, use load_nifti",
+				EnsureType<const char*>(convert_to_string(filename).c_str()),
+				int(hdr.datatype),
+				int(hdr.bitpix)));
+	}
+	XRAD_ASSERT_THROW(sizes.size() >= 3);
+
+	file_offset_t	offset;
+	wstring	data_filename = nifti_aux::nifti_data_filename(filename, hdr, offset);
+	result.MapData(make_shared<MappedFile>(data_filename, mode), offset, sizes);
+}
+
 
 }//namespace xrad
 